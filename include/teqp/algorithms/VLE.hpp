@@ -1,12 +1,15 @@
 #pragma once
 
 #include <optional>
+#include <atomic>
+#include <chrono>
 #include "teqp/derivs.hpp"
 #include "teqp/exceptions.hpp"
 #include "teqp/algorithms/critical_tracing.hpp"
 #include "teqp/algorithms/critical_pure.hpp"
 #include "teqp/algorithms/VLE_types.hpp"
 #include "teqp/algorithms/VLE_pure.hpp"
+#include "teqp/algorithms/trace_sinks.hpp"
 #include <Eigen/Dense>
 
 // Imports from boost for numerical integration
@@ -15,6 +18,10 @@
 #include <boost/numeric/odeint/stepper/euler.hpp>
 
 
+// Imports from boost for the thread pool
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
+
 // Imports from Eigen unsupported for hybrj method
 #include <unsupported/Eigen/NonLinearOptimization>
 
@@ -93,8 +100,11 @@ inline auto mix_VLE_Tx(const AbstractModel& model, double T, const Eigen::ArrayX
 
     for (int iter = 0; iter < maxiter; ++iter) {
 
-        auto [PsirL, PsirgradL, hessianL] = model.build_Psir_fgradHessian_autodiff(T, rhovecL);
-        auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
+        const auto derL = model.build_isochoric_derivative_bundle(T, rhovecL, false);
+        const auto derV = model.build_isochoric_derivative_bundle(T, rhovecV, false);
+        const auto &PsirL = derL.Psir, &PsirV = derV.Psir;
+        const auto &PsirgradL = derL.gradient_Psir, &PsirgradV = derV.gradient_Psir;
+        const auto &hessianL = derL.Hessian_Psir, &hessianV = derV.Hessian_Psir;
         auto rhoL = rhovecL.sum();
         auto rhoV = rhovecV.sum();
         Scalar pL = rhoL * RT - PsirL + (rhovecL.array() * PsirgradL.array()).sum(); // The (array*array).sum is a dot product
@@ -200,14 +210,29 @@ struct hybrj_functor__mix_VLE_Tp : Functor<double>
 
     hybrj_functor__mix_VLE_Tp(const Model& model, const double T, const double p) : Functor<double>(4, 4), model(model), T(T), p(p) {}
 
+    /// The derivatives of both phases at the last point; hybrj asks for the residual and the Jacobian at the same point, so the derivatives are only calculated once for both
+    Eigen::VectorXd x_last;
+    std::optional<std::tuple<IsochoricDerivativeBundle, IsochoricDerivativeBundle>> ders_last;
+    
+    const auto& get_derivatives(const VectorXd& x){
+        if (!ders_last || x_last.size() != x.size() || x_last != x){
+            const VectorXd::Index n = x.size() / 2;
+            Eigen::ArrayXd rhovecL = x.head(n).array(), rhovecV = x.tail(n).array();
+            ders_last = std::make_tuple(model.build_isochoric_derivative_bundle(T, rhovecL, false), model.build_isochoric_derivative_bundle(T, rhovecV, false));
+            x_last = x;
+        }
+        return ders_last.value();
+    }
+
     int operator()(const VectorXd& x, VectorXd& r)
     {
         const VectorXd::Index n = x.size() / 2;
         Eigen::Map<const Eigen::ArrayXd> rhovecL(&(x(0)), n);
         Eigen::Map<const Eigen::ArrayXd> rhovecV(&(x(0 + n)), n);
         auto RT = model.get_R((rhovecL / rhovecL.sum()).eval()) * T;
-        auto [PsirL, PsirgradL, hessianL] = model.build_Psir_fgradHessian_autodiff(T, rhovecL);
-        auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
+        const auto& [derL, derV] = get_derivatives(x);
+        const auto &PsirL = derL.Psir, &PsirV = derV.Psir;
+        const auto &PsirgradL = derL.gradient_Psir, &PsirgradV = derV.gradient_Psir;
         auto rhoL = rhovecL.sum();
         auto rhoV = rhovecV.sum();
         Scalar pL = rhoL * RT - PsirL + (rhovecL.array() * PsirgradL.array()).sum(); // The (array*array).sum is a dot product
@@ -241,8 +266,8 @@ struct hybrj_functor__mix_VLE_Tp : Functor<double>
         assert(J.cols() == 2*n);
 
         auto RT = model.get_R((rhovecL / rhovecL.sum()).eval()) * T;
-        auto [PsirL, PsirgradL, hessianL] = model.build_Psir_fgradHessian_autodiff(T, rhovecL);
-        auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
+        const auto& [derL, derV] = get_derivatives(x);
+        const auto &hessianL = derL.Hessian_Psir, &hessianV = derV.Hessian_Psir;
         auto dpdrhovecL = RT + (hessianL * rhovecL.matrix()).array();
         auto dpdrhovecV = RT + (hessianV * rhovecV.matrix()).array();
 
@@ -432,10 +457,13 @@ inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eige
         auto RVT = RLT; // Note: this should not be exactly the same if you use mole-fraction-weighted gas constants
         
         // calculations from the EOS in the isochoric thermodynamics formalism
-        auto [PsirL, PsirgradL, hessianL] = model.build_Psir_fgradHessian_autodiff(T, rhovecL);
-        auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-        auto DELTAdmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecL.eval())
-                              - model.build_d2PsirdTdrhoi_autodiff(T, rhovecV.eval())).eval();
+        // All the derivatives of each phase in one call
+        const auto derL = model.build_isochoric_derivative_bundle(T, rhovecL);
+        const auto derV = model.build_isochoric_derivative_bundle(T, rhovecV);
+        const auto &PsirL = derL.Psir, &PsirV = derV.Psir;
+        const auto &PsirgradL = derL.gradient_Psir, &PsirgradV = derV.gradient_Psir;
+        const auto &hessianL = derL.Hessian_Psir, &hessianV = derV.Hessian_Psir;
+        auto DELTAdmu_dT_res = (derL.d2PsirdTdrhovec - derV.d2PsirdTdrhovec).eval();
 
         auto make_diag = [](const Eigen::ArrayXd& v) -> Eigen::ArrayXXd {
             Eigen::MatrixXd A = Eigen::MatrixXd::Identity(v.size(), v.size());
@@ -470,10 +498,10 @@ inline auto mixture_VLE_px(const AbstractModel& model, double p_spec, const Eige
         J.block(0, 1, N, N) = HtotL; // These are the concentration derivatives
         J.block(0, N+1, N, N) = -HtotV; // These are the concentration derivatives
         // Pressure contributions in Jacobian
-        J(N, 0) = model.get_dpdT_constrhovec(T, rhovecL)/p_spec;
+        J(N, 0) = derL.dpdT()/p_spec;
         J.block(N, 1, 1, N) = dpdrhovecL.transpose()/p_spec;
         // No vapor concentration derivatives
-        J(N+1, 0) = model.get_dpdT_constrhovec(T, rhovecV)/p_spec;
+        J(N+1, 0) = derV.dpdT()/p_spec;
         // No liquid concentration derivatives
         J.block(N+1, N+1, 1, N) = dpdrhovecV.transpose()/p_spec;
         // Mole fraction contributions in Jacobian
@@ -785,14 +813,10 @@ auto get_dpsat_dTsat_isopleth(const Model& model, const double& T, const Eigen::
     //return der;
 }
 
-/***
- * \brief Trace an isotherm with parametric tracing
- * \ note If options.revision is 2, the data will be returned in the "data" field, otherwise the data will be returned as root array
-*/
-inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<TVLEOptions>& options = std::nullopt)
+namespace detail{
+/// The isotherm tracer; if sink is not null, the points are passed to the sink rather than stored in the returned JSON
+inline nlohmann::json trace_VLE_isotherm_binary(const AbstractModel &model, double T, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const TVLEOptions& opt, TraceSink* sink)
 {
-    // Get the options, or the default values if not provided
-    TVLEOptions opt = options.value_or(TVLEOptions{});
     auto N = rhovecL0.size();
     if (N != 2) {
         throw InvalidArgument("Size must be 2");
@@ -805,6 +829,16 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
 
     // Define datatypes and functions for tracing tools
     auto JSONdata = nlohmann::json::array();
+    
+    // The columns passed to the sink, if one is provided
+    std::vector<std::string> columns = {"t", "dt", "T / K", "pL / Pa", "pV / Pa", "c", "rhoL_0 / mol/m^3", "rhoL_1 / mol/m^3", "rhoV_0 / mol/m^3", "rhoV_1 / mol/m^3", "xL_0 / mole frac.", "xV_0 / mole frac.", "drhoL_0/dt", "drhoL_1/dt", "drhoV_0/dt", "drhoV_1/dt"};
+    if (opt.calc_criticality) {
+        columns.insert(columns.end(), {"crit. conditions L_0", "crit. conditions L_1", "crit. conditions V_0", "crit. conditions V_1"});
+    }
+    Eigen::ArrayXd row(columns.size());
+    if (sink != nullptr) {
+        sink->begin(columns);
+    }
 
     // Typedefs for the types
     using namespace boost::numeric::odeint;
@@ -900,6 +934,16 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
                 std::cout << "Something bad happened; couldn't calculate xprime in store_point" << std::endl;
             }
 
+            // Pass the data to the sink, in the order of the columns
+            if (sink != nullptr) {
+                row.head(16) << t, dt, T, pL, pV, c, rhovecL[0], rhovecL[1], rhovecV[0], rhovecV[1], rhovecL[0]/rhovecL.sum(), rhovecV[0]/rhovecV.sum(), last_drhodt[0], last_drhodt[1], last_drhodt[2], last_drhodt[3];
+                if (opt.calc_criticality) {
+                    row.tail(4) << model.get_criticality_conditions(T, rhovecL), model.get_criticality_conditions(T, rhovecV);
+                }
+                sink->push(row);
+                return;
+            }
+            
             // Store the data in a JSON structure
             nlohmann::json point = {
                 {"t", t},
@@ -1022,6 +1066,9 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
         store_point(); // last_drhodt is updated;
         
     }
+    if (sink != nullptr) {
+        sink->end();
+    }
     if (opt.revision == 1){
         return JSONdata;
     }
@@ -1039,15 +1086,32 @@ inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, cons
         throw teqp::InvalidArgument("revision is not valid");
     }
 }
+}
 
 /***
-* \brief Trace an isobar with parametric tracing
+ * \brief Trace an isotherm with parametric tracing
+ * \ note If options.revision is 2, the data will be returned in the "data" field, otherwise the data will be returned as root array
 */
-template<typename Model = AbstractModel>
-auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<PVLEOptions>& options = std::nullopt)
+inline auto trace_VLE_isotherm_binary(const AbstractModel &model, double T, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<TVLEOptions>& options = std::nullopt)
 {
     // Get the options, or the default values if not provided
-    PVLEOptions opt = options.value_or(PVLEOptions{});
+    return detail::trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, options.value_or(TVLEOptions{}), nullptr);
+}
+
+/***
+ * \brief Trace an isotherm with parametric tracing, passing each accepted point to the sink rather than storing it in JSON
+ * \note The columns are those of the JSON output, with the arrays split into one column per entry
+*/
+inline void trace_VLE_isotherm_binary(const AbstractModel &model, double T, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, TraceSink& sink, const std::optional<TVLEOptions>& options = std::nullopt)
+{
+    detail::trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, options.value_or(TVLEOptions{}), &sink);
+}
+
+namespace detail{
+/// The isobar tracer; if sink is not null, the points are passed to the sink rather than stored in the returned JSON
+template<typename Model = AbstractModel>
+nlohmann::json trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const PVLEOptions& opt, TraceSink* sink)
+{
     auto N = rhovecL0.size();
     if (N != 2) {
         throw InvalidArgument("Size must be 2");
@@ -1060,6 +1124,16 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
 
     // Define datatypes and functions for tracing tools
     auto JSONdata = nlohmann::json::array();
+    
+    // The columns passed to the sink, if one is provided
+    std::vector<std::string> columns = {"t", "dt", "T / K", "pL / Pa", "pV / Pa", "c", "rhoL_0 / mol/m^3", "rhoL_1 / mol/m^3", "rhoV_0 / mol/m^3", "rhoV_1 / mol/m^3", "xL_0 / mole frac.", "xV_0 / mole frac.", "dT/dt", "drhoL_0/dt", "drhoL_1/dt", "drhoV_0/dt", "drhoV_1/dt"};
+    if (opt.calc_criticality) {
+        columns.insert(columns.end(), {"crit. conditions L_0", "crit. conditions L_1", "crit. conditions V_0", "crit. conditions V_1"});
+    }
+    Eigen::ArrayXd row(columns.size());
+    if (sink != nullptr) {
+        sink->begin(columns);
+    }
 
     // Typedefs for the types
     using namespace boost::numeric::odeint;
@@ -1159,6 +1233,16 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
                 std::cout << "Something bad happened; couldn't calculate xprime in store_point" << std::endl;
             }
 
+            // Pass the data to the sink, in the order of the columns
+            if (sink != nullptr) {
+                row.head(17) << t, dt, T, pL, pV, c, rhovecL[0], rhovecL[1], rhovecV[0], rhovecV[1], rhovecL[0]/rhovecL.sum(), rhovecV[0]/rhovecV.sum(), last_drhodt[0], last_drhodt[1], last_drhodt[2], last_drhodt[3], last_drhodt[4];
+                if (opt.calc_criticality) {
+                    row.tail(4) << model.get_criticality_conditions(T, rhovecL), model.get_criticality_conditions(T, rhovecV);
+                }
+                sink->push(row);
+                return;
+            }
+            
             // Store the data in a JSON structure
             nlohmann::json point = {
                 {"t", t},
@@ -1280,12 +1364,105 @@ auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eige
         store_point(); // last_drhodt is updated;
 
     }
+    if (sink != nullptr) {
+        sink->end();
+    }
     return JSONdata;
 }
+}
+
+/***
+* \brief Trace an isobar with parametric tracing
+*/
+template<typename Model = AbstractModel>
+auto trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, const std::optional<PVLEOptions>& options = std::nullopt)
+{
+    // Get the options, or the default values if not provided
+    return detail::trace_VLE_isobar_binary(model, p, T0, rhovecL0, rhovecV0, options.value_or(PVLEOptions{}), nullptr);
+}
+
+/***
+* \brief Trace an isobar with parametric tracing, passing each accepted point to the sink rather than storing it in JSON
+* \note The columns are those of the JSON output, with the arrays split into one column per entry
+*/
+template<typename Model = AbstractModel>
+void trace_VLE_isobar_binary(const Model& model, double p, double T0, const Eigen::ArrayXd& rhovecL0, const Eigen::ArrayXd& rhovecV0, TraceSink& sink, const std::optional<PVLEOptions>& options = std::nullopt)
+{
+    detail::trace_VLE_isobar_binary(model, p, T0, rhovecL0, rhovecV0, options.value_or(PVLEOptions{}), &sink);
+}
+
+namespace detail{
+/**
+ * \brief Carry out a set of independent traces on a thread pool
+ *
+ * Each worker takes the next trace that has not been started yet, so long and short traces are balanced
+ * between the threads. The results are stored at the index of the spec, so the ordering of the output
+ * does not depend on the scheduling.
+ */
+template<typename Spec, typename Tracer>
+std::vector<VLETraceResult> run_traces(const std::vector<Spec>& specs, const Tracer& tracer, const std::size_t Nthreads){
+    std::vector<VLETraceResult> results(specs.size());
+    std::atomic<std::size_t> inext{0};
+    auto worker = [&](){
+        for (auto i = inext++; i < specs.size(); i = inext++){
+            auto& r = results[i];
+            auto tic = std::chrono::steady_clock::now();
+            try{
+                r.trace = tracer(specs[i]);
+                r.success = true;
+            }
+            catch(std::exception& e){
+                r.message = e.what();
+            }
+            auto toc = std::chrono::steady_clock::now();
+            r.elapsed_s = std::chrono::duration<double>(toc - tic).count();
+        }
+    };
+    const std::size_t Nworkers = std::max(std::size_t{1}, std::min(Nthreads, specs.size()));
+    if (Nworkers == 1){
+        worker();
+        return results;
+    }
+    boost::asio::thread_pool pool{Nworkers};
+    for (std::size_t i = 0; i < Nworkers; ++i){
+        boost::asio::post(pool, worker);
+    }
+    pool.join();
+    return results;
+}
+}
+
+/***
+ * \brief Trace a set of isotherms concurrently with Nthreads threads
+ * \note The model is shared between the threads and must not be modified while the traces are running
+ * \returns One result per spec, in the same order as the specs
+ */
+inline auto trace_VLE_isotherms_binary(const AbstractModel& model, const std::vector<VLEIsothermSpec>& specs, const std::size_t Nthreads = 1)
+{
+    auto tracer = [&model](const VLEIsothermSpec& spec){
+        return trace_VLE_isotherm_binary(model, spec.T, spec.rhovecL0, spec.rhovecV0, spec.options);
+    };
+    return detail::run_traces(specs, tracer, Nthreads);
+}
+
+/***
+ * \brief Trace a set of isobars concurrently with Nthreads threads
+ * \note The model is shared between the threads and must not be modified while the traces are running
+ * \returns One result per spec, in the same order as the specs
+ */
+inline auto trace_VLE_isobars_binary(const AbstractModel& model, const std::vector<VLEIsobarSpec>& specs, const std::size_t Nthreads = 1)
+{
+    auto tracer = [&model](const VLEIsobarSpec& spec){
+        return trace_VLE_isobar_binary(model, spec.p, spec.T0, spec.rhovecL0, spec.rhovecV0, spec.options);
+    };
+    return detail::run_traces(specs, tracer, Nthreads);
+}
 
 #define VLE_FUNCTIONS_TO_WRAP \
     X(trace_VLE_isobar_binary) \
     X(trace_VLE_isotherm_binary) \
+    X(trace_VLE_isobars_binary) \
+    X(trace_VLE_isotherms_binary) \
     X(get_dpsat_dTsat_isopleth) \
     X(get_drhovecdT_xsat) \
     X(get_drhovecdT_psat) \
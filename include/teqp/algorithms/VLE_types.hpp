@@ -1,5 +1,10 @@
 #pragma once
 
+#include <optional>
+#include <string>
+#include <Eigen/Dense>
+#include "nlohmann/json.hpp"
+
 namespace teqp{
 
 struct TVLEOptions {
@@ -49,4 +54,27 @@ struct MixVLEReturn {
     Eigen::ArrayXd r, initial_r;
 };
 
+/// The starting point of one isotherm in a batch of isotherms to be traced
+struct VLEIsothermSpec {
+    double T = -1; ///< Temperature, in K
+    Eigen::ArrayXd rhovecL0, rhovecV0; ///< Molar concentrations of the starting point, in mol/m^3
+    std::optional<TVLEOptions> options;
+};
+
+/// The starting point of one isobar in a batch of isobars to be traced
+struct VLEIsobarSpec {
+    double p = -1, ///< Pressure, in Pa
+    T0 = -1; ///< Temperature at the starting point, in K
+    Eigen::ArrayXd rhovecL0, rhovecV0; ///< Molar concentrations of the starting point, in mol/m^3
+    std::optional<PVLEOptions> options;
+};
+
+/// The outcome of one trace in a batch of traces
+struct VLETraceResult {
+    bool success = false; ///< False if the tracer threw an exception
+    std::string message = ""; ///< The message of the exception, if any
+    nlohmann::json trace; ///< The output of the tracer
+    double elapsed_s = -1; ///< Wall clock time taken by this trace, in seconds
+};
+
 }
@@ -1,8 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <vector>
+
 #include "teqp/derivs.hpp"
 #include "teqp/exceptions.hpp"
 #include "teqp/algorithms/VLLE_types.hpp"
+#include "teqp/algorithms/trace_sinks.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 
 // Imports from boost
@@ -45,26 +53,24 @@ namespace VLLE {
 
         for (int iter = 0; iter < maxiter; ++iter) {
 
-            auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-            auto [PsirL1, PsirgradL1, hessianL1] = model.build_Psir_fgradHessian_autodiff(T, rhovecL1);
-            auto [PsirL2, PsirgradL2, hessianL2] = model.build_Psir_fgradHessian_autodiff(T, rhovecL2);
+            // All the derivatives of each phase in one call; temperature derivatives are not needed at constant temperature
+            const auto derV = model.build_isochoric_derivative_bundle(T, rhovecV, false);
+            const auto derL1 = model.build_isochoric_derivative_bundle(T, rhovecL1, false);
+            const auto derL2 = model.build_isochoric_derivative_bundle(T, rhovecL2, false);
+            const auto &PsirgradV = derV.gradient_Psir, &PsirgradL1 = derL1.gradient_Psir, &PsirgradL2 = derL2.gradient_Psir;
             
-            auto HtotV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-            auto HtotL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-            auto HtotL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
-
-            auto zV = rhovecV/rhovecV.sum(), zL1 = rhovecL1 / rhovecL1.sum(), zL2 = rhovecL2 / rhovecL2.sum();
-            double RTL1 = model.get_R(zL1)*T, RTL2 = model.get_R(zL2)*T, RTV = model.get_R(zV)*T;
-
-            auto rhoL1 = rhovecL1.sum();
-            auto rhoL2 = rhovecL2.sum();
-            auto rhoV = rhovecV.sum();
-            double pL1 = rhoL1 * RTL1 - PsirL1 + (rhovecL1.array() * PsirgradL1.array()).sum(); // The (array*array).sum is a dot product
-            double pL2 = rhoL2 * RTL2 - PsirL2 + (rhovecL2.array() * PsirgradL2.array()).sum(); // The (array*array).sum is a dot product
-            double pV = rhoV * RTV - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-            auto dpdrhovecL1 = RTL1 + (hessianL1 * rhovecL1.matrix()).array();
-            auto dpdrhovecL2 = RTL2 + (hessianL2 * rhovecL2.matrix()).array();
-            auto dpdrhovecV = RTV + (hessianV * rhovecV.matrix()).array();
+            auto HtotV = derV.Hessian_Psi();
+            auto HtotL1 = derL1.Hessian_Psi();
+            auto HtotL2 = derL2.Hessian_Psi();
+
+            double RTL1 = derL1.R*T, RTL2 = derL2.R*T, RTV = derV.R*T;
+
+            double pL1 = derL1.p();
+            double pL2 = derL2.p();
+            double pV = derV.p();
+            auto dpdrhovecL1 = derL1.dpdrhovec();
+            auto dpdrhovecL2 = derL2.dpdrhovec();
+            auto dpdrhovecV = derV.dpdrhovec();
 
             // 2N rows are equality of chemical equilibria
             r.head(N) = PsirgradV + RTV*log(rhovecV) - (PsirgradL1 + RTL1*log(rhovecL1));
@@ -152,32 +158,29 @@ namespace VLLE {
         for (int iter = 0; iter < maxiter; ++iter) {
             T = x(x.size()-1);
 
-            auto [PsirV, PsirgradV, hessianV] = model.build_Psir_fgradHessian_autodiff(T, rhovecV);
-            auto [PsirL1, PsirgradL1, hessianL1] = model.build_Psir_fgradHessian_autodiff(T, rhovecL1);
-            auto [PsirL2, PsirgradL2, hessianL2] = model.build_Psir_fgradHessian_autodiff(T, rhovecL2);
+            // All the derivatives of each phase in one call, each is used several times below
+            const auto derV = model.build_isochoric_derivative_bundle(T, rhovecV);
+            const auto derL1 = model.build_isochoric_derivative_bundle(T, rhovecL1);
+            const auto derL2 = model.build_isochoric_derivative_bundle(T, rhovecL2);
+            const auto &PsirgradV = derV.gradient_Psir, &PsirgradL1 = derL1.gradient_Psir, &PsirgradL2 = derL2.gradient_Psir;
             
-            auto HtotV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-            auto HtotL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-            auto HtotL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
+            auto HtotV = derV.Hessian_Psi();
+            auto HtotL1 = derL1.Hessian_Psi();
+            auto HtotL2 = derL2.Hessian_Psi();
 
-            auto zV = rhovecV/rhovecV.sum(), zL1 = rhovecL1 / rhovecL1.sum(), zL2 = rhovecL2 / rhovecL2.sum();
-            double RL1 = model.get_R(zL1), RL2 = model.get_R(zL2), RV = model.get_R(zV);
+            double RL1 = derL1.R, RL2 = derL2.R, RV = derV.R;
             double RTL1 = RL1*T, RTL2 = RL2*T, RTV = RV*T;
 
-            auto rhoL1 = rhovecL1.sum();
-            auto rhoL2 = rhovecL2.sum();
-            auto rhoV = rhovecV.sum();
-            double pL1 = rhoL1 * RTL1 - PsirL1 + (rhovecL1.array() * PsirgradL1.array()).sum(); // The (array*array).sum is a dot product
-            double pL2 = rhoL2 * RTL2 - PsirL2 + (rhovecL2.array() * PsirgradL2.array()).sum(); // The (array*array).sum is a dot product
-            double pV = rhoV * RTV - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-            auto dpdrhovecL1 = RTL1 + (hessianL1 * rhovecL1.matrix()).array();
-            auto dpdrhovecL2 = RTL2 + (hessianL2 * rhovecL2.matrix()).array();
-            auto dpdrhovecV = RTV + (hessianV * rhovecV.matrix()).array();
+            double pL1 = derL1.p();
+            double pL2 = derL2.p();
+            double pV = derV.p();
+            auto dpdrhovecL1 = derL1.dpdrhovec();
+            auto dpdrhovecL2 = derL2.dpdrhovec();
+            auto dpdrhovecV = derV.dpdrhovec();
+            double dpdTV = derV.dpdT(), dpdTL1 = derL1.dpdT(), dpdTL2 = derL2.dpdT();
             
-            auto DELTAVL1dmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecV.eval())
-                                  - model.build_d2PsirdTdrhoi_autodiff(T, rhovecL1.eval())).eval();
-            auto DELTAL1L2dmu_dT_res = (model.build_d2PsirdTdrhoi_autodiff(T, rhovecL1.eval())
-                                  - model.build_d2PsirdTdrhoi_autodiff(T, rhovecL2.eval())).eval();
+            auto DELTAVL1dmu_dT_res = (derV.d2PsirdTdrhovec - derL1.d2PsirdTdrhovec).eval();
+            auto DELTAL1L2dmu_dT_res = (derL1.d2PsirdTdrhovec - derL2.d2PsirdTdrhovec).eval();
             auto DELTAVL1_dchempot_dT = (DELTAVL1dmu_dT_res + RV*log(rhovecV) - RL1*log(rhovecL1)).eval();
             auto DELTAL1L2_dchempot_dT = (DELTAL1L2dmu_dT_res + RL1*log(rhovecL1) - RL2*log(rhovecL2)).eval();
 
@@ -206,13 +209,13 @@ namespace VLLE {
             // Pressure contributions in Jacobian
             J.block(2*N, 0, 1, N) = dpdrhovecV.transpose();
             J.block(2*N, N, 1, N) = -dpdrhovecL1.transpose();
-            J(2*N, 2*N+2) = model.get_dpdT_constrhovec(T, rhovecV) - model.get_dpdT_constrhovec(T, rhovecL1);
+            J(2*N, 2*N+2) = dpdTV - dpdTL1;
             J.block(2 * N + 1, N, 1, N) = dpdrhovecL1.transpose();
             J.block(2 * N + 1, 2 * N, 1, N) = -dpdrhovecL2.transpose();
-            J(2*N+1, 2*N+2) = model.get_dpdT_constrhovec(T, rhovecL1) - model.get_dpdT_constrhovec(T, rhovecL2);
+            J(2*N+1, 2*N+2) = dpdTL1 - dpdTL2;
             
             J.block(2*N+2, 0, 1, N) = dpdrhovecV.transpose();
-            J(2*N+2, 2*N+2) = model.get_dpdT_constrhovec(T, rhovecV);
+            J(2*N+2, 2*N+2) = dpdTV;
             // Takes us to 2*N + 3 constraints, or 3*N+1 for N=2
 
             // Solve for the step
@@ -248,55 +251,149 @@ namespace VLLE {
         return std::make_tuple(return_code, Tfinal, rhovecVfinal, rhovecL1final, rhovecL2final);
     }
 
+    namespace detail{
+    
+        /// The bounding box of the segment between points index and index+1 of a curve, along the sweep axis ([lo, hi]) and the other axis ([olo, ohi])
+        struct SegmentBox {
+            double lo, hi, olo, ohi;
+            std::size_t index;
+            int curve;
+        };
+    
+        /// The sum of the lengths of the steps along one axis, relative to the range covered along that axis
+        template<typename Iterable>
+        inline void accumulate_steps(const Iterable& v, double& sum, double& vmin, double& vmax){
+            for (auto i = 0U; i + 1 < static_cast<std::size_t>(v.size()); ++i){
+                if (std::isfinite(v[i]) && std::isfinite(v[i+1])){
+                    sum += std::abs(v[i+1]-v[i]);
+                    vmin = std::min(vmin, std::min(v[i], v[i+1]));
+                    vmax = std::max(vmax, std::max(v[i], v[i+1]));
+                }
+            }
+        }
+    
+        /**
+         The segments are swept along the axis in which they overlap each other the least, that is the one in which the sum of the
+         projected lengths of the segments is smallest relative to the range spanned. For a trace that doubles back in x but is monotonic in y,
+         sweeping in y keeps the number of overlapping boxes small.
+         */
+        template<typename Iterable>
+        inline bool sweep_in_x(const std::vector<std::pair<const Iterable*, const Iterable*>>& curves){
+            double sx = 0, sy = 0;
+            double xmin = std::numeric_limits<double>::infinity(), xmax = -xmin, ymin = xmin, ymax = -xmin;
+            for (const auto& [x, y] : curves){
+                accumulate_steps(*x, sx, xmin, xmax);
+                accumulate_steps(*y, sy, ymin, ymax);
+            }
+            if (!(xmax > xmin)){ return false; }
+            if (!(ymax > ymin)){ return true; }
+            return sx/(xmax-xmin) <= sy/(ymax-ymin);
+        }
+    
+        template<typename Iterable>
+        inline void add_segment_boxes(std::vector<SegmentBox>& boxes, const Iterable& x, const Iterable& y, bool in_x, int curve){
+            const auto& a = (in_x) ? x : y;
+            const auto& b = (in_x) ? y : x;
+            for (auto i = 0U; i + 1 < static_cast<std::size_t>(x.size()); ++i){
+                // Segments with non-finite coordinates cannot intersect anything, and would break the ordering
+                if (!(std::isfinite(a[i]) && std::isfinite(a[i+1]) && std::isfinite(b[i]) && std::isfinite(b[i+1]))){
+                    continue;
+                }
+                boxes.emplace_back(SegmentBox{std::min(a[i], a[i+1]), std::max(a[i], a[i+1]), std::min(b[i], b[i+1]), std::max(b[i], b[i+1]), i, curve});
+            }
+        }
+    
+        /**
+         Call the callback for each pair of segments whose bounding boxes overlap. The boxes are sorted by their lower bound along the sweep axis,
+         and each box is only compared with the following boxes that start before it ends, so the cost is O(n log n) for the sort plus the number
+         of pairs of boxes that overlap along the sweep axis, rather than O(n^2) for all the pairs.
+         */
+        template<typename Callback>
+        inline void for_each_overlapping_pair(std::vector<SegmentBox>& boxes, const Callback& callback){
+            std::sort(boxes.begin(), boxes.end(), [](const SegmentBox& a, const SegmentBox& b){ return a.lo < b.lo; });
+            for (auto i = 0U; i < boxes.size(); ++i){
+                const auto& bi = boxes[i];
+                for (auto m = i + 1; m < boxes.size() && boxes[m].lo <= bi.hi; ++m){
+                    const auto& bm = boxes[m];
+                    if (bm.olo <= bi.ohi && bi.olo <= bm.ohi){
+                        callback(bi, bm);
+                    }
+                }
+            }
+        }
+    
+        /**
+         Intersection of the segment between points j and j+1 of the first curve with the segment between points k and k+1 of the second one
+         
+         Derived from https://stackoverflow.com/a/17931809
+         */
+        template<typename Iterable>
+        inline std::optional<SelfIntersectionSolution> intersect_segments(const Iterable& x1, const Iterable& y1, std::size_t j, const Iterable& x2, const Iterable& y2, std::size_t k){
+            Eigen::Array22d A;
+            auto p0 = (Eigen::Array2d() << x1[j], y1[j]).finished();
+            auto p1 = (Eigen::Array2d() << x1[j + 1], y1[j + 1]).finished();
+            auto q0 = (Eigen::Array2d() << x2[k], y2[k]).finished();
+            auto q1 = (Eigen::Array2d() << x2[k + 1], y2[k + 1]).finished();
+            A.col(0) = p1 - p0;
+            A.col(1) = q0 - q1;
+            Eigen::Array2d params = A.matrix().colPivHouseholderQr().solve((q0 - p0).matrix());
+            if ((params > 0).binaryExpr((params < 1), [](auto x, auto y) {return x & y; }).all()) { // Both of the params are in (0,1)
+                auto soln = p0 + params[0] * (p1 - p0);
+                return SelfIntersectionSolution{ j, k, params[0], params[1], soln[0], soln[1] };
+            }
+            return std::nullopt;
+        }
+    
+        inline void sort_solutions(std::vector<SelfIntersectionSolution>& solns){
+            std::sort(solns.begin(), solns.end(), [](const auto& a, const auto& b){ return std::tie(a.j, a.k) < std::tie(b.j, b.k); });
+        }
+    }
+
     /**
-    Derived from https://stackoverflow.com/a/17931809
+    \brief Find the points at which a curve intersects itself
+     
+    A sweep over the bounding boxes of the segments is used to find the candidate pairs of segments, see detail::for_each_overlapping_pair.
+    The solutions are sorted by j, then k, and j < k
     */
     template<typename Iterable>
     inline auto get_self_intersections(Iterable& x, Iterable& y) {
-        Eigen::Array22d A;
         std::vector<SelfIntersectionSolution> solns;
-        for (auto j = 0U; j < x.size() - 1; ++j) {
-            auto p0 = (Eigen::Array2d() << x[j], y[j]).finished();
-            auto p1 = (Eigen::Array2d() << x[j + 1], y[j + 1]).finished();
-            A.col(0) = p1 - p0;
-            for (auto k = j + 1; k < x.size() - 1; ++k) {
-                auto q0 = (Eigen::Array2d() << x[k], y[k]).finished();
-                auto q1 = (Eigen::Array2d() << x[k + 1], y[k + 1]).finished();
-                A.col(1) = q0 - q1;
-                Eigen::Array2d params = A.matrix().colPivHouseholderQr().solve((q0 - p0).matrix());
-                if ((params > 0).binaryExpr((params < 1), [](auto x, auto y) {return x & y; }).all()) { // Both of the params are in (0,1)
-                    auto soln = p0 + params[0] * (p1 - p0);
-                    solns.emplace_back(SelfIntersectionSolution{ static_cast<std::size_t>(j), static_cast<std::size_t>(k), params[0], params[1], soln[0], soln[1] });
-                }
-            }
-        }
+        const bool in_x = detail::sweep_in_x<Iterable>({{&x, &y}});
+        std::vector<detail::SegmentBox> boxes;
+        detail::add_segment_boxes(boxes, x, y, in_x, 0);
+        detail::for_each_overlapping_pair(boxes, [&](const detail::SegmentBox& a, const detail::SegmentBox& b){
+            auto j = std::min(a.index, b.index), k = std::max(a.index, b.index);
+            auto soln = detail::intersect_segments(x, y, j, x, y, k);
+            if (soln){ solns.push_back(soln.value()); }
+        });
+        detail::sort_solutions(solns);
         return solns;
     }
 
+    /**
+    \brief Find the points at which the curve (x1, y1) intersects the curve (x2, y2)
+     
+    A sweep over the bounding boxes of the segments of both curves is used to find the candidate pairs of segments, see detail::for_each_overlapping_pair.
+    The solutions are sorted by j (the index in the first curve), then k (the index in the second curve)
+    */
     template<typename Iterable>
     inline auto get_cross_intersections(Iterable& x1, Iterable& y1, Iterable& x2, Iterable& y2) {
-        Eigen::Array22d A;
         std::vector<SelfIntersectionSolution> solns;
-        for (auto j = 0U; j < x1.size() - 1; ++j) {
-            auto p0 = (Eigen::Array2d() << x1[j], y1[j]).finished();
-            auto p1 = (Eigen::Array2d() << x1[j + 1], y1[j + 1]).finished();
-            A.col(0) = p1 - p0;
-            for (auto k = 0U; k < x2.size() - 1; ++k) {
-                auto q0 = (Eigen::Array2d() << x2[k], y2[k]).finished();
-                auto q1 = (Eigen::Array2d() << x2[k + 1], y2[k + 1]).finished();
-                A.col(1) = q0 - q1;
-                Eigen::Array2d params = A.matrix().colPivHouseholderQr().solve((q0 - p0).matrix());
-                if ((params > 0).binaryExpr((params < 1), [](auto x, auto y) {return x & y; }).all()) { // Both of the params are in (0,1)
-                    auto soln = p0 + params[0] * (p1 - p0);
-                    solns.emplace_back(SelfIntersectionSolution{ static_cast<std::size_t>(j), static_cast<std::size_t>(k), params[0], params[1], soln[0], soln[1] });
-                }
-            }
-        }
+        const bool in_x = detail::sweep_in_x<Iterable>({{&x1, &y1}, {&x2, &y2}});
+        std::vector<detail::SegmentBox> boxes;
+        detail::add_segment_boxes(boxes, x1, y1, in_x, 0);
+        detail::add_segment_boxes(boxes, x2, y2, in_x, 1);
+        detail::for_each_overlapping_pair(boxes, [&](const detail::SegmentBox& a, const detail::SegmentBox& b){
+            if (a.curve == b.curve){ return; }
+            const auto& s1 = (a.curve == 0) ? a : b;
+            const auto& s2 = (a.curve == 0) ? b : a;
+            auto soln = detail::intersect_segments(x1, y1, s1.index, x2, y2, s2.index);
+            if (soln){ solns.push_back(soln.value()); }
+        });
+        detail::sort_solutions(solns);
         return solns;
     }
 
-    
-    
     inline auto find_VLLE_gen_binary(const AbstractModel& model, const std::vector<nlohmann::json>& traces, const std::string& key, const std::optional<VLLEFinderOptions> options = std::nullopt) {
         std::vector<double> x, y;
         auto opt = options.value_or(VLLEFinderOptions{});
@@ -484,21 +581,21 @@ namespace VLLE {
         
         Eigen::MatrixXd LHS(2, 2);
         Eigen::MatrixXd RHS(2, 1);
-        Eigen::MatrixXd PSIV = model.build_Psi_Hessian_autodiff(T, rhovecV);
-        Eigen::MatrixXd PSIL1 = model.build_Psi_Hessian_autodiff(T, rhovecL1);
-        Eigen::MatrixXd PSIL2 = model.build_Psi_Hessian_autodiff(T, rhovecL2);
-        double dpdTV = model.get_dpdT_constrhovec(T, rhovecV);
-        double dpdTL1 = model.get_dpdT_constrhovec(T, rhovecL1);
-        double dpdTL2 = model.get_dpdT_constrhovec(T, rhovecL2);
+        const auto derV = model.build_isochoric_derivative_bundle(T, rhovecV);
+        const auto derL1 = model.build_isochoric_derivative_bundle(T, rhovecL1);
+        const auto derL2 = model.build_isochoric_derivative_bundle(T, rhovecL2);
+        Eigen::MatrixXd PSIV = derV.Hessian_Psi();
+        Eigen::MatrixXd PSIL1 = derL1.Hessian_Psi();
+        Eigen::MatrixXd PSIL2 = derL2.Hessian_Psi();
+        double dpdTV = derV.dpdT();
+        double dpdTL1 = derL1.dpdT();
+        double dpdTL2 = derL2.dpdT();
         
         // here mu is not the entire chemical potential, rather it is just the residual part and
         // the density-dependent part from the ideal-gas
-        double RV = model.R(rhovecV/rhovecV.sum());
-        double RL1 = model.R(rhovecL1/rhovecL1.sum());
-        double RL2 = model.R(rhovecL2/rhovecL2.sum());
-        EArrayd dmudTV = model.build_d2PsirdTdrhoi_autodiff(T, rhovecV) + RV*log(rhovecV);
-        EArrayd dmudTL1 = model.build_d2PsirdTdrhoi_autodiff(T, rhovecL1) + RL1*log(rhovecL1);
-        EArrayd dmudTL2 = model.build_d2PsirdTdrhoi_autodiff(T, rhovecL2) + RL2*log(rhovecL2);
+        EArrayd dmudTV = derV.d2PsirdTdrhovec + derV.R*log(rhovecV);
+        EArrayd dmudTL1 = derL1.d2PsirdTdrhovec + derL1.R*log(rhovecL1);
+        EArrayd dmudTL2 = derL2.d2PsirdTdrhovec + derL2.R*log(rhovecL2);
         
         LHS.row(0) = PSIV*(rhovecL1-rhovecV).matrix();
         LHS.row(1) = PSIV*(rhovecL2-rhovecV).matrix();
@@ -513,11 +610,9 @@ namespace VLLE {
         return std::make_tuple(drhovecVdT, drhovecL1dT, drhovecL2dT);
     };
 
-    /**
-    \brief Given an initial VLLE solution, trace the VLLE curve. We know the VLLE curve is a function of only one state variable by Gibbs' rule
-     */
-    inline auto trace_VLLE_binary(const teqp::VLLE::AbstractModel& model, const double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, const std::optional<VLLETracerOptions>& options_ = std::nullopt){
-        auto options = options_.value_or(VLLETracerOptions());
+    namespace detail{
+    /// The VLLE tracer; if sink is not null, the points are passed to the sink rather than stored in the returned JSON
+    inline nlohmann::json trace_VLLE_binary(const teqp::VLLE::AbstractModel& model, const double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, const VLLETracerOptions& options, TraceSink* sink){
         
         // Typedefs for the types for odeint for simple Euler and RK45 integrators
         using state_type = std::vector<double>;
@@ -551,6 +646,13 @@ namespace VLLE {
         Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 4, 2) = rhovecL2init;
         
         nlohmann::json data_collector = nlohmann::json::array();
+        
+        // The columns passed to the sink, if one is provided
+        const std::vector<std::string> columns = {"T / K", "rhoL1_0 / mol/m^3", "rhoL1_1 / mol/m^3", "rhoL2_0 / mol/m^3", "rhoL2_1 / mol/m^3", "rhoV_0 / mol/m^3", "rhoV_1 / mol/m^3", "critV_0", "critV_1", "critL1_0", "critL1_1", "critL2_0", "critL2_1", "pV / Pa"};
+        Eigen::ArrayXd row(columns.size());
+        if (sink != nullptr) {
+            sink->begin(columns);
+        }
         for (auto iter = 0; iter < options.max_step_count; ++iter) {
             int retry_count = 0;
             
@@ -633,6 +735,12 @@ namespace VLLE {
                 break;
             }
             
+            if (sink != nullptr) {
+                row << T, rhovecL1, rhovecL2, rhovecV, critV, critL1, critL2, pV;
+                sink->push(row);
+                continue;
+            }
+            
             nlohmann::json entry{
                 {"T / K", T},
                 {"rhoL1 / mol/m^3", rhovecL1},
@@ -645,8 +753,27 @@ namespace VLLE {
             };
             data_collector.push_back(entry);
         }
+        if (sink != nullptr) {
+            sink->end();
+        }
         return data_collector;
     }
+    }
+
+    /**
+    \brief Given an initial VLLE solution, trace the VLLE curve. We know the VLLE curve is a function of only one state variable by Gibbs' rule
+     */
+    inline auto trace_VLLE_binary(const teqp::VLLE::AbstractModel& model, const double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, const std::optional<VLLETracerOptions>& options = std::nullopt){
+        return detail::trace_VLLE_binary(model, Tinit, rhovecVinit, rhovecL1init, rhovecL2init, options.value_or(VLLETracerOptions()), nullptr);
+    }
+
+    /**
+    \brief Trace the VLLE curve, passing each accepted point to the sink rather than storing it in JSON
+    \note The columns are those of the JSON output, with the arrays split into one column per entry
+     */
+    inline void trace_VLLE_binary(const teqp::VLLE::AbstractModel& model, const double Tinit, const EArrayd& rhovecVinit, const EArrayd& rhovecL1init, const EArrayd& rhovecL2init, TraceSink& sink, const std::optional<VLLETracerOptions>& options = std::nullopt){
+        detail::trace_VLLE_binary(model, Tinit, rhovecVinit, rhovecL1init, rhovecL2init, options.value_or(VLLETracerOptions()), &sink);
+    }
 
 }
 }
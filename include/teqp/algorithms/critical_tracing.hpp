@@ -9,6 +9,7 @@
 #include "teqp/algorithms/rootfinding.hpp"
 #include "teqp/algorithms/critical_pure.hpp"
 #include "teqp/algorithms/critical_tracing_types.hpp"
+#include "teqp/algorithms/trace_sinks.hpp"
 #include "teqp/exceptions.hpp"
 
 // Imports from boost
@@ -209,47 +210,80 @@ struct CriticalTracing {
         auto all_derivs = get_derivs(model, T, rhovec, std::nullopt);
         auto derivs = all_derivs.tot;
 
-        // The temperature derivative of total Psi w.r.t.T from a centered finite difference in T
-        auto dT = 1e-7;
-        auto plusT = get_derivs(model, T + dT, rhovec, all_derivs.ei.v0).tot;
-        auto minusT = get_derivs(model, T - dT, rhovec, all_derivs.ei.v0).tot;
-        auto derivT = (plusT - minusT) / (2.0 * dT);
-
         // Solve the eigenvalue problem for the given T & rho
         auto ei = all_derivs.ei;
 
-        auto sigma2 = 2e-5 * rhovec.sum(); // This is the perturbation along the second eigenvector
-
-        auto rhovec_plus = (rhovec + ei.v1 * sigma2).eval();
-        auto rhovec_minus = (rhovec - ei.v1 * sigma2).eval();
+        // The derivatives of the second and third derivatives of total Psi w.r.t. sigma_1, with respect to T
+        // (derivT), and with respect to a step of sigma_2 along the second eigenvector (deriv_sigma2)
+        auto derivT = all_derivs.tot, deriv_sigma2 = all_derivs.tot;
         std::string stepping_desc = "";
-        auto deriv_sigma2 = all_derivs.tot;
         auto eval = [](const auto& ex) { return ex.eval(); };
-        if (all(eval(rhovec_minus > 0)) && all(eval(rhovec_plus > 0))) {
-            // Conventional centered derivative
-            auto plus_sigma2 = get_derivs(model, T, rhovec_plus, ei.v0);
-            auto minus_sigma2 = get_derivs(model, T, rhovec_minus, ei.v0);
-            deriv_sigma2 = (plus_sigma2.tot - minus_sigma2.tot) / (2.0 * sigma2);
-            stepping_desc = "conventional centered";
-        }
-        else if (all(eval(rhovec_plus > 0))) {
-            // Forward derivative in the direction of v1
-            auto plus_sigma2 = get_derivs(model, T, rhovec_plus, ei.v0);
-            auto rhovec_2plus = (rhovec + 2 * ei.v1 * sigma2).eval();
-            auto plus2_sigma2 = get_derivs(model, T, rhovec_2plus, ei.v0);
-            deriv_sigma2 = (-3 * derivs + 4 * plus_sigma2.tot - plus2_sigma2.tot) / (2.0 * sigma2);
-            stepping_desc = "forward";
-        }
-        else if (all(eval(rhovec_minus > 0))) {
-            // Negative derivative in the direction of v1
-            auto minus_sigma2 = get_derivs(model, T, rhovec_minus, ei.v0);
-            auto rhovec_2minus = (rhovec - 2 * ei.v1 * sigma2).eval();
-            auto minus2_sigma2 = get_derivs(model, T, rhovec_2minus, ei.v0);
-            deriv_sigma2 = (-3 * derivs + 4 * minus_sigma2.tot - minus2_sigma2.tot) / (-2.0 * sigma2);
-            stepping_desc = "backwards";
+        
+        if (all(eval(rhovec > 0)) && ei.eigenvalues.size() == 2) {
+            // The derivatives are obtained by differentiating along the eigenvector v0, accounting for the rotation of the eigenvector
+            // itself. For a binary mixture, the derivative of v0 is along v1, from first-order perturbation theory:
+            //   dv0/dx = v1 (v1^T dH/dx v0)/(lambda0-lambda1)
+            // where x is either T or sigma_2. The mixed derivatives of Psir are obtained with forward-mode AD; the ideal-gas
+            // part, for which Psi^0_{ij} = RT delta_ij/rho_i, is handled analytically
+            const Eigen::ArrayXd v0 = ei.v0, v1 = ei.v1;
+            const auto R = model.R(rhovec / rhovec.sum());
+            auto mixed = model.get_Psir_sigma_mixed_derivs(T, rhovec, v0, v1);
+            
+            double HT00 = mixed[0] + R*(v0*v0/rhovec).sum(); // v0^T (dH/dT) v0
+            double HT10 = mixed[1] + R*(v1*v0/rhovec).sum(); // v1^T (dH/dT) v0
+            double PsiT000 = mixed[2] - R*(v0*v0*v0/rhovec.square()).sum(); // d/dT(sum_ijk Psi_ijk v0_i v0_j v0_k) at constant v0
+            double Psi001 = mixed[3] - R*T*(v0*v0*v1/rhovec.square()).sum(); // sum_ijk Psi_ijk v0_i v0_j v1_k
+            double Psi011 = mixed[4] - R*T*(v0*v1*v1/rhovec.square()).sum(); // sum_ijk Psi_ijk v0_i v1_j v1_k
+            double Psi0001 = mixed[5] + 2*R*T*(v0*v0*v0*v1/rhovec.cube()).sum(); // sum_ijkl Psi_ijkl v0_i v0_j v0_k v1_l
+            
+            double dlambda = ei.eigenvalues[0] - ei.eigenvalues[1];
+            double dv0dT = HT10/dlambda, dv0dsigma2 = Psi011/dlambda; // Components of the derivatives of v0 along v1
+            
+            derivT[2] = HT00;
+            derivT[3] = PsiT000 + 3*Psi001*dv0dT;
+            deriv_sigma2[2] = Psi001;
+            deriv_sigma2[3] = Psi0001 + 3*Psi001*dv0dsigma2;
+            stepping_desc = "AD";
         }
-        else {
-            throw std::invalid_argument("This is not possible I think.");
+        else{
+            // At infinite dilution, v1 is not an eigenvector of the Hessian, and finite differences are used
+            
+            // The temperature derivative of total Psi w.r.t.T from a centered finite difference in T
+            auto dT = 1e-7;
+            auto plusT = get_derivs(model, T + dT, rhovec, all_derivs.ei.v0).tot;
+            auto minusT = get_derivs(model, T - dT, rhovec, all_derivs.ei.v0).tot;
+            derivT = (plusT - minusT) / (2.0 * dT);
+            
+            auto sigma2 = 2e-5 * rhovec.sum(); // This is the perturbation along the second eigenvector
+            
+            auto rhovec_plus = (rhovec + ei.v1 * sigma2).eval();
+            auto rhovec_minus = (rhovec - ei.v1 * sigma2).eval();
+            if (all(eval(rhovec_minus > 0)) && all(eval(rhovec_plus > 0))) {
+                // Conventional centered derivative
+                auto plus_sigma2 = get_derivs(model, T, rhovec_plus, ei.v0);
+                auto minus_sigma2 = get_derivs(model, T, rhovec_minus, ei.v0);
+                deriv_sigma2 = (plus_sigma2.tot - minus_sigma2.tot) / (2.0 * sigma2);
+                stepping_desc = "conventional centered";
+            }
+            else if (all(eval(rhovec_plus > 0))) {
+                // Forward derivative in the direction of v1
+                auto plus_sigma2 = get_derivs(model, T, rhovec_plus, ei.v0);
+                auto rhovec_2plus = (rhovec + 2 * ei.v1 * sigma2).eval();
+                auto plus2_sigma2 = get_derivs(model, T, rhovec_2plus, ei.v0);
+                deriv_sigma2 = (-3 * derivs + 4 * plus_sigma2.tot - plus2_sigma2.tot) / (2.0 * sigma2);
+                stepping_desc = "forward";
+            }
+            else if (all(eval(rhovec_minus > 0))) {
+                // Negative derivative in the direction of v1
+                auto minus_sigma2 = get_derivs(model, T, rhovec_minus, ei.v0);
+                auto rhovec_2minus = (rhovec - 2 * ei.v1 * sigma2).eval();
+                auto minus2_sigma2 = get_derivs(model, T, rhovec_2minus, ei.v0);
+                deriv_sigma2 = (-3 * derivs + 4 * minus_sigma2.tot - minus2_sigma2.tot) / (-2.0 * sigma2);
+                stepping_desc = "backwards";
+            }
+            else {
+                throw std::invalid_argument("This is not possible I think.");
+            }
         }
 
         // The columns of b are from Eq. 31 and Eq. 33
@@ -267,13 +301,9 @@ struct CriticalTracing {
         std::cout << "b: " << b << std::endl;
         std::cout << "stepping_desc: " << stepping_desc << std::endl;
         std::cout << "deriv_sigma2: " << deriv_sigma2 << std::endl;
-        std::cout << "rhovec_plus: " << rhovec_plus << std::endl;
+        std::cout << "derivT: " << derivT << std::endl;
         std::cout << "all_derivs.tot:" << all_derivs.tot << std::endl;
         std::cout << "all_derivs.psir:" << all_derivs.psir << std::endl; 
-        auto plus_sigma2 = get_derivs(model, T, rhovec_plus, ei.v0);
-        std::cout << "plus_sigma2.tot:" << plus_sigma2.tot << std::endl;
-        std::cout << "plus_sigma2.psir:" << plus_sigma2.psir << std::endl;
-        std::cout << "dot of v0: " << plus_sigma2.ei.v0 * ei.v0 << std::endl;
 #endif
         return drhovec_dT;
     }
@@ -389,6 +419,19 @@ struct CriticalTracing {
     }
 
     static auto trace_critical_arclength_binary(const AbstractModel& model, const Scalar& T0, const VecType& rhovec0, const std::optional<std::string>& filename_ = std::nullopt, const std::optional<TCABOptions> &options_ = std::nullopt) -> nlohmann::json {
+        return trace_critical_arclength_binary(model, T0, rhovec0, filename_, options_, nullptr);
+    }
+    
+    /**
+    * \brief Trace the critical curve, passing each accepted point to the sink rather than storing it in JSON
+    * \note The columns are those of the JSON output; "locally stable" is stored as 1.0 or 0.0
+    */
+    static void trace_critical_arclength_binary(const AbstractModel& model, const Scalar& T0, const VecType& rhovec0, TraceSink& sink, const std::optional<TCABOptions> &options_ = std::nullopt) {
+        trace_critical_arclength_binary(model, T0, rhovec0, std::nullopt, options_, &sink);
+    }
+
+    /// The critical curve tracer; if sink is not null, the points are passed to the sink rather than stored in the returned JSON
+    static auto trace_critical_arclength_binary(const AbstractModel& model, const Scalar& T0, const VecType& rhovec0, const std::optional<std::string>& filename_, const std::optional<TCABOptions> &options_, TraceSink* sink) -> nlohmann::json {
         std::string filename = filename_.value_or("");
         TCABOptions options = options_.value_or(TCABOptions{});
 
@@ -407,6 +450,16 @@ struct CriticalTracing {
         auto JSONdata = nlohmann::json::array();
         std::ofstream ofs = (filename.empty()) ? std::ofstream() : std::ofstream(filename);
         
+        // The columns passed to the sink, if one is provided
+        std::vector<std::string> columns = {"t", "T / K", "rho0 / mol/m^3", "rho1 / mol/m^3", "c", "s^+", "p / Pa", "dT/dt", "drho0/dt", "drho1/dt", "lambda1", "dirderiv(lambda1)/dalpha"};
+        if (options.calc_stability) {
+            columns.push_back("locally stable");
+        }
+        Eigen::ArrayXd row(columns.size());
+        if (sink != nullptr) {
+            sink->begin(columns);
+        }
+        
         double c = options.init_c; 
 
         // The function for the derivative in the form of odeint
@@ -480,6 +533,16 @@ struct CriticalTracing {
             auto dxdt = x0;
             xprime(x0, dxdt, -1.0);
 
+            // Pass the data to the sink, in the order of the columns
+            if (sink != nullptr) {
+                row.head(12) << t, T, rhovec[0], rhovec[1], c, splus, p, dxdt[0], dxdt[1], dxdt[2], conditions[0], conditions[1];
+                if (options.calc_stability) {
+                    row.tail(1) << (is_locally_stable(model, T, rhovec, options.stability_rel_drho) ? 1.0 : 0.0);
+                }
+                sink->push(row);
+                return;
+            }
+
             // Store the data in a JSON structure
             nlohmann::json point = {
                 {"t", t},
@@ -733,6 +796,9 @@ struct CriticalTracing {
                 store_point();
             }
         }
+        if (sink != nullptr) {
+            sink->end();
+        }
         //auto N = JSONdata.size();
         return JSONdata;
     }
@@ -0,0 +1,184 @@
+#pragma once
+
+/**
+ Solution for the molar density from temperature, pressure and mole fractions
+
+ Models that can provide their density roots in closed form (the cubic EOS, through their method solve_cubic_density) do so; for all
+ other models the mechanically stable roots are found by marching up in density from the ideal-gas limit followed by a
+ safeguarded Newton iteration
+ */
+
+#include <optional>
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#include <Eigen/Dense>
+
+#include "teqp/derivs.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/density_types.hpp"
+
+namespace teqp{
+
+/// Models that return their density roots in closed form
+template<typename Model>
+concept HasClosedFormDensityRoots = requires(const Model& m, const double T, const double p, const Eigen::ArrayXd& z, DensityRoot root) {
+    { m.solve_cubic_density(T, p, z, root) } -> std::convertible_to<Eigen::ArrayXd>;
+};
+
+/// Pressure and its density derivative at constant temperature and composition
+template<typename Model>
+auto get_p_dpdrho(const Model& model, const double T, const double rho, const Eigen::ArrayXd& x) {
+    using tdx = TDXDerivatives<Model, double, Eigen::ArrayXd>;
+    const double R = model.R(x);
+    auto Ar0n = tdx::template get_Ar0n<2>(model, T, rho, x);
+    return std::make_tuple(rho*R*T*(1.0 + Ar0n[1]), R*T*(1.0 + 2.0*Ar0n[1] + Ar0n[2]));
+}
+
+/**
+ \brief Newton iteration for the density at the specified pressure, falling back to bisection whenever a step leaves the bracket [rholo, rhohi]
+ \returns The density, or nullopt if the iteration does not converge to a mechanically stable root
+ */
+template<typename Model>
+std::optional<double> polish_density(const Model& model, const double T, const double p, const Eigen::ArrayXd& x, double rho, double rholo = 0, double rhohi = std::numeric_limits<double>::infinity(), const double rho_reltol = 1e-13, const int maxiter = 100) {
+    for (auto iter = 0; iter < maxiter; ++iter){
+        auto [pcalc, dpdrho] = get_p_dpdrho(model, T, rho, x);
+        if (!std::isfinite(pcalc) || !std::isfinite(dpdrho)){ return std::nullopt; }
+        double r = pcalc - p;
+        if (r < 0){ rholo = std::max(rholo, rho); } else { rhohi = std::min(rhohi, rho); }
+        double rhonew = (dpdrho > 0) ? rho - r/dpdrho : std::numeric_limits<double>::quiet_NaN();
+        if (!(rhonew > rholo && rhonew < rhohi)){
+            if (!std::isfinite(rhohi)){ return std::nullopt; } // No bracket to fall back on
+            rhonew = (rholo + rhohi)/2;
+        }
+        if (std::abs(rhonew - rho) < rho_reltol*rho){
+            auto [pnew, dpdrhonew] = get_p_dpdrho(model, T, rhonew, x);
+            if (dpdrhonew > 0 && std::abs(pnew/p - 1) < 1e-8){ return rhonew; }
+            return std::nullopt;
+        }
+        rho = rhonew;
+    }
+    return std::nullopt;
+}
+
+/**
+ \brief Find the mechanically stable density roots by marching up in density from the ideal-gas limit; each upward crossing of the specified pressure is polished
+ \returns The roots in increasing order
+ */
+template<typename Model>
+std::vector<double> scan_density_roots(const Model& model, const double T, const double p, const Eigen::ArrayXd& x, const double rho_reltol = 1e-13, const int maxiter = 100) {
+    const double R = model.R(x);
+    double rho = p/(R*T)/100, rhoprev = -1;
+    std::vector<double> roots;
+    double fprev = -1;
+    for (auto k = 0; k < 500; ++k, rhoprev = rho, rho *= 1.1){
+        auto [pcalc, dpdrho] = get_p_dpdrho(model, T, rho, x);
+        if (!std::isfinite(pcalc)){ break; }
+        double f = pcalc - p;
+        if (k > 0 && fprev < 0 && f >= 0){
+            // An upward crossing of the specified pressure
+            auto r = polish_density(model, T, p, x, (rhoprev + rho)/2, rhoprev, rho, rho_reltol, maxiter);
+            if (r){ roots.push_back(r.value()); }
+        }
+        fprev = f;
+        // Far into the compressed liquid, nothing more to find
+        if (f > 0 && pcalc/(rho*R*T) > 50){ break; }
+    }
+    if (roots.empty()){
+        throw IterationFailure("Unable to find a density root at T=" + std::to_string(T) + " K and p=" + std::to_string(p) + " Pa");
+    }
+    return roots;
+}
+
+/**
+ \brief Molar density from temperature, pressure and mole fractions
+
+ \param model The model
+ \param T Temperature, in K
+ \param p Pressure, in Pa
+ \param z Mole fractions
+ \param root Which root(s) to return
+ \returns The selected root(s), in mol/m^3; only DensityRoot::all can return more than one value
+ */
+template<typename Model>
+Eigen::ArrayXd solve_density(const Model& model, const double T, const double p, const Eigen::ArrayXd& z, const DensityRoot root) {
+    if constexpr (HasClosedFormDensityRoots<Model>){
+        return model.solve_cubic_density(T, p, z, root);
+    }
+    else{
+        if (!(T > 0) || !(p > 0)){
+            throw InvalidArgument("Temperature and pressure must be positive to solve for the density");
+        }
+        auto roots = scan_density_roots(model, T, p, z);
+        switch (root){
+            case DensityRoot::vapor:
+                return Eigen::ArrayXd::Constant(1, roots.front());
+            case DensityRoot::liquid:
+                return Eigen::ArrayXd::Constant(1, roots.back());
+            case DensityRoot::all:
+                return Eigen::Map<const Eigen::ArrayXd>(&roots[0], static_cast<Eigen::Index>(roots.size()));
+            case DensityRoot::minimum_gibbs:{
+                // At constant T, p and z, G/(RT) differs from alphar + Z - ln(Z) by a constant
+                using tdx = TDXDerivatives<Model, double, Eigen::ArrayXd>;
+                const double RT = model.R(z)*T;
+                double rhobest = roots.front(), gbest = std::numeric_limits<double>::infinity();
+                for (auto rho : roots){
+                    double Z = p/(rho*RT);
+                    double g = tdx::get_Ar00(model, T, rho, z) + Z - std::log(Z);
+                    if (g < gbest){ gbest = g; rhobest = rho; }
+                }
+                return Eigen::ArrayXd::Constant(1, rhobest);
+            }
+            default:
+                throw InvalidArgument("Invalid density root selection");
+        }
+    }
+}
+
+/// For the AbstractModel, the solution is carried out by the concrete model type
+inline Eigen::ArrayXd solve_density(const teqp::cppinterface::AbstractModel& model, const double T, const double p, const Eigen::ArrayXd& z, const DensityRoot root) {
+    return model.solve_density(T, p, z, root);
+}
+
+/**
+ \brief Molar densities for a batch of temperatures and pressures
+
+ A failure at one point does not abort the batch; the density of that point is NaN
+
+ \param model The model
+ \param T Temperatures, in K
+ \param p Pressures, in Pa
+ \param Z Mole fractions, one row per point, or a single row that is used for all the points
+ \param root Which root to return; DensityRoot::all is not allowed because each point yields one density
+ */
+template<typename Model>
+Eigen::ArrayXd solve_density_batch(const Model& model, const Eigen::ArrayXd& T, const Eigen::ArrayXd& p, const Eigen::ArrayXXd& Z, const DensityRoot root) {
+    const auto Npts = T.size();
+    if (p.size() != Npts || (Z.rows() != Npts && Z.rows() != 1)){
+        throw InvalidArgument("Lengths of T and p must be the same, and Z must have either one row or one row per point");
+    }
+    if (root == DensityRoot::all){
+        throw InvalidArgument("The batched density solver returns one root per point; DensityRoot::all is not allowed");
+    }
+    Eigen::ArrayXd rho(Npts);
+    Eigen::ArrayXd z = Z.row(0).transpose();
+    for (auto i = 0; i < Npts; ++i){
+        if (Z.rows() != 1){ z = Z.row(i).transpose(); }
+        try{
+            rho[i] = solve_density(model, T[i], p[i], z, root)[0];
+        }
+        catch(const std::exception&){
+            rho[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return rho;
+}
+
+/// For the AbstractModel, the batch is carried out by the concrete model type
+inline Eigen::ArrayXd solve_density_batch(const teqp::cppinterface::AbstractModel& model, const Eigen::ArrayXd& T, const Eigen::ArrayXd& p, const Eigen::ArrayXXd& Z, const DensityRoot root) {
+    return model.solve_density_batch(T, p, Z, root);
+}
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+namespace teqp{
+
+/// The density root(s) to be returned when solving for the density from temperature, pressure and composition
+enum class DensityRoot {
+    liquid, ///< The largest mechanically stable root
+    vapor, ///< The smallest mechanically stable root
+    minimum_gibbs, ///< The mechanically stable root with the smallest Gibbs energy
+    all ///< All the mechanically stable roots, in increasing order
+};
+
+}
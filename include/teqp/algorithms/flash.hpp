@@ -0,0 +1,459 @@
+#pragma once
+
+/**
+ Isothermal-isobaric (T, p) flash calculations with a tangent plane stability test
+
+ The flash is written in terms of the concrete model type so that all the iterations are carried out without passing
+ through the AbstractModel interface; the AbstractModel::flash_Tp method dispatches (once) to the concrete type
+ */
+
+#include <optional>
+#include <vector>
+#include <thread>
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
+
+#include "teqp/derivs.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/flash_types.hpp"
+#include "teqp/algorithms/density.hpp"
+
+namespace teqp{
+namespace flash{
+
+enum class RootKind { liquid, vapor, minimum_gibbs };
+
+/// The state of one phase at the specified temperature and pressure
+struct PhaseState{
+    double rho = -1; ///< Molar density
+    Eigen::ArrayXd lnphi; ///< Natural logarithm of the fugacity coefficients
+};
+
+/**
+ \brief Solve the Rachford-Rice equation for the vapor fraction
+ \returns The vapor fraction, which may lie outside [0, 1] (negative flash); NaN if there is no solution because all K-factors are on the same side of unity
+ */
+inline double solve_Rachford_Rice(const Eigen::ArrayXd& z, const Eigen::ArrayXd& K, const int maxiter = 100){
+    if (K.maxCoeff() <= 1 || K.minCoeff() >= 1){
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    // The physically meaningful root is bracketed by the asymptotes
+    double betamin = 1.0/(1.0 - K.maxCoeff()), betamax = 1.0/(1.0 - K.minCoeff());
+    double beta = std::clamp(0.5, betamin + 1e-14, betamax - 1e-14);
+    for (auto iter = 0; iter < maxiter; ++iter){
+        Eigen::ArrayXd den = 1.0 + beta*(K-1.0);
+        double f = (z*(K-1.0)/den).sum();
+        double dfdbeta = -(z*(K-1.0).square()/den.square()).sum();
+        // f is monotonically decreasing in beta, so the bracket can be tightened
+        if (f > 0){ betamin = beta; } else { betamax = beta; }
+        double betanew = beta - f/dfdbeta;
+        if (!(betanew > betamin && betanew < betamax)){
+            betanew = (betamin + betamax)/2;
+        }
+        if (std::abs(betanew-beta) < 1e-14*std::max(1.0, std::abs(beta))){
+            return betanew;
+        }
+        beta = betanew;
+    }
+    return beta;
+}
+
+/**
+ \brief The machinery of the TP flash for a concrete model type
+ */
+template<typename Model>
+class TPFlasher{
+private:
+    const Model& model;
+    const TPFlashOptions opt;
+    using iso = IsochoricDerivatives<Model, double, Eigen::ArrayXd>;
+
+    /// Newton iteration for the density, returning nullopt if the iteration does not converge to a mechanically stable root
+    std::optional<double> polish_rho(const double T, const double p, const Eigen::ArrayXd& x, double rho) const {
+        return polish_density(model, T, p, x, rho, 0, std::numeric_limits<double>::infinity(), opt.rho_reltol, opt.max_rho_iter);
+    }
+
+    /// The smallest (vapor-like) and largest (liquid-like) mechanically stable density roots, in closed form for the cubic EOS
+    std::tuple<double, double> scan_roots(const double T, const double p, const Eigen::ArrayXd& x) const {
+        if constexpr (HasClosedFormDensityRoots<Model>){
+            Eigen::ArrayXd roots = model.solve_cubic_density(T, p, x, DensityRoot::all);
+            return {roots[0], roots[roots.size()-1]};
+        }
+        else{
+            auto roots = scan_density_roots(model, T, p, x, opt.rho_reltol, opt.max_rho_iter);
+            return {roots.front(), roots.back()};
+        }
+    }
+
+    /// Logarithms of the fugacity coefficients at the given density, where the density is a root at the specified pressure
+    Eigen::ArrayXd get_lnphi(const double T, const double p, const double rho, const Eigen::ArrayXd& x) const {
+        Eigen::ArrayXd rhovec = rho*x;
+        auto RT = model.R(x)*T;
+        Eigen::ArrayXd grad = iso::build_Psir_gradient_autodiff(model, T, rhovec).array();
+        return grad/RT - std::log(p/(rho*RT));
+    }
+
+    /**
+     \brief Derivatives of the logarithms of the fugacities with respect to the mole numbers at constant T and p, for a phase with a total of one mole
+
+     In the isochoric formalism, with \f$H\f$ the Hessian of \f$\Psi\f$ (residual + ideal) with respect to the molar concentrations, the
+     partial derivatives of the chemical potential at constant volume are \f$H/V\f$, and the transformation to constant
+     pressure subtracts the rank-one term from the partial molar volumes
+     */
+    Eigen::MatrixXd get_dlnfdn_Tp(const double T, const double rho, const Eigen::ArrayXd& x) const {
+        Eigen::ArrayXd rhovec = rho*x;
+        auto RT = model.R(x)*T;
+        auto [Psir, grad, H] = iso::build_Psir_fgradHessian_autodiff(model, T, rhovec);
+        Eigen::MatrixXd Htot = H;
+        Htot.diagonal().array() += RT/rhovec;
+        Eigen::VectorXd dpdrhovec = (RT + (H*rhovec.matrix()).array()).matrix();
+        double denom = dpdrhovec.dot(rhovec.matrix());
+        // Volume of one mole is 1/rho
+        return (rho/RT)*(Htot - dpdrhovec*dpdrhovec.transpose()/denom);
+    }
+
+    /// Dominant eigenvalue extrapolation of a successive substitution sequence (Crowe and Nishio)
+    static void accelerate(Eigen::ArrayXd& lnX, const Eigen::ArrayXd& delta, const Eigen::ArrayXd& deltaprev){
+        double lambda = (delta*delta).sum()/(deltaprev*delta).sum();
+        if (std::isfinite(lambda) && lambda > 0 && lambda < 1){
+            lnX += delta*lambda/(1-lambda);
+        }
+    }
+
+public:
+    TPFlasher(const Model& model, const TPFlashOptions& options = {}) : model(model), opt(options) {};
+
+    /// Solve for the density root of the desired kind; a guess value is tried first, if provided
+    PhaseState get_phase(const double T, const double p, const Eigen::ArrayXd& x, RootKind kind, const std::optional<double>& rhoguess = std::nullopt) const {
+        PhaseState ps;
+        if (rhoguess && kind != RootKind::minimum_gibbs){
+            auto r = polish_rho(T, p, x, rhoguess.value());
+            if (r){
+                ps.rho = r.value();
+                ps.lnphi = get_lnphi(T, p, ps.rho, x);
+                return ps;
+            }
+        }
+        auto [rhoV, rhoL] = scan_roots(T, p, x);
+        if (kind == RootKind::minimum_gibbs && rhoV != rhoL){
+            auto lnphiV = get_lnphi(T, p, rhoV, x), lnphiL = get_lnphi(T, p, rhoL, x);
+            // The ideal-gas parts of the Gibbs energy are the same for both roots
+            if ((x*lnphiV).sum() < (x*lnphiL).sum()){
+                ps.rho = rhoV; ps.lnphi = lnphiV;
+            }
+            else{
+                ps.rho = rhoL; ps.lnphi = lnphiL;
+            }
+            return ps;
+        }
+        ps.rho = (kind == RootKind::liquid) ? rhoL : rhoV;
+        ps.lnphi = get_lnphi(T, p, ps.rho, x);
+        return ps;
+    }
+
+    /// The result of a stability test
+    struct StabilityResult{
+        double tpd = 0; ///< The minimum modified tangent plane distance
+        Eigen::ArrayXd w; ///< Mole fractions of the most unstable trial phase
+        double rho = -1; ///< Molar density of the most unstable trial phase
+        int num_iter = 0;
+    };
+
+    /**
+     \brief Michelsen's tangent plane stability test, carried out by accelerated successive substitution from each of the trial phases
+     \param feed The state of the feed phase
+     \param trials The initial mole fractions of the trial phases
+     */
+    StabilityResult stability_test(const double T, const double p, const Eigen::ArrayXd& z, const PhaseState& feed, const std::vector<Eigen::ArrayXd>& trials) const {
+        StabilityResult res;
+        const Eigen::ArrayXd d = log(z) + feed.lnphi;
+        for (const auto& w0 : trials){
+            Eigen::ArrayXd lnW = log(w0), delta, deltaprev;
+            std::optional<double> rho;
+            Eigen::ArrayXd lnphi;
+            bool converged = false;
+            for (auto iter = 0; iter < opt.max_stability_iter; ++iter){
+                res.num_iter++;
+                Eigen::ArrayXd w = exp(lnW)/exp(lnW).sum();
+                PhaseState trial = rho ? get_phase(T, p, w, (rho.value() > feed.rho) ? RootKind::liquid : RootKind::vapor, rho) : get_phase(T, p, w, RootKind::minimum_gibbs);
+                rho = trial.rho;
+                lnphi = trial.lnphi;
+                Eigen::ArrayXd lnWnew = d - lnphi;
+                delta = lnWnew - lnW;
+                lnW = lnWnew;
+                if ((lnW - log(z)).square().sum() < opt.trivial_tol){
+                    break; // Converging to the trivial solution
+                }
+                if (delta.abs().maxCoeff() < opt.stability_tol){
+                    converged = true; break;
+                }
+                if (opt.acceleration_period > 0 && iter > 0 && iter % opt.acceleration_period == 0){
+                    accelerate(lnW, delta, deltaprev);
+                }
+                deltaprev = delta;
+            }
+            if (!converged){ continue; }
+            double tpd = 1.0 - exp(lnW).sum();
+            if (tpd < res.tpd){
+                res.tpd = tpd;
+                res.w = exp(lnW)/exp(lnW).sum();
+                res.rho = rho.value();
+            }
+        }
+        return res;
+    }
+
+    /**
+     \brief Two-phase flash from initial K-factors by accelerated successive substitution, switching to Newton's method with the analytic Jacobian
+     \returns The result; if it converges to the trivial solution or outside the two-phase region, success is false and Nphases is set to one
+     */
+    TPFlashResult flash_from_K(const double T, const double p, const Eigen::ArrayXd& z, const Eigen::ArrayXd& K0, std::optional<double> rhoL, std::optional<double> rhoV) const {
+        TPFlashResult r;
+        r.T = T; r.p = p; r.z = z;
+        const auto N = z.size();
+        Eigen::ArrayXd lnK = log(K0), delta, deltaprev;
+        Eigen::ArrayXd x, y;
+        PhaseState L, V;
+        double beta = 0.5;
+
+        auto update_phases = [&](){
+            L = get_phase(T, p, x, RootKind::liquid, rhoL); rhoL = L.rho;
+            V = get_phase(T, p, y, RootKind::vapor, rhoV); rhoV = V.rho;
+        };
+
+        // Successive substitution
+        bool switch_to_Newton = false;
+        for (auto iter = 0; iter < opt.max_SS_iter; ++iter){
+            r.num_SS_iter++;
+            Eigen::ArrayXd K = exp(lnK);
+            beta = solve_Rachford_Rice(z, K);
+            if (!std::isfinite(beta) || lnK.abs().maxCoeff() < 1e-4){
+                r.Nphases = 1;
+                r.message = "Converged to trivial solution in successive substitution";
+                return r;
+            }
+            x = z/(1.0 + beta*(K-1.0)); x /= x.sum();
+            y = K*x; y /= y.sum();
+            update_phases();
+            delta = (L.lnphi - V.lnphi) - lnK;
+            lnK += delta;
+            if (delta.abs().maxCoeff() < opt.SS_switch_tol){
+                switch_to_Newton = true; break;
+            }
+            if (opt.acceleration_period > 0 && iter > 0 && iter % opt.acceleration_period == 0){
+                accelerate(lnK, delta, deltaprev);
+            }
+            deltaprev = delta;
+        }
+        if (!switch_to_Newton){
+            r.message = "Successive substitution did not converge";
+            return r;
+        }
+
+        // Newton's method in the vapor mole numbers, for one mole of feed
+        beta = solve_Rachford_Rice(z, exp(lnK));
+        if (!std::isfinite(beta) || beta <= 0 || beta >= 1){
+            r.Nphases = 1;
+            r.message = "Successive substitution converged outside the two-phase region";
+            return r;
+        }
+        Eigen::ArrayXd v = beta*y;
+        bool converged = false;
+        for (auto iter = 0; iter < opt.max_Newton_iter; ++iter){
+            r.num_Newton_iter++;
+            Eigen::ArrayXd l = z - v;
+            beta = v.sum();
+            x = l/l.sum(); y = v/v.sum();
+            update_phases();
+            Eigen::VectorXd g = (log(y) + V.lnphi - log(x) - L.lnphi).matrix();
+            if (g.cwiseAbs().maxCoeff() < opt.Newton_tol){
+                converged = true; break;
+            }
+            // Mole number derivatives of a phase with n moles are those of one mole divided by n
+            Eigen::MatrixXd J = get_dlnfdn_Tp(T, V.rho, y)/beta + get_dlnfdn_Tp(T, L.rho, x)/(1.0-beta);
+            Eigen::ArrayXd dv = J.ldlt().solve(-g).array();
+            if (!dv.allFinite()){
+                break;
+            }
+            // Keep all the mole numbers in both phases positive
+            double scale = 1.0;
+            for (auto i = 0; i < N; ++i){
+                if (v[i] + dv[i] <= 0){ scale = std::min(scale, -0.5*v[i]/dv[i]); }
+                if (l[i] - dv[i] <= 0){ scale = std::min(scale, 0.5*l[i]/dv[i]); }
+            }
+            v += scale*dv;
+        }
+        if (!converged){
+            r.message = "Newton iteration did not converge";
+            return r;
+        }
+        r.success = true;
+        r.Nphases = 2;
+        r.beta = beta;
+        r.x = x; r.y = y;
+        r.rhoL = L.rho; r.rhoV = V.rho;
+        r.K = y/x;
+        return r;
+    }
+
+    /**
+     \brief Carry out the complete flash
+     \param T Temperature, in K
+     \param p Pressure, in Pa
+     \param z Mole fractions of the feed, all of which must be positive
+     \param guess Optional warm-start values
+     */
+    TPFlashResult flash(const double T, const double p, const Eigen::ArrayXd& z, const TPFlashGuess& guess = {}) const {
+        if ((z <= 0).any()){
+            throw InvalidArgument("All the mole fractions in the feed must be positive; remove the absent components");
+        }
+        const auto N = z.size();
+        if (guess.K && guess.K.value().size() != N){
+            throw InvalidArgument("Length of K-factors guess does not match the length of the feed mole fractions");
+        }
+
+        auto single_phase = [&](const PhaseState& feed, TPFlashResult r){
+            r.success = true;
+            r.Nphases = 1;
+            r.T = T; r.p = p; r.z = z; r.x = z; r.y = z;
+            r.rhoL = feed.rho; r.rhoV = feed.rho;
+            r.beta = -1;
+            r.K = Eigen::ArrayXd::Ones(N);
+            return r;
+        };
+
+        // Warm start directly from the provided K-factors
+        std::optional<PhaseState> feed;
+        if (guess.K && opt.skip_stability_with_guess && N > 1){
+            auto r = flash_from_K(T, p, z, guess.K.value(), guess.rhoL, guess.rhoV);
+            if (r.success){
+                // Check that the Gibbs energy decreases relative to the single-phase feed
+                feed = get_phase(T, p, z, RootKind::minimum_gibbs);
+                double G2 = (1.0-r.beta)*(r.x*(log(r.x) + get_lnphi(T, p, r.rhoL, r.x))).sum() + r.beta*(r.y*(log(r.y) + get_lnphi(T, p, r.rhoV, r.y))).sum();
+                double G1 = (z*(log(z) + feed.value().lnphi)).sum();
+                if (G2 < G1){
+                    return r;
+                }
+            }
+        }
+        if (!feed){
+            feed = get_phase(T, p, z, RootKind::minimum_gibbs);
+        }
+        TPFlashResult r;
+        if (N == 1){
+            return single_phase(feed.value(), r);
+        }
+
+        // Initial compositions of the trial phases
+        std::vector<Eigen::ArrayXd> trials;
+        if (guess.K){
+            trials.push_back(z*guess.K.value());
+            trials.push_back(z/guess.K.value());
+        }
+        for (auto i = 0; i < N; ++i){
+            Eigen::ArrayXd w = Eigen::ArrayXd::Constant(N, 1e-3/(N-1));
+            w[i] = 1-1e-3;
+            trials.push_back(w);
+        }
+        auto stab = stability_test(T, p, z, feed.value(), trials);
+        r.num_stability_iter = stab.num_iter;
+        r.tpd = stab.tpd;
+        if (stab.tpd >= opt.tpd_tol){
+            return single_phase(feed.value(), r);
+        }
+
+        // Unstable, so split into the feed and the trial phase, with the lighter one as the vapor
+        bool trial_is_vapor = stab.rho < feed.value().rho;
+        Eigen::ArrayXd K0 = trial_is_vapor ? (stab.w/z).eval() : (z/stab.w).eval();
+        std::optional<double> rhoL = trial_is_vapor ? feed.value().rho : stab.rho, rhoV = trial_is_vapor ? stab.rho : feed.value().rho;
+        auto r2 = flash_from_K(T, p, z, K0, rhoL, rhoV);
+        r2.num_stability_iter = r.num_stability_iter;
+        r2.tpd = r.tpd;
+        if (!r2.success && r2.Nphases == 1){
+            auto r1 = single_phase(feed.value(), r2);
+            r1.message = r2.message;
+            return r1;
+        }
+        return r2;
+    }
+};
+
+/**
+ \brief Isothermal-isobaric flash for a concrete model type
+ \param model The model
+ \param T Temperature, in K
+ \param p Pressure, in Pa
+ \param z Mole fractions of the feed
+ \param guess Optional warm-start values (K-factors and phase densities)
+ \param options Options controlling the iterations
+ */
+template<typename Model, typename = typename std::enable_if<not std::is_base_of<teqp::cppinterface::AbstractModel, Model>::value>::type>
+TPFlashResult flash_Tp(const Model& model, const double T, const double p, const Eigen::ArrayXd& z, const std::optional<TPFlashGuess>& guess = std::nullopt, const std::optional<TPFlashOptions>& options = std::nullopt){
+    return TPFlasher<Model>(model, options.value_or(TPFlashOptions{})).flash(T, p, z, guess.value_or(TPFlashGuess{}));
+}
+
+/// For the AbstractModel, the flash is carried out by the concrete model type
+inline TPFlashResult flash_Tp(const teqp::cppinterface::AbstractModel& model, const double T, const double p, const Eigen::ArrayXd& z, const std::optional<TPFlashGuess>& guess = std::nullopt, const std::optional<TPFlashOptions>& options = std::nullopt){
+    return model.flash_Tp(T, p, z, guess, options);
+}
+
+/**
+ \brief Carry out a batch of flash calculations
+
+ The points are divided into contiguous chunks, one per thread. Within a chunk, each successful two-phase solution is used
+ as the warm start for the next point, so the points should be sorted along some path (e.g., increasing pressure) for the best
+ performance. An exception in one point does not abort the batch; the message is stored in the result for that point.
+
+ \param model The model (either a concrete model or an AbstractModel)
+ \param T Temperatures, in K
+ \param p Pressures, in Pa
+ \param Z Mole fractions of the feeds, one row per point
+ \param options Options controlling the iterations
+ \param warm_start If true, use the solution at the previous point in the chunk as the warm start
+ \param Nthreads Number of threads to use
+ */
+template<typename Model>
+std::vector<TPFlashResult> flash_Tp_batch(const Model& model, const Eigen::ArrayXd& T, const Eigen::ArrayXd& p, const Eigen::ArrayXXd& Z, const std::optional<TPFlashOptions>& options = std::nullopt, const bool warm_start = true, const std::size_t Nthreads = 1){
+    const auto Npts = static_cast<std::size_t>(T.size());
+    if (static_cast<std::size_t>(p.size()) != Npts || static_cast<std::size_t>(Z.rows()) != Npts){
+        throw InvalidArgument("Lengths of T, p, and rows of Z must all be the same");
+    }
+    std::vector<TPFlashResult> results(Npts);
+    auto do_chunk = [&](std::size_t istart, std::size_t iend){
+        std::optional<TPFlashGuess> guess;
+        for (auto i = istart; i < iend; ++i){
+            Eigen::ArrayXd z = Z.row(i).transpose();
+            try{
+                results[i] = flash_Tp(model, T[i], p[i], z, guess, options);
+            }
+            catch(std::exception& e){
+                results[i] = TPFlashResult{};
+                results[i].T = T[i]; results[i].p = p[i]; results[i].z = z;
+                results[i].message = e.what();
+            }
+            if (warm_start && results[i].success){
+                guess = results[i].as_guess();
+            }
+        }
+    };
+    const std::size_t Nchunks = std::max(std::size_t{1}, std::min(Nthreads, Npts));
+    if (Nchunks == 1){
+        do_chunk(0, Npts);
+        return results;
+    }
+    boost::asio::thread_pool pool{Nchunks};
+    for (std::size_t ichunk = 0; ichunk < Nchunks; ++ichunk){
+        std::size_t istart = ichunk*Npts/Nchunks, iend = (ichunk+1)*Npts/Nchunks;
+        boost::asio::post(pool, [&do_chunk, istart, iend](){ do_chunk(istart, iend); });
+    }
+    pool.join();
+    return results;
+}
+
+}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <Eigen/Dense>
+
+namespace teqp{
+namespace flash{
+
+/// Options for the isothermal-isobaric flash calculation
+struct TPFlashOptions {
+    double stability_tol = 1e-10, ///< Convergence tolerance on the change in ln(W) in the stability test
+    tpd_tol = -1e-8, ///< The modified tangent plane distance must be less than this value for the feed to be considered unstable
+    trivial_tol = 1e-4, ///< If the sum of squared differences between ln(W) and ln(z) falls below this value, the stability test converged to the trivial solution
+    SS_switch_tol = 1e-5, ///< When the change in ln(K) in successive substitution is smaller than this value, switch to Newton
+    Newton_tol = 1e-12, ///< Convergence tolerance on the norm of the residual of the Newton iteration
+    rho_reltol = 1e-13; ///< Relative convergence tolerance of the density solver
+    int max_stability_iter = 200, ///< Maximum number of successive substitution steps in the stability test
+    max_SS_iter = 200, ///< Maximum number of successive substitution steps in the flash
+    max_Newton_iter = 30, ///< Maximum number of Newton steps in the flash
+    acceleration_period = 5, ///< Every acceleration_period steps of successive substitution, a dominant eigenvalue extrapolation is carried out; 0 to disable
+    max_rho_iter = 100; ///< Maximum number of steps in the density solver
+    bool skip_stability_with_guess = true; ///< If K-factors are provided and the flash from them converges to a two-phase solution, skip the stability test
+};
+
+/// Optional warm-start values for the flash, for instance from the solution at a nearby state point
+struct TPFlashGuess {
+    std::optional<Eigen::ArrayXd> K; ///< K-factors y_i/x_i
+    std::optional<double> rhoL, ///< Molar density of the liquid phase (or the only phase), in mol/m^3
+    rhoV; ///< Molar density of the vapor phase, in mol/m^3
+};
+
+/// The result of a flash calculation
+struct TPFlashResult {
+    bool success = false; ///< True if the calculation converged
+    int Nphases = 0; ///< Number of phases at equilibrium (1 or 2)
+    double T = -1, p = -1;
+    double beta = -1; ///< Molar vapor fraction; -1 for a single phase
+    double tpd = 0; ///< Minimum modified tangent plane distance found in the stability test
+    Eigen::ArrayXd z, x, y; ///< Mole fractions in the feed, liquid and vapor phases
+    double rhoL = -1, rhoV = -1; ///< Molar densities of the liquid and vapor phases; both are the density of the phase for a single phase
+    Eigen::ArrayXd K; ///< The K-factors y_i/x_i (usable as warm start for a nearby state point)
+    int num_stability_iter = 0, num_SS_iter = 0, num_Newton_iter = 0;
+    std::string message = "";
+
+    /// Convert the solution to a warm-start guess for a nearby state point
+    TPFlashGuess as_guess() const {
+        TPFlashGuess g;
+        if (Nphases == 2){ g.K = K; }
+        g.rhoL = rhoL; g.rhoV = rhoV;
+        return g;
+    }
+};
+
+}
+}
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <optional>
+#include <limits>
 
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/cpp/derivs.hpp"
 #include "teqp/exceptions.hpp"
 
 #include <boost/multiprecision/cpp_bin_float.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
 
 namespace teqp {
 namespace iteration {
@@ -511,5 +514,147 @@ public:
 };
 
 
+/// Options for the batch Newton-Raphson solver
+struct BatchNROptions{
+    int maxiter = 50; ///< Maximum number of Newton steps for each point
+    double tol = 1e-11; ///< Tolerance on the maximum absolute value of the scaled residuals
+    bool continuation = true; ///< If true, the solution of the previous point is used as the initial guess for the next point (within a chunk)
+    std::size_t Nthreads = 1; ///< Number of threads; the points are divided into contiguous chunks, one per thread
+};
+
+/// The results of the batch Newton-Raphson solver, one entry per point
+struct BatchNRResult{
+    Eigen::ArrayXd T, rho; ///< The solutions for temperature and molar density
+    Eigen::ArrayXi iterations; ///< Number of Newton steps taken (including those of a retry from the provided initial guess)
+    Eigen::ArrayXd maxabsr; ///< Maximum absolute value of the scaled residuals at the solution
+    Eigen::ArrayX<bool> success; ///< True if the point converged
+};
+
+/**
+ \brief Solve many inverse problems (for instance (p,h) or (p,s) to (T,rho)) for a mixture of fixed composition
+
+ The same formulation as NRIterator is used, but with a light-weight loop: the 2x2 system is solved explicitly, the density
+ is iterated in \f$\ln(\rho)\f$ to keep it positive, and the residuals are scaled to be dimensionless (relative for T, D and P;
+ divided by \f$RT\f$ for H and U and by \f$R\f$ for S) so that a single tolerance can be used whatever the reference state of the
+ enthalpy and entropy.
+
+ If the targets are sorted along a path, with continuation enabled the solution of the previous point is used as the initial
+ guess for the next one. If the iteration from the previous solution fails, the iteration is retried from the provided initial guess.
+
+ A failure at one point does not abort the batch; if the model throws for a point, its temperature, density and residual are NaN.
+
+ \param alphamodel The ideal-gas and residual models
+ \param vars The two variables that are specified, allowed are 'H','S','U','P','T','D'
+ \param vals The target values, one row per point and one column per variable
+ \param T0 Initial guesses for the temperature, one per point, or a single value used for all points
+ \param rho0 Initial guesses for the molar density, one per point, or a single value used for all points
+ \param z Mole fractions
+ \param options Options for the iteration
+ */
+inline BatchNRResult solve_NR_batch(const AlphaModel& alphamodel, const std::vector<char>& vars, const Eigen::Ref<const Eigen::ArrayXXd>& vals, const Eigen::Ref<const Eigen::ArrayXd>& T0, const Eigen::Ref<const Eigen::ArrayXd>& rho0, const Eigen::Ref<const Eigen::ArrayXd>& z, const std::optional<BatchNROptions>& options_ = std::nullopt){
+    const auto options = options_.value_or(BatchNROptions{});
+    if (vars.size() != 2 || vals.cols() != 2){
+        throw teqp::InvalidArgument("Two variables must be specified");
+    }
+    const auto N = vals.rows();
+    for (const auto& g : {T0.size(), rho0.size()}){
+        if (g != 1 && g != N){
+            throw teqp::InvalidArgument("Initial guesses must be of length one or the number of points");
+        }
+    }
+    const Eigen::ArrayXd zz = z;
+    const double R = alphamodel.get_R(zz);
+    
+    BatchNRResult res;
+    res.T.resize(N); res.rho.resize(N); res.iterations.setZero(N); res.maxabsr.resize(N);
+    res.success.setConstant(N, false);
+    
+    // Scaling factor for residual i to make it dimensionless
+    auto scale = [&](char var, double target, double T) -> double {
+        switch(var){
+            case 'T': case 'D': case 'P': return std::abs(target);
+            case 'H': case 'U': return R*T;
+            case 'S': return R;
+            default: throw teqp::InvalidArgument("bad var: " + std::string(1, var));
+        }
+    };
+    
+    // Newton iteration for one point, returns (converged, iterations, maxabsr, T, rho)
+    auto solve_one = [&](const Eigen::Array2d& target, double T, double rho){
+        double maxabsr = 1e99;
+        int iter = 0;
+        for (; iter < options.maxiter; ++iter){
+            auto A = alphamodel.get_deriv_mat2(T, rho, zz);
+            auto im = build_iteration_Jv(vars, A, R, T, rho, zz);
+            Eigen::Array2d r = im.v - target;
+            for (auto i = 0; i < 2; ++i){
+                double s = scale(vars[i], target(i), T);
+                r(i) /= s; im.J.row(i) /= s;
+            }
+            maxabsr = r.abs().maxCoeff();
+            if (!std::isfinite(maxabsr)){ break; }
+            if (maxabsr < options.tol){
+                return std::make_tuple(true, iter, maxabsr, T, rho);
+            }
+            // Explicit solution of J*[dT, dln(rho)] = -r
+            double J00 = im.J(0,0), J01 = im.J(0,1)*rho, J10 = im.J(1,0), J11 = im.J(1,1)*rho;
+            double det = J00*J11 - J01*J10;
+            double dT = (-r(0)*J11 + J01*r(1))/det;
+            double dlnrho = (-J00*r(1) + J10*r(0))/det;
+            if (!std::isfinite(dT) || !std::isfinite(dlnrho)){ break; }
+            // Do not allow the temperature to more than halve in one step
+            if (T + dT < 0.5*T){ dT = -0.5*T; }
+            T += dT;
+            rho *= exp(dlnrho);
+        }
+        return std::make_tuple(false, iter, maxabsr, T, rho);
+    };
+    
+    auto do_chunk = [&](Eigen::Index istart, Eigen::Index iend){
+        bool have_previous = false;
+        double Tprev = -1, rhoprev = -1;
+        for (auto i = istart; i < iend; ++i){
+            const Eigen::Array2d target = vals.row(i).transpose();
+            const double Tguess = (T0.size() == 1) ? T0(0) : T0(i), rhoguess = (rho0.size() == 1) ? rho0(0) : rho0(i);
+            int iterations = 0;
+            bool ok = false; double maxabsr = 1e99, T = Tguess, rho = rhoguess;
+            // A failure at one point must not escape the worker, so an exception marks the point as failed with NaN outputs
+            auto attempt = [&](double Tstart, double rhostart){
+                try{
+                    int its;
+                    std::tie(ok, its, maxabsr, T, rho) = solve_one(target, Tstart, rhostart);
+                    iterations += its;
+                }
+                catch(const std::exception&){
+                    ok = false; maxabsr = T = rho = std::numeric_limits<double>::quiet_NaN();
+                }
+            };
+            if (options.continuation && have_previous){
+                attempt(Tprev, rhoprev);
+            }
+            if (!ok){
+                attempt(Tguess, rhoguess);
+            }
+            res.T(i) = T; res.rho(i) = rho; res.iterations(i) = iterations; res.maxabsr(i) = maxabsr; res.success(i) = ok;
+            have_previous = ok;
+            Tprev = T; rhoprev = rho;
+        }
+    };
+    
+    const auto Nchunks = static_cast<Eigen::Index>(std::max(std::size_t{1}, std::min(options.Nthreads, static_cast<std::size_t>(N))));
+    if (Nchunks == 1){
+        do_chunk(0, N);
+        return res;
+    }
+    boost::asio::thread_pool pool{static_cast<std::size_t>(Nchunks)};
+    for (Eigen::Index ichunk = 0; ichunk < Nchunks; ++ichunk){
+        Eigen::Index istart = ichunk*N/Nchunks, iend = (ichunk+1)*N/Nchunks;
+        boost::asio::post(pool, [&do_chunk, istart, iend](){ do_chunk(istart, iend); });
+    }
+    pool.join();
+    return res;
+}
+
+
 }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <set>
+#include <vector>
 #include "teqp/exceptions.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 
@@ -355,6 +357,54 @@ public:
     const std::vector<std::shared_ptr<AbstractSpecification>> specifications; ///< The specification equations
     CallResult res; ///< The internal buffer of residual vector and Jacobian (to minimize copies)
     
+    /// Counters of the work that has been done, accumulated over all the calls
+    struct Counters{
+        std::size_t Ncalls = 0, ///< Number of calls to call (each builds the residual vector and the Jacobian)
+        Nphase_derivatives = 0, ///< Number of evaluations of the isochoric derivative bundle of a phase
+        Ncaloric_derivatives = 0, ///< Number of evaluations of the caloric derivatives of a phase
+        Nsteps = 0; ///< Number of Newton steps solved for
+    };
+    Counters counters;
+    
+    /// The result of a Newton iteration with iterate
+    struct IterationResult{
+        Eigen::ArrayXd x; ///< The final values of the independent variables
+        std::size_t Niter = 0; ///< The number of steps taken
+        double max_abs_r = -1; ///< The largest absolute value of the residuals at the final values
+        bool converged = false; ///< True if the largest absolute value of the residuals is below the tolerance
+    };
+    
+private:
+    /**
+     The buffers that are reused from one call to the next, sized in the constructor, so that the containers are not rebuilt in each iteration
+     
+     For the step, the unknowns are split into the molar concentrations of phases 1..Nphases-1 (v) and the rest (y: T, the molar concentrations of phase 0
+     and the betas). The rows of the fugacity equalities between phase 0 and phase i only involve the molar concentrations of phase i among the v,
+     so the block of these rows and the v columns is block-diagonal, and the v are eliminated phase by phase (a Schur complement), leaving a
+     dense system of size Ncomponents+Nphases+1 for y.
+     */
+    struct Workspace{
+        std::vector<Eigen::Map<const Eigen::ArrayXd>> rhovecs;
+        std::vector<RequiredPhaseDerivatives> derivatives;
+        std::vector<CaloricPhaseDerivatives> caloricderivatives;
+        std::vector<Eigen::PartialPivLU<Eigen::MatrixXd>> LU; ///< LU decomposition of the block of the Jacobian for phase i in its fugacity rows
+        std::vector<Eigen::MatrixXd> DinvJFy; ///< The blocks of D_i^{-1}*J_Fy, one for each phase other than phase 0
+        std::vector<Eigen::VectorXd> DinvrF; ///< The blocks of D_i^{-1}*r_F, one for each phase other than phase 0
+        Eigen::MatrixXd Jy, S; ///< The columns of the Jacobian for y, and the Schur complement
+        Eigen::VectorXd rhsy, y, dx;
+    };
+    Workspace ws;
+    
+    /// Indices of the columns of the y unknowns in the full vector of unknowns
+    std::vector<Eigen::Index> y_columns() const {
+        std::vector<Eigen::Index> cols;
+        for (auto i = 0U; i < 1 + Ncomponents; ++i){ cols.push_back(i); }
+        for (auto i = 0U; i < Nphases; ++i){ cols.push_back(Nindependent - Nphases + i); }
+        return cols;
+    }
+    
+public:
+    
     /**
      \brief A helper class for doing multi-phase phase equilibrium calculations with additional specification equations
      
@@ -384,6 +434,17 @@ public:
         // Resize the working buffers
         res.r.resize(Nindependent);
         res.J.resize(Nindependent, Nindependent);
+        ws.rhovecs.reserve(Nphases);
+        ws.derivatives.resize(Nphases);
+        ws.caloricderivatives.resize(Nphases);
+        ws.LU.resize(Nphases-1, Eigen::PartialPivLU<Eigen::MatrixXd>(Ncomponents));
+        ws.DinvJFy.resize(Nphases-1, Eigen::MatrixXd(Ncomponents, 1+Ncomponents+Nphases));
+        ws.DinvrF.resize(Nphases-1, Eigen::VectorXd(Ncomponents));
+        ws.Jy.resize(Nindependent, 1+Ncomponents+Nphases);
+        ws.S.resize(1+Ncomponents+Nphases, 1+Ncomponents+Nphases);
+        ws.rhsy.resize(1+Ncomponents+Nphases);
+        ws.y.resize(1+Ncomponents+Nphases);
+        ws.dx.resize(Nindependent);
     }
     auto attach_ideal_gas(const std::shared_ptr<const AbstractModel>& ptr){
         idealgasptr = ptr;
@@ -403,8 +464,10 @@ public:
         if (x.size() != Nindependent){
             throw teqp::InvalidArgument("Wrong size; should be of size"+ std::to_string(Nindependent) + "; is of size " + std::to_string(x.size()));
         }
+        counters.Ncalls++;
         double T = x[0];
-        std::vector<Eigen::Map<const Eigen::ArrayXd>> rhovecs;
+        auto& rhovecs = ws.rhovecs;
+        rhovecs.clear(); // Keeps the capacity reserved in the constructor
         for (auto iphase_ = 0; iphase_ < Nphases; ++iphase_){
             rhovecs.push_back(Eigen::Map<const Eigen::ArrayXd>(&x[1 + iphase_*Ncomp], Ncomponents));
         }
@@ -417,19 +480,19 @@ public:
             RequiredPhaseDerivatives der;
             der.rho = rhovec.sum();
             der.R = R;
-            // Three in one via tuple unpacking
-            std::tie(der.Psir, der.gradient_Psir, der.Hessian_Psir) = modelref.build_Psir_fgradHessian_autodiff(T, rhovec);
-            // And then the temperature derivatives
-            // Psir = ar*R*T*rho
-            // d(Psir)/dT = d(rho*alphar*R*T)/dT = rho*R*d(alphar*T)/dT = rho*R*(T*dalphar/dT + alphar) = rho*R*(T*dalphar/dT) + Psir/T
-            // and T*dalphar/dT = -Ar10 so
-            der.d_Psir_dT = der.rho*R*(-modelref.get_Ar10(T, der.rho, rhovec/der.rho)) + der.Psir/T;
-            der.d_gradient_Psir_dT = modelref.build_d2PsirdTdrhoi_autodiff(T, rhovec);
+            // All the composition and temperature derivatives in one call
+            auto bundle = modelref.build_isochoric_derivative_bundle(T, rhovec);
+            der.Psir = bundle.Psir;
+            der.gradient_Psir = bundle.gradient_Psir;
+            der.Hessian_Psir = bundle.Hessian_Psir;
+            der.d_Psir_dT = bundle.dPsirdT;
+            der.d_gradient_Psir_dT = bundle.d2PsirdTdrhovec;
             return der;
         };
-        std::vector<RequiredPhaseDerivatives> derivatives;
+        auto& derivatives = ws.derivatives;
         for (auto iphase_ = 0; iphase_ < Nphases; ++iphase_){
-            derivatives.emplace_back(calculate_required_derivatives(this->residptr, T, rhovecs[iphase_]));
+            derivatives[iphase_] = calculate_required_derivatives(this->residptr, T, rhovecs[iphase_]);
+            counters.Nphase_derivatives++;
         }
         
         // First we have the equalities in (natural) logarithm of fugacity coefficient (always present)
@@ -455,17 +518,11 @@ public:
             // And Ncomp entries in the first column (of index 0) in the Jacobian for the
             // temperature derivative
             J.block(irow, 0, Ncomp, 1) = dlnfdT_phase0 - dlnfdT_phasei;
-            // And in the rows in the Jacobian, there is a block for each phase,
-            // including the first one with index 0, and the correct block needs to be selected
-            // which for first phase is of positive sign, and elsewhere, of negative sign
-            for (auto iphasej = 0; iphasej < Ncomp; ++iphasej){
-                if (iphasej == 0){
-                    J.block(irow, 1+iphasej*Ncomp, Ncomp, Ncomp) = dlnfdrho_phase0;
-                }
-                else{
-                    J.block(irow, 1+iphasej*Ncomp, Ncomp, Ncomp) = -dlnfdrho_phasei;
-                }
-            }
+            // And in the rows in the Jacobian, there is a block for the first phase (with index 0),
+            // of positive sign, and one for the phase with index iphasei, of negative sign;
+            // the blocks of the other phases are zero
+            J.block(irow, 1, Ncomp, Ncomp) = dlnfdrho_phase0;
+            J.block(irow, 1+iphasei*Ncomp, Ncomp, Ncomp) = -dlnfdrho_phasei;
             irow += Ncomp;
         }
         
@@ -480,14 +537,8 @@ public:
             Eigen::ArrayXd dpdrho_phasei = derivatives[iphasei].dpdrhovec(T, rhovecs[iphasei]);
             r[irow] = p_phase0 - p_phasei;
             J(irow, 0) = dpdT_phase0 - dpdT_phasei;
-            for (auto iphasej = 0; iphasej < Nphases; ++iphasej){
-                if (iphasej == 0){
-                    J.block(irow, 1+iphasej*Ncomp, 1, Ncomp) = dpdrho_phase0.transpose();
-                }
-                else{
-                    J.block(irow, 1+iphasej*Ncomp, 1, Ncomp) = -dpdrho_phasei.transpose();
-                }
-            }
+            J.block(irow, 1, 1, Ncomp) = dpdrho_phase0.transpose();
+            J.block(irow, 1+iphasei*Ncomp, 1, Ncomp) = -dpdrho_phasei.transpose();
             // Note: no Jacobian contribution for derivatives w.r.t. betas
             irow += 1;
         }
@@ -544,10 +595,11 @@ public:
             der.d_gradient_Psiig_dT = modelref.build_d2PsirdTdrhoi_autodiff(T, rhovec);
             return der;
         };
-        std::vector<CaloricPhaseDerivatives> caloricderivatives;
+        auto& caloricderivatives = ws.caloricderivatives;
         if (this->idealgasptr){
             for (auto iphase_ = 0; iphase_ < Nphases; ++iphase_){
-                caloricderivatives.emplace_back(calculate_caloric_derivatives(*this->idealgasptr->get(), residptr,  T, rhovecs[iphase_]));
+                caloricderivatives[iphase_] = calculate_caloric_derivatives(*this->idealgasptr->get(), residptr,  T, rhovecs[iphase_]);
+                counters.Ncaloric_derivatives++;
             }
             sidecar.derivatives = &derivatives;
             sidecar.caloricderivatives = &caloricderivatives;
@@ -562,6 +614,75 @@ public:
         
         // Finally, zero out the rows and columns in the Jacobian where mole fractions are zero, which would otherwise cause issues
     }
+    
+    /**
+     \brief Solve for the Newton step from the residual vector and Jacobian of the last call
+     
+     The molar concentrations of the phases other than the first are eliminated by block elimination, see Workspace,
+     which requires Nphases-1 LU decompositions of Ncomponents x Ncomponents matrices and the solution of one dense
+     system of size Ncomponents+Nphases+1, rather than the solution of the dense system of size Nindependent.
+     The result is the same as that of J.colPivHouseholderQr().solve(-r) in exact arithmetic.
+     */
+    const Eigen::VectorXd& solve_step(){
+        const auto& J = res.J;
+        const auto& r = res.r;
+        const Eigen::Index Nc = Ncomponents, NF = Nc*(Nphases-1), Ny = 1+Nc+Nphases;
+        const auto ycols = y_columns();
+        for (auto k = 0; k < Ny; ++k){
+            ws.Jy.col(k) = J.col(ycols[k]);
+        }
+        // The rows that are not fugacity equalities, and their v columns
+        auto Gy = ws.Jy.bottomRows(Nindependent - NF);
+        ws.S = Gy;
+        ws.rhsy = -r.tail(Nindependent - NF);
+        for (auto i = 1U; i < Nphases; ++i){
+            auto rows = (i-1)*Nc;
+            auto& LU = ws.LU[i-1];
+            LU.compute(J.block(rows, 1+i*Nc, Nc, Nc));
+            ws.DinvJFy[i-1] = LU.solve(ws.Jy.middleRows(rows, Nc));
+            ws.DinvrF[i-1] = LU.solve(r.segment(rows, Nc));
+            auto Gv = J.block(NF, 1+i*Nc, Nindependent-NF, Nc);
+            ws.S.noalias() -= Gv*ws.DinvJFy[i-1];
+            ws.rhsy.noalias() += Gv*ws.DinvrF[i-1];
+        }
+        ws.y = ws.S.colPivHouseholderQr().solve(ws.rhsy);
+        for (auto k = 0; k < Ny; ++k){
+            ws.dx[ycols[k]] = ws.y[k];
+        }
+        for (auto i = 1U; i < Nphases; ++i){
+            ws.dx.segment(1+i*Nc, Nc) = -ws.DinvrF[i-1] - ws.DinvJFy[i-1]*ws.y;
+        }
+        counters.Nsteps++;
+        return ws.dx;
+    }
+    
+    /**
+     \brief Carry out Newton steps with the block solver until the residuals are all smaller in magnitude than the tolerance
+     \param x0 The initial values of the independent variables, as from UnpackedVariables::pack
+     \param maxiter The maximum number of steps
+     \param tol The tolerance on the absolute value of the residuals
+     */
+    IterationResult iterate(const Eigen::ArrayXd& x0, std::size_t maxiter = 50, double tol = 1e-10){
+        IterationResult o;
+        o.x = x0;
+        for (o.Niter = 0; o.Niter < maxiter; ++o.Niter){
+            call(o.x);
+            o.max_abs_r = res.r.cwiseAbs().maxCoeff();
+            if (o.max_abs_r < tol){
+                o.converged = true;
+                return o;
+            }
+            const auto& dx = solve_step();
+            if (!dx.allFinite()){
+                return o;
+            }
+            o.x += dx.array();
+        }
+        call(o.x);
+        o.max_abs_r = res.r.cwiseAbs().maxCoeff();
+        o.converged = (o.max_abs_r < tol);
+        return o;
+    }
     auto num_Jacobian(const Eigen::ArrayXd& x, const Eigen::ArrayXd& dx){
         Eigen::MatrixXd J(Nindependent, Nindependent);
         call(x);
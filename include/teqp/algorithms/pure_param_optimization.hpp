@@ -1,7 +1,14 @@
 #pragma once
 
 #include <tuple>
+#include <array>
 #include <variant>
+#include <mutex>
+#include <latch>
+#include <chrono>
+#include <numeric>
+#include <valarray>
+#include <exception>
 
 #include "nlohmann/json.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
@@ -13,13 +20,64 @@
 
 namespace teqp::algorithms::pure_param_optimization {
 
+/**
+ The contributions to the cost function are split into two steps so that the gradient of the cost w.r.t. the parameters can be obtained
+ by implicit differentiation (see cost_and_gradient):
+ 
+ * solve_state: iteratively solves for the state variables (e.g., the saturated densities) that the cost depends on
+ * cost_at_state: the cost for given state variables, without any iteration
+ 
+ Contributions with state variables also provide state_residuals, the equations that are zero at the solution of solve_state,
+ and state_Jacobian, their derivatives w.r.t. the state variables
+ */
+namespace detail{
+
+    /// The pure-fluid VLE conditions for the densities u = [rhoL, rhoV], the same residuals as in IsothermPureVLEResiduals
+    template<typename Model>
+    auto pure_VLE_residuals(const Model& model, double T, const Eigen::ArrayXd& u){
+        const Eigen::ArrayXd z = Eigen::ArrayXd::Ones(1);
+        auto derL = model->get_Ar02n(T, u[0], z), derV = model->get_Ar02n(T, u[1], z);
+        Eigen::ArrayXd r(2);
+        r[0] = u[0]*(1.0 + derL[1]) - u[1]*(1.0 + derV[1]);
+        r[1] = (derL[0] + derL[1] + log(u[0])) - (derV[0] + derV[1] + log(u[1]));
+        return r;
+    }
+    
+    /// The derivatives of pure_VLE_residuals w.r.t. u = [rhoL, rhoV]
+    template<typename Model>
+    auto pure_VLE_Jacobian(const Model& model, double T, const Eigen::ArrayXd& u){
+        const Eigen::ArrayXd z = Eigen::ArrayXd::Ones(1);
+        auto derL = model->get_Ar02n(T, u[0], z), derV = model->get_Ar02n(T, u[1], z);
+        Eigen::MatrixXd J(2, 2);
+        J(0, 0) = 1.0 + 2*derL[1] + derL[2];
+        J(0, 1) = -(1.0 + 2*derV[1] + derV[2]);
+        J(1, 0) = J(0, 0)/u[0];
+        J(1, 1) = J(0, 1)/u[1];
+        return J;
+    }
+}
+
 struct SatRhoLPoint{
     double T, rhoL_exp, rhoL_guess, rhoV_guess, weight=1.0;
     auto check_fields() const{}
+    
     template<typename Model>
-    auto calculate_contribution(const Model& model) const{
+    Eigen::ArrayXd solve_state(const Model& model) const{
         auto rhoLrhoV = model->pure_VLE_T(T, rhoL_guess, rhoV_guess, 10);
-        return std::abs(rhoLrhoV[0]-rhoL_exp)*weight;
+        return (Eigen::ArrayXd(2) << rhoLrhoV[0], rhoLrhoV[1]).finished();
+    }
+    template<typename Model>
+    auto state_residuals(const Model& model, const Eigen::ArrayXd& u) const{ return detail::pure_VLE_residuals(model, T, u); }
+    template<typename Model>
+    auto state_Jacobian(const Model& model, const Eigen::ArrayXd& u) const{ return detail::pure_VLE_Jacobian(model, T, u); }
+    template<typename Model>
+    double cost_at_state(const Model& /*model*/, const Eigen::ArrayXd& u) const{
+        return std::abs(u[0]-rhoL_exp)*weight;
+    }
+    
+    template<typename Model>
+    auto calculate_contribution(const Model& model) const{
+        return cost_at_state(model, solve_state(model));
     }
 };
 
@@ -39,6 +97,16 @@ struct PVTNoniterativePoint{
         #undef X
     }
     
+    /// There are no state variables
+    template<typename Model>
+    Eigen::ArrayXd solve_state(const Model& /*model*/) const{ return Eigen::ArrayXd(0); }
+    template<typename Model>
+    auto state_residuals(const Model& /*model*/, const Eigen::ArrayXd& /*u*/) const{ return Eigen::ArrayXd(0); }
+    template<typename Model>
+    auto state_Jacobian(const Model& /*model*/, const Eigen::ArrayXd& /*u*/) const{ return Eigen::MatrixXd(0, 0); }
+    template<typename Model>
+    double cost_at_state(const Model& model, const Eigen::ArrayXd& /*u*/) const{ return calculate_contribution(model); }
+    
     template<typename Model>
     auto calculate_contribution(const Model& model) const{
         // See for instance Eq. 17 in https://doi.org/10.1063/5.0086060
@@ -65,9 +133,18 @@ struct SatRhoLPPoint{
     }
     
     template<typename Model>
-    auto calculate_contribution(const Model& model) const{
+    Eigen::ArrayXd solve_state(const Model& model) const{
         auto rhoLrhoV = model->pure_VLE_T(T.value(), rhoL_guess.value(), rhoV_guess.value(), 10);
-        auto rhoL = rhoLrhoV[0];
+        return (Eigen::ArrayXd(2) << rhoLrhoV[0], rhoLrhoV[1]).finished();
+    }
+    template<typename Model>
+    auto state_residuals(const Model& model, const Eigen::ArrayXd& u) const{ return detail::pure_VLE_residuals(model, T.value(), u); }
+    template<typename Model>
+    auto state_Jacobian(const Model& model, const Eigen::ArrayXd& u) const{ return detail::pure_VLE_Jacobian(model, T.value(), u); }
+    
+    template<typename Model>
+    double cost_at_state(const Model& model, const Eigen::ArrayXd& u) const{
+        auto rhoL = u[0];
         auto p = rhoL*R*T.value()*(1+model->get_Ar01(T.value(), rhoL, z));
 //        std::cout << p << "," << p_exp << "," << (p_exp-p)/p_exp << std::endl;
         
@@ -75,6 +152,11 @@ struct SatRhoLPPoint{
         double cost_p = std::abs(p-p_exp.value())/p_exp.value()*weight_p;
         return ((weight_rho != 0) ? cost_rhoL : 0) + ((weight_p != 0) ? cost_p : 0);
     }
+    
+    template<typename Model>
+    auto calculate_contribution(const Model& model) const{
+        return cost_at_state(model, solve_state(model));
+    }
 };
 
 #define SatRhoLPWPoint_optionalfields X(T) X(p_exp) X(rhoL_exp) X(w_exp) X(rhoL_guess) X(rhoV_guess) X(Ao20) X(M) X(R)
@@ -93,12 +175,25 @@ struct SatRhoLPWPoint{
     }
     
     template<typename Model>
-    auto calculate_contribution(const Model& model) const{
-        
+    Eigen::ArrayXd solve_state(const Model& model) const{
         auto rhoLrhoV = model->pure_VLE_T(T.value(), rhoL_guess.value(), rhoV_guess.value(), 10);
+        return (Eigen::ArrayXd(2) << rhoLrhoV[0], rhoLrhoV[1]).finished();
+    }
+    template<typename Model>
+    auto state_residuals(const Model& model, const Eigen::ArrayXd& u) const{ return detail::pure_VLE_residuals(model, T.value(), u); }
+    template<typename Model>
+    auto state_Jacobian(const Model& model, const Eigen::ArrayXd& u) const{ return detail::pure_VLE_Jacobian(model, T.value(), u); }
+    
+    template<typename Model>
+    auto calculate_contribution(const Model& model) const{
+        return cost_at_state(model, solve_state(model));
+    }
+    
+    template<typename Model>
+    double cost_at_state(const Model& model, const Eigen::ArrayXd& u) const{
         
         // First part, density
-        auto rhoL = rhoLrhoV[0];
+        auto rhoL = u[0];
         
         auto Ar0n = model->get_Ar02n(T.value(), rhoL, z);
         double Ar01 = Ar0n[1], Ar02 = Ar0n[2];
@@ -141,6 +236,12 @@ struct SOSPoint{
     
     template<typename Model>
     auto calculate_contribution(const Model& model) const{
+        return cost_at_state(model, solve_state(model));
+    }
+    
+    /// The density at the experimental pressure
+    template<typename Model>
+    Eigen::ArrayXd solve_state(const Model& model) const{
         
         double rho = rho_guess.value();
         double R_ = R.value();
@@ -161,6 +262,25 @@ struct SOSPoint{
             }
             rho += change;
         }
+        return (Eigen::ArrayXd(1) << rho).finished();
+    }
+    /// The relative deviation from the experimental pressure, as used in solve_state
+    template<typename Model>
+    auto state_residuals(const Model& model, const Eigen::ArrayXd& u) const{
+        auto Ar01 = model->get_Ar01(T.value(), u[0], z);
+        return (Eigen::ArrayXd(1) << (u[0]*R.value()*T.value()*(1+Ar01)-p_exp.value())/p_exp.value()).finished();
+    }
+    template<typename Model>
+    auto state_Jacobian(const Model& model, const Eigen::ArrayXd& u) const{
+        auto Ar0n = model->get_Ar02n(T.value(), u[0], z);
+        return (Eigen::MatrixXd(1, 1) << R.value()*T.value()*(1 + 2*Ar0n[1] + Ar0n[2])/p_exp.value()).finished();
+    }
+    
+    template<typename Model>
+    double cost_at_state(const Model& model, const Eigen::ArrayXd& u) const{
+        double rho = u[0];
+        double R_ = R.value();
+        double T_K_ = T.value();
 
         // Second part, speed of sound
         //
@@ -180,6 +300,93 @@ struct SOSPoint{
 
 using PureOptimizationContribution = std::variant<SatRhoLPoint, SatRhoLPPoint, SatRhoLPWPoint, SOSPoint, PVTNoniterativePoint>;
 
+/**
+ The cost function and its gradient w.r.t. the parameters. The state variables u of each contribution (e.g., the saturated densities) 
+ are solved for once, and their sensitivity to the parameters follows from implicit differentiation of the state residuals r(u, x) = 0:
+ 
+ du/dx_k = -(dr/du)^{-1} dr/dx_k
+ 
+ \note The scope is narrower than a forward-mode automatic differentiation of the cost, which would need the models to be templated on the
+ type of their parameters; they are not, and the parameters are only reachable as doubles through set_parameters. The implicit
+ differentiation through the states is exact, but the partial derivatives w.r.t. the parameters at fixed state are taken from fourth-order
+ central differences with a relative step of 1e-4 of the parameter. The step is not tuned to the model: it is small enough that the
+ truncation error is negligible, and large enough to stay clear of roundoff and of the kinks of the absolute deviations in the cost. The
+ result agrees with the closed-form gradient of the van der Waals EOS to about 1e-11, relative, but it is not exact. The iterative solvers
+ are not re-run for each parameter.
+ 
+ \param contributions The contributions to the cost function
+ \param model The model, whose parameters are modified by set_parameters
+ \param set_parameters A callable that sets the parameters of the model to the given values
+ \param x The parameters
+ */
+template<typename Model, typename SetParameters>
+auto cost_and_gradient(const std::vector<PureOptimizationContribution>& contributions, const Model& model, const SetParameters& set_parameters, const Eigen::ArrayXd& x){
+    
+    Eigen::ArrayXd xx = x;
+    Eigen::ArrayXd gradient = Eigen::ArrayXd::Zero(x.size());
+    set_parameters(xx);
+    
+    // Solve for the states and their Jacobians at the nominal parameters
+    std::vector<Eigen::ArrayXd> states; states.reserve(contributions.size());
+    std::vector<Eigen::MatrixXd> Jacobians; Jacobians.reserve(contributions.size());
+    double cost = 0.0;
+    for (const auto& contrib : contributions){
+        std::visit([&](const auto& c){
+            auto u = c.solve_state(model);
+            cost += c.cost_at_state(model, u);
+            Jacobians.push_back(c.state_Jacobian(model, u));
+            states.push_back(u);
+        }, contrib);
+    }
+    if (!std::isfinite(cost)){
+        return std::make_tuple(1e30, gradient);
+    }
+    
+    // Fourth-order central differences
+    constexpr std::array<double, 4> offsets = {-2.0, -1.0, 1.0, 2.0};
+    constexpr std::array<double, 4> weights = {1.0/12.0, -8.0/12.0, 8.0/12.0, -1.0/12.0};
+    
+    for (auto k = 0; k < x.size(); ++k){
+        double h = 1e-4*((x[k] != 0) ? std::abs(x[k]) : 1.0);
+        
+        // Partial derivatives of the state residuals w.r.t. the parameter, at fixed states
+        std::vector<Eigen::ArrayXd> drdx(contributions.size());
+        for (auto i = 0U; i < contributions.size(); ++i){ drdx[i] = Eigen::ArrayXd::Zero(states[i].size()); }
+        for (auto m = 0U; m < offsets.size(); ++m){
+            xx[k] = x[k] + offsets[m]*h; set_parameters(xx);
+            for (auto i = 0U; i < contributions.size(); ++i){
+                if (states[i].size() == 0){ continue; }
+                drdx[i] += weights[m]/h*std::visit([&](const auto& c){ return Eigen::ArrayXd(c.state_residuals(model, states[i])); }, contributions[i]);
+            }
+        }
+        std::vector<Eigen::ArrayXd> du; du.reserve(contributions.size());
+        for (auto i = 0U; i < contributions.size(); ++i){
+            if (states[i].size() == 0){
+                du.emplace_back(0);
+            }
+            else{
+                du.push_back(Jacobians[i].partialPivLu().solve(-drdx[i].matrix()).array());
+            }
+        }
+        
+        // Derivative of the cost along the direction in which the states move with the parameter
+        double dcostdx = 0.0;
+        for (auto m = 0U; m < offsets.size(); ++m){
+            xx[k] = x[k] + offsets[m]*h; set_parameters(xx);
+            for (auto i = 0U; i < contributions.size(); ++i){
+                dcostdx += weights[m]/h*std::visit([&](const auto& c){ return c.cost_at_state(model, Eigen::ArrayXd(states[i] + offsets[m]*h*du[i])); }, contributions[i]);
+            }
+        }
+        gradient[k] = dcostdx;
+        xx[k] = x[k];
+    }
+    set_parameters(xx);
+    if (!gradient.allFinite()){
+        return std::make_tuple(1e30, Eigen::ArrayXd(Eigen::ArrayXd::Zero(x.size())));
+    }
+    return std::make_tuple(cost, gradient);
+}
+
 class PureParameterOptimizer{
 private:
     auto make_pointers(const std::vector<std::variant<std::string, std::vector<std::string>>>& pointerstrs){
@@ -199,12 +406,111 @@ private:
         }
         return pointers_;
     }
+    
+    /// The private model whose parameters are overwritten in-place, and the slots for each pointer
+    std::unique_ptr<teqp::cppinterface::AbstractModel> m_inplace_model;
+    std::vector<std::vector<double*>> m_slots;
+    mutable std::mutex m_inplace_mutex; ///< Serializes the use of the private model
+    
+    /// Build the private model once and resolve the slots of all the pointers; if a pointer cannot be updated in-place (NotImplementedError),
+    /// the model is rebuilt for each evaluation instead. Any other error, like an invalid model or index, is passed on to the caller
+    void make_slots(){
+        try{
+            auto model = teqp::cppinterface::make_model(jbase);
+            std::vector<std::vector<double*>> slots;
+            for (const auto& ptrs : pointers){
+                std::vector<double*> buffer;
+                for (const auto& ptr : ptrs){
+                    // The pointers are into the full JSON, the model only knows about the contents of the "model" field
+                    std::string s = ptr.to_string();
+                    if (s.rfind("/model/", 0) != 0){
+                        throw teqp::NotImplementedError("Pointer " + s + " is not in the model specification");
+                    }
+                    buffer.push_back(model->get_parameter_slot(s.substr(6)));
+                }
+                slots.push_back(buffer);
+            }
+            m_inplace_model = std::move(model);
+            m_slots = slots;
+        }
+        catch(const teqp::NotImplementedError&){
+            m_inplace_model.reset();
+            m_slots.clear();
+        }
+    }
+    
+    /// Write the parameters into the slots of the private model
+    template<typename T>
+    void write_slots(const T& x) const {
+        if (static_cast<std::size_t>(x.size()) != m_slots.size()){
+            throw teqp::InvalidArgument("sizes don't match");
+        }
+        for (auto i = 0U; i < m_slots.size(); ++i){
+            for (auto slot : m_slots[i]){
+                *slot = x[i];
+            }
+        }
+        m_inplace_model->update_parameters();
+    }
+    
+    /// The thread pool of cost_function_threaded, which lives as long as the optimizer, unless the number of threads changes
+    std::unique_ptr<boost::asio::thread_pool> m_pool;
+    std::size_t m_pool_threads = 0;
+    std::mutex m_pool_mutex; ///< Serializes the calls to cost_function_threaded
+    std::vector<double> m_contribution_times; ///< The time in seconds taken by each contribution in the last call to cost_function_threaded
+    std::valarray<double> m_contribution_costs; ///< Buffer for the cost of each contribution
+    
+    /**
+     Partition the contributions into contiguous chunks of about the same total time, as measured in the last call. 
+     A few chunks per thread are made so that the threads can balance the load if the timings change.
+     
+     \returns The indices of the boundaries of the chunks, chunk i spans [bounds[i], bounds[i+1])
+     */
+    std::vector<std::size_t> make_chunks(std::size_t Nthreads) const {
+        const std::size_t N = contributions.size();
+        const std::size_t Nchunks = std::min(N, 4*Nthreads);
+        std::vector<std::size_t> bounds = {0};
+        if (N == 0){
+            return bounds;
+        }
+        double total = std::accumulate(m_contribution_times.begin(), m_contribution_times.end(), 0.0);
+        // If the timings are not usable, fall back to equal cost for each contribution
+        bool uniform = !(total > 0) || !std::isfinite(total);
+        if (uniform){ total = static_cast<double>(N); }
+        double target = total/Nchunks, summer = 0.0;
+        for (auto i = 0U; i < N; ++i){
+            summer += (uniform) ? 1.0 : m_contribution_times[i];
+            // Leave at least one contribution for each of the remaining chunks
+            std::size_t remaining_chunks = Nchunks - bounds.size();
+            if (remaining_chunks > 0 && (summer >= target*bounds.size() || N - (i+1) == remaining_chunks)){
+                bounds.push_back(i+1);
+            }
+        }
+        if (bounds.back() != N){
+            bounds.push_back(N);
+        }
+        return bounds;
+    }
+    
+    template<typename Model>
+    double sum_contributions(const Model& model) const {
+        double cost = 0.0;
+        for (const auto& contrib : contributions){
+            cost += std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contrib);
+        }
+        return cost;
+    }
 public:
     const nlohmann::json jbase;
     std::vector<std::vector<nlohmann::json::json_pointer>> pointers;
     std::vector<PureOptimizationContribution> contributions;
     
-    PureParameterOptimizer(const nlohmann::json jbase, const std::vector<std::variant<std::string, std::vector<std::string>>>& pointerstrs) : jbase(jbase), pointers(make_pointers(pointerstrs)){}
+    PureParameterOptimizer(const nlohmann::json jbase, const std::vector<std::variant<std::string, std::vector<std::string>>>& pointerstrs) : jbase(jbase), pointers(make_pointers(pointerstrs)){
+        make_slots();
+    }
+    
+    /// True if the parameters are written in-place into a private copy of the model rather than rebuilding the model from JSON for each evaluation
+    bool uses_parameter_slots() const { return static_cast<bool>(m_inplace_model); }
     
     void add_one_contribution(const PureOptimizationContribution& cont){
         std::visit([](const auto&c){c.check_fields();}, cont);
@@ -240,12 +546,15 @@ public:
     
     template<typename T>
     auto cost_function(const T& x) const{
-        const auto [_model, _helpers] = prepare(x);
-        const auto& model = _model;
-        const auto& helpers = _helpers;
         double cost = 0.0;
-        for (const auto& contrib : contributions){
-            cost += std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contrib);
+        if (m_inplace_model){
+            std::lock_guard<std::mutex> lock(m_inplace_mutex);
+            write_slots(x);
+            cost = sum_contributions(m_inplace_model);
+        }
+        else{
+            const auto [_model, _helpers] = prepare(x);
+            cost = sum_contributions(_model);
         }
         if (!std::isfinite(cost)){
             return 1e30;
@@ -253,28 +562,79 @@ public:
         return cost;
     }
     
+    /**
+     The cost function and its gradient w.r.t. the parameters, see cost_and_gradient.  The parameters must be updatable in-place, 
+     as indicated by uses_parameter_slots
+     */
+    std::tuple<double, Eigen::ArrayXd> cost_function_and_gradient(const Eigen::ArrayXd& x) const{
+        if (!m_inplace_model){
+            throw teqp::NotImplementedError("The gradient of the cost function requires parameters that can be updated in-place");
+        }
+        std::lock_guard<std::mutex> lock(m_inplace_mutex);
+        return cost_and_gradient(contributions, m_inplace_model, [this](const Eigen::ArrayXd& x_){ write_slots(x_); }, x);
+    }
+    
+    /**
+     Evaluate the cost function with the contributions spread over Nthreads threads. The threads are kept between calls, 
+     and the contributions are grouped into chunks that are balanced according to the time each contribution took in the last call.
+     */
     template<typename T>
     auto cost_function_threaded(const T& x, std::size_t Nthreads) {
-        boost::asio::thread_pool pool{Nthreads}; // Nthreads in the pool
-        const auto [_model, _helpers] = prepare(x);
-        const auto& model = _model;
-        const auto& helpers = _helpers;
-        std::valarray<double> buffer(contributions.size());
-        std::size_t i = 0;
-        for (const auto& contrib : contributions){
-            auto& dest = buffer[i];
-            auto payload = [&model, &dest, contrib] (){
-                dest = std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contrib);
-                if (!std::isfinite(dest)){ dest = 1e30; }
+        if (Nthreads < 1){
+            throw teqp::InvalidArgument("At least one thread is needed to evaluate the cost function");
+        }
+        std::lock_guard<std::mutex> pool_lock(m_pool_mutex);
+        if (!m_pool || m_pool_threads != Nthreads){
+            if (m_pool){ m_pool->join(); }
+            m_pool = std::make_unique<boost::asio::thread_pool>(Nthreads);
+            m_pool_threads = Nthreads;
+        }
+        if (m_contribution_times.size() != contributions.size()){
+            // No timings yet, assume all the contributions are equally expensive
+            m_contribution_times.assign(contributions.size(), 1.0);
+            m_contribution_costs.resize(contributions.size());
+        }
+        
+        std::unique_lock<std::mutex> lock(m_inplace_mutex, std::defer_lock);
+        std::unique_ptr<teqp::cppinterface::AbstractModel> _model;
+        if (m_inplace_model){
+            lock.lock();
+            write_slots(x);
+        }
+        else{
+            _model = std::get<0>(prepare(x));
+        }
+        const auto& model = (m_inplace_model) ? m_inplace_model : _model;
+        
+        auto bounds = make_chunks(Nthreads);
+        std::latch done(bounds.size()-1);
+        std::vector<std::exception_ptr> errors(bounds.size()-1);
+        for (auto ichunk = 0U; ichunk + 1 < bounds.size(); ++ichunk){
+            auto payload = [this, &model, &done, &error=errors[ichunk], begin=bounds[ichunk], end=bounds[ichunk+1]] (){
+                try{
+                    for (auto i = begin; i < end; ++i){
+                        auto tic = std::chrono::steady_clock::now();
+                        double& dest = m_contribution_costs[i];
+                        dest = std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contributions[i]);
+                        if (!std::isfinite(dest)){ dest = 1e30; }
+                        m_contribution_times[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - tic).count();
+                    }
+                }
+                catch(...){
+                    error = std::current_exception();
+                }
+                done.count_down();
             };
-            boost::asio::post(pool, payload);
-            i++;
+            boost::asio::post(*m_pool, payload);
+        }
+        done.wait();
+        for (const auto& error : errors){
+            if (error){ std::rethrow_exception(error); }
         }
-        pool.join();
         double summer = 0.0;
-        for (auto i = 0; i < contributions.size(); ++i){
-//            std::cout << buffer[i] << std::endl;
-            summer += buffer[i];
+        for (auto i = 0U; i < contributions.size(); ++i){
+//            std::cout << m_contribution_costs[i] << std::endl;
+            summer += m_contribution_costs[i];
         }
 //        std::cout << summer << std::endl;
         return summer;
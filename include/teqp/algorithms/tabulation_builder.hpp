@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <optional>
+#include <algorithm>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include <Eigen/Dense>
+
+#include "teqp/derivs.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/models/tabulated.hpp"
+
+namespace teqp {
+namespace tabulated {
+
+/**
+ \brief Build a TabulatedAlphar from any model at a fixed composition
+
+ The grid starts as a uniform grid of NT x Nrho nodes. At the center of each cell, the interpolated values of \f$\alpha^r\f$,
+ \f$\Lambda^r_{01}\f$ and \f$\Lambda^r_{10}\f$ are compared with those of the model, and the temperature and density intervals of the
+ cells whose error exceeds the tolerance are bisected. This is repeated until all the validation points are within tolerance
+ or the maximum number of refinements (or nodes) is reached. The maximum errors at the validation points of the final table are
+ stored in the table and in the build report; they are the observed errors, not a rigorous bound.
+
+ If the fluid is pure and guess values for the critical point are provided, the saturation curve is traced from the critical point
+ down to the minimum temperature, and the cells lying entirely within the two-phase region are excluded from the error control
+ (and from evaluation).
+
+ Fields of the spec:
+ "molefrac", "Tmin / K", "Tmax / K", "rhomin / mol/m^3", "rhomax / mol/m^3" (required),
+ "NT", "Nrho", "tolerance", "max_refinements", "max_nodes", "Tcguess / K", "rhocguess / mol/m^3", "Nsat" (optional)
+ */
+inline TabulatedAlphar build_tabulation(const cppinterface::AbstractModel& model, const nlohmann::json& spec) {
+    const auto zvec = spec.at("molefrac").get<std::vector<double>>();
+    const Eigen::ArrayXd z = Eigen::Map<const Eigen::ArrayXd>(zvec.data(), zvec.size());
+    const double Tmin = spec.at("Tmin / K"), Tmax = spec.at("Tmax / K");
+    const double rhomin = spec.at("rhomin / mol/m^3"), rhomax = spec.at("rhomax / mol/m^3");
+    const int NT0 = spec.value("NT", 20), Nrho0 = spec.value("Nrho", 20);
+    const double tol = spec.value("tolerance", 1e-8);
+    const int max_refinements = spec.value("max_refinements", 8);
+    const std::size_t max_nodes = spec.value("max_nodes", 1000000);
+    if (!(Tmin > 0 && Tmax > Tmin)) {
+        throw teqp::InvalidArgument("Tmin must be positive and less than Tmax");
+    }
+    if (!(rhomin >= 0 && rhomax > rhomin)) {
+        throw teqp::InvalidArgument("rhomin must be non-negative and less than rhomax");
+    }
+    if (NT0 < 2 || Nrho0 < 2) {
+        throw teqp::InvalidArgument("NT and Nrho must be at least 2");
+    }
+    const double R = model.get_R(z);
+
+    // Saturation curve for a pure fluid, used to exclude the cells within the two-phase region
+    std::vector<double> Tsat, rhoLsat, rhoVsat;
+    double Tc = -1, rhoc = -1;
+    if (z.size() == 1 && spec.contains("Tcguess / K") && spec.contains("rhocguess / mol/m^3")) {
+        std::tie(Tc, rhoc) = model.solve_pure_critical(spec.at("Tcguess / K"), spec.at("rhocguess / mol/m^3"));
+        auto T0 = 0.999*Tc;
+        if (T0 > Tmin) {
+            auto rhoLV = model.extrapolate_from_critical(Tc, rhoc, T0);
+            auto Tvec = Eigen::ArrayXd::LinSpaced(spec.value("Nsat", 200), T0, Tmin);
+            for (auto T : Tvec) {
+                try {
+                    rhoLV = model.pure_VLE_T(T, rhoLV[0], rhoLV[1], 20);
+                }
+                catch (...) {
+                    break;
+                }
+                if (!std::isfinite(rhoLV[0]) || !std::isfinite(rhoLV[1]) || rhoLV[0] <= rhoLV[1]) {
+                    break;
+                }
+                // Stored in order of increasing temperature
+                Tsat.insert(Tsat.begin(), T); rhoLsat.insert(rhoLsat.begin(), rhoLV[0]); rhoVsat.insert(rhoVsat.begin(), rhoLV[1]);
+            }
+        }
+    }
+    // Linear interpolation in the saturation curve, returns (rhoL, rhoV), or nothing if out of range
+    auto sat_at = [&](double T) -> std::optional<std::array<double, 2>> {
+        if (Tsat.size() < 2 || T < Tsat.front() || T > Tsat.back()) { return std::nullopt; }
+        auto k = std::clamp<std::size_t>(std::upper_bound(Tsat.begin(), Tsat.end(), T) - Tsat.begin(), 1, Tsat.size()-1);
+        double w = (T - Tsat[k-1])/(Tsat[k]-Tsat[k-1]);
+        return std::array<double, 2>{rhoLsat[k-1] + w*(rhoLsat[k]-rhoLsat[k-1]), rhoVsat[k-1] + w*(rhoVsat[k]-rhoVsat[k-1])};
+    };
+
+    // Values at the nodes are cached so that they are not recalculated when the grid is refined
+    std::map<std::pair<double, double>, std::array<double, 4>> cache;
+    auto node = [&](double T, double rho) -> const std::array<double, 4>& {
+        auto key = std::make_pair(T, rho);
+        auto it = cache.find(key);
+        if (it != cache.end()) { return it->second; }
+        std::array<double, 4> v;
+        if (rho == 0) {
+            // alphar = B_2*rho + ..., so only the density derivatives survive in the limit of zero density
+            v = {0.0, 0.0, model.get_dmBnvirdTm(2, 0, T, z), model.get_dmBnvirdTm(2, 1, T, z)};
+        }
+        else {
+            v = {model.get_Ar00(T, rho, z), -model.get_Ar10(T, rho, z)/T, model.get_Ar01(T, rho, z)/rho, -model.get_Ar11(T, rho, z)/(T*rho)};
+        }
+        return cache.emplace(key, v).first->second;
+    };
+
+    std::vector<double> Tn(NT0), rhon(Nrho0);
+    for (auto i = 0; i < NT0; ++i) { Tn[i] = Tmin + (Tmax-Tmin)*i/(NT0-1.0); }
+    for (auto j = 0; j < Nrho0; ++j) { rhon[j] = rhomin + (rhomax-rhomin)*j/(Nrho0-1.0); }
+
+    auto make_table = [&](const std::array<double, 3>& errs) {
+        const std::size_t NT = Tn.size(), Nrho = rhon.size(), NN = NT*Nrho;
+        TabulationFileHeader h{};
+        std::memcpy(h.magic, "TEQPTAB1", 8);
+        h.version = 1; h.NT = NT; h.Nrho = Nrho; h.Ncomp = z.size(); h.Nsat = Tsat.size();
+        h.R = R;
+        h.max_abs_err_alphar = errs[0]; h.max_abs_err_Ar01 = errs[1]; h.max_abs_err_Ar10 = errs[2];
+        std::vector<double> buf;
+        buf.reserve(z.size() + NT + Nrho + 4*NN + (NT-1)*(Nrho-1) + 3*Tsat.size());
+        buf.insert(buf.end(), zvec.begin(), zvec.end());
+        buf.insert(buf.end(), Tn.begin(), Tn.end());
+        buf.insert(buf.end(), rhon.begin(), rhon.end());
+        for (auto k = 0; k < 4; ++k) {
+            for (auto T : Tn) { for (auto rho : rhon) { buf.push_back(node(T, rho)[k]); } }
+        }
+        for (auto i = 0U; i+1 < NT; ++i) {
+            auto satlo = sat_at(Tn[i]), sathi = sat_at(Tn[i+1]);
+            for (auto j = 0U; j+1 < Nrho; ++j) {
+                bool excluded = satlo && sathi
+                    && rhon[j] > std::max((*satlo)[1], (*sathi)[1])
+                    && rhon[j+1] < std::min((*satlo)[0], (*sathi)[0]);
+                buf.push_back(excluded ? 1.0 : 0.0);
+            }
+        }
+        buf.insert(buf.end(), Tsat.begin(), Tsat.end());
+        buf.insert(buf.end(), rhoLsat.begin(), rhoLsat.end());
+        buf.insert(buf.end(), rhoVsat.begin(), rhoVsat.end());
+        return std::make_tuple(h, std::make_shared<VectorTableMemory>(std::move(buf)));
+    };
+
+    using tdx = TDXDerivatives<TabulatedAlphar, double, Eigen::ArrayXd>;
+    std::array<double, 3> errs{0, 0, 0};
+    int refinements = 0;
+    bool converged = false;
+    std::size_t Nexcluded = 0;
+    for (;;) {
+        auto [h, mem] = make_table({0, 0, 0});
+        TabulatedAlphar tab(h, mem);
+
+        // Validate at the center of each cell, and flag the intervals to be split
+        errs = {0, 0, 0};
+        Nexcluded = 0;
+        std::vector<bool> splitT(Tn.size()-1, false), splitrho(rhon.size()-1, false);
+        for (auto i = 0U; i+1 < Tn.size(); ++i) {
+            for (auto j = 0U; j+1 < rhon.size(); ++j) {
+                double T = (Tn[i] + Tn[i+1])/2, rho = (rhon[j] + rhon[j+1])/2;
+                if (tab.is_excluded(T, rho)) { Nexcluded++; continue; }
+                std::array<double, 3> e{
+                    std::abs(tab.alphar(T, rho, z) - model.get_Ar00(T, rho, z)),
+                    std::abs(tdx::get_Ar01(tab, T, rho, z) - model.get_Ar01(T, rho, z)),
+                    std::abs(tdx::get_Ar10(tab, T, rho, z) - model.get_Ar10(T, rho, z))
+                };
+                for (auto k = 0; k < 3; ++k) { errs[k] = std::max(errs[k], e[k]); }
+                if (*std::max_element(e.begin(), e.end()) > tol) {
+                    splitT[i] = true; splitrho[j] = true;
+                }
+            }
+        }
+        converged = (*std::max_element(errs.begin(), errs.end()) <= tol);
+        auto NTnew = Tn.size() + std::count(splitT.begin(), splitT.end(), true);
+        auto Nrhonew = rhon.size() + std::count(splitrho.begin(), splitrho.end(), true);
+        if (converged || refinements >= max_refinements || NTnew*Nrhonew > max_nodes) {
+            break;
+        }
+        auto bisect = [](const std::vector<double>& x, const std::vector<bool>& split) {
+            std::vector<double> o;
+            for (auto i = 0U; i+1 < x.size(); ++i) {
+                o.push_back(x[i]);
+                if (split[i]) { o.push_back((x[i] + x[i+1])/2); }
+            }
+            o.push_back(x.back());
+            return o;
+        };
+        Tn = bisect(Tn, splitT);
+        rhon = bisect(rhon, splitrho);
+        refinements++;
+    }
+    auto [h, mem] = make_table(errs);
+    nlohmann::json report = {
+        {"refinements", refinements},
+        {"converged", converged},
+        {"tolerance", tol},
+        {"excluded_cells", Nexcluded},
+        {"Nsat", Tsat.size()}
+    };
+    if (Tc > 0) {
+        report["Tc / K"] = Tc;
+        report["rhoc / mol/m^3"] = rhoc;
+    }
+    return TabulatedAlphar(h, mem, report);
+}
+
+} // namespace tabulated
+} // namespace teqp
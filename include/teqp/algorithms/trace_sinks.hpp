@@ -0,0 +1,191 @@
+#pragma once
+
+/**
+ Sinks that consume the points of a trace (VLE isotherms and isobars, VLLE, critical curves) as they are accepted.
+
+ The tracers normally accumulate every point into a nlohmann::json array. When a sink is provided instead, each accepted
+ point is passed to the sink as one row of doubles (in the order of the column names given to begin), and no JSON is
+ constructed. The row buffer is owned by the tracer and reused, so the memory held by the tracer does not grow with the
+ length of the trace; what the sink does with the row is up to the sink.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "teqp/exceptions.hpp"
+
+namespace teqp {
+
+/// The interface for the consumers of the points of a trace
+class TraceSink {
+protected:
+    std::vector<std::string> m_columns;
+public:
+    virtual ~TraceSink() = default;
+    /// Called once by the tracer before the first point with the names of the columns
+    virtual void begin(const std::vector<std::string>& columns) { m_columns = columns; }
+    /// Called by the tracer for each accepted point; the values are in the order of the columns
+    virtual void push(const Eigen::Ref<const Eigen::ArrayXd>& row) = 0;
+    /// Called once by the tracer when the trace is finished
+    virtual void end() {}
+    /// The names of the columns
+    const auto& get_columns() const { return m_columns; }
+};
+
+/// A sink that forwards each point to a user-provided function
+class CallbackTraceSink : public TraceSink {
+public:
+    using callback_t = std::function<void(const std::vector<std::string>&, const Eigen::Ref<const Eigen::ArrayXd>&)>;
+private:
+    callback_t m_callback;
+public:
+    CallbackTraceSink(const callback_t& callback) : m_callback(callback) {}
+    void push(const Eigen::Ref<const Eigen::ArrayXd>& row) override { m_callback(m_columns, row); }
+};
+
+/// A sink that stores the points as a structure of arrays, one contiguous array of doubles per column
+class ColumnarTraceSink : public TraceSink {
+private:
+    std::vector<std::vector<double>> m_data;
+public:
+    void begin(const std::vector<std::string>& columns) override {
+        TraceSink::begin(columns);
+        m_data.assign(columns.size(), {});
+    }
+    void push(const Eigen::Ref<const Eigen::ArrayXd>& row) override {
+        if (static_cast<std::size_t>(row.size()) != m_data.size()) {
+            throw teqp::InvalidArgument("Length of row does not match the number of columns");
+        }
+        for (auto i = 0U; i < m_data.size(); ++i) {
+            m_data[i].push_back(row[i]);
+        }
+    }
+    /// Reserve space for Npoints points in each column
+    void reserve(std::size_t Npoints) {
+        for (auto& col : m_data) { col.reserve(Npoints); }
+    }
+    /// The number of points stored
+    std::size_t size() const { return m_data.empty() ? 0 : m_data[0].size(); }
+    /// The values in the column with the given name
+    Eigen::ArrayXd get(const std::string& name) const {
+        auto it = std::find(m_columns.begin(), m_columns.end(), name);
+        if (it == m_columns.end()) {
+            throw teqp::InvalidArgument("Column \"" + name + "\" is not in the trace");
+        }
+        const auto& col = m_data[it - m_columns.begin()];
+        return Eigen::Map<const Eigen::ArrayXd>(col.data(), col.size());
+    }
+    /// All the columns, as a map from the column name to the values
+    std::map<std::string, Eigen::ArrayXd> as_map() const {
+        std::map<std::string, Eigen::ArrayXd> o;
+        for (const auto& name : m_columns) { o[name] = get(name); }
+        return o;
+    }
+};
+
+/// A sink that writes each point as a line of a CSV file, with a header line of the column names
+class CSVTraceSink : public TraceSink {
+private:
+    std::ofstream m_ofs;
+public:
+    CSVTraceSink(const std::string& filename) : m_ofs(filename) {
+        if (!m_ofs) {
+            throw teqp::InvalidArgument("Unable to open " + filename + " for writing");
+        }
+        m_ofs << std::setprecision(std::numeric_limits<double>::max_digits10);
+    }
+    void begin(const std::vector<std::string>& columns) override {
+        TraceSink::begin(columns);
+        for (auto i = 0U; i < columns.size(); ++i) {
+            m_ofs << (i > 0 ? "," : "") << columns[i];
+        }
+        m_ofs << "\n";
+    }
+    void push(const Eigen::Ref<const Eigen::ArrayXd>& row) override {
+        for (auto i = 0; i < row.size(); ++i) {
+            m_ofs << (i > 0 ? "," : "") << row[i];
+        }
+        m_ofs << "\n";
+    }
+    void end() override { m_ofs.flush(); }
+};
+
+/**
+ \brief A sink that writes the points to a binary file
+
+ The layout of the file (native endianness) is: the 8 characters "TEQPTRC1", the number of columns as a uint64,
+ for each column the length of its name as a uint64 followed by the characters of the name, and then the rows
+ of doubles, one after the other. The number of rows follows from the size of the file. Use read_binary_trace to load it.
+ */
+class BinaryTraceSink : public TraceSink {
+private:
+    std::ofstream m_ofs;
+public:
+    BinaryTraceSink(const std::string& filename) : m_ofs(filename, std::ios::binary) {
+        if (!m_ofs) {
+            throw teqp::InvalidArgument("Unable to open " + filename + " for writing");
+        }
+    }
+    void begin(const std::vector<std::string>& columns) override {
+        TraceSink::begin(columns);
+        m_ofs.write("TEQPTRC1", 8);
+        std::uint64_t Ncol = columns.size();
+        m_ofs.write(reinterpret_cast<const char*>(&Ncol), sizeof(Ncol));
+        for (const auto& name : columns) {
+            std::uint64_t len = name.size();
+            m_ofs.write(reinterpret_cast<const char*>(&len), sizeof(len));
+            m_ofs.write(name.data(), len);
+        }
+    }
+    void push(const Eigen::Ref<const Eigen::ArrayXd>& row) override {
+        for (auto i = 0; i < row.size(); ++i) {
+            double v = row[i];
+            m_ofs.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+    }
+    void end() override { m_ofs.flush(); }
+};
+
+/// Read a file written by BinaryTraceSink into a ColumnarTraceSink
+inline ColumnarTraceSink read_binary_trace(const std::string& filename) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) {
+        throw teqp::InvalidArgument("Unable to open " + filename);
+    }
+    char magic[8];
+    ifs.read(magic, 8);
+    if (!ifs || std::memcmp(magic, "TEQPTRC1", 8) != 0) {
+        throw teqp::InvalidArgument(filename + " is not a binary trace file");
+    }
+    std::uint64_t Ncol = 0;
+    ifs.read(reinterpret_cast<char*>(&Ncol), sizeof(Ncol));
+    std::vector<std::string> columns(Ncol);
+    for (auto& name : columns) {
+        std::uint64_t len = 0;
+        ifs.read(reinterpret_cast<char*>(&len), sizeof(len));
+        name.resize(len);
+        ifs.read(name.data(), len);
+    }
+    if (!ifs) {
+        throw teqp::InvalidArgument("Header of " + filename + " is truncated");
+    }
+    ColumnarTraceSink sink;
+    sink.begin(columns);
+    Eigen::ArrayXd row(Ncol);
+    while (ifs.read(reinterpret_cast<char*>(row.data()), Ncol*sizeof(double))) {
+        sink.push(row);
+    }
+    return sink;
+}
+
+}
@@ -1,15 +1,12 @@
 #pragma once
 
+#include <concepts>
+
 #include "teqp/derivs.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 #include "teqp/exceptions.hpp"
-
-#if defined(TEQP_MULTIPRECISION_ENABLED)
-// Imports from boost
-#include <boost/multiprecision/cpp_bin_float.hpp>
-using namespace boost::multiprecision;
-#include "teqp/finite_derivs.hpp"
-#endif
+#include "teqp/algorithms/flash.hpp"
+#include "teqp/algorithms/density.hpp"
 
 namespace teqp{
 namespace cppinterface{
@@ -96,6 +93,50 @@ concept CallableReducingTemperature = requires(T t, U u) {
     { t.get_reducing_temperature(u) };
 };
 
+template<typename T>
+concept HasParameterSlots = !std::is_const_v<T> && requires(T t, const std::string& pointer) {
+    { t.get_parameter_slot(pointer) } -> std::same_as<double*>;
+    { t.update_parameters() };
+};
+
+/**
+ Call the function with the mole fractions copied into an Eigen array of fixed size when there are one to four components, so that
+ the derivative routines do not need to allocate on the heap for pure fluids and small mixtures. Otherwise the mole fractions are
+ passed as a dynamically-sized array.
+ 
+ \note All the overloads of the function must return the same type
+ */
+template<typename MoleFracType, typename Function>
+auto call_with_fixed_size(const MoleFracType& molefrac, const Function& f){
+    switch (molefrac.size()){
+        case 1: return f(Eigen::Array<double, 1, 1>(molefrac));
+        case 2: return f(Eigen::Array<double, 2, 1>(molefrac));
+        case 3: return f(Eigen::Array<double, 3, 1>(molefrac));
+        case 4: return f(Eigen::Array<double, 4, 1>(molefrac));
+        default:
+            if constexpr (std::is_same_v<MoleFracType, EArrayd>){
+                return f(molefrac);
+            }
+            else{
+                return f(EArrayd(molefrac));
+            }
+    }
+}
+
+/**
+ Call the function with the model, or with the model wrapped in a PureAlpharWrapper if the model provides a dedicated evaluation
+ of \f$\alpha^r\f$ for a pure fluid
+ */
+template<typename Model, typename Function>
+auto call_with_pure_model(const Model& model, const Function& f){
+    if constexpr (HasPureAlphar<Model>){
+        return f(PureAlpharWrapper<Model>{model});
+    }
+    else{
+        return f(model);
+    }
+}
+
 /**
  This class holds a const reference to a class, and exposes an interface that matches that used in AbstractModel
  
@@ -128,46 +169,83 @@ public:
         return mp.get_cref().R(molefrac);
     };
     
+    virtual double* get_parameter_slot(const std::string& pointer) override {
+        using Model = std::remove_reference_t<decltype(mp.get_ref())>;
+        if constexpr(HasParameterSlots<Model>){
+            return mp.get_ref().get_parameter_slot(pointer);
+        }
+        else{
+            throw teqp::NotImplementedError("This model does not support in-place parameter updates");
+        }
+    }
+    virtual void update_parameters() override {
+        using Model = std::remove_reference_t<decltype(mp.get_ref())>;
+        if constexpr(HasParameterSlots<Model>){
+            mp.get_ref().update_parameters();
+        }
+        else{
+            throw teqp::NotImplementedError("This model does not support in-place parameter updates");
+        }
+    }
+
     virtual double get_Arxy(const int NT, const int ND, const double T, const double rhomolar, const EArrayd& molefrac) const override{
-        return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Ar(NT, ND, mp.get_cref(), T, rhomolar, molefrac);
+        return call_with_fixed_size(molefrac, [&](const auto& z) -> double { return TDXDerivatives<decltype(mp.get_cref()), double, std::decay_t<decltype(z)>>::get_Ar(NT, ND, mp.get_cref(), T, rhomolar, z); });
+    };
+    
+    virtual double get_Arxy_pure(const int NT, const int ND, const double T, const double rhomolar) const override{
+        const auto z = Eigen::Array<double, 1, 1>::Ones().eval();
+        return call_with_pure_model(mp.get_cref(), [&](const auto& model) -> double { return TDXDerivatives<decltype(model), double, Eigen::Array<double, 1, 1>>::get_Ar(NT, ND, model, T, rhomolar, z); });
+    };
+    
+    virtual PureDerivativeBundle pure_bundle(const double T, const double rhomolar) const override{
+        const auto z = Eigen::Array<double, 1, 1>::Ones().eval();
+        auto derivs = call_with_pure_model(mp.get_cref(), [&](const auto& model) { return DerivativeHolderSquare<2>(model, T, rhomolar, z).derivs; });
+        PureDerivativeBundle bundle;
+        bundle.T = T;
+        bundle.rho = rhomolar;
+        bundle.R = mp.get_cref().R(z);
+        bundle.Ar00 = derivs(0, 0);
+        bundle.Ar01 = derivs(0, 1);
+        bundle.Ar02 = derivs(0, 2);
+        bundle.Ar10 = derivs(1, 0);
+        bundle.Ar11 = derivs(1, 1);
+        bundle.Ar20 = derivs(2, 0);
+        return bundle;
     };
     
     // Here X-Macros are used to create functions like get_Ar00, get_Ar01, ....
-#define X(i,j) virtual double get_Ar ## i ## j(const double T, const double rho, const REArrayd& molefrac) const  override { return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Arxy<i,j>(mp.get_cref(), T, rho, molefrac); };
+#define X(i,j) virtual double get_Ar ## i ## j(const double T, const double rho, const REArrayd& molefrac) const  override { return call_with_fixed_size(molefrac, [&](const auto& z) -> double { return TDXDerivatives<decltype(mp.get_cref()), double, std::decay_t<decltype(z)>>::template get_Arxy<i,j>(mp.get_cref(), T, rho, z); }); };
     ARXY_args
 #undef X
     // And like get_Ar01n, get_Ar02n, ....
-#define X(i) virtual EArrayd get_Ar0 ## i ## n(const double T, const double rho, const REArrayd& molefrac) const  override { auto vals = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Ar0n<i>(mp.get_cref(), T, rho, molefrac); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
+#define X(i) virtual EArrayd get_Ar0 ## i ## n(const double T, const double rho, const REArrayd& molefrac) const  override { auto vals = call_with_fixed_size(molefrac, [&](const auto& z) { return TDXDerivatives<decltype(mp.get_cref()), double, std::decay_t<decltype(z)>>::template get_Ar0n<i>(mp.get_cref(), T, rho, z); }); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
     AR0N_args
 #undef X
     // And like get_Ar10n, get_Ar20n, ....
-#define X(i) virtual EArrayd get_Ar ## i ## 0n(const double T, const double rho, const REArrayd& molefrac) const  override { auto vals = TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::template get_Arn0<i>(mp.get_cref(), T, rho, molefrac); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
+#define X(i) virtual EArrayd get_Ar ## i ## 0n(const double T, const double rho, const REArrayd& molefrac) const  override { auto vals = call_with_fixed_size(molefrac, [&](const auto& z) { return TDXDerivatives<decltype(mp.get_cref()), double, std::decay_t<decltype(z)>>::template get_Arn0<i>(mp.get_cref(), T, rho, z); }); return Eigen::Map<Eigen::ArrayXd>(&(vals[0]), vals.size()); };
     ARN0_args
 #undef X
     
+    /// The n-th density derivative of alphar times rho^n, from the Taylor series in density carried out in double-double precision
+    template<int n>
+    double get_Ar0nep(const double T, const double rho, const EArrayd& molefrac) const {
+        using series_t = TaylorSeries<n, DoubleDouble>;
+        auto c = mp.get_cref().alphar(T, series_t::variable(DoubleDouble(rho)), molefrac);
+        // The coefficient n is the derivative divided by n!
+        DoubleDouble Ar0n = c[n];
+        for (auto k = 1; k <= n; ++k){
+            Ar0n = Ar0n*(k*rho);
+        }
+        return static_cast<double>(Ar0n);
+    }
     virtual double get_Ar01ep(const double T, const double rho, const EArrayd& molefrac) const  override {
-        using namespace boost::multiprecision;
-        using my_float_t = number<cpp_bin_float<100U>>;
-        auto f = [&](const auto& rhoep){
-            return mp.get_cref().alphar(T, rhoep, molefrac);
-        };
-        return rho*static_cast<double>(centered_diff<1,4>(f, static_cast<my_float_t>(rho), 1e-16*static_cast<my_float_t>(rho)));
+        return get_Ar0nep<1>(T, rho, molefrac);
     }
     virtual double get_Ar02ep(const double T, const double rho, const EArrayd& molefrac) const  override {
-        using namespace boost::multiprecision;
-        using my_float_t = number<cpp_bin_float<100U>>;
-        auto f = [&](const auto& rhoep){
-            return mp.get_cref().alphar(T, rhoep, molefrac);
-        };
-        return rho*rho*static_cast<double>(centered_diff<2,4>(f, static_cast<my_float_t>(rho), 1e-16*static_cast<my_float_t>(rho)));
+        return get_Ar0nep<2>(T, rho, molefrac);
     }
     virtual double get_Ar03ep(const double T, const double rho, const EArrayd& molefrac) const  override {
-        using namespace boost::multiprecision;
-        using my_float_t = number<cpp_bin_float<100U>>;
-        auto f = [&](const auto& rhoep){
-            return mp.get_cref().alphar(T, rhoep, molefrac);
-        };
-        return rho*rho*rho*static_cast<double>(centered_diff<3,4>(f, static_cast<my_float_t>(rho), 1e-16*static_cast<my_float_t>(rho)));
+        return get_Ar0nep<3>(T, rho, molefrac);
     }
     
     virtual double get_reducing_density(const EArrayd& molefrac) const  override {
@@ -196,6 +274,9 @@ public:
     virtual std::map<int, double> get_Bnvir(const int Nderiv, const double T, const EArrayd& z) const override {
         return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Bnvir_runtime(Nderiv, mp.get_cref(), T, z);
     };
+    virtual std::map<int, double> get_Bnvir_ep(const int Nderiv, const double T, const EArrayd& z) const override {
+        return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Bnvir_ep_runtime(Nderiv, mp.get_cref(), T, z);
+    };
     virtual double get_B12vir(const double T, const EArrayd& z) const override {
         return VirialDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_B12vir(mp.get_cref(), T, z);
     };
@@ -213,6 +294,15 @@ public:
     virtual double get_ATrhoXiXjXk(const double T, const int NT, const double rhomolar, const int ND, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj, const int k, const int NXk) const override {
         return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_ATrhoXiXjXk_runtime(mp.get_cref(), T, NT, rhomolar, ND, molefrac, i, NXi, j, NXj, k, NXk);
     };
+    virtual EArrayd get_ATrhoXi_all(const double T, const int NT, const double rhomolar, const int ND, const EArrayd& molefrac) const override {
+        return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_ATrhoXi_all_runtime(mp.get_cref(), T, NT, rhomolar, ND, molefrac);
+    };
+    virtual EMatrixd get_ATrhoXiXj_all(const double T, const int NT, const double rhomolar, const int ND, const EArrayd& molefrac) const override {
+        return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_ATrhoXiXj_all_runtime(mp.get_cref(), T, NT, rhomolar, ND, molefrac);
+    };
+    virtual EArrayd get_ATrhoXiXjXk_all(const double T, const int NT, const double rhomolar, const int ND, const EArrayd& molefrac) const override {
+        return TDXDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_ATrhoXiXjXk_all_runtime(mp.get_cref(), T, NT, rhomolar, ND, molefrac);
+    };
     
     // Composition derivatives with tau and delta as the working variables
     virtual double get_AtaudeltaXi(const double tau, const int NT, const double delta, const int ND, const EArrayd& molefrac, const int i, const int NXi) const override {
@@ -232,6 +322,17 @@ public:
 #define X(f) virtual EArrayd f(const double T, const EArrayd& rhovec) const override { return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
     ISOCHORIC_array_args
 #undef X
+    /// One reverse sweep over the tape is cheaper than one forward evaluation per component from about this many components
+    static constexpr Eigen::Index reverse_mode_min_components = 5;
+    virtual EArrayd get_fugacity_coefficients(const double T, const EArrayd& rhovec) const override {
+        using id = IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>;
+        if constexpr (supports_adjoint_t<std::decay_t<decltype(mp.get_cref())>>::value){
+            if (rhovec.size() >= reverse_mode_min_components){
+                return id::template get_fugacity_coefficients<ADBackends::reverse>(mp.get_cref(), T, rhovec);
+            }
+        }
+        return id::get_fugacity_coefficients(mp.get_cref(), T, rhovec);
+    };
 #define X(f) virtual EMatrixd f(const double T, const EArrayd& rhovec) const override { return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::f(mp.get_cref(), T, rhovec); };
     ISOCHORIC_matrix_args
 #undef X
@@ -241,10 +342,27 @@ public:
     virtual Eigen::ArrayXd get_Psir_sigma_derivs(const double T, const EArrayd& rhovec, const EArrayd& v) const override{
         return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Psir_sigma_derivs(mp.get_cref(), T, rhovec, v);
     };
+    virtual Eigen::ArrayXd get_Psir_sigma_mixed_derivs(const double T, const EArrayd& rhovec, const EArrayd& v0, const EArrayd& v1) const override{
+        return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::get_Psir_sigma_mixed_derivs(mp.get_cref(), T, rhovec, v0, v1);
+    };
+    virtual IsochoricDerivativeBundle build_isochoric_derivative_bundle(const double T, const EArrayd& rhovec, const bool T_derivatives) const override{
+        return IsochoricDerivatives<decltype(mp.get_cref()), double, EArrayd>::build_isochoric_derivative_bundle(mp.get_cref(), T, rhovec, T_derivatives);
+    };
     
     virtual EArray33d get_deriv_mat2(const double T, double rho, const EArrayd& z ) const override {
         return DerivativeHolderSquare<2>(mp.get_cref(), T, rho, z).derivs;
     };
+    
+    virtual EArrayd solve_density(const double T, const double p, const EArrayd& z, const DensityRoot root) const override {
+        return teqp::solve_density(mp.get_cref(), T, p, z, root);
+    };
+    virtual EArrayd solve_density_batch(const REArrayd& T, const REArrayd& p, const REMatrixd& Z, const DensityRoot root) const override {
+        return teqp::solve_density_batch(mp.get_cref(), T, p, Z, root);
+    };
+    
+    virtual flash::TPFlashResult flash_Tp(const double T, const double p, const EArrayd& z, const std::optional<flash::TPFlashGuess>& guess, const std::optional<flash::TPFlashOptions>& options) const override {
+        return flash::flash_Tp(mp.get_cref(), T, p, z, guess, options);
+    };
 };
 
 template<typename TemplatedModel> auto view(const TemplatedModel& tp){
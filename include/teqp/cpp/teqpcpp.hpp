@@ -1,4 +1,5 @@
 #pragma once 
+#include <map>
 #include <memory>
 #include <typeindex>
 #include <optional>
@@ -11,6 +12,9 @@
 #include "teqp/algorithms/critical_tracing_types.hpp"
 #include "teqp/algorithms/VLE_types.hpp"
 #include "teqp/algorithms/VLLE_types.hpp"
+#include "teqp/algorithms/flash_types.hpp"
+#include "teqp/algorithms/density_types.hpp"
+#include "teqp/derivs_types.hpp"
 
 using EArray2 = Eigen::Array<double, 2, 1>;
 using EArrayd = Eigen::ArrayX<double>;
@@ -62,7 +66,6 @@ using REMatrixd = Eigen::Ref<const Eigen::Array<double, Eigen::Dynamic, Eigen::D
     X(build_Psir_gradient_autodiff) \
     X(get_chempotVLE_autodiff) \
     X(get_dchempotdT_autodiff) \
-    X(get_fugacity_coefficients) \
     X(get_partial_molar_volumes) \
     X(build_d2PsirdTdrhoi_autodiff) \
     X(get_dpdrhovec_constT)
@@ -100,8 +103,24 @@ namespace teqp {
             
             virtual double get_R(const EArrayd&) const = 0;
             double R(const EArrayd& x) const { return get_R(x); };
-            
+
+            /**
+             \brief Get the storage of a numeric parameter of the model so that it can be overwritten in-place, for instance by an optimizer
+
+             \param pointer The JSON pointer to the parameter, relative to the model specification (the "model" field of the JSON passed to make_model), e.g., "/coeffs/0/m"
+
+             The slot remains valid for the lifetime of the model. After writing to one or more slots, update_parameters must be called
+             before the model is evaluated. Models (and parameters) that do not support in-place updates raise a NotImplementedError
+             */
+            virtual double* get_parameter_slot(const std::string& pointer) = 0;
+            /// Recalculate the quantities that are derived from the parameters after the slots were written
+            virtual void update_parameters() = 0;
+
             virtual double get_Arxy(const int, const int, const double, const double, const EArrayd&) const = 0;
+            /// The derivative \f$\Lambda^{\rm r}_{xy}\f$ of a pure fluid, without the mixing rules for models that provide a pure-fluid path (multifluid, PC-SAFT, cubics)
+            virtual double get_Arxy_pure(const int NT, const int ND, const double T, const double rhomolar) const = 0;
+            /// The residual derivatives of a pure fluid up to second order in one call, see PureDerivativeBundle
+            virtual PureDerivativeBundle pure_bundle(const double T, const double rhomolar) const = 0;
             
             // Here X-Macros are used to create functions like get_Ar00, get_Ar01, ....
             #define X(i,j) virtual double get_Ar ## i ## j(const double T, const double rho, const REArrayd& molefrac) const = 0;
@@ -116,7 +135,7 @@ namespace teqp {
                 ARN0_args
             #undef X
             
-            // Extended precision evaluations, for testing of virial coefficients
+            // Extended (double-double) precision evaluations, for testing of virial coefficients
             virtual double get_Ar01ep(const double, const double, const EArrayd&) const = 0;
             virtual double get_Ar02ep(const double, const double, const EArrayd&) const = 0;
             virtual double get_Ar03ep(const double, const double, const EArrayd&) const = 0;
@@ -129,6 +148,7 @@ namespace teqp {
             // Virial derivatives
             virtual double get_B2vir(const double T, const EArrayd& z) const = 0;
             virtual std::map<int, double> get_Bnvir(const int Nderiv, const double T, const EArrayd& z) const = 0;
+            virtual std::map<int, double> get_Bnvir_ep(const int Nderiv, const double T, const EArrayd& z) const = 0;
             virtual double get_B12vir(const double T, const EArrayd& z) const = 0;
             virtual double get_dmBnvirdTm(const int Nderiv, const int NTderiv, const double T, const EArrayd& z) const = 0;
             
@@ -136,6 +156,10 @@ namespace teqp {
             virtual double get_ATrhoXi(const double T, const int NT, const double rhomolar, int ND, const EArrayd& molefrac, const int i, const int NXi) const = 0;
             virtual double get_ATrhoXiXj(const double T, const int NT, const double rhomolar, int ND, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj) const = 0;
             virtual double get_ATrhoXiXjXk(const double T, const int NT, const double rhomolar, int ND, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj, const int k, const int NXk) const = 0;
+            // All the composition derivatives at once, for any number of components; the third derivative w.r.t. x_i, x_j, and x_k is at the index (i*N+j)*N+k
+            virtual EArrayd get_ATrhoXi_all(const double T, const int NT, const double rhomolar, int ND, const EArrayd& molefrac) const = 0;
+            virtual EMatrixd get_ATrhoXiXj_all(const double T, const int NT, const double rhomolar, int ND, const EArrayd& molefrac) const = 0;
+            virtual EArrayd get_ATrhoXiXjXk_all(const double T, const int NT, const double rhomolar, int ND, const EArrayd& molefrac) const = 0;
             
             virtual double get_AtaudeltaXi(const double tau, const int Ntau, const double delta, int Ndelta, const EArrayd& molefrac, const int i, const int NXi) const = 0;
             virtual double get_AtaudeltaXiXj(const double tau, const int Ntau, const double delta, int Ndelta, const EArrayd& molefrac, const int i, const int NXi, const int j, const int NXj) const = 0;
@@ -148,6 +172,8 @@ namespace teqp {
             #define X(f) virtual EArrayd f(const double T, const EArrayd& rhovec) const = 0;
                 ISOCHORIC_array_args
             #undef X
+            /// The fugacity coefficients; for models that support it, the gradient of \f$\Psi^r\f$ is taken in reverse mode once there are enough components
+            virtual EArrayd get_fugacity_coefficients(const double T, const EArrayd& rhovec) const = 0;
             #define X(f) virtual EMatrixd f(const double T, const EArrayd& rhovec) const = 0;
                 ISOCHORIC_matrix_args
             #undef X
@@ -155,6 +181,8 @@ namespace teqp {
                 ISOCHORIC_multimatrix_args
             #undef X
             virtual Eigen::ArrayXd get_Psir_sigma_derivs(const double T, const EArrayd& rhovec, const EArrayd& v) const = 0;
+            virtual Eigen::ArrayXd get_Psir_sigma_mixed_derivs(const double T, const EArrayd& rhovec, const EArrayd& v0, const EArrayd& v1) const = 0;
+            virtual IsochoricDerivativeBundle build_isochoric_derivative_bundle(const double T, const EArrayd& rhovec, const bool T_derivatives = true) const = 0;
             
             double get_neff(const double, const double, const EArrayd&) const;
             
@@ -172,16 +200,33 @@ namespace teqp {
             virtual double get_dpsat_dTsat_isopleth(const double T, const REArrayd& rhovecL, const REArrayd& rhovecV) const;
             virtual nlohmann::json trace_VLE_isotherm_binary(const double T0, const EArrayd& rhovec0, const EArrayd& rhovecV0, const std::optional<TVLEOptions> & = std::nullopt) const;
             virtual nlohmann::json trace_VLE_isobar_binary(const double p, const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<PVLEOptions> & = std::nullopt) const;
+            /// Trace a set of isotherms concurrently, see teqp/algorithms/VLE.hpp
+            std::vector<VLETraceResult> trace_VLE_isotherms_binary(const std::vector<VLEIsothermSpec>& specs, const std::size_t Nthreads = 1) const;
+            /// Trace a set of isobars concurrently, see teqp/algorithms/VLE.hpp
+            std::vector<VLETraceResult> trace_VLE_isobars_binary(const std::vector<VLEIsobarSpec>& specs, const std::size_t Nthreads = 1) const;
+            /// Trace an isotherm, returning the points as a map from column name to values rather than as JSON, see teqp/algorithms/trace_sinks.hpp
+            std::map<std::string, EArrayd> trace_VLE_isotherm_binary_columns(const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<TVLEOptions> & = std::nullopt) const;
+            /// Trace an isobar, returning the points as a map from column name to values rather than as JSON, see teqp/algorithms/trace_sinks.hpp
+            std::map<std::string, EArrayd> trace_VLE_isobar_binary_columns(const double p, const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<PVLEOptions> & = std::nullopt) const;
             virtual std::tuple<VLE_return_code,EArrayd,EArrayd> mix_VLE_Tx(const double T, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const REArrayd& xspec, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const;
             virtual MixVLEReturn mix_VLE_Tp(const double T, const double pgiven, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLETpFlags> &flags = std::nullopt) const;
+            /// Molar density from temperature, pressure and mole fractions; in closed form for the cubic EOS, see teqp/algorithms/density.hpp
+            virtual EArrayd solve_density(const double T, const double p, const EArrayd& z, const DensityRoot root) const = 0;
+            /// Molar densities for a batch of points, with one row of Z per point or a single row for all of them, see teqp/algorithms/density.hpp
+            virtual EArrayd solve_density_batch(const REArrayd& T, const REArrayd& p, const REMatrixd& Z, const DensityRoot root) const = 0;
+            /// Isothermal-isobaric flash; the iterations are carried out by the concrete model type, see teqp/algorithms/flash.hpp
+            virtual flash::TPFlashResult flash_Tp(const double T, const double p, const EArrayd& z, const std::optional<flash::TPFlashGuess>& guess = std::nullopt, const std::optional<flash::TPFlashOptions>& options = std::nullopt) const = 0;
+            std::vector<flash::TPFlashResult> flash_Tp_batch(const REArrayd& T, const REArrayd& p, const REMatrixd& Z, const std::optional<flash::TPFlashOptions>& options = std::nullopt, const bool warm_start = true, const std::size_t Nthreads = 1) const;
             virtual std::tuple<VLE_return_code,double,EArrayd,EArrayd> mixture_VLE_px(const double p_spec, const REArrayd& xmolar_spec, const double T0, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLEpxFlags>& flags = std::nullopt) const;
             
             std::tuple<VLLE::VLLE_return_code,EArrayd,EArrayd,EArrayd> mix_VLLE_T(const double T, const REArrayd& rhovecVinit, const REArrayd& rhovecL1init, const REArrayd& rhovecL2init, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const;
             std::vector<nlohmann::json> find_VLLE_T_binary(const std::vector<nlohmann::json>& traces, const std::optional<VLLE::VLLEFinderOptions> options = std::nullopt) const;
             std::vector<nlohmann::json> find_VLLE_p_binary(const std::vector<nlohmann::json>& traces, const std::optional<VLLE::VLLEFinderOptions> options = std::nullopt) const;
             nlohmann::json trace_VLLE_binary(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const;
+            std::map<std::string, EArrayd> trace_VLLE_binary_columns(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const;
             
             virtual nlohmann::json trace_critical_arclength_binary(const double T0, const EArrayd& rhovec0, const std::optional<std::string>& = std::nullopt, const std::optional<TCABOptions> & = std::nullopt) const;
+            std::map<std::string, EArrayd> trace_critical_arclength_binary_columns(const double T0, const EArrayd& rhovec0, const std::optional<TCABOptions> & = std::nullopt) const;
             virtual EArrayd get_drhovec_dT_crit(const double T, const REArrayd& rhovec) const;
             virtual double get_dp_dT_crit(const double T, const REArrayd& rhovec) const;
             virtual EArray2 get_criticality_conditions(const double T, const REArrayd& rhovec) const;
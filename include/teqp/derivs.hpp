@@ -10,6 +10,7 @@
 
 #include "teqp/types.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/derivs_types.hpp"
 
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
 #include "MultiComplex/MultiComplex.hpp"
@@ -89,7 +90,7 @@ struct wrt_helper {
     }
 };
 
-enum class ADBackends { autodiff
+enum class ADBackends { autodiff, reverse
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
     ,multicomplex
 #endif
@@ -113,6 +114,54 @@ concept CallableAlpharTauDelta = requires(T t, U u, V v, W w) {
     { t.alphar_taudelta(u,v,w) };
 };
 
+/// Models (like the ideal-gas Helmholtz energy) that provide the temperature derivatives in closed form, which are used in place of automatic differentiation
+template<int N, typename Model, typename Scalar, typename VectorType>
+concept HasAnalyticTDerivatives = std::is_same_v<Scalar, double> && requires(const std::decay_t<Model>& m, const Scalar& T, const VectorType& molefrac) {
+    { m.template alphaig_Tderivs<N>(T, T, molefrac) } -> std::same_as<std::valarray<double>>;
+};
+
+/// Models (like the cubic models) that provide the derivatives of \f$\alpha^r\f$ w.r.t. 1/T and \f$\rho\f$ in closed form, which are used in place of automatic differentiation
+template<int NT, int ND, typename Model, typename Scalar, typename VectorType>
+concept HasAnalyticTDDerivatives = std::is_same_v<Scalar, double> && requires(const std::decay_t<Model>& m, const Scalar& T, const VectorType& molefrac) {
+    { m.template alphar_TDderivs<NT, ND>(T, T, molefrac) } -> std::same_as<Eigen::Array<double, NT+1, ND+1>>;
+};
+
+/// Models (like the cubic models) that provide the value, gradient, and Hessian of \f$\Psi^r\f$ w.r.t. the molar concentrations in closed form
+template<typename Model, typename Scalar, typename VectorType>
+concept HasAnalyticPsirDerivatives = std::is_same_v<Scalar, double> && requires(const std::decay_t<Model>& m, const Scalar& T, const VectorType& rhovec) {
+    { m.Psir_fgradHessian(T, rhovec) };
+};
+
+/// The closed-form derivatives take the place of the default backend (autodiff); a backend that is selected explicitly is used as such
+template<ADBackends be>
+constexpr bool closed_form_backend = (be == ADBackends::autodiff);
+
+/// Models (like the multifluid, PC-SAFT and cubic models) that provide \f$\alpha^r\f$ of a pure fluid without going through the mixing rules
+template<typename Model>
+concept HasPureAlphar = requires(const std::decay_t<Model>& m, const double& T, const double& rho) {
+    { m.alphar_pure(T, rho) };
+};
+
+/**
+ \brief Expose the alphar_pure method of a model as the alphar method, so that the derivatives of a pure fluid are
+ taken with TDXDerivatives without evaluating the mixing rules. The mole fractions are not used, except by the
+ closed-form derivatives, which are forwarded to the model when it provides them.
+ */
+template<typename Model>
+struct PureAlpharWrapper {
+    const Model& model;
+
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar(const TType& T, const RhoType& rho, const MoleFracType& /*molefrac*/) const {
+        return model.alphar_pure(T, rho);
+    }
+    
+    template<int NT, int ND, typename MoleFracType>
+    auto alphar_TDderivs(const double T, const double rho, const MoleFracType& molefrac) const requires HasAnalyticTDDerivatives<NT, ND, Model, double, MoleFracType> {
+        return model.template alphar_TDderivs<NT, ND>(T, rho, molefrac);
+    }
+};
+
 template<typename Model, typename Scalar = double, typename VectorType = Eigen::ArrayXd>
 struct TDXDerivatives {
     
@@ -150,7 +199,11 @@ struct TDXDerivatives {
     template<int iT, int iD, ADBackends be = ADBackends::autodiff, class AlphaWrapper>
     static auto get_Agenxy(const AlphaWrapper& w, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
         
-        if constexpr (iT == 0 && iD == 0){
+        if constexpr (be == ADBackends::reverse){
+            // Reverse mode only pays off for gradients w.r.t. many variables, so forward mode is used for T and rho
+            return get_Agenxy<iT, iD, ADBackends::autodiff>(w, T, rho, molefrac);
+        }
+        else if constexpr (iT == 0 && iD == 0){
             return AlphaCaller(w, T, rho, molefrac);
         }
         else if constexpr (iT == 0 && iD > 0) {
@@ -464,6 +517,153 @@ struct TDXDerivatives {
         return powi(forceeval(1.0 / T), iT) * powi(rho, iD) * der[der.size() - 1];
     }
 
+    /**
+     Evaluate the model with \f$1/T\f$ and \f$\rho\f$ carried as Taylor series, and the mole fractions given as numbers of type Number,
+     and return the coefficient of the term in \f$(1/T)^x\rho^y\f$ scaled to
+     \f[
+     (1/T)^x(\rho)^y\deriv{^{x+y}(\alpha^r)}{(1/T)^x\partial \rho^y}{}
+     \f]
+     */
+    template<int iT, int iD, typename Number, typename AlphaWrapper>
+    static Number get_ATrho_swept(const AlphaWrapper& w, const Scalar& T, const Scalar& rho, const Eigen::ArrayX<Number>& molefrac){
+        using rho_t = TaylorSeries<iD, Number>;
+        using num_t = TaylorSeries<iT, rho_t>;
+        rho_t rhoinner = rho_t(Number(rho));
+        if constexpr (iD > 0){ rhoinner[1] = Number(1.0); }
+        const num_t rho_ = num_t(rhoinner);
+        Eigen::ArrayX<num_t> molefrac_(molefrac.size());
+        for (auto i = 0; i < molefrac.size(); ++i){ molefrac_[i] = num_t(rho_t(molefrac[i])); }
+        auto val = [&](){
+            if constexpr (iT == 0){
+                return num_t(AlphaCaller(w, T, rho_, molefrac_));
+            }
+            else{
+                num_t Trecip = num_t(rho_t(Number(1.0/T)));
+                Trecip[1] = rho_t(Number(1.0));
+                return num_t(AlphaCaller(w, 1.0/Trecip, rho_, molefrac_));
+            }
+        }();
+        // The Taylor coefficients are the derivatives divided by the factorials
+        const double scale = tgamma(iT + 1)*tgamma(iD + 1)*powi(1.0/T, iT)*powi(rho, iD);
+        return val[iT][iD]*scale;
+    }
+
+    /**
+     Calculate the gradient and the Hessian of
+     \f[
+     \Lambda_{xy} = (1/T)^x(\rho)^y\deriv{^{x+y}(\alpha^r)}{(1/T)^x\partial \rho^y}{}
+     \f]
+     w.r.t. the mole fractions, all treated as being independent. The mole fractions are seeded as VectorHyperDual
+     numbers, so everything comes out of one evaluation of the model rather than the N(N+1)/2 evaluations
+     of get_ATrhoXi and get_ATrhoXiXj. Up to MaxN components, the derivatives are carried in fixed-capacity storage
+     on the stack; beyond that, the same evaluation is carried out with heap storage, so there is no limit on the number
+     of components.
+     */
+    template<int iT, int iD, int MaxN = 20, typename AlphaWrapper>
+    static auto get_ATrhoX_gradHessian(const AlphaWrapper& w, const Scalar& T, const Scalar& rho, const VectorType& molefrac){
+        using vhd = VectorHyperDual<MaxN>;
+        const auto N = molefrac.size();
+        if constexpr (MaxN != Eigen::Dynamic) {
+            if (N > MaxN) {
+                return get_ATrhoX_gradHessian<iT, iD, Eigen::Dynamic>(w, T, rho, molefrac);
+            }
+        }
+        Eigen::ArrayX<vhd> molefrac_(N);
+        for (auto i = 0; i < N; ++i){ molefrac_[i] = vhd::variable(molefrac[i], i, N); }
+        vhd u = get_ATrho_swept<iT, iD>(w, T, rho, molefrac_);
+        if (u.is_constant()) {
+            return std::make_tuple(Eigen::ArrayXd::Zero(N).eval(), Eigen::MatrixXd::Zero(N, N).eval());
+        }
+        Eigen::ArrayXd g = u.grad;
+        return std::make_tuple(g, u.get_Hessian());
+    }
+
+    /// The gradient of \f$\Lambda_{xy}\f$ w.r.t. the mole fractions, the entries are those of get_ATrhoXi<iT, iD, 1>
+    template<int iT, int iD, int MaxN = 20, typename AlphaWrapper>
+    static Eigen::ArrayXd get_ATrhoXi_all(const AlphaWrapper& w, const Scalar& T, const Scalar& rho, const VectorType& molefrac){
+        return std::get<0>(get_ATrhoX_gradHessian<iT, iD, MaxN>(w, T, rho, molefrac));
+    }
+
+    /// The Hessian of \f$\Lambda_{xy}\f$ w.r.t. the mole fractions, the entries are those of get_ATrhoXiXj<iT, iD, 1, 1>, and get_ATrhoXi<iT, iD, 2> on the diagonal
+    template<int iT, int iD, int MaxN = 20, typename AlphaWrapper>
+    static Eigen::ArrayXXd get_ATrhoXiXj_all(const AlphaWrapper& w, const Scalar& T, const Scalar& rho, const VectorType& molefrac){
+        return std::get<1>(get_ATrhoX_gradHessian<iT, iD, MaxN>(w, T, rho, molefrac)).array();
+    }
+
+    /**
+     The tensor of the third derivatives of \f$\Lambda_{xy}\f$ w.r.t. the mole fractions, flattened so that the
+     derivative w.r.t. \f$x_i\f$, \f$x_j\f$, and \f$x_k\f$ is at the index \f$(iN+j)N+k\f$.
+
+     Each evaluation of the model gives the derivative of the entire Hessian in the direction of one mole fraction,
+     so N evaluations are needed in place of the O(N^3) evaluations of the individual entries. As in get_ATrhoX_gradHessian,
+     more than MaxN components are handled with heap storage.
+     */
+    template<int iT, int iD, int MaxN = 20, typename AlphaWrapper>
+    static Eigen::ArrayXd get_ATrhoXiXjXk_all(const AlphaWrapper& w, const Scalar& T, const Scalar& rho, const VectorType& molefrac){
+        using vhd = VectorHyperDual<MaxN>;
+        using series_t = TaylorSeries<1, vhd>;
+        const auto N = molefrac.size();
+        if constexpr (MaxN != Eigen::Dynamic) {
+            if (N > MaxN) {
+                return get_ATrhoXiXjXk_all<iT, iD, Eigen::Dynamic>(w, T, rho, molefrac);
+            }
+        }
+        Eigen::ArrayXd o = Eigen::ArrayXd::Zero(N*N*N);
+        Eigen::ArrayX<series_t> molefrac_(N);
+        for (auto k = 0; k < N; ++k){
+            for (auto i = 0; i < N; ++i){
+                molefrac_[i] = series_t(vhd::variable(molefrac[i], i, N));
+                molefrac_[i][1] = vhd(i == k ? 1.0 : 0.0);
+            }
+            series_t u = get_ATrho_swept<iT, iD>(w, T, rho, molefrac_);
+            if (u[1].is_constant()){ continue; }
+            Eigen::MatrixXd dHdxk = u[1].get_Hessian();
+            for (auto i = 0; i < N; ++i){
+                for (auto j = 0; j < N; ++j){
+                    o[(i*N + j)*N + k] = dHdxk(i, j);
+                }
+            }
+        }
+        return o;
+    }
+
+    #define get_ATrhoX_all_runtime_combinations \
+        X(0,0) \
+        X(1,0) \
+        X(0,1) \
+        X(2,0) \
+        X(1,1) \
+        X(0,2)
+
+    template<typename AlphaWrapper>
+    static auto get_ATrhoXi_all_runtime(const AlphaWrapper& w, const Scalar& T, int iT, const Scalar& rho, int iD, const VectorType& molefrac){
+        #define X(a,b) if (iT == a && iD == b) { return get_ATrhoXi_all<a,b>(w, T, rho, molefrac); }
+        get_ATrhoX_all_runtime_combinations
+        #undef X
+        throw teqp::InvalidArgument("Can't match these derivative counts");
+    }
+
+    template<typename AlphaWrapper>
+    static auto get_ATrhoXiXj_all_runtime(const AlphaWrapper& w, const Scalar& T, int iT, const Scalar& rho, int iD, const VectorType& molefrac){
+        #define X(a,b) if (iT == a && iD == b) { return get_ATrhoXiXj_all<a,b>(w, T, rho, molefrac); }
+        get_ATrhoX_all_runtime_combinations
+        #undef X
+        throw teqp::InvalidArgument("Can't match these derivative counts");
+    }
+
+    #define get_ATrhoXiXjXk_all_runtime_combinations \
+        X(0,0) \
+        X(1,0) \
+        X(0,1)
+
+    template<typename AlphaWrapper>
+    static auto get_ATrhoXiXjXk_all_runtime(const AlphaWrapper& w, const Scalar& T, int iT, const Scalar& rho, int iD, const VectorType& molefrac){
+        #define X(a,b) if (iT == a && iD == b) { return get_ATrhoXiXjXk_all<a,b>(w, T, rho, molefrac); }
+        get_ATrhoXiXjXk_all_runtime_combinations
+        #undef X
+        throw teqp::InvalidArgument("Can't match these derivative counts");
+    }
+
     /**
     * Calculate the derivative \f$\Lambda^{\rm r}_{xy}\f$, where
     * \f[
@@ -474,7 +674,15 @@ struct TDXDerivatives {
     */
     template<int iT, int iD, ADBackends be = ADBackends::autodiff>
     static auto get_Arxy(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
-        return get_Agenxy<iT, iD, be>(model, T, rho, molefrac);
+        if constexpr (closed_form_backend<be> && iT > 0 && iD == 0 && HasAnalyticTDerivatives<iT, Model, Scalar, VectorType>){
+            return model.template alphaig_Tderivs<iT>(T, rho, molefrac)[iT];
+        }
+        else if constexpr (closed_form_backend<be> && HasAnalyticTDDerivatives<iT, iD, Model, Scalar, VectorType>){
+            return model.template alphar_TDderivs<iT, iD>(T, rho, molefrac)(iT, iD);
+        }
+        else{
+            return get_Agenxy<iT, iD, be>(model, T, rho, molefrac);
+        }
     }
 
     /**
@@ -487,7 +695,12 @@ struct TDXDerivatives {
     */
     template<int iT, int iD, ADBackends be = ADBackends::autodiff>
     static auto get_Aigxy(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
-        return get_Agenxy<iT, iD, be>(model, T, rho, molefrac);
+        if constexpr (closed_form_backend<be> && iT > 0 && iD == 0 && HasAnalyticTDerivatives<iT, Model, Scalar, VectorType>){
+            return model.template alphaig_Tderivs<iT>(T, rho, molefrac)[iT];
+        }
+        else{
+            return get_Agenxy<iT, iD, be>(model, T, rho, molefrac);
+        }
     }
 
     template<ADBackends be = ADBackends::autodiff>
@@ -607,7 +820,16 @@ struct TDXDerivatives {
     */
     template<int iT, ADBackends be = ADBackends::autodiff>
     static auto get_Arn0(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
-        return get_Agenn0<iT, be>(model, T, rho, molefrac);
+        if constexpr (closed_form_backend<be> && HasAnalyticTDerivatives<iT, Model, Scalar, VectorType>){
+            return model.template alphaig_Tderivs<iT>(T, rho, molefrac);
+        }
+        else if constexpr (closed_form_backend<be> && HasAnalyticTDDerivatives<iT, 0, Model, Scalar, VectorType>){
+            auto ders = model.template alphar_TDderivs<iT, 0>(T, rho, molefrac);
+            return std::valarray<double>(&(ders(0, 0)), iT+1);
+        }
+        else{
+            return get_Agenn0<iT, be>(model, T, rho, molefrac);
+        }
     }
     
     /**
@@ -620,7 +842,13 @@ struct TDXDerivatives {
     */
     template<int iD, ADBackends be = ADBackends::autodiff>
     static auto get_Ar0n(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
-        return get_Agen0n<iD, be>(model, T, rho, molefrac);
+        if constexpr (closed_form_backend<be> && HasAnalyticTDDerivatives<0, iD, Model, Scalar, VectorType>){
+            auto ders = model.template alphar_TDderivs<0, iD>(T, rho, molefrac);
+            return std::valarray<double>(&(ders(0, 0)), iD+1);
+        }
+        else{
+            return get_Agen0n<iD, be>(model, T, rho, molefrac);
+        }
     }
     
 
@@ -768,6 +996,40 @@ struct VirialDerivatives {
         }
     }
 
+    /**
+    * \brief The virial coefficients in extended precision
+    *
+    * The same as get_Bnvir, except that the Taylor series in density of alphar is carried out with double-double
+    * numbers, so that the higher virial coefficients, which result from the cancellation of large terms in some
+    * models, retain more digits. The temperature remains in double precision.
+    * \tparam Nderiv The maximum virial coefficient to return; e.g. 5: B_2, B_3, ..., B_5
+    */
+    template <int Nderiv>
+    static auto get_Bnvir_ep(const Model& model, const Scalar &T, const VectorType& molefrac)
+    {
+        // The coefficient k of the Taylor series is d^k(alphar)/drho^k/k!, so B_n = (n-1)*c_{n-1}
+        using series_t = TaylorSeries<Nderiv-1, DoubleDouble>;
+        auto c = model.alphar(T, series_t::variable(DoubleDouble(0.0)), molefrac);
+        std::map<int, double> o;
+        for (int n = 2; n <= Nderiv; ++n) {
+            o[n] = static_cast<double>(c[n-1]*static_cast<double>(n-1));
+        }
+        return o;
+    }
+
+    /// This version of the get_Bnvir_ep takes the maximum number of derivatives as a runtime argument
+    /// and then forwards all arguments to the corresponding templated function
+    static auto get_Bnvir_ep_runtime(const int Nderiv, const Model& model, const Scalar &T, const VectorType& molefrac) {
+        switch(Nderiv){
+            case 2: return get_Bnvir_ep<2>(model, T, molefrac);
+            case 3: return get_Bnvir_ep<3>(model, T, molefrac);
+            case 4: return get_Bnvir_ep<4>(model, T, molefrac);
+            case 5: return get_Bnvir_ep<5>(model, T, molefrac);
+            case 6: return get_Bnvir_ep<6>(model, T, molefrac);
+            default: throw std::invalid_argument("Only Nderiv up to 6 is supported, get_Bnvir_ep templated function allows more");
+        }
+    }
+
     /**
     * \brief Temperature derivatives of a virial coefficient
     * 
@@ -1026,46 +1288,93 @@ struct IsochoricDerivatives{
     /**
     * \brief Calculate the Hessian of \f$\Psi^r = a^r \rho\f$ w.r.t. the molar concentrations
     *
-    * Requires the use of autodiff derivatives to calculate second partial derivatives
+    * Requires the use of autodiff derivatives to calculate second partial derivatives, unless the model provides them in closed form
+    * and closed_form is true
     */
+    template<bool closed_form = true>
     static auto build_Psir_Hessian_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
-        // Double derivatives in each component's concentration
-        // N^N matrix (symmetric)
-
-        dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
-        ArrayXdual2nd g;
-        ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
-        auto hfunc = [&model, &T](const ArrayXdual2nd& rho_) {
-            auto rhotot_ = rho_.sum();
-            auto molefrac = (rho_ / rhotot_).eval();
-            return forceeval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
-        };
-        return autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g).eval(); // evaluate the function value u, its gradient, and its Hessian matrix H
+        if constexpr (closed_form && HasAnalyticPsirDerivatives<Model, Scalar, VectorType>){
+            return std::get<2>(model.Psir_fgradHessian(T, rho));
+        }
+        else{
+            // Double derivatives in each component's concentration
+            // N^N matrix (symmetric)
+
+            dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
+            ArrayXdual2nd g;
+            ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
+            auto hfunc = [&model, &T](const ArrayXdual2nd& rho_) {
+                auto rhotot_ = rho_.sum();
+                auto molefrac = (rho_ / rhotot_).eval();
+                return forceeval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
+            };
+            return autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g).eval(); // evaluate the function value u, its gradient, and its Hessian matrix H
+        }
     }
 
     /**
     * \brief Calculate the function value, gradient, and Hessian of \f$Psi^r = a^r\rho\f$ w.r.t. the molar concentrations
     *
-    * Uses autodiff to calculate the derivatives
+    * Uses autodiff to calculate the derivatives, unless the model provides them in closed form and closed_form is true
     */
+    template<bool closed_form = true>
     static auto build_Psir_fgradHessian_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
-        // Double derivatives in each component's concentration
-        // N^N matrix (symmetric)
+        if constexpr (closed_form && HasAnalyticPsirDerivatives<Model, Scalar, VectorType>){
+            return model.Psir_fgradHessian(T, rho);
+        }
+        else{
+            // Double derivatives in each component's concentration
+            // N^N matrix (symmetric)
+
+            dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
+            ArrayXdual g;
+            ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
+            auto hfunc = [&model, &T](const ArrayXdual2nd& rho_) {
+                auto rhotot_ = rho_.sum();
+                auto molefrac = (rho_ / rhotot_).eval();
+                return forceeval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
+            };
+            // Evaluate the function value u, its gradient, and its Hessian matrix H
+            Eigen::MatrixXd H = autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g); 
+            // Remove autodiff stuff from the numerical values
+            auto f = getbaseval(u);
+            auto gg = g.cast<double>().eval();
+            return std::make_tuple(f, gg, H);
+        }
+    }
 
-        dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
-        ArrayXdual g;
-        ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
-        auto hfunc = [&model, &T](const ArrayXdual2nd& rho_) {
-            auto rhotot_ = rho_.sum();
-            auto molefrac = (rho_ / rhotot_).eval();
-            return forceeval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
-        };
-        // Evaluate the function value u, its gradient, and its Hessian matrix H
-        Eigen::MatrixXd H = autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g); 
-        // Remove autodiff stuff from the numerical values
-        auto f = getbaseval(u);
-        auto gg = g.cast<double>().eval();
-        return std::make_tuple(f, gg, H);
+    /**
+    * \brief Calculate the function value, gradient, and Hessian of \f$Psi^r = a^r\rho\f$ w.r.t. the molar concentrations with vector-mode forward derivatives
+    *
+    * The molar concentrations are seeded as VectorHyperDual numbers, so everything comes out of one evaluation
+    * of the model, rather than the N(N+1)/2 evaluations of build_Psir_fgradHessian_autodiff. Up to MaxN components are supported.
+    */
+    template<int MaxN = 20>
+    static auto build_Psir_fgradHessian_vectorAD(const Model& model, const Scalar& T, const VectorType& rho) {
+        using vhd = VectorHyperDual<MaxN>;
+        const auto N = rho.size();
+        if (N > MaxN) {
+            throw teqp::InvalidArgument("The vector-mode Hessian supports at most " + std::to_string(MaxN) + " components; " + std::to_string(N) + " were provided");
+        }
+        Eigen::ArrayX<vhd> rhovecc(N); for (auto i = 0; i < N; ++i) { rhovecc[i] = vhd::variable(rho[i], i, N); }
+        vhd rhotot_ = rhovecc.sum();
+        auto molefrac = (rhovecc / rhotot_).eval();
+        vhd u = model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_;
+        if (u.is_constant()) {
+            return std::make_tuple(u.val, Eigen::ArrayXd::Zero(N).eval(), Eigen::MatrixXd::Zero(N, N).eval());
+        }
+        Eigen::ArrayXd g = u.grad;
+        return std::make_tuple(u.val, g, u.get_Hessian());
+    }
+
+    /**
+    * \brief Calculate the Hessian of \f$\Psi^r = a^r \rho\f$ w.r.t. the molar concentrations with vector-mode forward derivatives
+    *
+    * \sa build_Psir_fgradHessian_vectorAD
+    */
+    template<int MaxN = 20>
+    static auto build_Psir_Hessian_vectorAD(const Model& model, const Scalar& T, const VectorType& rho) {
+        return std::get<2>(build_Psir_fgradHessian_vectorAD<MaxN>(model, T, rho));
     }
 
     /**
@@ -1083,6 +1392,44 @@ struct IsochoricDerivatives{
         return H;
     }
 
+    /**
+    * \brief Calculate the bundle of derivatives of \f$\Psi^r = a^r\rho\f$ that are needed by the phase equilibrium solvers
+    *
+    * If the temperature derivatives are requested, the Hessian is taken w.r.t. the vector \f$[T, \rho_0, \rho_1, ...]\f$, which requires
+    * (N+1)(N+2)/2 evaluations of the model; this is the same number of evaluations as build_Psir_fgradHessian_autodiff, build_d2PsirdTdrhoi_autodiff
+    * and get_dPsirdT_constrhovec taken together, and it replaces all of them. Otherwise only the N(N+1)/2 evaluations of the Hessian w.r.t. the molar concentrations are needed.
+    */
+    static auto build_isochoric_derivative_bundle(const Model& model, const Scalar& T, const VectorType& rhovec, const bool T_derivatives = true) {
+        const auto N = rhovec.size();
+        IsochoricDerivativeBundle b;
+        b.T = T;
+        b.rhovec = rhovec;
+        b.R = model.R((rhovec/rhovec.sum()).eval());
+        b.has_T_derivatives = T_derivatives;
+        if (!T_derivatives){
+            std::tie(b.Psir, b.gradient_Psir, b.Hessian_Psir) = build_Psir_fgradHessian_autodiff(model, T, rhovec);
+            return b;
+        }
+        dual2nd u;
+        ArrayXdual g;
+        ArrayXdual2nd x(N+1);
+        x[0] = T;
+        for (auto i = 0; i < N; ++i) { x[i+1] = rhovec[i]; }
+        auto hfunc = [&model, N](const ArrayXdual2nd& x_) {
+            const auto& T_ = x_[0];
+            auto rhotot_ = x_.tail(N).sum();
+            auto molefrac = (x_.tail(N) / rhotot_).eval();
+            return forceeval(model.alphar(T_, rhotot_, molefrac) * model.R(molefrac) * T_ * rhotot_);
+        };
+        Eigen::MatrixXd H = autodiff::hessian(hfunc, wrt(x), at(x), u, g);
+        b.Psir = getbaseval(u);
+        b.dPsirdT = getbaseval(g[0]);
+        b.gradient_Psir = g.tail(N).cast<double>().eval();
+        b.d2PsirdTdrhovec = H.col(0).tail(N).array().eval();
+        b.Hessian_Psir = H.bottomRightCorner(N, N);
+        return b;
+    }
+
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
     /**
     * \brief Calculate the Hessian of Psir = ar*rho w.r.t. the molar concentrations (residual contribution only)
@@ -1110,17 +1457,38 @@ struct IsochoricDerivatives{
     /**
     * \brief Gradient of Psir = ar*rho w.r.t. the molar concentrations
     *
-    * Uses autodiff to calculate derivatives
+    * Uses autodiff to calculate derivatives, unless the model provides them in closed form and closed_form is true
     */
+    template<bool closed_form = true>
     static auto build_Psir_gradient_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
-        ArrayXdual rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
-        auto psirfunc = [&model, &T](const ArrayXdual& rho_) {
-            auto rhotot_ = rho_.sum();
-            auto molefrac = (rho_ / rhotot_).eval();
-            return forceeval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
-        };
-        auto val = autodiff::gradient(psirfunc, wrt(rhovecc), at(rhovecc)).eval(); // evaluate the gradient
-        return val;
+        if constexpr (closed_form && HasAnalyticPsirDerivatives<Model, Scalar, VectorType>){
+            return std::get<1>(model.Psir_fgradHessian(T, rho)).matrix().eval();
+        }
+        else{
+            ArrayXdual rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
+            auto psirfunc = [&model, &T](const ArrayXdual& rho_) {
+                auto rhotot_ = rho_.sum();
+                auto molefrac = (rho_ / rhotot_).eval();
+                return forceeval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
+            };
+            auto val = autodiff::gradient(psirfunc, wrt(rhovecc), at(rhovecc)).eval(); // evaluate the gradient
+            return val;
+        }
+    }
+
+    /**
+    * \brief Gradient of Psir = ar*rho w.r.t. the molar concentrations
+    *
+    * Uses reverse-mode (adjoint) derivatives on a tape, so the cost is a small multiple of one evaluation
+    * of the model, irrespective of the number of components
+    */
+    static auto build_Psir_gradient_reverse(const Model& model, const Scalar& T, const VectorType& rho) {
+        adjoint::TapeGuard guard;
+        Eigen::ArrayX<AdjointVar> rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = AdjointVar::variable(rho[i]); }
+        AdjointVar rhotot_ = rhovecc.sum();
+        auto molefrac = (rhovecc / rhotot_).eval();
+        AdjointVar u = model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_;
+        return adjoint::gradient(u, rhovecc);
     }
 
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
@@ -1174,6 +1542,9 @@ struct IsochoricDerivatives{
         if constexpr (be == ADBackends::autodiff) {
             return build_Psir_gradient_autodiff(model, T, rho);
         }
+        else if constexpr (be == ADBackends::reverse) {
+            return build_Psir_gradient_reverse(model, T, rho);
+        }
 #if defined(TEQP_MULTICOMPLEX_ENABLED)
         else if constexpr (be == ADBackends::multicomplex) {
             return build_Psir_gradient_multicomplex(model, T, rho);
@@ -1346,7 +1717,7 @@ struct IsochoricDerivatives{
         auto molefrac = (rhovec / rhotot).eval();
         auto R = model.R(molefrac);
         auto [lnZ, Z, dZdrho] = get_lnZ_Z_dZdrho(model, T, rhovec);
-        auto hessian = build_Psir_Hessian_autodiff(model, T, rhovec);
+        auto hessian = build_Psir_Hessian_autodiff<closed_form_backend<be>>(model, T, rhovec);
         return forceeval((1/(R*T)*(hessian*molefrac.matrix()).array() - dZdrho/Z).eval());
     }
     
@@ -1384,7 +1755,7 @@ struct IsochoricDerivatives{
         Eigen::RowVector<decltype(rhotot), Eigen::Dynamic> dZdx_Z = dZdx/Z;
         
         // Starting matrix is from the first term
-        auto hessian = build_Psir_Hessian_autodiff(model, T, rhovec);
+        auto hessian = build_Psir_Hessian_autodiff<closed_form_backend<be>>(model, T, rhovec);
         Eigen::ArrayXXd out = rhotot/(R*T)*hessian;
         
         // Then each row gets the second part
@@ -1398,7 +1769,7 @@ struct IsochoricDerivatives{
         auto molefrac = (rhovec / rhotot).eval();
         auto R = model.R(molefrac);
         
-        auto hessian = build_Psir_Hessian_autodiff(model, T, rhovec);
+        auto hessian = build_Psir_Hessian_autodiff<closed_form_backend<be>>(model, T, rhovec);
         // Starting matrix is from the first term
         Eigen::ArrayXXd out = 1/(R*T)*rhotot*hessian;
         return out;
@@ -1507,6 +1878,41 @@ struct IsochoricDerivatives{
         for (auto i = 0; i < ret.size(); ++i){ ret[i] = der[i];}
         return ret;
     }
+    
+    /**
+    * \brief Mixed derivatives of \f$\Psi^r(T+\tau, \vec\rho + \sigma_1\vec v_0 + \sigma_2\vec v_1)\f$ with respect to \f$\tau\f$, \f$\sigma_1\f$ and \f$\sigma_2\f$, evaluated at \f$\tau=\sigma_1=\sigma_2=0\f$
+    *
+    * These are the derivatives needed to differentiate the criticality conditions (the derivatives of \f$\Psi\f$ along the eigenvector \f$\vec v_0\f$)
+    * with respect to temperature and with respect to a step along \f$\vec v_1\f$
+    *
+    * \returns The derivatives in the order \f$\tau\sigma_1\sigma_1\f$, \f$\tau\sigma_1\sigma_2\f$, \f$\tau\sigma_1\sigma_1\sigma_1\f$, \f$\sigma_1\sigma_1\sigma_2\f$, \f$\sigma_1\sigma_2\sigma_2\f$, \f$\sigma_1\sigma_1\sigma_1\sigma_2\f$
+    */
+    static VectorType get_Psir_sigma_mixed_derivs(const Model& model, const Scalar& T, const VectorType& rhovec, const VectorType& v0, const VectorType& v1) {
+        auto wrapper = [&model, &T, &rhovec, &v0, &v1](const auto& tau, const auto& sigma_1, const auto& sigma_2) {
+            using adtype = std::decay_t<decltype(tau)>;
+            auto rhovecused = (rhovec.template cast<adtype>() + sigma_1*v0.template cast<adtype>() + sigma_2*v1.template cast<adtype>()).eval();
+            adtype Tused = T + tau;
+            auto rhotot = rhovecused.sum();
+            auto molefrac = (rhovecused / rhotot).eval();
+            return forceeval(model.alphar(Tused, rhotot, molefrac) * model.R(molefrac) * Tused * rhotot);
+        };
+        VectorType ret(6);
+        {
+            using adtype = autodiff::HigherOrderDual<3, double>;
+            adtype tau = 0.0, sigma_1 = 0.0, sigma_2 = 0.0;
+            ret[0] = derivatives(wrapper, wrt(tau, sigma_1, sigma_1), at(tau, sigma_1, sigma_2)).back();
+            ret[1] = derivatives(wrapper, wrt(tau, sigma_1, sigma_2), at(tau, sigma_1, sigma_2)).back();
+            ret[3] = derivatives(wrapper, wrt(sigma_1, sigma_1, sigma_2), at(tau, sigma_1, sigma_2)).back();
+            ret[4] = derivatives(wrapper, wrt(sigma_1, sigma_2, sigma_2), at(tau, sigma_1, sigma_2)).back();
+        }
+        {
+            using adtype = autodiff::HigherOrderDual<4, double>;
+            adtype tau = 0.0, sigma_1 = 0.0, sigma_2 = 0.0;
+            ret[2] = derivatives(wrapper, wrt(tau, sigma_1, sigma_1, sigma_1), at(tau, sigma_1, sigma_2)).back();
+            ret[5] = derivatives(wrapper, wrt(sigma_1, sigma_1, sigma_1, sigma_2), at(tau, sigma_1, sigma_2)).back();
+        }
+        return ret;
+    }
 };
 
 template<int Nderivsmax>
@@ -1520,18 +1926,22 @@ public:
         using tdx = TDXDerivatives<decltype(model), Scalar, VecType>;
         static_assert(Nderivsmax == 2, "It's gotta be 2 for now");
         
-        
-        auto AX02 = tdx::template get_Agen0n<2>(model, T, rho, z);
-        derivs(0, 0) = AX02[0];
-        derivs(0, 1) = AX02[1];
-        derivs(0, 2) = AX02[2];
-        
-        auto AX20 = tdx::template get_Agenn0<2>(model, T, rho, z);
-        derivs(0, 0) = AX20[0];
-        derivs(1, 0) = AX20[1];
-        derivs(2, 0) = AX20[2];
-        
-        derivs(1, 1) = tdx::template get_Agenxy<1,1>(model, T, rho, z);
+        if constexpr (HasAnalyticTDDerivatives<2, 2, Model, Scalar, VecType>){
+            derivs = model.template alphar_TDderivs<2, 2>(T, rho, z);
+        }
+        else{
+            auto AX02 = tdx::template get_Agen0n<2>(model, T, rho, z);
+            derivs(0, 0) = AX02[0];
+            derivs(0, 1) = AX02[1];
+            derivs(0, 2) = AX02[2];
+            
+            auto AX20 = tdx::template get_Agenn0<2>(model, T, rho, z);
+            derivs(0, 0) = AX20[0];
+            derivs(1, 0) = AX20[1];
+            derivs(2, 0) = AX20[2];
+            
+            derivs(1, 1) = tdx::template get_Agenxy<1,1>(model, T, rho, z);
+        }
     }
 };
 
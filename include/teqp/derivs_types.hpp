@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include "teqp/exceptions.hpp"
+
+namespace teqp{
+
+/**
+ \brief The derivatives of \f$\Psi^r = a^r\rho\f$ of one phase that are needed by the phase equilibrium solvers in the isochoric formalism
+
+ All the values are obtained in one sweep of second-order forward autodiff over the vector \f$[T, \rho_0, \rho_1, ...]\f$ (or only over the
+ molar concentrations if the temperature derivatives are not requested), so that the Newton solvers do not call the model separately for
+ the Hessian, the temperature derivatives of the gradient, and the temperature derivative of the pressure of the same phase.
+ */
+struct IsochoricDerivativeBundle {
+    double T = -1; ///< Temperature, in K
+    Eigen::ArrayXd rhovec; ///< Molar concentrations, in mol/m^3
+    double R = -1; ///< Molar gas constant at the composition of the phase
+    bool has_T_derivatives = false; ///< True if dPsirdT and d2PsirdTdrhovec were calculated
+
+    double Psir = 0; ///< \f$\Psi^r\f$
+    Eigen::ArrayXd gradient_Psir; ///< \f$\partial\Psi^r/\partial\rho_i\f$
+    Eigen::MatrixXd Hessian_Psir; ///< \f$\partial^2\Psi^r/\partial\rho_i\partial\rho_j\f$
+    double dPsirdT = 0; ///< \f$\partial\Psi^r/\partial T\f$ at constant molar concentrations
+    Eigen::ArrayXd d2PsirdTdrhovec; ///< \f$\partial^2\Psi^r/\partial T\partial\rho_i\f$
+
+    /// Total molar density
+    double rho() const { return rhovec.sum(); }
+    /// Pressure
+    double p() const { return rho()*R*T - Psir + (rhovec*gradient_Psir).sum(); }
+    /// Derivatives of the pressure w.r.t. the molar concentrations at constant temperature
+    Eigen::ArrayXd dpdrhovec() const { return (R*T + (Hessian_Psir*rhovec.matrix()).array()).eval(); }
+    /// The Hessian of \f$\Psi=\Psi^{\rm ig}+\Psi^r\f$ w.r.t. the molar concentrations, the ideal-gas part only contributes on the diagonal
+    Eigen::MatrixXd Hessian_Psi() const {
+        Eigen::MatrixXd H = Hessian_Psir;
+        H.diagonal().array() += R*T/rhovec;
+        return H;
+    }
+    /// Derivative of the pressure w.r.t. temperature at constant molar concentrations
+    double dpdT() const {
+        require_T_derivatives();
+        return rho()*R - dPsirdT + (rhovec*d2PsirdTdrhovec).sum();
+    }
+    /// Temperature derivative of the chemical potential of each component (with the same missing ideal-gas contributions as in IsochoricDerivatives::get_dchempotdT_autodiff)
+    Eigen::ArrayXd dchempotdT() const {
+        require_T_derivatives();
+        return (d2PsirdTdrhovec + R*(1.0 + log(rhovec))).eval();
+    }
+private:
+    void require_T_derivatives() const {
+        if (!has_T_derivatives){
+            throw teqp::InvalidArgument("The temperature derivatives were not calculated for this derivative bundle");
+        }
+    }
+};
+
+/**
+ \brief The residual derivatives of a pure fluid that are needed for the common thermodynamic properties
+ 
+ The derivatives are given as
+ \f[
+ \Lambda^{\rm r}_{ij} = (1/T)^i\rho^j\left(\frac{\partial^{i+j}(\alpha^r)}{\partial(1/T)^i\partial\rho^j}\right)
+ \f]
+ for \f$i+j\leq 2\f$, as obtained from AbstractModel::pure_bundle
+ */
+struct PureDerivativeBundle {
+    double T = -1; ///< Temperature, in K
+    double rho = -1; ///< Molar density, in mol/m^3
+    double R = -1; ///< Molar gas constant
+    double Ar00 = 0, Ar01 = 0, Ar02 = 0, Ar10 = 0, Ar11 = 0, Ar20 = 0;
+    
+    /// Pressure
+    double p() const { return rho*R*T*(1.0 + Ar01); }
+    /// Derivative of the pressure w.r.t. the molar density at constant temperature
+    double dpdrho_T() const { return R*T*(1.0 + 2.0*Ar01 + Ar02); }
+    /// Derivative of the pressure w.r.t. temperature at constant molar density
+    double dpdT_rho() const { return rho*R*(1.0 + Ar01 - Ar11); }
+    /// Residual molar entropy
+    double sr() const { return R*(Ar10 - Ar00); }
+    /// Residual molar enthalpy
+    double hr() const { return R*T*(Ar10 + Ar01); }
+    /// Residual molar isochoric heat capacity
+    double cvr() const { return -R*Ar20; }
+};
+
+}
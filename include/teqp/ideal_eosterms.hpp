@@ -1,6 +1,7 @@
 #pragma once
 #include <variant>
 #include <filesystem>
+#include <array>
 
 #include "teqp/types.hpp"
 #include "teqp/exceptions.hpp"
@@ -8,6 +9,90 @@
 
 namespace teqp {
 
+    /**
+     The analytic temperature derivatives of the ideal-gas terms are returned as
+     
+     \f$ A^{\rm ig}_{n0} = (1/T)^n\left(\frac{\partial^n\alpha^{\rm ig}}{\partial(1/T)^n}\right) \f$
+     
+     for n = 0, ..., N, the same quantities that TDXDerivatives::get_Arn0 obtains with automatic differentiation
+     */
+    template<int N>
+    using IdealTDerivs = Eigen::Array<double, N+1, 1>;
+
+    namespace detail{
+    
+        /**
+         For a function f(y) whose derivative s = f'(y) satisfies the Riccati equation \f$ s' = a_0 + a_1s + a_2s^2 \f$,
+         each derivative \f$ d^{k+1}f/dy^{k+1} = P_k(s) \f$ is a polynomial in s of degree k+1. Returns the coefficients 
+         of \f$P_k\f$ for k = 0, ..., N-1, in increasing powers of s
+         */
+        template<int N>
+        constexpr auto riccati_polynomials(double a0, double a1, double a2){
+            std::array<std::array<double, N+1>, N> P{};
+            if constexpr (N > 0){
+                P[0][1] = 1.0;
+                for (auto k = 1; k < N; ++k){
+                    // d/dy s^m = m*s^(m-1)*(a0 + a1*s + a2*s^2)
+                    for (auto m = 1; m <= k; ++m){
+                        double dm = m*P[k-1][m];
+                        P[k][m-1] += dm*a0;
+                        P[k][m] += dm*a1;
+                        P[k][m+1] += dm*a2;
+                    }
+                }
+            }
+            return P;
+        }
+    
+        /**
+         Sum of the terms \f$ n_i f(\theta_i/T) \f$ and their derivatives, where f'(y) = s(y) satisfies a Riccati equation 
+         (see riccati_polynomials) and s(y) is given in s. Since y = \f$\theta_i(1/T)\f$, the derivatives
+         in 1/T multiplied by \f$(1/T)^k\f$ are \f$ y^k d^kf/dy^k \f$
+         */
+        template<int N>
+        void add_riccati_Tderivs(IdealTDerivs<N>& A, const Eigen::ArrayXd& n, const Eigen::ArrayXd& y, const Eigen::ArrayXd& s, double a0, double a1, double a2){
+            auto coeffs = riccati_polynomials<N>(a0, a1, a2);
+            Eigen::ArrayXd ypowk = n;
+            for (auto k = 1; k <= N; ++k){
+                ypowk *= y;
+                // Horner's method for the polynomial in s
+                const auto& c = coeffs[k-1];
+                Eigen::ArrayXd poly = Eigen::ArrayXd::Constant(s.size(), c[k]);
+                for (auto m = k-1; m >= 0; --m){
+                    poly = poly*s + c[m];
+                }
+                A[k] += (ypowk*poly).sum();
+            }
+        }
+    
+        /// \f$ (1/T)^k d^k(\ln(1/T))/d(1/T)^k = (-1)^{k-1}(k-1)! \f$ for k > 0
+        inline double log_Trecip_derivative(int k){
+            double val = 1.0;
+            for (auto j = 1; j < k; ++j){ val *= -j; }
+            return val;
+        }
+        
+        /// \f$ (1/T)^k d^k(T^t)/d(1/T)^k = (-t)(-t-1)\cdots(-t-k+1)T^t \f$
+        inline double power_Trecip_factor(double t, int k){
+            double val = 1.0;
+            for (auto j = 0; j < k; ++j){ val *= (-t - j); }
+            return val;
+        }
+    
+        /// The elements of a followed by those of b
+        inline std::valarray<double> concatenate(const std::valarray<double>& a, const std::valarray<double>& b){
+            std::valarray<double> o(a.size() + b.size());
+            o[std::slice(0, a.size(), 1)] = a;
+            o[std::slice(a.size(), b.size(), 1)] = b;
+            return o;
+        }
+    
+        /// View a std::valarray as an Eigen array without copying
+        inline auto as_array(const std::valarray<double>& v){
+            return Eigen::Map<const Eigen::ArrayXd>(std::begin(v), static_cast<Eigen::Index>(v.size()));
+        }
+    }
+
     /**
     \f$ \alpha^{\rm ig}= a \f$
     */
@@ -21,6 +106,13 @@ namespace teqp {
             using otype = std::common_type_t <TType, RhoType>;
             return forceeval(static_cast<otype>(a));
         }
+        
+        template<int N>
+        auto alphaig_Tderivs(double /*T*/, double /*rho*/) const {
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            A[0] = a;
+            return A;
+        }
     };
 
     /**
@@ -42,6 +134,17 @@ namespace teqp {
             using otype = std::common_type_t <TType, RhoType>;
             return forceeval(static_cast<otype>(a * log(T)));
         }
+        
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            // a*ln(T) = -a*ln(1/T)
+            IdealTDerivs<N> A;
+            A[0] = a*log(T);
+            for (auto k = 1; k <= N; ++k){
+                A[k] = -a*detail::log_Trecip_derivative(k);
+            }
+            return A;
+        }
     };
 
     /**
@@ -65,6 +168,16 @@ namespace teqp {
             using otype = std::common_type_t <TType, RhoType>;
             return forceeval(static_cast<otype>(log(rho) + a_1 + a_2 / T));
         }
+        
+        template<int N>
+        auto alphaig_Tderivs(double T, double rho) const {
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            A[0] = log(rho) + a_1 + a_2 / T;
+            if constexpr (N > 0){
+                A[1] = a_2 / T;
+            }
+            return A;
+        }
     };
 
     /**
@@ -84,6 +197,23 @@ namespace teqp {
             }
             return forceeval(summer);
         }
+        
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            for (auto i = 0U; i < n.size(); ++i) {
+                double val = n[i] * pow(T, t[i]);
+                for (auto k = 0; k <= N; ++k){
+                    A[k] += detail::power_Trecip_factor(t[i], k)*val;
+                }
+            }
+            return A;
+        }
+
+        /// A single term with the coefficients of this term and the other one
+        auto merged_with(const IdealHelmholtzPowerT& other) const {
+            return IdealHelmholtzPowerT(detail::concatenate(n, other.n), detail::concatenate(t, other.t), R);
+        }
     };
 
     /**
@@ -103,6 +233,22 @@ namespace teqp {
             }
             return forceeval(summer);
         }
+        
+        /// With \f$ y=\theta/T \f$, the derivative of \f$ \ln(1-\exp(-y)) \f$ is \f$ s = 1/(\exp(y)-1) \f$, and \f$ s' = -s-s^2 \f$
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            Eigen::ArrayXd y = detail::as_array(theta)/T;
+            A[0] = (detail::as_array(n)*log(1.0 - exp(-y))).sum();
+            Eigen::ArrayXd s = 1.0/(exp(y) - 1.0);
+            detail::add_riccati_Tderivs<N>(A, detail::as_array(n), y, s, 0.0, -1.0, -1.0);
+            return A;
+        }
+
+        /// A single term with the coefficients of this term and the other one
+        auto merged_with(const IdealHelmholtzPlanckEinstein& other) const {
+            return IdealHelmholtzPlanckEinstein(detail::concatenate(n, other.n), detail::concatenate(theta, other.theta), R);
+        }
     };
 
     /**
@@ -128,6 +274,23 @@ namespace teqp {
             }
             return forceeval(summer);
         }
+        
+        /// With \f$ y=\theta/T \f$, the derivative of \f$ \ln(c+d\exp(y)) \f$ is \f$ s = d\exp(y)/(c+d\exp(y)) \f$, and \f$ s' = s-s^2 \f$
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            Eigen::ArrayXd y = detail::as_array(theta)/T;
+            Eigen::ArrayXd dexpy = detail::as_array(d)*exp(y), denom = detail::as_array(c) + dexpy;
+            A[0] = (detail::as_array(n)*log(denom)).sum();
+            Eigen::ArrayXd s = dexpy/denom;
+            detail::add_riccati_Tderivs<N>(A, detail::as_array(n), y, s, 0.0, 1.0, -1.0);
+            return A;
+        }
+
+        /// A single term with the coefficients of this term and the other one
+        auto merged_with(const IdealHelmholtzPlanckEinsteinGeneralized& other) const {
+            return IdealHelmholtzPlanckEinsteinGeneralized(detail::concatenate(n, other.n), detail::concatenate(c, other.c), detail::concatenate(d, other.d), detail::concatenate(theta, other.theta), R);
+        }
     };
 
     /**
@@ -151,6 +314,22 @@ namespace teqp {
             }
             return forceeval(summer);
         }
+        
+        /// With \f$ y=\theta/T \f$, the derivative of \f$ \ln(|\cosh(y)|) \f$ is \f$ s = \tanh(y) \f$, and \f$ s' = 1-s^2 \f$
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            Eigen::ArrayXd y = detail::as_array(theta)/T;
+            A[0] = (detail::as_array(n)*log(abs(cosh(y)))).sum();
+            Eigen::ArrayXd s = tanh(y);
+            detail::add_riccati_Tderivs<N>(A, detail::as_array(n), y, s, 1.0, 0.0, -1.0);
+            return A;
+        }
+
+        /// A single term with the coefficients of this term and the other one
+        auto merged_with(const IdealHelmholtzGERG2004Cosh& other) const {
+            return IdealHelmholtzGERG2004Cosh(detail::concatenate(n, other.n), detail::concatenate(theta, other.theta), R);
+        }
     };
 
     /**
@@ -174,6 +353,22 @@ namespace teqp {
             }
             return forceeval(summer);
         }
+        
+        /// With \f$ y=\theta/T \f$, the derivative of \f$ \ln(|\sinh(y)|) \f$ is \f$ s = \coth(y) \f$, and \f$ s' = 1-s^2 \f$
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            Eigen::ArrayXd y = detail::as_array(theta)/T;
+            A[0] = (detail::as_array(n)*log(abs(sinh(y)))).sum();
+            Eigen::ArrayXd s = 1.0/tanh(y);
+            detail::add_riccati_Tderivs<N>(A, detail::as_array(n), y, s, 1.0, 0.0, -1.0);
+            return A;
+        }
+
+        /// A single term with the coefficients of this term and the other one
+        auto merged_with(const IdealHelmholtzGERG2004Sinh& other) const {
+            return IdealHelmholtzGERG2004Sinh(detail::concatenate(n, other.n), detail::concatenate(theta, other.theta), R);
+        }
     };
 
     /**
@@ -198,6 +393,20 @@ namespace teqp {
                 c*((T-T_0)/T-log(T/T_0))
             ));
         }
+        
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            // c*(1 - T_0/T + ln(1/T) + ln(T_0))
+            IdealTDerivs<N> A;
+            A[0] = c*((T-T_0)/T-log(T/T_0));
+            for (auto k = 1; k <= N; ++k){
+                A[k] = c*detail::log_Trecip_derivative(k);
+            }
+            if constexpr (N > 0){
+                A[1] -= c*T_0/T;
+            }
+            return A;
+        }
     };
 
     /**
@@ -222,6 +431,20 @@ namespace teqp {
                 c*(pow(T,t)*(1/(t+1)-1/t) - pow(T_0,t+1)/(T*(t+1)) + pow(T_0,t)/t)
             ));
         }
+        
+        template<int N>
+        auto alphaig_Tderivs(double T, double /*rho*/) const {
+            IdealTDerivs<N> A;
+            A[0] = c*(pow(T,t)*(1/(t+1)-1/t) - pow(T_0,t+1)/(T*(t+1)) + pow(T_0,t)/t);
+            double powterm = c*pow(T,t)*(1/(t+1)-1/t);
+            for (auto k = 1; k <= N; ++k){
+                A[k] = detail::power_Trecip_factor(t, k)*powterm;
+            }
+            if constexpr (N > 0){
+                A[1] -= c*pow(T_0,t+1)/(T*(t+1));
+            }
+            return A;
+        }
     };
 
     // The collection of possible terms that could be part of the summation
@@ -286,6 +509,33 @@ namespace teqp {
                     throw InvalidArgument("Don't understand this type: " + term.at("type").get<std::string>());
                 }
             }
+            merge_array_terms();
+        }
+        
+        /**
+         The terms that are sums over arrays of coefficients (power and Planck-Einstein-like terms) are merged so that 
+         there is at most one term of each of these kinds, whose coefficients are stored contiguously
+         */
+        void merge_array_terms(){
+            std::vector<IdealHelmholtzTerms> merged;
+            for (const auto& term : contributions){
+                bool absorbed = std::visit([&merged](const auto& t){
+                    using T = std::decay_t<decltype(t)>;
+                    if constexpr (requires { t.merged_with(t); }){
+                        for (auto& existing : merged){
+                            if (std::holds_alternative<T>(existing)){
+                                existing.template emplace<T>(std::get<T>(existing).merged_with(t));
+                                return true;
+                            }
+                        }
+                    }
+                    return false;
+                }, term);
+                if (!absorbed){
+                    merged.push_back(term);
+                }
+            }
+            contributions.swap(merged);
         }
         
         template<typename TType, typename RhoType>
@@ -297,6 +547,16 @@ namespace teqp {
             }
             return ig;
         }
+        
+        /// The analytic temperature derivatives \f$A^{\rm ig}_{n0}\f$ for n = 0, ..., N
+        template<int N>
+        auto alphaig_Tderivs(double T, double rho) const{
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            for (const auto& term : contributions) {
+                A += std::visit([&](auto& t) { return t.template alphaig_Tderivs<N>(T, rho); }, term);
+            }
+            return A;
+        }
     };
 
     /**
@@ -341,6 +601,30 @@ namespace teqp {
             return ig;
         }
         
+        /**
+         The analytic temperature derivatives \f$A^{\rm ig}_{n0}\f$ for n = 0, ..., N, with the same layout as the result of
+         TDXDerivatives::get_Arn0, which uses them in place of automatic differentiation
+         */
+        template<int N, typename MoleFrac>
+        auto alphaig_Tderivs(double T, double rho, const MoleFrac &molefrac) const {
+            if (static_cast<std::size_t>(molefrac.size()) != pures.size()){
+                throw teqp::InvalidArgument("molefrac and pures are not the same length");
+            }
+            IdealTDerivs<N> A = IdealTDerivs<N>::Zero();
+            std::size_t i = 0;
+            for (auto &pure : pures){
+                double x = getbaseval(molefrac[i]);
+                if (x != 0){
+                    A += x*pure.template alphaig_Tderivs<N>(T, rho);
+                    A[0] += x*log(x);
+                }
+                i++;
+            }
+            std::valarray<double> o(N+1);
+            for (auto n = 0; n <= N; ++n){ o[n] = A[n]; }
+            return o;
+        }
+        
         /// This pass-through function is required to allow this model to sit in the AllowedModels variant
         /// which allows the ideal-gas Helmholtz terms to be treated just the same as the residual terms
         template<typename TType, typename RhoType, typename MoleFrac>
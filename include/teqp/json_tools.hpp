@@ -70,6 +70,29 @@ namespace teqp{
         }
     };
 
+    /// Split a JSON pointer like "/coeffs/0/m" into its (unescaped) reference tokens, here {"coeffs", "0", "m"}
+    inline auto split_JSON_pointer(const std::string& pointer){
+        nlohmann::json::json_pointer ptr(pointer);
+        std::vector<std::string> tokens;
+        while (!ptr.empty()){
+            tokens.insert(tokens.begin(), ptr.back());
+            ptr.pop_back();
+        }
+        return tokens;
+    }
+
+    /// Convert a reference token of a JSON pointer to an array index, which must be less than N
+    inline std::size_t JSON_pointer_index(const std::string& token, std::size_t N){
+        if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos){
+            throw teqp::InvalidArgument("JSON pointer token \"" + token + "\" is not an array index");
+        }
+        auto i = std::stoul(token);
+        if (i >= N){
+            throw teqp::InvalidArgument("JSON pointer index " + token + " is out of range; there are " + std::to_string(N) + " entries");
+        }
+        return i;
+    }
+
     /**
     A method for loading something from a nlohmann::json node. Thing to be operated on can be:
     
@@ -0,0 +1,235 @@
+#pragma once
+
+/**
+ A tape-based reverse-mode (adjoint) automatic differentiation number type
+
+ Each operation on an AdjointVar records the partial derivatives of its result with respect to
+ its (at most two) arguments on a thread-local tape. The gradient of a scalar result with respect
+ to all the independent variables is then obtained with one reverse sweep over the tape, so it
+ costs a small multiple of one evaluation of the function, irrespective of the number of variables.
+
+ The tape keeps its capacity between evaluations, so after the first evaluation no heap
+ allocation is carried out. A number with a negative index is a constant, and is not recorded.
+ */
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include "Eigen/Dense"
+
+namespace teqp {
+
+// The functions live in their own namespace so that they are only found by argument-dependent
+// lookup, and do not hide the overloads for double in the rest of teqp
+namespace adjoint {
+
+/// The partial derivatives of the result of an operation w.r.t. its arguments; a negative parent is unused
+struct TapeEntry {
+    int parent0, parent1;
+    double partial0, partial1;
+};
+
+class Tape {
+private:
+    std::vector<TapeEntry> entries;
+public:
+    int push(int parent0, double partial0, int parent1 = -1, double partial1 = 0.0){
+        entries.push_back({parent0, parent1, partial0, partial1});
+        return static_cast<int>(entries.size()) - 1;
+    }
+    auto size() const { return entries.size(); }
+    /// Drop the entries after the first n, keeping the capacity
+    void truncate(std::size_t n){ entries.resize(n); }
+    const auto& get_entries() const { return entries; }
+};
+
+/// The tape that the operations in this thread are recorded on
+inline Tape& get_tape(){
+    thread_local Tape tape;
+    return tape;
+}
+
+/// Removes everything that was recorded on the tape during the lifetime of the guard
+class TapeGuard {
+private:
+    Tape& tape;
+    const std::size_t n;
+public:
+    TapeGuard(Tape& tape = get_tape()) : tape(tape), n(tape.size()) {}
+    ~TapeGuard(){ tape.truncate(n); }
+};
+
+struct AdjointVar {
+    double val = 0.0; ///< The value
+    int index = -1; ///< The index of the entry on the tape, negative for a constant
+
+    AdjointVar() = default;
+    AdjointVar(double v) : val(v) {}
+    AdjointVar(int v) : val(static_cast<double>(v)) {}
+    AdjointVar(double v, int index) : val(v), index(index) {}
+
+    /// Make an independent variable with value v
+    static auto variable(double v){
+        return AdjointVar(v, get_tape().push(-1, 0.0));
+    }
+    bool is_constant() const { return index < 0; }
+
+    /// The result of \f$f(x)\f$ given the values of \f$f\f$ and \f$f'\f$ at the value of x
+    auto chain(double f0, double f1) const {
+        if (is_constant()){ return AdjointVar(f0); }
+        return AdjointVar(f0, get_tape().push(index, f1));
+    }
+
+    AdjointVar operator-() const { return chain(-val, -1.0); }
+
+    AdjointVar& operator+=(const AdjointVar& b);
+    AdjointVar& operator-=(const AdjointVar& b);
+    AdjointVar& operator*=(const AdjointVar& b);
+    AdjointVar& operator/=(const AdjointVar& b);
+};
+
+/// The result of \f$f(a,b)\f$ given the value of \f$f\f$ and its partial derivatives at the values of a and b
+inline auto chain2(const AdjointVar& a, const AdjointVar& b, double f0, double fa, double fb){
+    if (a.is_constant()){ return b.chain(f0, fb); }
+    if (b.is_constant()){ return a.chain(f0, fa); }
+    return AdjointVar(f0, get_tape().push(a.index, fa, b.index, fb));
+}
+
+inline auto operator+(const AdjointVar& a, const AdjointVar& b){ return chain2(a, b, a.val+b.val, 1.0, 1.0); }
+inline auto operator-(const AdjointVar& a, const AdjointVar& b){ return chain2(a, b, a.val-b.val, 1.0, -1.0); }
+inline auto operator*(const AdjointVar& a, const AdjointVar& b){ return chain2(a, b, a.val*b.val, b.val, a.val); }
+inline auto operator/(const AdjointVar& a, const AdjointVar& b){ const double q = a.val/b.val; return chain2(a, b, q, 1.0/b.val, -q/b.val); }
+inline auto operator+(const AdjointVar& a, double b){ return a.chain(a.val+b, 1.0); }
+inline auto operator-(const AdjointVar& a, double b){ return a.chain(a.val-b, 1.0); }
+inline auto operator*(const AdjointVar& a, double b){ return a.chain(a.val*b, b); }
+inline auto operator/(const AdjointVar& a, double b){ return a.chain(a.val/b, 1.0/b); }
+inline auto operator+(double a, const AdjointVar& b){ return b.chain(a+b.val, 1.0); }
+inline auto operator-(double a, const AdjointVar& b){ return b.chain(a-b.val, -1.0); }
+inline auto operator*(double a, const AdjointVar& b){ return b.chain(a*b.val, a); }
+inline auto operator/(double a, const AdjointVar& b){ const double q = a/b.val; return b.chain(q, -q/b.val); }
+
+inline AdjointVar& AdjointVar::operator+=(const AdjointVar& b){ return *this = *this + b; }
+inline AdjointVar& AdjointVar::operator-=(const AdjointVar& b){ return *this = *this - b; }
+inline AdjointVar& AdjointVar::operator*=(const AdjointVar& b){ return *this = *this * b; }
+inline AdjointVar& AdjointVar::operator/=(const AdjointVar& b){ return *this = *this / b; }
+
+// Comparisons are made on the values
+#define TEQP_ADJOINT_COMPARISON(op) \
+inline bool operator op(const AdjointVar& a, const AdjointVar& b){ return a.val op b.val; } \
+inline bool operator op(const AdjointVar& a, double b){ return a.val op b; } \
+inline bool operator op(double a, const AdjointVar& b){ return a op b.val; }
+TEQP_ADJOINT_COMPARISON(<)
+TEQP_ADJOINT_COMPARISON(>)
+TEQP_ADJOINT_COMPARISON(<=)
+TEQP_ADJOINT_COMPARISON(>=)
+TEQP_ADJOINT_COMPARISON(==)
+TEQP_ADJOINT_COMPARISON(!=)
+#undef TEQP_ADJOINT_COMPARISON
+
+inline auto exp(const AdjointVar& x){ const double e = std::exp(x.val); return x.chain(e, e); }
+inline auto expm1(const AdjointVar& x){ return x.chain(std::expm1(x.val), std::exp(x.val)); }
+inline auto log(const AdjointVar& x){ return x.chain(std::log(x.val), 1.0/x.val); }
+inline auto log1p(const AdjointVar& x){ return x.chain(std::log1p(x.val), 1.0/(1.0+x.val)); }
+inline auto sqrt(const AdjointVar& x){ const double s = std::sqrt(x.val); return x.chain(s, 0.5/s); }
+inline auto cbrt(const AdjointVar& x){ const double c = std::cbrt(x.val); return x.chain(c, c/(3.0*x.val)); }
+inline auto sin(const AdjointVar& x){ return x.chain(std::sin(x.val), std::cos(x.val)); }
+inline auto cos(const AdjointVar& x){ return x.chain(std::cos(x.val), -std::sin(x.val)); }
+inline auto tan(const AdjointVar& x){ const double t = std::tan(x.val); return x.chain(t, 1.0+t*t); }
+inline auto sinh(const AdjointVar& x){ return x.chain(std::sinh(x.val), std::cosh(x.val)); }
+inline auto cosh(const AdjointVar& x){ return x.chain(std::cosh(x.val), std::sinh(x.val)); }
+inline auto tanh(const AdjointVar& x){ const double t = std::tanh(x.val); return x.chain(t, 1.0-t*t); }
+inline auto atan(const AdjointVar& x){ return x.chain(std::atan(x.val), 1.0/(1.0+x.val*x.val)); }
+inline auto abs(const AdjointVar& x){ return (x.val < 0) ? -x : x; }
+
+inline auto pow(const AdjointVar& x, double e){
+    if (e == 0.0){ return AdjointVar(1.0); }
+    if (e == 1.0){ return x; }
+    const double p = std::pow(x.val, e-1.0);
+    return x.chain(p*x.val, e*p);
+}
+inline auto pow(const AdjointVar& x, int e){
+    if (e == 0){ return AdjointVar(1.0); }
+    if (e == 1){ return x; }
+    const double p = std::pow(x.val, e-1);
+    return x.chain(p*x.val, e*p);
+}
+inline auto pow(const AdjointVar& x, const AdjointVar& e){
+    if (e.is_constant()){ return pow(x, e.val); }
+    const double p = std::pow(x.val, e.val);
+    return chain2(x, e, p, e.val*std::pow(x.val, e.val-1.0), p*std::log(x.val));
+}
+inline auto pow(double x, const AdjointVar& e){
+    const double p = std::pow(x, e.val);
+    return e.chain(p, p*std::log(x));
+}
+
+inline bool isfinite(const AdjointVar& x){ return std::isfinite(x.val); }
+
+/// Gradient of y w.r.t. the independent variables in x, from one reverse sweep over the tape
+template<typename Vars>
+Eigen::ArrayXd gradient(const AdjointVar& y, const Vars& x, const Tape& tape = get_tape()){
+    Eigen::ArrayXd g = Eigen::ArrayXd::Zero(x.size());
+    if (y.is_constant()){ return g; }
+    int base = y.index;
+    for (auto i = 0; i < x.size(); ++i){
+        if (!x[i].is_constant()){ base = std::min(base, x[i].index); }
+    }
+    // Adjoints of the entries on [base, y.index], thread-local to be re-used between calls
+    thread_local std::vector<double> adj;
+    adj.assign(static_cast<std::size_t>(y.index - base + 1), 0.0);
+    adj.back() = 1.0;
+    const auto& entries = tape.get_entries();
+    for (auto k = y.index; k >= base; --k){
+        const double a = adj[k - base];
+        if (a == 0.0){ continue; }
+        const auto& e = entries[k];
+        if (e.parent0 >= base){ adj[e.parent0 - base] += e.partial0*a; }
+        if (e.parent1 >= base){ adj[e.parent1 - base] += e.partial1*a; }
+    }
+    for (auto i = 0; i < x.size(); ++i){
+        if (!x[i].is_constant()){ g[i] = adj[x[i].index - base]; }
+    }
+    return g;
+}
+
+} // namespace adjoint
+
+using adjoint::AdjointVar;
+
+template<typename T> struct is_adjointvar_t : public std::false_type {};
+template<> struct is_adjointvar_t<AdjointVar> : public std::true_type {};
+
+/// Models whose alphar has been checked to work with AdjointVar opt in to reverse-mode derivatives by specializing this trait
+template<typename Model> struct supports_adjoint_t : public std::false_type {};
+
+} // namespace teqp
+
+namespace std {
+template<> struct common_type<teqp::AdjointVar, double> { using type = teqp::AdjointVar; };
+template<> struct common_type<double, teqp::AdjointVar> { using type = teqp::AdjointVar; };
+}
+
+namespace Eigen {
+template<>
+struct NumTraits<teqp::AdjointVar> : NumTraits<double> {
+    using Real = teqp::AdjointVar;
+    using NonInteger = teqp::AdjointVar;
+    using Nested = teqp::AdjointVar;
+    using Literal = double;
+    enum {
+        IsComplex = 0,
+        IsInteger = 0,
+        IsSigned = 1,
+        RequireInitialization = 1,
+        ReadCost = 1,
+        AddCost = 3,
+        MulCost = 3
+    };
+};
+template<typename BinOp>
+struct ScalarBinaryOpTraits<teqp::AdjointVar, double, BinOp> { using ReturnType = teqp::AdjointVar; };
+template<typename BinOp>
+struct ScalarBinaryOpTraits<double, teqp::AdjointVar, BinOp> { using ReturnType = teqp::AdjointVar; };
+}
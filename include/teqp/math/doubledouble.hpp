@@ -0,0 +1,322 @@
+#pragma once
+
+/**
+ A double-double number type, carrying about 32 significant decimal digits
+
+ A number is stored as the unevaluated sum of two doubles, hi + lo, with |lo| <= ulp(hi)/2. The arithmetic is built
+ from the error-free transformations of the sum and the product (the latter with a fused multiply-add), following:
+
+ Y. Hida, X. S. Li, D. H. Bailey, "Algorithms for quad-double precision floating point arithmetic", ARITH-15, 2001
+
+ so that an operation costs some tens of floating point operations in hardware, rather than the hundreds of operations of
+ a software floating point type of the same precision. The exponent range is that of double.
+ */
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "Eigen/Dense"
+
+namespace teqp {
+
+// The functions live in their own namespace so that they are only found by argument-dependent
+// lookup, and do not hide the overloads for double in the rest of teqp
+namespace doubledouble {
+
+struct DoubleDouble {
+    double hi = 0.0, lo = 0.0;
+
+    DoubleDouble() = default;
+    DoubleDouble(double x) : hi(x), lo(0.0) {}
+    DoubleDouble(int x) : hi(static_cast<double>(x)), lo(0.0) {}
+    DoubleDouble(double hi, double lo) : hi(hi), lo(lo) {}
+
+    explicit operator double() const { return hi + lo; }
+
+    DoubleDouble operator-() const { return {-hi, -lo}; }
+
+    DoubleDouble& operator+=(const DoubleDouble& b);
+    DoubleDouble& operator-=(const DoubleDouble& b);
+    DoubleDouble& operator*=(const DoubleDouble& b);
+    DoubleDouble& operator/=(const DoubleDouble& b);
+};
+
+namespace detail {
+/// The sum of a and b as hi + lo, where |a| >= |b|
+inline DoubleDouble quick_two_sum(double a, double b){
+    double s = a + b;
+    return {s, b - (s - a)};
+}
+/// The sum of a and b as hi + lo
+inline DoubleDouble two_sum(double a, double b){
+    double s = a + b, bb = s - a;
+    return {s, (a - (s - bb)) + (b - bb)};
+}
+/// The product of a and b as hi + lo
+inline DoubleDouble two_prod(double a, double b){
+    double p = a * b;
+    return {p, std::fma(a, b, -p)};
+}
+}
+
+inline DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b){
+    auto s = detail::two_sum(a.hi, b.hi), t = detail::two_sum(a.lo, b.lo);
+    s.lo += t.hi;
+    s = detail::quick_two_sum(s.hi, s.lo);
+    s.lo += t.lo;
+    return detail::quick_two_sum(s.hi, s.lo);
+}
+inline DoubleDouble operator+(const DoubleDouble& a, double b){
+    auto s = detail::two_sum(a.hi, b);
+    s.lo += a.lo;
+    return detail::quick_two_sum(s.hi, s.lo);
+}
+inline DoubleDouble operator*(const DoubleDouble& a, const DoubleDouble& b){
+    auto p = detail::two_prod(a.hi, b.hi);
+    p.lo += a.hi*b.lo + a.lo*b.hi;
+    return detail::quick_two_sum(p.hi, p.lo);
+}
+inline DoubleDouble operator*(const DoubleDouble& a, double b){
+    auto p = detail::two_prod(a.hi, b);
+    p.lo += a.lo*b;
+    return detail::quick_two_sum(p.hi, p.lo);
+}
+inline DoubleDouble operator/(const DoubleDouble& a, const DoubleDouble& b){
+    // Long division, with the remainder carried in double-double
+    double q1 = a.hi/b.hi;
+    auto r = a + (b*(-q1));
+    double q2 = r.hi/b.hi;
+    r = r + (b*(-q2));
+    double q3 = r.hi/b.hi;
+    return detail::quick_two_sum(q1, q2) + q3;
+}
+inline DoubleDouble operator/(const DoubleDouble& a, double b){
+    double q1 = a.hi/b;
+    auto p = detail::two_prod(q1, b);
+    auto r = a + (-p);
+    double q2 = r.hi/b;
+    r = r + (detail::two_prod(q2, b)*(-1.0));
+    double q3 = r.hi/b;
+    return detail::quick_two_sum(q1, q2) + q3;
+}
+inline DoubleDouble operator+(double a, const DoubleDouble& b){ return b + a; }
+inline DoubleDouble operator-(const DoubleDouble& a, const DoubleDouble& b){ return a + (-b); }
+inline DoubleDouble operator-(const DoubleDouble& a, double b){ return a + (-b); }
+inline DoubleDouble operator-(double a, const DoubleDouble& b){ return (-b) + a; }
+inline DoubleDouble operator*(double a, const DoubleDouble& b){ return b*a; }
+inline DoubleDouble operator/(double a, const DoubleDouble& b){ return DoubleDouble(a)/b; }
+
+inline DoubleDouble& DoubleDouble::operator+=(const DoubleDouble& b){ return *this = *this + b; }
+inline DoubleDouble& DoubleDouble::operator-=(const DoubleDouble& b){ return *this = *this - b; }
+inline DoubleDouble& DoubleDouble::operator*=(const DoubleDouble& b){ return *this = *this * b; }
+inline DoubleDouble& DoubleDouble::operator/=(const DoubleDouble& b){ return *this = *this / b; }
+
+// Comparisons are made on the normalized pairs
+#define TEQP_DOUBLEDOUBLE_COMPARISON(op) \
+inline bool operator op(const DoubleDouble& a, const DoubleDouble& b){ return (a.hi == b.hi) ? (a.lo op b.lo) : (a.hi op b.hi); } \
+inline bool operator op(const DoubleDouble& a, double b){ return (a.hi == b) ? (a.lo op 0.0) : (a.hi op b); } \
+inline bool operator op(double a, const DoubleDouble& b){ return (a == b.hi) ? (0.0 op b.lo) : (a op b.hi); }
+TEQP_DOUBLEDOUBLE_COMPARISON(<)
+TEQP_DOUBLEDOUBLE_COMPARISON(>)
+TEQP_DOUBLEDOUBLE_COMPARISON(<=)
+TEQP_DOUBLEDOUBLE_COMPARISON(>=)
+#undef TEQP_DOUBLEDOUBLE_COMPARISON
+inline bool operator==(const DoubleDouble& a, const DoubleDouble& b){ return a.hi == b.hi && a.lo == b.lo; }
+inline bool operator==(const DoubleDouble& a, double b){ return a.hi == b && a.lo == 0.0; }
+inline bool operator==(double a, const DoubleDouble& b){ return b == a; }
+inline bool operator!=(const DoubleDouble& a, const DoubleDouble& b){ return !(a == b); }
+inline bool operator!=(const DoubleDouble& a, double b){ return !(a == b); }
+inline bool operator!=(double a, const DoubleDouble& b){ return !(b == a); }
+
+namespace constants {
+inline const DoubleDouble ln2{6.931471805599452862e-01, 2.319046813846299558e-17};
+inline const DoubleDouble pi{3.141592653589793116e+00, 1.224646799147353207e-16};
+inline const DoubleDouble pi_2{1.570796326794896558e+00, 6.123233995736766036e-17};
+inline const DoubleDouble twopi{6.283185307179586232e+00, 2.449293598294706414e-16};
+}
+
+inline bool isfinite(const DoubleDouble& x){ return std::isfinite(x.hi); }
+inline bool isnan(const DoubleDouble& x){ return std::isnan(x.hi); }
+inline DoubleDouble abs(const DoubleDouble& x){ return (x.hi < 0) ? -x : x; }
+inline DoubleDouble fabs(const DoubleDouble& x){ return abs(x); }
+inline DoubleDouble ldexp(const DoubleDouble& x, int e){ return {std::ldexp(x.hi, e), std::ldexp(x.lo, e)}; }
+inline DoubleDouble floor(const DoubleDouble& x){
+    double hi = std::floor(x.hi);
+    return (hi == x.hi) ? detail::quick_two_sum(hi, std::floor(x.lo)) : DoubleDouble(hi);
+}
+
+namespace detail {
+/// \f$e^r-1\f$ for \f$|r|\leq\ln(2)/2\f$ from the Taylor series of \f$e^{r/512}-1\f$ and nine squarings
+inline DoubleDouble expm1_reduced(const DoubleDouble& r){
+    const auto s = ldexp(r, -9);
+    DoubleDouble sum = s, term = s;
+    for (auto k = 2; k < 12; ++k){
+        term = term*s/static_cast<double>(k);
+        sum += term;
+        if (std::abs(term.hi) < 1e-36*std::abs(sum.hi)){ break; }
+    }
+    // (1+x)^2 - 1 = 2x + x^2
+    for (auto i = 0; i < 9; ++i){
+        sum = ldexp(sum, 1) + sum*sum;
+    }
+    return sum;
+}
+/// The Taylor series of sin and cos for \f$|r|\leq\pi/4\f$
+inline std::pair<DoubleDouble, DoubleDouble> sincos_reduced(const DoubleDouble& r){
+    const auto r2 = r*r;
+    DoubleDouble s = r, c = 1.0, term_s = r, term_c = 1.0;
+    for (auto k = 1; k < 20; ++k){
+        term_s = -term_s*r2/static_cast<double>((2*k)*(2*k+1));
+        term_c = -term_c*r2/static_cast<double>((2*k-1)*(2*k));
+        s += term_s;
+        c += term_c;
+        if (std::abs(term_c.hi) < 1e-36 && std::abs(term_s.hi) < 1e-36){ break; }
+    }
+    return {s, c};
+}
+}
+
+inline DoubleDouble exp(const DoubleDouble& x){
+    if (x.hi > 709.78){ return std::numeric_limits<double>::infinity(); }
+    if (x.hi < -745.2){ return 0.0; }
+    // exp(x) = 2^m exp(r) with |r| <= ln(2)/2
+    const double m = std::floor(x.hi/constants::ln2.hi + 0.5);
+    const auto r = x - constants::ln2*m;
+    return ldexp(detail::expm1_reduced(r) + 1.0, static_cast<int>(m));
+}
+inline DoubleDouble expm1(const DoubleDouble& x){
+    if (std::abs(x.hi) <= 0.5*constants::ln2.hi){
+        return detail::expm1_reduced(x);
+    }
+    return exp(x) - 1.0;
+}
+inline DoubleDouble log(const DoubleDouble& x){
+    if (x.hi <= 0){ return (x.hi == 0) ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN(); }
+    // One Newton step on exp(y) = x from the double precision value doubles the number of correct digits
+    DoubleDouble y = std::log(x.hi);
+    return y + x*exp(-y) - 1.0;
+}
+inline DoubleDouble log1p(const DoubleDouble& x){
+    // The Newton step on expm1(y) = x keeps the relative precision for small x
+    DoubleDouble y = std::log1p(x.hi);
+    const auto em1 = expm1(y);
+    return y + (x - em1)/(em1 + 1.0);
+}
+inline DoubleDouble sqrt(const DoubleDouble& x){
+    if (x.hi <= 0){ return (x.hi == 0) ? DoubleDouble(0.0) : DoubleDouble(std::numeric_limits<double>::quiet_NaN()); }
+    // Karp's trick: one Newton step from the double precision value
+    const double r = 1.0/std::sqrt(x.hi), ax = x.hi*r;
+    const auto ax2 = detail::two_prod(ax, ax);
+    return detail::two_sum(ax, (x - ax2).hi*r*0.5);
+}
+inline DoubleDouble cbrt(const DoubleDouble& x){
+    if (x.hi == 0){ return 0.0; }
+    // One Newton step on y^3 = x from the double precision value
+    const DoubleDouble y = std::cbrt(x.hi);
+    return y - (y*y*y - x)/(3.0*y*y);
+}
+inline DoubleDouble pow(const DoubleDouble& x, int n){
+    if (n == 0){ return 1.0; }
+    DoubleDouble result = 1.0, base = x;
+    unsigned int e = (n < 0) ? static_cast<unsigned int>(-n) : static_cast<unsigned int>(n);
+    while (e > 0){
+        if (e & 1U){ result *= base; }
+        base *= base;
+        e >>= 1U;
+    }
+    return (n < 0) ? 1.0/result : result;
+}
+inline DoubleDouble pow(const DoubleDouble& x, const DoubleDouble& e){
+    if (e.lo == 0 && e.hi == std::floor(e.hi) && std::abs(e.hi) < 64){
+        return pow(x, static_cast<int>(e.hi));
+    }
+    return exp(e*log(x));
+}
+inline DoubleDouble pow(const DoubleDouble& x, double e){ return pow(x, DoubleDouble(e)); }
+inline DoubleDouble pow(double x, const DoubleDouble& e){ return pow(DoubleDouble(x), e); }
+
+inline DoubleDouble sin(const DoubleDouble& x){
+    // Reduction to |r| <= pi/4, and the quadrant j
+    const auto t = x - constants::twopi*std::floor(x.hi/constants::twopi.hi + 0.5);
+    const double j = std::floor(t.hi/constants::pi_2.hi + 0.5);
+    const auto [s, c] = detail::sincos_reduced(t - constants::pi_2*j);
+    switch (static_cast<int>(j)){
+        case 0: return s;
+        case 1: return c;
+        case -1: return -c;
+        default: return -s;
+    }
+}
+inline DoubleDouble cos(const DoubleDouble& x){
+    const auto t = x - constants::twopi*std::floor(x.hi/constants::twopi.hi + 0.5);
+    const double j = std::floor(t.hi/constants::pi_2.hi + 0.5);
+    const auto [s, c] = detail::sincos_reduced(t - constants::pi_2*j);
+    switch (static_cast<int>(j)){
+        case 0: return c;
+        case 1: return -s;
+        case -1: return s;
+        default: return -c;
+    }
+}
+inline DoubleDouble tan(const DoubleDouble& x){ return sin(x)/cos(x); }
+inline DoubleDouble atan(const DoubleDouble& x){
+    // One Newton step on tan(y) = x from the double precision value
+    const DoubleDouble y = std::atan(x.hi);
+    const auto c = cos(y);
+    return y + (x*c - sin(y))*c;
+}
+inline DoubleDouble sinh(const DoubleDouble& x){
+    const auto em1 = expm1(x);
+    return ldexp(em1 + em1/(em1 + 1.0), -1);
+}
+inline DoubleDouble cosh(const DoubleDouble& x){
+    const auto e = exp(x);
+    return ldexp(e + 1.0/e, -1);
+}
+inline DoubleDouble tanh(const DoubleDouble& x){
+    if (std::abs(x.hi) > 40){ return (x.hi > 0) ? 1.0 : -1.0; }
+    const auto em1 = expm1(ldexp(x, 1));
+    return em1/(em1 + 2.0);
+}
+
+} // namespace doubledouble
+
+using doubledouble::DoubleDouble;
+
+template<typename T> struct is_doubledouble_t : public std::false_type {};
+template<> struct is_doubledouble_t<DoubleDouble> : public std::true_type {};
+
+} // namespace teqp
+
+namespace std {
+template<> struct common_type<teqp::DoubleDouble, double> { using type = teqp::DoubleDouble; };
+template<> struct common_type<double, teqp::DoubleDouble> { using type = teqp::DoubleDouble; };
+}
+
+namespace Eigen {
+template<>
+struct NumTraits<teqp::DoubleDouble> : NumTraits<double> {
+    using Real = teqp::DoubleDouble;
+    using NonInteger = teqp::DoubleDouble;
+    using Nested = teqp::DoubleDouble;
+    using Literal = double;
+    enum {
+        IsComplex = 0,
+        IsInteger = 0,
+        IsSigned = 1,
+        RequireInitialization = 1,
+        ReadCost = 2,
+        AddCost = 20,
+        MulCost = 10
+    };
+    static inline double epsilon() { return 4.93038065763132e-32; } // 2^-104
+    static inline double dummy_precision() { return 1e-30; }
+    static inline int digits10() { return 31; }
+};
+template<typename BinOp>
+struct ScalarBinaryOpTraits<teqp::DoubleDouble, double, BinOp> { using ReturnType = teqp::DoubleDouble; };
+template<typename BinOp>
+struct ScalarBinaryOpTraits<double, teqp::DoubleDouble, BinOp> { using ReturnType = teqp::DoubleDouble; };
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+/**
+ A vector-mode second-order forward automatic differentiation number type
+
+ Each number carries its value, its gradient, and its Hessian with respect to a vector of
+ up to MaxN independent variables, so the full Hessian of a scalar function of N variables
+ is obtained from a single evaluation of the function rather than from the N(N+1)/2
+ evaluations that are needed with nested dual numbers. The Hessian is symmetric, so only
+ its upper triangle is propagated through the operations.
+
+ The storage is a fixed-capacity Eigen buffer on the stack, so no heap allocation is carried out
+ in the arithmetic. A number whose gradient is empty is a constant, and the operations
+ with constants skip the derivative propagation.
+ */
+
+#include <cmath>
+#include <type_traits>
+
+#include "Eigen/Dense"
+
+namespace teqp {
+
+// The functions live in their own namespace so that they are only found by argument-dependent
+// lookup, and do not hide the overloads for double in the rest of teqp
+namespace hyperdual {
+
+template<int MaxN>
+struct VectorHyperDual {
+    using GradType = Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, MaxN, 1>;
+    using HessType = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MaxN, MaxN>;
+
+    double val = 0.0; ///< The value
+    GradType grad; ///< The gradient, empty for a constant
+    HessType hess; ///< The Hessian, only the upper triangle is meaningful; the lower triangle is kept at zero so that the whole-matrix operations only read initialized values
+
+    VectorHyperDual() = default;
+    VectorHyperDual(double v) : val(v) {}
+    VectorHyperDual(int v) : val(static_cast<double>(v)) {}
+
+    /// Make the i-th of N independent variables, with value v
+    static auto variable(double v, Eigen::Index i, Eigen::Index N){
+        VectorHyperDual x(v);
+        x.grad = GradType::Zero(N);
+        x.hess = HessType::Zero(N, N);
+        x.grad[i] = 1.0;
+        return x;
+    }
+    bool is_constant() const { return grad.size() == 0; }
+    auto size() const { return grad.size(); }
+
+    /// The Hessian with the lower triangle filled in from the upper triangle
+    Eigen::MatrixXd get_Hessian() const {
+        Eigen::MatrixXd H = hess.template selfadjointView<Eigen::Upper>();
+        return H;
+    }
+
+    /// The result of \f$f(x)\f$ given the values of \f$f\f$, \f$f'\f$ and \f$f''\f$ at the value of x
+    auto chain(double f0, double f1, double f2) const {
+        VectorHyperDual r(f0);
+        if (is_constant()){ return r; }
+        const auto N = size();
+        r.grad = f1*grad;
+        r.hess.setZero(N, N);
+        for (auto j = 0; j < N; ++j){
+            const double c = f2*grad[j];
+            for (auto i = 0; i <= j; ++i){
+                r.hess(i, j) = f1*hess(i, j) + c*grad[i];
+            }
+        }
+        return r;
+    }
+
+    VectorHyperDual operator-() const {
+        VectorHyperDual r(-val);
+        if (!is_constant()){ r.grad = -grad; r.hess = -hess; }
+        return r;
+    }
+
+    VectorHyperDual& operator+=(const VectorHyperDual& b){
+        if (!b.is_constant()){
+            if (is_constant()){ grad = b.grad; hess = b.hess; }
+            else{ grad += b.grad; hess += b.hess; }
+        }
+        val += b.val;
+        return *this;
+    }
+    VectorHyperDual& operator-=(const VectorHyperDual& b){
+        if (!b.is_constant()){
+            if (is_constant()){ grad = -b.grad; hess = -b.hess; }
+            else{ grad -= b.grad; hess -= b.hess; }
+        }
+        val -= b.val;
+        return *this;
+    }
+    VectorHyperDual& operator*=(const VectorHyperDual& b);
+    VectorHyperDual& operator/=(const VectorHyperDual& b);
+
+    VectorHyperDual& operator+=(double b){ val += b; return *this; }
+    VectorHyperDual& operator-=(double b){ val -= b; return *this; }
+    VectorHyperDual& operator*=(double b){ val *= b; if (!is_constant()){ grad *= b; hess *= b; } return *this; }
+    VectorHyperDual& operator/=(double b){ return *this *= (1.0/b); }
+};
+
+template<int M> auto operator+(VectorHyperDual<M> a, const VectorHyperDual<M>& b){ return a += b; }
+template<int M> auto operator-(VectorHyperDual<M> a, const VectorHyperDual<M>& b){ return a -= b; }
+template<int M> auto operator+(VectorHyperDual<M> a, double b){ return a += b; }
+template<int M> auto operator-(VectorHyperDual<M> a, double b){ return a -= b; }
+template<int M> auto operator*(VectorHyperDual<M> a, double b){ return a *= b; }
+template<int M> auto operator/(VectorHyperDual<M> a, double b){ return a /= b; }
+template<int M> auto operator+(double a, VectorHyperDual<M> b){ return b += a; }
+template<int M> auto operator-(double a, const VectorHyperDual<M>& b){ return (-b) += a; }
+template<int M> auto operator*(double a, VectorHyperDual<M> b){ return b *= a; }
+
+template<int M>
+auto operator*(const VectorHyperDual<M>& a, const VectorHyperDual<M>& b){
+    if (a.is_constant()){ return a.val*b; }
+    if (b.is_constant()){ return a*b.val; }
+    const auto N = a.size();
+    VectorHyperDual<M> r(a.val*b.val);
+    r.grad = a.val*b.grad + b.val*a.grad;
+    r.hess.setZero(N, N);
+    for (auto j = 0; j < N; ++j){
+        const double agj = a.grad[j], bgj = b.grad[j];
+        for (auto i = 0; i <= j; ++i){
+            r.hess(i, j) = a.val*b.hess(i, j) + b.val*a.hess(i, j) + a.grad[i]*bgj + b.grad[i]*agj;
+        }
+    }
+    return r;
+}
+
+/// The quotient q = a/b follows from differentiating q*b = a twice
+template<int M>
+auto operator/(const VectorHyperDual<M>& a, const VectorHyperDual<M>& b){
+    if (b.is_constant()){ return a/b.val; }
+    const double binv = 1.0/b.val;
+    if (a.is_constant()){ return a.val*b.chain(binv, -binv*binv, 2.0*binv*binv*binv); }
+    const auto N = a.size();
+    const double q = a.val*binv;
+    VectorHyperDual<M> r(q);
+    r.grad = (a.grad - q*b.grad)*binv;
+    r.hess.setZero(N, N);
+    for (auto j = 0; j < N; ++j){
+        const double qgj = r.grad[j], bgj = b.grad[j];
+        for (auto i = 0; i <= j; ++i){
+            r.hess(i, j) = (a.hess(i, j) - q*b.hess(i, j) - r.grad[i]*bgj - b.grad[i]*qgj)*binv;
+        }
+    }
+    return r;
+}
+template<int M> auto operator/(double a, const VectorHyperDual<M>& b){ return VectorHyperDual<M>(a)/b; }
+
+template<int M> VectorHyperDual<M>& VectorHyperDual<M>::operator*=(const VectorHyperDual<M>& b){ return *this = *this*b; }
+template<int M> VectorHyperDual<M>& VectorHyperDual<M>::operator/=(const VectorHyperDual<M>& b){ return *this = *this/b; }
+
+// Comparisons are made on the values
+#define TEQP_VHD_COMPARISON(op) \
+template<int M> bool operator op(const VectorHyperDual<M>& a, const VectorHyperDual<M>& b){ return a.val op b.val; } \
+template<int M> bool operator op(const VectorHyperDual<M>& a, double b){ return a.val op b; } \
+template<int M> bool operator op(double a, const VectorHyperDual<M>& b){ return a op b.val; }
+TEQP_VHD_COMPARISON(<)
+TEQP_VHD_COMPARISON(>)
+TEQP_VHD_COMPARISON(<=)
+TEQP_VHD_COMPARISON(>=)
+TEQP_VHD_COMPARISON(==)
+TEQP_VHD_COMPARISON(!=)
+#undef TEQP_VHD_COMPARISON
+
+template<int M> auto exp(const VectorHyperDual<M>& x){ const double e = std::exp(x.val); return x.chain(e, e, e); }
+template<int M> auto expm1(const VectorHyperDual<M>& x){ const double e = std::exp(x.val); return x.chain(std::expm1(x.val), e, e); }
+template<int M> auto log(const VectorHyperDual<M>& x){ const double r = 1.0/x.val; return x.chain(std::log(x.val), r, -r*r); }
+template<int M> auto log1p(const VectorHyperDual<M>& x){ const double r = 1.0/(1.0+x.val); return x.chain(std::log1p(x.val), r, -r*r); }
+template<int M> auto sqrt(const VectorHyperDual<M>& x){ const double s = std::sqrt(x.val); return x.chain(s, 0.5/s, -0.25/(s*x.val)); }
+template<int M> auto cbrt(const VectorHyperDual<M>& x){ const double c = std::cbrt(x.val), d = c/(3.0*x.val); return x.chain(c, d, -2.0*d/(3.0*x.val)); }
+template<int M> auto sin(const VectorHyperDual<M>& x){ const double s = std::sin(x.val); return x.chain(s, std::cos(x.val), -s); }
+template<int M> auto cos(const VectorHyperDual<M>& x){ const double c = std::cos(x.val); return x.chain(c, -std::sin(x.val), -c); }
+template<int M> auto tan(const VectorHyperDual<M>& x){ const double t = std::tan(x.val), d = 1.0+t*t; return x.chain(t, d, 2.0*t*d); }
+template<int M> auto sinh(const VectorHyperDual<M>& x){ const double s = std::sinh(x.val); return x.chain(s, std::cosh(x.val), s); }
+template<int M> auto cosh(const VectorHyperDual<M>& x){ const double c = std::cosh(x.val); return x.chain(c, std::sinh(x.val), c); }
+template<int M> auto tanh(const VectorHyperDual<M>& x){ const double t = std::tanh(x.val), d = 1.0-t*t; return x.chain(t, d, -2.0*t*d); }
+template<int M> auto atan(const VectorHyperDual<M>& x){ const double d = 1.0/(1.0+x.val*x.val); return x.chain(std::atan(x.val), d, -2.0*x.val*d*d); }
+template<int M> auto abs(const VectorHyperDual<M>& x){ return (x.val < 0) ? -x : x; }
+
+template<int M> auto pow(const VectorHyperDual<M>& x, double e){
+    if (e == 0.0){ return VectorHyperDual<M>(1.0); }
+    if (e == 1.0){ return x; }
+    const double p = std::pow(x.val, e-2.0);
+    return x.chain(p*x.val*x.val, e*p*x.val, e*(e-1.0)*p);
+}
+template<int M> auto pow(const VectorHyperDual<M>& x, int e){
+    if (e == 0){ return VectorHyperDual<M>(1.0); }
+    if (e == 1){ return x; }
+    const double p = std::pow(x.val, e-2);
+    return x.chain(p*x.val*x.val, e*p*x.val, e*(e-1.0)*p);
+}
+template<int M> auto pow(const VectorHyperDual<M>& x, const VectorHyperDual<M>& e){
+    if (e.is_constant()){ return pow(x, e.val); }
+    return exp(e*log(x));
+}
+template<int M> auto pow(double x, const VectorHyperDual<M>& e){
+    const double p = std::pow(x, e.val), l = std::log(x);
+    return e.chain(p, p*l, p*l*l);
+}
+
+template<int M> bool isfinite(const VectorHyperDual<M>& x){ return std::isfinite(x.val); }
+
+} // namespace hyperdual
+
+using hyperdual::VectorHyperDual;
+
+template<typename T> struct is_vectorhyperdual_t : public std::false_type {};
+template<int M> struct is_vectorhyperdual_t<VectorHyperDual<M>> : public std::true_type {};
+
+} // namespace teqp
+
+namespace std {
+template<int M> struct common_type<teqp::VectorHyperDual<M>, double> { using type = teqp::VectorHyperDual<M>; };
+template<int M> struct common_type<double, teqp::VectorHyperDual<M>> { using type = teqp::VectorHyperDual<M>; };
+}
+
+namespace Eigen {
+template<int M>
+struct NumTraits<teqp::VectorHyperDual<M>> : NumTraits<double> {
+    using Real = teqp::VectorHyperDual<M>;
+    using NonInteger = teqp::VectorHyperDual<M>;
+    using Nested = teqp::VectorHyperDual<M>;
+    using Literal = double;
+    enum {
+        IsComplex = 0,
+        IsInteger = 0,
+        IsSigned = 1,
+        RequireInitialization = 1,
+        ReadCost = 1,
+        AddCost = 3,
+        MulCost = 3
+    };
+};
+template<int M, typename BinOp>
+struct ScalarBinaryOpTraits<teqp::VectorHyperDual<M>, double, BinOp> { using ReturnType = teqp::VectorHyperDual<M>; };
+template<int M, typename BinOp>
+struct ScalarBinaryOpTraits<double, teqp::VectorHyperDual<M>, BinOp> { using ReturnType = teqp::VectorHyperDual<M>; };
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+/**
+ A truncated univariate Taylor series number type, for derivatives of high order in one variable
+
+ The coefficient \f$c_k\f$ is the k-th derivative divided by \f$k!\f$. The arithmetic and the elementary functions propagate
+ the coefficients with the usual recurrences (see Griewank and Walther, "Evaluating Derivatives", 2nd ed., SIAM, 2008, ch. 13),
+ so that all the derivatives up to order N are obtained in O(N^2) operations of the scalar type. In contrast to
+ autodiff::Real, the scalar type may be any type with the arithmetic operators and elementary functions, for instance
+ DoubleDouble.
+ */
+
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+#include "Eigen/Dense"
+
+namespace teqp {
+
+// The functions live in their own namespace so that they are only found by argument-dependent
+// lookup, and do not hide the overloads for double in the rest of teqp
+namespace taylor {
+
+template<int N, typename Scalar = double>
+struct TaylorSeries {
+    std::array<Scalar, N+1> c; ///< The Taylor coefficients
+
+    TaylorSeries(){ c.fill(Scalar(0.0)); }
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> || std::is_same_v<T, Scalar>>>
+    TaylorSeries(const T& v){ c.fill(Scalar(0.0)); c[0] = static_cast<Scalar>(v); }
+
+    /// Make the independent variable with value v
+    static auto variable(const Scalar& v){
+        TaylorSeries x(v);
+        if constexpr (N > 0){ x.c[1] = 1.0; }
+        return x;
+    }
+    const Scalar& operator[](std::size_t k) const { return c[k]; }
+    Scalar& operator[](std::size_t k) { return c[k]; }
+    /// The k-th derivative w.r.t. the independent variable
+    Scalar derivative(int k) const {
+        Scalar f = c[k];
+        for (auto i = 2; i <= k; ++i){ f = f*static_cast<double>(i); }
+        return f;
+    }
+
+    TaylorSeries operator-() const { TaylorSeries r; for (auto k = 0; k <= N; ++k){ r.c[k] = -c[k]; } return r; }
+
+    TaylorSeries& operator+=(const TaylorSeries& b){ for (auto k = 0; k <= N; ++k){ c[k] += b.c[k]; } return *this; }
+    TaylorSeries& operator-=(const TaylorSeries& b){ for (auto k = 0; k <= N; ++k){ c[k] -= b.c[k]; } return *this; }
+    TaylorSeries& operator*=(const TaylorSeries& b);
+    TaylorSeries& operator/=(const TaylorSeries& b);
+};
+
+/// Scalars that can be combined with a TaylorSeries with scalar type S
+template<typename U, typename S>
+concept TaylorConstant = std::is_arithmetic_v<U> || std::is_same_v<U, S>;
+
+template<int N, typename S>
+auto operator+(const TaylorSeries<N, S>& a, const TaylorSeries<N, S>& b){ auto r = a; r += b; return r; }
+template<int N, typename S>
+auto operator-(const TaylorSeries<N, S>& a, const TaylorSeries<N, S>& b){ auto r = a; r -= b; return r; }
+template<int N, typename S>
+auto operator*(const TaylorSeries<N, S>& a, const TaylorSeries<N, S>& b){
+    TaylorSeries<N, S> r;
+    for (auto k = 0; k <= N; ++k){
+        S s = a.c[0]*b.c[k];
+        for (auto j = 1; j <= k; ++j){ s += a.c[j]*b.c[k-j]; }
+        r.c[k] = s;
+    }
+    return r;
+}
+template<int N, typename S>
+auto operator/(const TaylorSeries<N, S>& a, const TaylorSeries<N, S>& b){
+    TaylorSeries<N, S> r;
+    for (auto k = 0; k <= N; ++k){
+        S s = a.c[k];
+        for (auto j = 0; j < k; ++j){ s -= r.c[j]*b.c[k-j]; }
+        r.c[k] = s/b.c[0];
+    }
+    return r;
+}
+template<int N, typename S>
+TaylorSeries<N, S>& TaylorSeries<N, S>::operator*=(const TaylorSeries<N, S>& b){ return *this = *this * b; }
+template<int N, typename S>
+TaylorSeries<N, S>& TaylorSeries<N, S>::operator/=(const TaylorSeries<N, S>& b){ return *this = *this / b; }
+
+template<int N, typename S, TaylorConstant<S> U>
+auto operator+(const TaylorSeries<N, S>& a, const U& b){ auto r = a; r.c[0] = r.c[0] + b; return r; }
+template<int N, typename S, TaylorConstant<S> U>
+auto operator+(const U& a, const TaylorSeries<N, S>& b){ auto r = b; r.c[0] = a + r.c[0]; return r; }
+template<int N, typename S, TaylorConstant<S> U>
+auto operator-(const TaylorSeries<N, S>& a, const U& b){ auto r = a; r.c[0] = r.c[0] - b; return r; }
+template<int N, typename S, TaylorConstant<S> U>
+auto operator-(const U& a, const TaylorSeries<N, S>& b){ auto r = -b; r.c[0] = a + r.c[0]; return r; }
+template<int N, typename S, TaylorConstant<S> U>
+auto operator*(const TaylorSeries<N, S>& a, const U& b){ auto r = a; for (auto& ck : r.c){ ck = ck*b; } return r; }
+template<int N, typename S, TaylorConstant<S> U>
+auto operator*(const U& a, const TaylorSeries<N, S>& b){ auto r = b; for (auto& ck : r.c){ ck = a*ck; } return r; }
+template<int N, typename S, TaylorConstant<S> U>
+auto operator/(const TaylorSeries<N, S>& a, const U& b){ auto r = a; for (auto& ck : r.c){ ck = ck/b; } return r; }
+template<int N, typename S, TaylorConstant<S> U>
+auto operator/(const U& a, const TaylorSeries<N, S>& b){ return TaylorSeries<N, S>(a)/b; }
+
+// Comparisons are made on the values
+#define TEQP_TAYLOR_COMPARISON(op) \
+template<int N, typename S> bool operator op(const TaylorSeries<N, S>& a, const TaylorSeries<N, S>& b){ return a.c[0] op b.c[0]; } \
+template<int N, typename S, TaylorConstant<S> U> bool operator op(const TaylorSeries<N, S>& a, const U& b){ return a.c[0] op b; } \
+template<int N, typename S, TaylorConstant<S> U> bool operator op(const U& a, const TaylorSeries<N, S>& b){ return a op b.c[0]; }
+TEQP_TAYLOR_COMPARISON(<)
+TEQP_TAYLOR_COMPARISON(>)
+TEQP_TAYLOR_COMPARISON(<=)
+TEQP_TAYLOR_COMPARISON(>=)
+TEQP_TAYLOR_COMPARISON(==)
+TEQP_TAYLOR_COMPARISON(!=)
+#undef TEQP_TAYLOR_COMPARISON
+
+namespace detail {
+/// The series of f(a) from f' = g(a)*a', with f(a0) = f0 and the series g of g(a) known up to order k-1 when the coefficient k of f is needed
+template<int N, typename S, typename G>
+auto integrate_chain(const TaylorSeries<N, S>& a, const S& f0, const G& g_of_f){
+    // f_k = (1/k) sum_{j=1}^{k} j a_j g_{k-j}, where g may depend on the f_j with j < k
+    TaylorSeries<N, S> f; f.c[0] = f0;
+    TaylorSeries<N, S> g; g.c[0] = g_of_f(f, 0);
+    for (auto k = 1; k <= N; ++k){
+        S s = static_cast<double>(k)*a.c[k]*g.c[0];
+        for (auto j = 1; j < k; ++j){ s += static_cast<double>(j)*a.c[j]*g.c[k-j]; }
+        f.c[k] = s/static_cast<double>(k);
+        g.c[k] = g_of_f(f, k);
+    }
+    return f;
+}
+}
+
+template<int N, typename S>
+auto exp(const TaylorSeries<N, S>& a){
+    using std::exp;
+    // f' = f a'
+    return detail::integrate_chain(a, S(exp(a.c[0])), [](const auto& f, int k){ return f.c[k]; });
+}
+template<int N, typename S>
+auto expm1(const TaylorSeries<N, S>& a){
+    using std::exp; using std::expm1;
+    // The same as exp, except for the value
+    const S e0 = exp(a.c[0]);
+    auto f = detail::integrate_chain(a, e0, [](const auto& f, int k){ return f.c[k]; });
+    f.c[0] = expm1(a.c[0]);
+    return f;
+}
+template<int N, typename S>
+auto log(const TaylorSeries<N, S>& a){
+    using std::log;
+    // f' a = a', so k f_k a_0 = k a_k - sum_{j=1}^{k-1} j f_j a_{k-j}
+    TaylorSeries<N, S> f; f.c[0] = log(a.c[0]);
+    for (auto k = 1; k <= N; ++k){
+        S s = static_cast<double>(k)*a.c[k];
+        for (auto j = 1; j < k; ++j){ s -= static_cast<double>(j)*f.c[j]*a.c[k-j]; }
+        f.c[k] = s/(static_cast<double>(k)*a.c[0]);
+    }
+    return f;
+}
+template<int N, typename S>
+auto log1p(const TaylorSeries<N, S>& a){
+    using std::log1p;
+    auto f = log(a + 1.0);
+    f.c[0] = log1p(a.c[0]);
+    return f;
+}
+/// Integer powers by repeated squaring, which are also valid if the value is zero
+template<int N, typename S>
+TaylorSeries<N, S> pow(const TaylorSeries<N, S>& a, int n){
+    if (n < 0){ return 1.0/pow(a, -n); }
+    TaylorSeries<N, S> result(1.0), base = a;
+    while (n > 0){
+        if (n & 1){ result *= base; }
+        n >>= 1;
+        if (n > 0){ base *= base; }
+    }
+    return result;
+}
+namespace detail {
+/// The series of a^e, given the value f0 of a_0^e, with q((e+1) j - k) from a functor of (j, k)
+template<int N, typename S, typename Coeff>
+auto pow_recurrence(const TaylorSeries<N, S>& a, const S& f0, const Coeff& coeff, double q = 1.0){
+    // f' a = e f a', so k a_0 f_k = sum_{j=1}^{k} ((e+1) j - k) a_j f_{k-j}
+    TaylorSeries<N, S> f; f.c[0] = f0;
+    for (auto k = 1; k <= N; ++k){
+        S s = 0.0;
+        for (auto j = 1; j <= k; ++j){ s += coeff(j, k)*a.c[j]*f.c[k-j]; }
+        f.c[k] = s/(q*static_cast<double>(k)*a.c[0]);
+    }
+    return f;
+}
+}
+
+template<int N, typename S, TaylorConstant<S> U>
+auto pow(const TaylorSeries<N, S>& a, const U& e){
+    using std::pow; using std::floor; using std::abs;
+    if constexpr (std::is_integral_v<U>){
+        return pow(a, static_cast<int>(e));
+    }
+    else{
+        if constexpr (std::is_arithmetic_v<U>){
+            if (e == floor(e) && abs(e) < 64){
+                return pow(a, static_cast<int>(e));
+            }
+        }
+        return detail::pow_recurrence(a, S(pow(a.c[0], e)), [&e](int j, int k){ return static_cast<double>(j)*(e + 1.0) - static_cast<double>(k); });
+    }
+}
+template<int N, typename S>
+auto pow(const TaylorSeries<N, S>& a, const TaylorSeries<N, S>& e){ return exp(e*log(a)); }
+template<int N, typename S, TaylorConstant<S> U>
+auto pow(const U& a, const TaylorSeries<N, S>& e){ using std::log; return exp(e*S(log(S(a)))); }
+// The exponents 1/2 and 1/3 are kept as ratios of integers so that the coefficients are exact for any scalar type
+template<int N, typename S>
+auto sqrt(const TaylorSeries<N, S>& a){
+    using std::sqrt;
+    return detail::pow_recurrence(a, S(sqrt(a.c[0])), [](int j, int k){ return 3.0*j - 2.0*k; }, 2.0);
+}
+template<int N, typename S>
+auto cbrt(const TaylorSeries<N, S>& a){
+    using std::cbrt;
+    return detail::pow_recurrence(a, S(cbrt(a.c[0])), [](int j, int k){ return 4.0*j - 3.0*k; }, 3.0);
+}
+
+namespace detail {
+/// Coupled recurrences for (sin, cos) if sign = -1, or (sinh, cosh) if sign = +1
+template<int N, typename S>
+auto trig_pair(const TaylorSeries<N, S>& a, const S& s0, const S& c0, double sign){
+    TaylorSeries<N, S> s, c; s.c[0] = s0; c.c[0] = c0;
+    for (auto k = 1; k <= N; ++k){
+        S ss = 0.0, cc = 0.0;
+        for (auto j = 1; j <= k; ++j){
+            ss += static_cast<double>(j)*a.c[j]*c.c[k-j];
+            cc += static_cast<double>(j)*a.c[j]*s.c[k-j];
+        }
+        s.c[k] = ss/static_cast<double>(k);
+        c.c[k] = sign*cc/static_cast<double>(k);
+    }
+    return std::make_pair(s, c);
+}
+}
+
+template<int N, typename S>
+auto sin(const TaylorSeries<N, S>& a){ using std::sin; using std::cos; return detail::trig_pair(a, S(sin(a.c[0])), S(cos(a.c[0])), -1.0).first; }
+template<int N, typename S>
+auto cos(const TaylorSeries<N, S>& a){ using std::sin; using std::cos; return detail::trig_pair(a, S(sin(a.c[0])), S(cos(a.c[0])), -1.0).second; }
+template<int N, typename S>
+auto tan(const TaylorSeries<N, S>& a){ using std::sin; using std::cos; auto [s, c] = detail::trig_pair(a, S(sin(a.c[0])), S(cos(a.c[0])), -1.0); return s/c; }
+template<int N, typename S>
+auto sinh(const TaylorSeries<N, S>& a){ using std::sinh; using std::cosh; return detail::trig_pair(a, S(sinh(a.c[0])), S(cosh(a.c[0])), 1.0).first; }
+template<int N, typename S>
+auto cosh(const TaylorSeries<N, S>& a){ using std::sinh; using std::cosh; return detail::trig_pair(a, S(sinh(a.c[0])), S(cosh(a.c[0])), 1.0).second; }
+template<int N, typename S>
+auto tanh(const TaylorSeries<N, S>& a){ using std::sinh; using std::cosh; auto [s, c] = detail::trig_pair(a, S(sinh(a.c[0])), S(cosh(a.c[0])), 1.0); return s/c; }
+template<int N, typename S>
+auto atan(const TaylorSeries<N, S>& a){
+    using std::atan;
+    // f' (1+a^2) = a'
+    const auto u = 1.0 + a*a;
+    TaylorSeries<N, S> f; f.c[0] = atan(a.c[0]);
+    for (auto k = 1; k <= N; ++k){
+        S s = static_cast<double>(k)*a.c[k];
+        for (auto j = 1; j < k; ++j){ s -= static_cast<double>(j)*f.c[j]*u.c[k-j]; }
+        f.c[k] = s/(static_cast<double>(k)*u.c[0]);
+    }
+    return f;
+}
+template<int N, typename S>
+auto abs(const TaylorSeries<N, S>& a){ return (a.c[0] < 0) ? -a : a; }
+template<int N, typename S>
+bool isfinite(const TaylorSeries<N, S>& a){ using std::isfinite; return isfinite(a.c[0]); }
+
+} // namespace taylor
+
+using taylor::TaylorSeries;
+
+template<typename T> struct is_taylorseries_t : public std::false_type {};
+template<int N, typename S> struct is_taylorseries_t<TaylorSeries<N, S>> : public std::true_type {};
+
+} // namespace teqp
+
+namespace std {
+template<int N, typename S> struct common_type<teqp::TaylorSeries<N, S>, double> { using type = teqp::TaylorSeries<N, S>; };
+template<int N, typename S> struct common_type<double, teqp::TaylorSeries<N, S>> { using type = teqp::TaylorSeries<N, S>; };
+}
+
+namespace Eigen {
+template<int N, typename S>
+struct NumTraits<teqp::TaylorSeries<N, S>> : NumTraits<double> {
+    using Real = teqp::TaylorSeries<N, S>;
+    using NonInteger = teqp::TaylorSeries<N, S>;
+    using Nested = teqp::TaylorSeries<N, S>;
+    using Literal = double;
+    enum {
+        IsComplex = 0,
+        IsInteger = 0,
+        IsSigned = 1,
+        RequireInitialization = 1,
+        ReadCost = N+1,
+        AddCost = 3*(N+1),
+        MulCost = 3*(N+1)*(N+1)
+    };
+};
+template<int N, typename S, typename BinOp>
+struct ScalarBinaryOpTraits<teqp::TaylorSeries<N, S>, double, BinOp> { using ReturnType = teqp::TaylorSeries<N, S>; };
+template<int N, typename S, typename BinOp>
+struct ScalarBinaryOpTraits<double, teqp::TaylorSeries<N, S>, BinOp> { using ReturnType = teqp::TaylorSeries<N, S>; };
+}
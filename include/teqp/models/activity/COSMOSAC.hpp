@@ -6,6 +6,11 @@
  DOI: 10.1021/acs.jctc.9b01016
  */
 
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <array>
+
 namespace teqp::activity::activity_models::COSMOSAC{
 
 /**
@@ -68,6 +73,40 @@ struct COSMO3Constants {
 
 enum class profile_type { NHB_PROFILE, OH_PROFILE, OT_PROFILE };
 
+namespace detail{
+    /// Solve the dense linear system J*x = b by Gaussian elimination with partial pivoting on the base values, for numerical types (like those of autodiff) that Eigen's decompositions do not handle
+    template<typename T>
+    Eigen::ArrayX<T> gauss_solve(Eigen::ArrayXX<T> J, Eigen::ArrayX<T> b){
+        const auto N = b.size();
+        for (Eigen::Index k = 0; k < N; ++k){
+            Eigen::Index ipivot = k;
+            for (Eigen::Index i = k+1; i < N; ++i){
+                if (std::abs(getbaseval(J(i, k))) > std::abs(getbaseval(J(ipivot, k)))){ ipivot = i; }
+            }
+            if (ipivot != k){
+                J.row(k).swap(J.row(ipivot));
+                std::swap(b(k), b(ipivot));
+            }
+            for (Eigen::Index i = k+1; i < N; ++i){
+                T factor = J(i, k)/J(k, k);
+                for (Eigen::Index j = k; j < N; ++j){
+                    J(i, j) -= factor*J(k, j);
+                }
+                b(i) -= factor*b(k);
+            }
+        }
+        Eigen::ArrayX<T> x(N);
+        for (Eigen::Index i = N-1; i >= 0; --i){
+            T summer = b(i);
+            for (Eigen::Index j = i+1; j < N; ++j){
+                summer -= J(i, j)*x(j);
+            }
+            x(i) = summer/J(i, i);
+        }
+        return x;
+    }
+}
+
 class COSMO3 {
 private:
     std::vector<double> A_COSMO_A2; ///< The area per fluid, in \AA^2
@@ -76,6 +115,41 @@ private:
     COSMO3Constants m_consts;
     COSMOSAC::CombinatorialConstants m_comb_consts;
     Eigen::Index ileft, w;
+    
+    /**
+     The quantities that only depend on temperature, for the last temperature (as a double) that was used. The cache is keyed 
+     also on the constants that enter into these quantities since they can be modified via get_mutable_COSMO_constants
+     */
+    struct TemperatureCache{
+        std::mutex mutex;
+        double T = -1;
+        std::array<double, 7> consts{};
+        std::shared_ptr<const Eigen::ArrayXXd> expDELTAW; ///< exp(-DELTAW/(RT)) for the segments in the window, 153x153
+        std::vector<std::shared_ptr<const Eigen::ArrayXd>> lnGamma_pure; ///< ln(Gamma) of each pure fluid
+    };
+    /// Owns the cache of one instance; a copy starts with an empty cache of its own rather than sharing the cache of the original
+    struct TemperatureCacheHolder{
+        std::unique_ptr<TemperatureCache> cache = std::make_unique<TemperatureCache>();
+        TemperatureCacheHolder() = default;
+        TemperatureCacheHolder(const TemperatureCacheHolder&) : TemperatureCacheHolder() {}
+        TemperatureCacheHolder& operator=(const TemperatureCacheHolder&){ cache = std::make_unique<TemperatureCache>(); return *this; }
+        TemperatureCache* operator->() const { return cache.get(); }
+    };
+    TemperatureCacheHolder m_cache;
+    
+    auto get_cache_key() const {
+        return std::array<double, 7>{m_consts.A_ES, m_consts.B_ES, m_consts.c_OH_OH, m_consts.c_OT_OT, m_consts.c_OH_OT, m_consts.R, m_consts.Gamma_rel_tol};
+    }
+    /// Reset the cache if the temperature or the constants have changed, the lock on the cache mutex must be held
+    void check_cache(double T) const {
+        auto key = get_cache_key();
+        if (m_cache->T != T || m_cache->consts != key){
+            m_cache->T = T;
+            m_cache->consts = key;
+            m_cache->expDELTAW.reset();
+            m_cache->lnGamma_pure.assign(profiles.size(), nullptr);
+        }
+    }
 public:
     COSMO3(const std::vector<double>& A_COSMO_A2, const std::vector<double>& V_COSMO_A3, const std::vector<FluidSigmaProfiles> &SigmaProfiles, const COSMO3Constants &constants = COSMO3Constants(), const CombinatorialConstants &comb_constants = CombinatorialConstants())
     : A_COSMO_A2(A_COSMO_A2), V_COSMO_A3(V_COSMO_A3), profiles(SigmaProfiles), m_consts(constants), m_comb_consts(comb_constants) {
@@ -246,53 +320,194 @@ public:
         else {
             // The fast branch!
             // ----------------
-            
-            // Build the massive AA matrix that is 153*153 in size
-            //auto midTime = std::chrono::high_resolution_clock::now();
+            return get_lnGamma(T, psigmas).exp().eval();
+        }
+    }
+    
+    /**
+     The matrix \f$\exp(-\Delta W/(RT))\f$ for the segments within the window of nonzero p(sigma), 153x153 in the order of NHB, OH, OT.
+     For a double temperature, the matrix is cached
+     */
+    template<typename TType>
+    auto get_expDELTAW(const TType& T) const {
+        double R = m_consts.R;
+        auto build = [&](){
             std::vector<profile_type> types = { profile_type::NHB_PROFILE, profile_type::OH_PROFILE, profile_type::OT_PROFILE };
-            std::vector<Eigen::Index> offsets = {0*51, 1*51, 2*51};
-            Eigen::ArrayXX<TXType> AA(153, 153);
+            Eigen::ArrayXX<TType> expDELTAW = Eigen::ArrayXX<TType>::Zero(153, 153);
             for (auto i = 0; i < 3; ++i) {
                 for (auto j = 0; j < 3; ++j) {
-                    Eigen::Index rowoffset = offsets[i], coloffset = offsets[j];
-                    AA.matrix().block(rowoffset + ileft, coloffset + ileft, w, w) = Eigen::exp(-get_DELTAW_fast(T, types[i], types[j]).block(ileft, ileft, w, w).array() / (R*T)).template cast<TXType>().rowwise()*psigmas.template cast<TXType>().segment(coloffset+ileft,w).transpose();
+                    expDELTAW.matrix().block(51*i + ileft, 51*j + ileft, w, w) = Eigen::exp(-get_DELTAW_fast(T, types[i], types[j]).block(ileft, ileft, w, w).array() / (R*T));
                 }
             }
-            //auto midTime2 = std::chrono::high_resolution_clock::now();
+            return expDELTAW;
+        };
+        if constexpr (std::is_same_v<TType, double>){
+            std::lock_guard<std::mutex> lock(m_cache->mutex);
+            check_cache(T);
+            if (!m_cache->expDELTAW){
+                m_cache->expDELTAW = std::make_shared<const Eigen::ArrayXXd>(build());
+            }
+            return m_cache->expDELTAW;
+        }
+        else{
+            return std::make_shared<const Eigen::ArrayXX<TType>>(build());
+        }
+    }
+    
+    /**
+     Obtain \f$\ln\Gamma\f$, the logarithms of the segment activity coefficients, by Newton's method. Only the segments within the window of
+     nonzero p(sigma) are considered, the remainder have \f$\Gamma=1\f$.
+     
+     In the equations
+     \f[ \ln\Gamma_m + \ln\left(\sum_n A_{mn}\Gamma_n\right) = 0 \f]
+     with \f$A_{mn} = \exp(-\Delta W_{mn}/(RT))p_n\f$, only the segments with nonzero \f$p_n\f$ are coupled, so the Newton iteration is carried out for those 
+     segments and the others are obtained afterwards by direct evaluation.
+     
+     The Newton iteration is carried out with the base values (doubles). For other numerical types, a few Newton steps in that type are then 
+     taken from the converged solution, each of which doubles the number of correct orders of derivatives
+     
+     \param T Temperature, in K
+     \param psigmas Charge densities, in the order of NHB, OH, OT.  Length is 153.
+     \param lnGamma_guess Optional initial guess for \f$\ln\Gamma\f$, of length 153
+     */
+    template<typename TType, typename PSigmaType>
+    auto get_lnGamma(const TType& T, const PSigmaType& psigmas, const std::optional<Eigen::ArrayXd>& lnGamma_guess = std::nullopt) const {
+        
+        using TXType = std::decay_t<std::common_type_t<TType, decltype(psigmas[0])>>;
+        const auto expDELTAW = get_expDELTAW(T);
+        
+        // Indices of the segments in the window, and those of them that have nonzero p(sigma)
+        std::vector<Eigen::Index> active, inactive;
+        for (Eigen::Index offset : {51*0, 51*1, 51*2}){
+            for (auto k = ileft; k < ileft + w; ++k){
+                (getbaseval(psigmas[offset + k]) != 0.0 ? active : inactive).push_back(offset + k);
+            }
+        }
+        const auto Na = static_cast<Eigen::Index>(active.size());
+        Eigen::ArrayXX<TXType> A(Na, Na);
+        for (auto m = 0; m < Na; ++m){
+            for (auto n = 0; n < Na; ++n){
+                A(m, n) = (*expDELTAW)(active[m], active[n])*psigmas[active[n]];
+            }
+        }
+        Eigen::ArrayXd lnGamma_d(Na);
+        for (auto m = 0; m < Na; ++m){
+            lnGamma_d(m) = (lnGamma_guess) ? lnGamma_guess.value()(active[m]) : 0.0;
+        }
+        
+        // Newton's method with the base values
+        Eigen::MatrixXd Ad(Na, Na);
+        for (auto m = 0; m < Na; ++m){
+            for (auto n = 0; n < Na; ++n){
+                Ad(m, n) = getbaseval(A(m, n));
+            }
+        }
+        auto residual = [&Ad](const Eigen::ArrayXd& u){
+            return (u + (Ad*u.exp().matrix()).array().log()).eval();
+        };
+        auto to_scientific = [](double val) { std::ostringstream out; out << std::scientific << val; return out.str(); };
+        auto max_iter = 100;
+        Eigen::ArrayXd F = residual(lnGamma_d);
+        for (auto counter = 0; counter <= max_iter; ++counter) {
+            Eigen::ArrayXd eu = lnGamma_d.exp();
+            Eigen::ArrayXd S = (Ad*eu.matrix()).array();
+            Eigen::MatrixXd J = ((Ad.array().rowwise()*eu.transpose()).colwise()/S).matrix();
+            J.diagonal().array() += 1.0;
+            Eigen::ArrayXd step = J.partialPivLu().solve(-F.matrix()).array();
             
-            for (auto counter = 0; counter <= max_iter; ++counter) {
-                for (Eigen::Index offset : {51*0, 51*1, 51*2}){
-                    Gammanew.segment(offset + ileft, w) = 1 / (
-                                                               AA.matrix().block(offset+ileft,51*0+ileft,w,w).array().rowwise()*Gamma.segment(51*0+ileft, w).transpose()
-                                                               + AA.matrix().block(offset+ileft,51*1+ileft,w,w).array().rowwise()*Gamma.segment(51*1+ileft, w).transpose()
-                                                               + AA.matrix().block(offset+ileft,51*2+ileft,w,w).array().rowwise()*Gamma.segment(51*2+ileft, w).transpose()
-                                                               ).rowwise().sum();
-                }
-                for (Eigen::Index offset : {51 * 0, 51 * 1, 51 * 2}) {
-                    Gamma.segment(offset + ileft, w) = (Gamma.segment(offset + ileft, w) + Gammanew.segment(offset + ileft, w)) / 2;
-                }
-                double maxdiff = getbaseval(((Gamma - Gammanew) / Gamma).cwiseAbs().real().maxCoeff());
-                if (maxdiff < m_consts.Gamma_rel_tol) {
-                    break;
-                }
-                if (!std::isfinite(maxdiff)){
-                    throw teqp::InvalidArgument("Gammas are not finite");
+            // Backtrack if the step does not reduce the residual, which can happen far from the solution
+            double maxF = F.cwiseAbs().maxCoeff(), lambda = 1.0;
+            Eigen::ArrayXd lnGamma_new = lnGamma_d + step, Fnew = residual(lnGamma_new);
+            while (!(Fnew.cwiseAbs().maxCoeff() < maxF) && lambda > 1e-3){
+                lambda /= 2;
+                lnGamma_new = lnGamma_d + lambda*step;
+                Fnew = residual(lnGamma_new);
+            }
+            lnGamma_d = lnGamma_new; F = Fnew;
+            double maxdiff = (lambda*step).cwiseAbs().maxCoeff();
+            if (!std::isfinite(maxdiff)){
+                throw teqp::InvalidArgument("Gammas are not finite");
+            }
+            if (maxdiff < m_consts.Gamma_rel_tol) {
+                break;
+            }
+            if (counter == max_iter){
+                throw std::invalid_argument("Could not obtain the desired tolerance of "
+                                            + to_scientific(m_consts.Gamma_rel_tol)
+                                            +" after "
+                                            +std::to_string(max_iter)
+                                            +" iterations in get_lnGamma; current value is "
+                                            + to_scientific(maxdiff));
+            }
+        }
+        
+        Eigen::ArrayX<TXType> lnGamma_a = lnGamma_d.template cast<TXType>();
+        if constexpr (!std::is_same_v<TXType, double>){
+            for (auto step = 0; step < 3; ++step){
+                Eigen::ArrayX<TXType> eu(Na), S(Na), Fa(Na);
+                for (auto n = 0; n < Na; ++n){ eu(n) = exp(lnGamma_a(n)); }
+                Eigen::ArrayXX<TXType> J(Na, Na);
+                for (auto m = 0; m < Na; ++m){
+                    S(m) = 0.0;
+                    for (auto n = 0; n < Na; ++n){ S(m) += A(m, n)*eu(n); }
+                    Fa(m) = lnGamma_a(m) + log(S(m));
+                    for (auto n = 0; n < Na; ++n){ J(m, n) = A(m, n)*eu(n)/S(m); }
+                    J(m, m) += 1.0;
                 }
-                if (counter == max_iter){
-                    throw std::invalid_argument("Could not obtain the desired tolerance of "
-                                                + to_scientific(m_consts.Gamma_rel_tol)
-                                                +" after "
-                                                +std::to_string(max_iter)
-                                                +" iterations in get_Gamma; current value is "
-                                                + to_scientific(maxdiff));
+                Eigen::ArrayX<TXType> negF = -Fa;
+                lnGamma_a += detail::gauss_solve(J, negF);
+            }
+        }
+        
+        Eigen::ArrayX<TXType> lnGamma = Eigen::ArrayX<TXType>::Zero(153);
+        for (auto m = 0; m < Na; ++m){
+            lnGamma(active[m]) = lnGamma_a(m);
+        }
+        // The segments without any contribution follow directly from the others
+        for (auto m : inactive){
+            TXType S = 0.0;
+            for (auto n = 0; n < Na; ++n){
+                S += (*expDELTAW)(m, active[n])*psigmas[active[n]]*exp(lnGamma_a(n));
+            }
+            lnGamma(m) = -log(S);
+        }
+        return lnGamma;
+    }
+    
+    /// \f$\ln\Gamma\f$ of the i-th pure fluid, which is cached for a double temperature
+    template<typename TType>
+    auto get_lnGamma_pure(std::size_t i, const TType& T) const {
+        double A_i = A_COSMO_A2[i];
+        auto calc = [&](){
+            Eigen::ArrayX<double> psigmas(3*51); // For a pure fluid, p(sigma) does not depend on temperature
+            psigmas << profiles[i].nhb.psigma(A_i), profiles[i].oh.psigma(A_i), profiles[i].ot.psigma(A_i);
+            if (m_consts.fast_Gamma){
+                return get_lnGamma(T, psigmas);
+            }
+            else{
+                return get_Gamma(T, psigmas).log().eval();
+            }
+        };
+        if constexpr (std::is_same_v<TType, double>){
+            if (!m_consts.fast_Gamma){
+                return calc();
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_cache->mutex);
+                check_cache(T);
+                if (m_cache->lnGamma_pure[i]){
+                    return Eigen::ArrayXd(*m_cache->lnGamma_pure[i]);
                 }
             }
-            //auto endTime = std::chrono::high_resolution_clock::now();
-            //std::cout << std::chrono::duration<double>(midTime - startTime).count() << " s elapsed (DELTAW)\n";
-            //std::cout << std::chrono::duration<double>(midTime2 - midTime).count() << " s elapsed (AA)\n";
-            //std::cout << std::chrono::duration<double>(endTime - midTime2).count() << " s elapsed (comps)\n";
-            //std::cout << std::chrono::duration<double>(endTime - startTime).count() << " s elapsed (total)\n";
-            return Gamma;
+            // The lock is not held while solving, so a concurrent caller might solve for the same fluid
+            auto lnGamma = std::make_shared<const Eigen::ArrayXd>(calc());
+            std::lock_guard<std::mutex> lock(m_cache->mutex);
+            check_cache(T);
+            m_cache->lnGamma_pure[i] = lnGamma;
+            return Eigen::ArrayXd(*lnGamma);
+        }
+        else{
+            return calc();
         }
     }
     
@@ -307,7 +522,7 @@ public:
         double A_i = A_COSMO_A2[i];
         psigmas << profiles[i].nhb.psigma(A_i), profiles[i].oh.psigma(A_i), profiles[i].ot.psigma(A_i);
         //        double check_sum = psigmas.sum(); //// Should sum to 1.0
-        auto lnGammai = get_Gamma(T, psigmas).log().eval();
+        auto lnGammai = get_lnGamma_pure(i, T);
         return A_i/AEFFPRIME*(psigmas*(lnGamma_mix - lnGammai)).sum();
     }
     
@@ -323,17 +538,55 @@ public:
     {
         using TXType = std::decay_t<std::common_type_t<TType, decltype(molefracs[0])>>;
         
-        Eigen::Array<TXType, 153, 1> psigmas;
+        Eigen::ArrayX<TXType> psigmas(3*51);
         psigmas << get_psigma_mix(molefracs, profile_type::NHB_PROFILE), get_psigma_mix(molefracs, profile_type::OH_PROFILE), get_psigma_mix(molefracs, profile_type::OT_PROFILE);
         
         Eigen::ArrayX<TXType> lngamma(molefracs.size());
         //        double check_sum = psigmas.sum(); //// Should sum to 1.0
-        Eigen::ArrayX<TXType> lnGamma_mix = get_Gamma(T, psigmas).log();
+        Eigen::ArrayX<TXType> lnGamma_mix = (m_consts.fast_Gamma) ? get_lnGamma(T, psigmas) : get_Gamma(T, psigmas).log().eval();
         for (Eigen::Index i = 0; i < molefracs.size(); ++i) {
             lngamma(i) = get_lngamma_resid(i, T, lnGamma_mix);
         }
         return lngamma;
     }
+    
+    /**
+     The residual part of ln(γ_i) for many compositions at the same temperature, as in the screening of phase equilibria. The
+     quantities that only depend on temperature are evaluated once, and the segment activity coefficients of each composition
+     are the starting point of the iteration for the next one, so neighboring compositions should be in neighboring rows
+     
+     \param T Temperature, in K
+     \param X The mole fractions, one composition per row
+     \returns The residual parts of ln(γ_i), one composition per row
+     */
+    Eigen::ArrayXXd get_lngamma_resid_many(double T, const Eigen::ArrayXXd& X) const
+    {
+        if (static_cast<std::size_t>(X.cols()) != profiles.size()){
+            throw teqp::InvalidArgument("The number of columns in X must be the number of components");
+        }
+        const auto N = X.cols();
+        Eigen::ArrayXXd lnGamma_pure(153, N);
+        for (auto i = 0; i < N; ++i){
+            lnGamma_pure.col(i) = get_lnGamma_pure(i, T);
+        }
+        Eigen::ArrayXXd psigmas_pure(153, N);
+        for (auto i = 0; i < N; ++i){
+            double A_i = A_COSMO_A2[i];
+            psigmas_pure.col(i) << profiles[i].nhb.psigma(A_i), profiles[i].oh.psigma(A_i), profiles[i].ot.psigma(A_i);
+        }
+        Eigen::ArrayXXd out(X.rows(), N);
+        std::optional<Eigen::ArrayXd> lnGamma_mix;
+        for (auto irow = 0; irow < X.rows(); ++irow){
+            Eigen::ArrayXd z = X.row(irow).transpose();
+            Eigen::Array<double, 153, 1> psigmas;
+            psigmas << get_psigma_mix(z, profile_type::NHB_PROFILE), get_psigma_mix(z, profile_type::OH_PROFILE), get_psigma_mix(z, profile_type::OT_PROFILE);
+            lnGamma_mix = (m_consts.fast_Gamma) ? get_lnGamma(T, psigmas, lnGamma_mix) : get_Gamma(T, psigmas).log().eval();
+            for (auto i = 0; i < N; ++i){
+                out(irow, i) = A_COSMO_A2[i]/m_consts.AEFFPRIME*(psigmas_pure.col(i)*(lnGamma_mix.value() - lnGamma_pure.col(i))).sum();
+            }
+        }
+        return out;
+    }
     template<typename TType, typename MoleFracs>
     auto calc_lngamma_resid(TType T, const MoleFracs& molefracs) const
     {
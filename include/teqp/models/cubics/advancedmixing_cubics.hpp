@@ -217,6 +217,15 @@ public:
         auto val = Psiminus - a / (R_JmolK * T) * Psiplus;
         return forceeval(val);
     }
+    
+    /// Molar density from temperature, pressure and mole fractions from the closed-form roots of the cubic, see cubic_density_roots
+    template<typename MoleFracType>
+    Eigen::ArrayXd solve_cubic_density(const double T, const double p, const MoleFracType& molefrac, const DensityRoot root) const {
+        if (static_cast<std::size_t>(molefrac.size()) != alphas.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        return cubic_density_roots(T, p, get_a(T, molefrac), get_b(T, molefrac), Delta1, Delta2, R_JmolK, root);
+    }
 };
 
 inline auto make_AdvancedPRaEres(const nlohmann::json& j){
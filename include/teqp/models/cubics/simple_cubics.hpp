@@ -8,6 +8,8 @@ Implementations of the canonical cubic equations of state
 #include <variant>
 #include <valarray>
 #include <optional>
+#include <algorithm>
+#include <array>
 
 #include "teqp/types.hpp"
 #include "teqp/constants.hpp"
@@ -15,6 +17,7 @@ Implementations of the canonical cubic equations of state
 #include "cubicsuperancillary.hpp"
 #include "teqp/json_tools.hpp"
 #include "teqp/math/pow_templates.hpp"
+#include "teqp/algorithms/density_types.hpp"
 
 #include "nlohmann/json.hpp"
 
@@ -22,6 +25,64 @@ Implementations of the canonical cubic equations of state
 
 namespace teqp {
 
+/// Helpers for the closed-form temperature derivatives of the alpha functions and the attractive parameter
+namespace cubic_derivs {
+
+    template<int N>
+    using TderivArray = Eigen::Array<double, N+1, 1>;
+
+    inline double binomial(int n, int k){
+        double c = 1.0;
+        for (auto j = 1; j <= k; ++j){ c = c*(n-k+j)/j; }
+        return c;
+    }
+
+    /// The derivatives \f$d^n(x^p)/dx^n\f$ for n = 0, ..., N
+    template<int N>
+    TderivArray<N> pow_derivs(double x, double p){
+        TderivArray<N> o;
+        o[0] = pow(x, p);
+        for (auto n = 1; n <= N; ++n){ o[n] = o[n-1]*(p-n+1)/x; }
+        return o;
+    }
+
+    /// The derivatives of the product \f$fg\f$ from those of \f$f\f$ and \f$g\f$ (Leibniz rule)
+    template<int N>
+    TderivArray<N> product_derivs(const TderivArray<N>& f, const TderivArray<N>& g){
+        TderivArray<N> o = TderivArray<N>::Zero();
+        for (auto n = 0; n <= N; ++n){
+            for (auto k = 0; k <= n; ++k){ o[n] += binomial(n, k)*f[k]*g[n-k]; }
+        }
+        return o;
+    }
+
+    /// The derivatives of \f$\sqrt{f}\f$ from those of \f$f\f$, by solving the Leibniz rule of \f$f=uu\f$ for the highest derivative of \f$u\f$
+    template<int N>
+    TderivArray<N> sqrt_derivs(const TderivArray<N>& f){
+        TderivArray<N> o;
+        o[0] = sqrt(f[0]);
+        for (auto n = 1; n <= N; ++n){
+            double s = f[n];
+            for (auto k = 1; k < n; ++k){ s -= binomial(n, k)*o[k]*o[n-k]; }
+            o[n] = s/(2*o[0]);
+        }
+        return o;
+    }
+
+    /// The derivatives of \f$\exp(g)\f$ from those of \f$g\f$, from the Leibniz rule of \f$u'=g'u\f$
+    template<int N>
+    TderivArray<N> exp_derivs(const TderivArray<N>& g){
+        TderivArray<N> o;
+        o[0] = exp(g[0]);
+        for (auto n = 1; n <= N; ++n){
+            double s = 0;
+            for (auto k = 0; k < n; ++k){ s += binomial(n-1, k)*g[k+1]*o[n-1-k]; }
+            o[n] = s;
+        }
+        return o;
+    }
+}
+
 /**
  * \brief The standard alpha function used by Peng-Robinson and SRK
  */
@@ -32,11 +93,25 @@ private:
     mi;  ///< The "m" parameter
 public:
     BasicAlphaFunction(NumType Tci, NumType mi) : Tci(Tci), mi(mi) {};
+    /// Set the critical temperature, for in-place parameter updates
+    void set_Tci(NumType Tci_){ Tci = Tci_; }
+    /// Set the "m" parameter, for in-place parameter updates
+    void set_mi(NumType mi_){ mi = mi_; }
+    auto get_Tci() const { return Tci; }
+    auto get_mi() const { return mi; }
     
     template<typename TType>
     auto operator () (const TType& T) const {
         return forceeval(pow2(forceeval(1.0 + mi * (1.0 - sqrt(T / Tci)))));
     }
+    /// The value and the first N derivatives w.r.t. T
+    template<int N>
+    auto Tderivs(double T) const {
+        using namespace cubic_derivs;
+        TderivArray<N> u = -mi*pow_derivs<N>(T, 0.5)/sqrt(Tci);
+        u[0] += 1.0 + mi;
+        return product_derivs<N>(u, u);
+    }
 };
 
 /**
@@ -56,10 +131,28 @@ public:
             throw teqp::InvalidArgument("coefficients c for Twu alpha function must have length 3");
         }
     };
+    /// Set the critical temperature, for in-place parameter updates
+    void set_Tci(NumType Tci_){ Tci = Tci_; }
+    auto get_Tci() const { return Tci; }
+    const auto& get_c() const { return c; }
     template<typename TType>
     auto operator () (const TType& T) const {
         return forceeval(pow(T/Tci,c[2]*(c[1]-1))*exp(c[0]*(1.0-pow(T/Tci, c[1]*c[2]))));
     }
+    /// The value and the first N derivatives w.r.t. T, from the derivatives of \f$\ln\alpha_i\f$
+    template<int N>
+    auto Tderivs(double T) const {
+        using namespace cubic_derivs;
+        const double p = c[2]*(c[1]-1), q = c[1]*c[2];
+        TderivArray<N> g = -c[0]*pow_derivs<N>(T, q)/pow(Tci, q);
+        g[0] += c[0] + p*log(T/Tci);
+        double dnlnT = 1.0/T; // d^n(ln(T))/dT^n
+        for (auto n = 1; n <= N; ++n){
+            g[n] += p*dnlnT;
+            dnlnT *= -n/T;
+        }
+        return exp_derivs<N>(g);
+    }
 };
 
 /**
@@ -84,16 +177,216 @@ public:
             throw teqp::InvalidArgument("coefficients c for Mathias-Copeman alpha function must have length 3");
         }
     };
+    /// Set the critical temperature, for in-place parameter updates
+    void set_Tci(NumType Tci_){ Tci = Tci_; }
+    auto get_Tci() const { return Tci; }
+    const auto& get_c() const { return c; }
     template<typename TType>
     auto operator () (const TType& T) const {
         auto x = 1.0 - sqrt(T/Tci);
         auto paren = 1.0 + c[0]*x + c[1]*x*x + c[2]*x*x*x;
         return forceeval(paren*paren);
     }
+    /// The value and the first N derivatives w.r.t. T
+    template<int N>
+    auto Tderivs(double T) const {
+        using namespace cubic_derivs;
+        TderivArray<N> x = -pow_derivs<N>(T, 0.5)/sqrt(Tci);
+        x[0] += 1.0;
+        TderivArray<N> x2 = product_derivs<N>(x, x), x3 = product_derivs<N>(x2, x);
+        TderivArray<N> paren = c[0]*x + c[1]*x2 + c[2]*x3;
+        paren[0] += 1.0;
+        return product_derivs<N>(paren, paren);
+    }
 };
 
 using AlphaFunctionOptions = std::variant<BasicAlphaFunction<double>, TwuAlphaFunction<double>, MathiasCopemanAlphaFunction<double>>;
 
+/**
+ \brief The alpha functions of the components gathered by kind, so that the square roots of the alpha functions of all the
+ components are obtained in one vectorized pass per kind rather than with one visit per component
+ */
+class GroupedAlphaFunctions {
+private:
+    struct Group {
+        std::vector<Eigen::Index> indices; ///< The indices of the components in the mixture
+        Eigen::ArrayXd Tc; ///< The critical temperatures
+        Eigen::ArrayXXd c; ///< The coefficients, one row per component
+        
+        void add(Eigen::Index i, double Tci, const Eigen::Array3d& ci){
+            auto n = static_cast<Eigen::Index>(indices.size());
+            indices.push_back(i);
+            Tc.conservativeResize(n+1); Tc[n] = Tci;
+            c.conservativeResize(n+1, 3); c.row(n) = ci.transpose();
+        }
+        /// A view of the indices, which an indexed view holds without copying them
+        auto index_map() const {
+            return Eigen::Map<const Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>>(indices.data(), static_cast<Eigen::Index>(indices.size()));
+        }
+    };
+    Group basic, twu, mathiascopeman;
+    std::vector<Eigen::Index> other; ///< Components whose alpha function is of another kind, these are evaluated one at a time
+    Eigen::Index N = 0;
+    
+public:
+    GroupedAlphaFunctions() = default;
+    
+    template<typename AlphaFunctions>
+    GroupedAlphaFunctions(const AlphaFunctions& alphas) : N(static_cast<Eigen::Index>(alphas.size())) {
+        for (auto i = 0; i < N; ++i){
+            std::visit([&](const auto& alpha){
+                using alpha_t = std::decay_t<decltype(alpha)>;
+                if constexpr (std::is_same_v<alpha_t, BasicAlphaFunction<double>>){
+                    basic.add(i, alpha.get_Tci(), Eigen::Array3d(alpha.get_mi(), 0.0, 0.0));
+                }
+                else if constexpr (std::is_same_v<alpha_t, TwuAlphaFunction<double>>){
+                    twu.add(i, alpha.get_Tci(), alpha.get_c());
+                }
+                else if constexpr (std::is_same_v<alpha_t, MathiasCopemanAlphaFunction<double>>){
+                    mathiascopeman.add(i, alpha.get_Tci(), alpha.get_c());
+                }
+                else{
+                    other.push_back(i);
+                }
+            }, alphas[i]);
+        }
+    }
+    
+    /// The square roots of the alpha functions of all the components, written into o, which must have one element per component
+    template<typename AlphaFunctions, typename Out>
+    void sqrt_alpha(double T, const AlphaFunctions& alphas, Out& o) const {
+        if (!basic.indices.empty()){
+            o(basic.index_map()) = (1.0 + basic.c.col(0)*(1.0 - (T/basic.Tc).sqrt())).abs();
+        }
+        if (!twu.indices.empty()){
+            const auto& c = twu.c;
+            auto lntheta = (T/twu.Tc).log();
+            o(twu.index_map()) = (0.5*(c.col(2)*(c.col(1)-1.0)*lntheta + c.col(0)*(1.0 - (c.col(1)*c.col(2)*lntheta).exp()))).exp();
+        }
+        if (!mathiascopeman.indices.empty()){
+            const auto& c = mathiascopeman.c;
+            auto x = 1.0 - (T/mathiascopeman.Tc).sqrt();
+            o(mathiascopeman.index_map()) = (1.0 + x*(c.col(0) + x*(c.col(1) + x*c.col(2)))).abs();
+        }
+        for (auto i : other){
+            o[i] = sqrt(std::visit([&](const auto& alpha) { return static_cast<double>(alpha(T)); }, alphas[i]));
+        }
+    }
+    
+    /// The square roots of the alpha functions of all the components
+    template<typename AlphaFunctions>
+    Eigen::ArrayXd sqrt_alpha(double T, const AlphaFunctions& alphas) const {
+        Eigen::ArrayXd o(N);
+        sqrt_alpha(T, alphas, o);
+        return o;
+    }
+};
+
+/**
+ \brief The density roots of a cubic EOS with the pressure
+ \f[
+ p = \frac{\rho RT}{1-b\rho} - \frac{a\rho^2}{(1+\Delta_1b\rho)(1+\Delta_2b\rho)}
+ \f]
+ With \f$A = ap/(RT)^2\f$ and \f$B = bp/(RT)\f$, the compressibility factor satisfies
+ \f[
+ Z^3 + [(\Delta_1+\Delta_2-1)B-1]Z^2 + [A+\Delta_1\Delta_2B^2-(\Delta_1+\Delta_2)B(B+1)]Z - [AB+\Delta_1\Delta_2B^2(B+1)] = 0
+ \f]
+ whose real roots are obtained in closed form (trigonometric form for three real roots, Cardano otherwise). The roots with
+ \f$Z > B\f$ are converted to densities and polished with Newton steps on the pressure, which recovers the precision lost
+ in the polynomial for the dense roots. When there are three real roots, the middle one is mechanically unstable and is discarded.
+
+ \param T Temperature, in K
+ \param p Pressure, in Pa
+ \param a The attractive parameter of the mixture
+ \param b The covolume of the mixture
+ \param Delta1 The constant \f$\Delta_1\f$ of the cubic EOS
+ \param Delta2 The constant \f$\Delta_2\f$ of the cubic EOS
+ \param R The gas constant
+ \param root Which root(s) to return
+ \returns The selected root(s), in mol/m^3, in increasing order
+ */
+inline Eigen::ArrayXd cubic_density_roots(const double T, const double p, const double a, const double b, const double Delta1, const double Delta2, const double R, const DensityRoot root){
+    if (!(T > 0) || !(p > 0)){
+        throw InvalidArgument("Temperature and pressure must be positive to solve for the density");
+    }
+    const double RT = R*T, A = a*p/(RT*RT), B = b*p/RT;
+    const double c2 = (Delta1 + Delta2 - 1.0)*B - 1.0,
+                 c1 = A + Delta1*Delta2*B*B - (Delta1 + Delta2)*B*(B + 1.0),
+                 c0 = -(A*B + Delta1*Delta2*B*B*(B + 1.0));
+    
+    // Real roots of the monic cubic polynomial in Z
+    double Zs[3];
+    int Nroots = 0;
+    const double Q = (c2*c2 - 3.0*c1)/9.0, Rc = (2.0*c2*c2*c2 - 9.0*c2*c1 + 27.0*c0)/54.0;
+    if (Rc*Rc < Q*Q*Q){
+        const double theta = std::acos(Rc/std::sqrt(Q*Q*Q)), sqrtQ = std::sqrt(Q);
+        for (auto k = 0; k < 3; ++k){
+            Zs[Nroots++] = -2.0*sqrtQ*std::cos((theta + 2.0*k*EIGEN_PI)/3.0) - c2/3.0;
+        }
+    }
+    else{
+        const double Ac = -std::copysign(std::cbrt(std::abs(Rc) + std::sqrt(Rc*Rc - Q*Q*Q)), Rc);
+        const double Bc = (Ac == 0.0) ? 0.0 : Q/Ac;
+        Zs[Nroots++] = Ac + Bc - c2/3.0;
+    }
+    
+    auto get_p_dpdrho = [&](double rho){
+        const double D1 = 1.0 + Delta1*b*rho, D2 = 1.0 + Delta2*b*rho, D = D1*D2, den = 1.0 - b*rho;
+        return std::make_tuple(rho*RT/den - a*rho*rho/D, RT/(den*den) - a*rho*(2.0*D - rho*b*(Delta1*D2 + Delta2*D1))/(D*D));
+    };
+    
+    std::vector<double> rhos;
+    for (auto k = 0; k < Nroots; ++k){
+        if (!(Zs[k] > B)){ continue; }
+        double rho = p/(Zs[k]*RT);
+        for (auto iter = 0; iter < 4; ++iter){
+            auto [pcalc, dpdrho] = get_p_dpdrho(rho);
+            double rhonew = rho - (pcalc - p)/dpdrho;
+            if (!std::isfinite(rhonew) || !(rhonew > 0 && rhonew*b < 1)){ break; }
+            bool converged = std::abs(rhonew - rho) < 1e-15*rho;
+            rho = rhonew;
+            if (converged){ break; }
+        }
+        // Only the mechanically stable roots are retained; near the spinodal the sign of dp/drho cannot be trusted, so nothing is discarded
+        if (std::get<1>(get_p_dpdrho(rho)) > 0 || Nroots == 1){
+            rhos.push_back(rho);
+        }
+    }
+    if (rhos.empty()){
+        for (auto k = 0; k < Nroots; ++k){
+            if (Zs[k] > B){ rhos.push_back(p/(Zs[k]*RT)); }
+        }
+    }
+    if (rhos.empty()){
+        throw IterationFailure("Unable to find a density root of the cubic EOS at T=" + std::to_string(T) + " K and p=" + std::to_string(p) + " Pa");
+    }
+    std::sort(rhos.begin(), rhos.end());
+    // Two roots may have been polished onto the same density
+    rhos.erase(std::unique(rhos.begin(), rhos.end(), [](double x, double y){ return std::abs(x - y) < 1e-12*y; }), rhos.end());
+    
+    switch (root){
+        case DensityRoot::vapor:
+            return Eigen::ArrayXd::Constant(1, rhos.front());
+        case DensityRoot::liquid:
+            return Eigen::ArrayXd::Constant(1, rhos.back());
+        case DensityRoot::all:
+            return Eigen::Map<const Eigen::ArrayXd>(&rhos[0], static_cast<Eigen::Index>(rhos.size()));
+        case DensityRoot::minimum_gibbs:{
+            // At constant T, p and z, G/(RT) differs from alphar + Z - ln(Z) by a constant
+            double rhobest = rhos.front(), gbest = std::numeric_limits<double>::infinity();
+            for (auto rho : rhos){
+                double Z = p/(rho*RT);
+                double alphar = -std::log1p(-b*rho) - a/(RT*b*(Delta1 - Delta2))*(std::log1p(Delta1*b*rho) - std::log1p(Delta2*b*rho));
+                double g = alphar + Z - std::log(Z);
+                if (g < gbest){ gbest = g; rhobest = rho; }
+            }
+            return Eigen::ArrayXd::Constant(1, rhobest);
+        }
+        default:
+            throw InvalidArgument("Invalid density root selection");
+    }
+}
+
 template<typename TC>
 auto build_alpha_functions(const TC& Tc_K, const nlohmann::json& jalphas){
     std::vector<AlphaFunctionOptions> alphas;
@@ -138,8 +431,12 @@ protected:
     std::valarray<NumType> ai, bi;
     const NumType Delta1, Delta2, OmegaA, OmegaB;
     int superanc_index;
-    const AlphaFunctions alphas;
+    AlphaFunctions alphas;
     Eigen::ArrayXXd kmat;
+    Eigen::ArrayXXd Kmat; ///< The temperature-independent part \f$(1-k_{ij})\sqrt{a_ia_j}\f$ of the attractive parameters
+    GroupedAlphaFunctions grouped_alphas;
+    std::valarray<NumType> Tcrit_K, pcrit_Pa; ///< Retained for in-place parameter updates
+    std::optional<std::valarray<NumType>> acentric; ///< Only present if the alpha functions were generated from the acentric factors
     
     nlohmann::json meta;
     const double m_R_JmolK;
@@ -150,6 +447,14 @@ protected:
     template<typename TType, typename IndexType>
     auto get_bi(TType /*T*/, IndexType i) const { return bi[i]; }
     
+    /// Precalculate the temperature-independent part of the attractive parameters and gather the alpha functions by kind
+    void build_mixing_constants(){
+        Eigen::VectorXd sqrtai(ai.size());
+        for (auto i = 0U; i < ai.size(); ++i) { sqrtai[i] = sqrt(ai[i]); }
+        Kmat = (1.0 - kmat)*(sqrtai*sqrtai.transpose()).array();
+        grouped_alphas = GroupedAlphaFunctions(alphas);
+    }
+    
     template<typename IndexType>
     void check_kmat(IndexType N) {
         if (kmat.cols() != kmat.rows()) {
@@ -173,13 +478,75 @@ public:
             ai[i] = OmegaA * pow2(m_R_JmolK * Tc_K[i]) / pc_Pa[i];
             bi[i] = OmegaB * m_R_JmolK * Tc_K[i] / pc_Pa[i];
         }
+        Tcrit_K = Tc_K;
+        pcrit_Pa = pc_Pa;
         check_kmat(ai.size());
+        build_mixing_constants();
     };
     
     void set_meta(const nlohmann::json& j) { meta = j; }
     auto get_meta() const { return meta; }
     auto get_kmat() const { return kmat; }
     
+    /// Store the acentric factors from which the BasicAlphaFunction of each component was generated, so that they can be updated in-place
+    template<typename AcentricType>
+    void set_acentric(const AcentricType& w){
+        acentric = std::valarray<NumType>(w.size());
+        for (auto i = 0U; i < acentric.value().size(); ++i){
+            acentric.value()[i] = w[i];
+        }
+    }
+    
+    /// The "m" parameter of the BasicAlphaFunction from the acentric factor, for the canonical PR and SRK
+    NumType get_m_from_acentric(NumType w) const {
+        if (superanc_index == CubicSuperAncillary::PR_CODE){
+            return (w < 0.491) ? 0.37464 + 1.54226*w - 0.26992*pow2(w) : 0.379642 + 1.48503*w - 0.164423*pow2(w) + 0.016666*pow3(w);
+        }
+        else if (superanc_index == CubicSuperAncillary::SRK_CODE){
+            return 0.48 + 1.574*w - 0.176*w*w;
+        }
+        throw teqp::InvalidArgument("The relationship between m and the acentric factor is only known for PR and SRK");
+    }
+    
+    /**
+     \brief Get the storage of a parameter for in-place updates, see AbstractModel::get_parameter_slot
+     
+     The supported pointers are /Tcrit ~1 K/i, /pcrit ~1 Pa/i, /kmat/i/j, and /acentric/i if the alpha functions were generated from the acentric factors
+     */
+    double* get_parameter_slot(const std::string& pointer){
+        auto tokens = split_JSON_pointer(pointer);
+        if (tokens.size() == 2 && tokens[0] == "Tcrit / K"){
+            return &Tcrit_K[JSON_pointer_index(tokens[1], ai.size())];
+        }
+        if (tokens.size() == 2 && tokens[0] == "pcrit / Pa"){
+            return &pcrit_Pa[JSON_pointer_index(tokens[1], ai.size())];
+        }
+        if (tokens.size() == 2 && tokens[0] == "acentric" && acentric){
+            return &(acentric.value()[JSON_pointer_index(tokens[1], ai.size())]);
+        }
+        if (tokens.size() == 3 && tokens[0] == "kmat"){
+            return &kmat(JSON_pointer_index(tokens[1], ai.size()), JSON_pointer_index(tokens[2], ai.size()));
+        }
+        throw teqp::NotImplementedError("The cubic parameter at " + pointer + " cannot be updated in-place");
+    }
+    
+    /// Recalculate the attractive and covolume parameters and the alpha functions after the parameter slots were written
+    void update_parameters(){
+        for (auto i = 0U; i < ai.size(); ++i) {
+            ai[i] = OmegaA * pow2(m_R_JmolK * Tcrit_K[i]) / pcrit_Pa[i];
+            bi[i] = OmegaB * m_R_JmolK * Tcrit_K[i] / pcrit_Pa[i];
+            std::visit([&](auto& alpha){
+                alpha.set_Tci(Tcrit_K[i]);
+                if constexpr (std::is_same_v<std::decay_t<decltype(alpha)>, BasicAlphaFunction<NumType>>){
+                    if (acentric){
+                        alpha.set_mi(get_m_from_acentric(acentric.value()[i]));
+                    }
+                }
+            }, alphas[i]);
+        }
+        build_mixing_constants();
+    }
+    
     /// Return a tuple of saturated liquid and vapor densities for the EOS given the temperature
     /// Uses the superancillary equations from Bell and Deiters:
     /// \param T Temperature
@@ -214,18 +581,56 @@ public:
         return m_R_JmolK;
     }
     
+    /**
+     The attractive parameter \f$a = \sum_i\sum_j x_ix_j(1-k_{ij})\sqrt{a_ia_j\alpha_i\alpha_j} = \mathbf{u}^{\rm T}\mathbf{K}\mathbf{u}\f$ with \f$u_i = x_i\sqrt{\alpha_i}\f$,
+     where the matrix \f$\mathbf{K}\f$ does not depend on temperature. For double arguments the square roots of the alpha functions are evaluated
+     in one vectorized pass for each kind of alpha function. For mixtures of up to 8 components the vector \f$\mathbf{u}\f$ is held on the stack.
+     */
     template<typename TType, typename CompType>
     auto get_a(TType T, const CompType& molefracs) const {
-        std::common_type_t<TType, decltype(molefracs[0])> a_ = 0.0;
-        for (auto i = 0U; i < molefracs.size(); ++i) {
-            auto alphai = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[i]));
-            auto ai_ = forceeval(this->ai[i] * alphai);
-            for (auto j = 0U; j < molefracs.size(); ++j) {
-                auto alphaj = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[j]));
-                auto aj_ = this->ai[j] * alphaj;
-                auto aij = forceeval((1 - kmat(i,j)) * sqrt(ai_ * aj_));
-                a_ = a_ + molefracs[i] * molefracs[j] * aij;
+        using result_t = std::decay_t<std::common_type_t<TType, decltype(molefracs[0])>>;
+        const auto N = static_cast<Eigen::Index>(molefracs.size());
+        constexpr Eigen::Index Nstack = 8;
+        if constexpr (std::is_same_v<result_t, double>){
+            if (N <= Nstack){
+                Eigen::Array<double, Eigen::Dynamic, 1, 0, Nstack, 1> u(N);
+                grouped_alphas.sqrt_alpha(T, alphas, u);
+                for (auto i = 0; i < N; ++i) { u[i] *= molefracs[i]; }
+                return quadratic_form(u, N);
             }
+            Eigen::ArrayXd u(N);
+            grouped_alphas.sqrt_alpha(T, alphas, u);
+            for (auto i = 0; i < N; ++i) { u[i] *= molefracs[i]; }
+            return static_cast<double>(u.matrix().dot(Kmat.matrix()*u.matrix()));
+        }
+        else{
+            auto fill = [&](auto& u){
+                for (auto i = 0; i < N; ++i) {
+                    auto alphai = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[i]));
+                    u[i] = molefracs[i]*sqrt(alphai);
+                }
+            };
+            if (N <= Nstack){
+                std::array<result_t, Nstack> u;
+                fill(u);
+                return quadratic_form(u, N);
+            }
+            std::vector<result_t> u(N);
+            fill(u);
+            return quadratic_form(u, N);
+        }
+    }
+    
+    /// The quadratic form \f$\mathbf{u}^{\rm T}\mathbf{K}\mathbf{u}\f$ of the first N elements of u, summed element by element
+    template<typename VecType>
+    auto quadratic_form(const VecType& u, const Eigen::Index N) const {
+        std::decay_t<decltype(u[0])> a_ = 0.0;
+        for (auto i = 0; i < N; ++i) {
+            std::decay_t<decltype(u[0])> Ku = 0.0;
+            for (auto j = 0; j < N; ++j) {
+                Ku += Kmat(i, j)*u[j];
+            }
+            a_ += u[i]*Ku;
         }
         return forceeval(a_);
     }
@@ -253,6 +658,165 @@ public:
         auto val = Psiminus - get_a(T, molefrac) / (m_R_JmolK * T) * Psiplus;
         return forceeval(val);
     }
+    
+    /// Molar density from temperature, pressure and mole fractions from the closed-form roots of the cubic, see cubic_density_roots
+    template<typename MoleFracType>
+    Eigen::ArrayXd solve_cubic_density(const double T, const double p, const MoleFracType& molefrac, const DensityRoot root) const {
+        if (static_cast<std::size_t>(molefrac.size()) != alphas.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        return cubic_density_roots(T, p, get_a(T, molefrac), get_b(T, molefrac), Delta1, Delta2, m_R_JmolK, root);
+    }
+    
+    /// \f$\alpha^r\f$ of a pure fluid, without the mixing rules for the attractive and covolume parameters
+    template<typename TType, typename RhoType>
+    auto alphar_pure(const TType& T, const RhoType& rho) const
+    {
+        if (alphas.size() != 1) {
+            throw teqp::InvalidArgument("The pure-fluid evaluation requires one component, but there are " + std::to_string(alphas.size()));
+        }
+        auto alpha = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[0]));
+        auto a = forceeval((1 - kmat(0,0)) * ai[0] * alpha);
+        auto b = bi[0];
+        auto Psiminus = -log(1.0 - b * rho);
+        auto Psiplus = log((Delta1 * b * rho + 1.0) / (Delta2 * b * rho + 1.0)) / (b * (Delta1 - Delta2));
+        auto val = Psiminus - a / (m_R_JmolK * T) * Psiplus;
+        return forceeval(val);
+    }
+    
+    /// The attractive parameter and its first N derivatives w.r.t. T
+    template<int N, typename CompType>
+    auto get_a_Tderivs(double T, const CompType& molefracs) const {
+        using namespace cubic_derivs;
+        const auto Ncomp = static_cast<Eigen::Index>(molefracs.size());
+        // Each a_ij is K_ij multiplied by the square roots of alpha_i and alpha_j, so the derivatives of the square roots are needed
+        auto a_from = [&](auto& sqrtalpha){
+            for (auto i = 0; i < Ncomp; ++i) {
+                auto alphai = std::visit([&](const auto& t) { return t.template Tderivs<N>(T); }, alphas[i]);
+                sqrtalpha.row(i) = sqrt_derivs<N>(alphai).transpose();
+            }
+            TderivArray<N> a = TderivArray<N>::Zero();
+            for (auto i = 0; i < Ncomp; ++i) {
+                for (auto j = 0; j < Ncomp; ++j) {
+                    double xx = molefracs[i]*molefracs[j]*Kmat(i,j);
+                    for (auto n = 0; n <= N; ++n){
+                        for (auto k = 0; k <= n; ++k){
+                            a[n] += xx*binomial(n, k)*sqrtalpha(i, k)*sqrtalpha(j, n-k);
+                        }
+                    }
+                }
+            }
+            return a;
+        };
+        // For mixtures of up to 8 components the derivatives of the square roots are held on the stack
+        constexpr Eigen::Index Nstack = 8;
+        if (Ncomp <= Nstack){
+            Eigen::Array<double, Eigen::Dynamic, N+1, 0, Nstack, N+1> sqrtalpha(Ncomp, N+1);
+            return a_from(sqrtalpha);
+        }
+        Eigen::Array<double, Eigen::Dynamic, N+1> sqrtalpha(Ncomp, N+1);
+        return a_from(sqrtalpha);
+    }
+    
+    /**
+     \brief The derivatives \f$\Lambda^r_{xy}\f$ for x = 0, ..., NT and y = 0, ..., ND in closed form
+     
+     With \f$\tau=1/T\f$, \f$\alpha^r = \Psi^-(\rho) - \tau a(T)\Psi^+(\rho)/R\f$ is a sum of products of a function of temperature and a function of
+     density, so each derivative is a product of the derivatives of the factors. The derivatives of \f$\tau a\f$ w.r.t. \f$\tau\f$ are obtained from the
+     derivatives of \f$a/T\f$ w.r.t. T with the Lah numbers, \f$\tau^x\partial^x f/\partial\tau^x = (-1)^x\sum_{k=1}^x L(x,k)T^k\partial^k f/\partial T^k\f$
+     */
+    template<int NT, int ND, typename MoleFracType>
+    Eigen::Array<double, NT+1, ND+1> alphar_TDderivs(const double T, const double rho, const MoleFracType& molefrac) const requires std::is_same_v<std::decay_t<decltype(molefrac[0])>, double> {
+        using namespace cubic_derivs;
+        if (static_cast<std::size_t>(molefrac.size()) != alphas.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        const double b = get_b(T, molefrac), eta = b*rho;
+        
+        // T^k d^k(a/T)/dT^k
+        TderivArray<NT> a = get_a_Tderivs<NT>(T, molefrac), F = TderivArray<NT>::Zero();
+        for (auto k = 0; k <= NT; ++k){
+            for (auto j = 0; j <= k; ++j){
+                F[k] += binomial(k, j)*powi(T, j)*a[j]*(((k-j) % 2 == 0) ? 1 : -1)*tgamma(k-j+1)/T;
+            }
+        }
+        // tau^x d^x(tau*a)/dtau^x
+        TderivArray<NT> At = TderivArray<NT>::Zero();
+        At[0] = F[0];
+        for (auto x = 1; x <= NT; ++x){
+            for (auto k = 1; k <= x; ++k){
+                double Lah = binomial(x-1, k-1)*tgamma(x+1)/tgamma(k+1);
+                At[x] += ((x % 2 == 0) ? 1 : -1)*Lah*F[k];
+            }
+        }
+        // rho^y d^y(Psi^-)/drho^y and rho^y d^y(Psi^+)/drho^y
+        Eigen::Array<double, ND+1, 1> Pm, Pp;
+        Pm[0] = -log1p(-eta);
+        Pp[0] = (log1p(Delta1*eta) - log1p(Delta2*eta))/(b*(Delta1 - Delta2));
+        for (auto y = 1; y <= ND; ++y){
+            double fact = tgamma(y);
+            Pm[y] = fact*powi(eta/(1.0-eta), y);
+            Pp[y] = ((y % 2 == 1) ? fact : -fact)*(powi(Delta1*eta/(1.0+Delta1*eta), y) - powi(Delta2*eta/(1.0+Delta2*eta), y))/(b*(Delta1 - Delta2));
+        }
+        
+        Eigen::Array<double, NT+1, ND+1> o = -(At.matrix()*Pp.matrix().transpose()).array()/m_R_JmolK;
+        o.row(0) += Pm.transpose();
+        return o;
+    }
+    
+    /**
+     \brief The value, gradient, and Hessian of \f$\Psi^r=\rho a^r\f$ w.r.t. the molar concentrations in closed form
+     
+     In terms of the molar concentrations, \f$\Psi^r = -RT\rho\ln(1-B) - \tilde{A}G(B)\f$ with \f$B=\sum_i b_i\rho_i\f$,
+     \f$\tilde{A}=\sum_i\sum_j a_{ij}\rho_i\rho_j\f$, and \f$G(B) = \ln[(1+\Delta_1B)/(1+\Delta_2B)]/[(\Delta_1-\Delta_2)B]\f$. At small B the
+     Taylor series of G is used to avoid the loss of precision in its derivatives.
+     */
+    template<typename RhoVecType>
+    auto Psir_fgradHessian(const double T, const RhoVecType& rhovec) const requires std::is_same_v<std::decay_t<decltype(rhovec[0])>, double> {
+        const auto N = rhovec.size();
+        if (static_cast<std::size_t>(N) != alphas.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        const double RT = m_R_JmolK*T;
+        Eigen::VectorXd sqrtalpha = grouped_alphas.sqrt_alpha(T, alphas), b(N), rho_(N);
+        for (auto i = 0; i < N; ++i){
+            b[i] = bi[i];
+            rho_[i] = rhovec[i];
+        }
+        Eigen::MatrixXd aij = (Kmat*(sqrtalpha*sqrtalpha.transpose()).array()).matrix();
+        Eigen::VectorXd arho = aij*rho_;
+        const double rhotot = rho_.sum(), B = b.dot(rho_), Atilde = rho_.dot(arho);
+        
+        double G = 0, dG = 0, d2G = 0;
+        if (std::abs(B) < 0.05){
+            // G = sum_n (-1)^n h_n B^n/(n+1) with h_n = sum_{k=0}^n Delta1^k Delta2^(n-k)
+            double h = 1.0, Delta2n = 1.0, Bn = 1.0, Bnm1 = 0.0, Bnm2 = 0.0;
+            for (auto n = 0; n < 30; ++n){
+                double gn = ((n % 2 == 0) ? 1 : -1)*h/(n+1);
+                G += gn*Bn;
+                dG += n*gn*Bnm1;
+                d2G += n*(n-1)*gn*Bnm2;
+                Bnm2 = Bnm1; Bnm1 = Bn; Bn *= B;
+                Delta2n *= Delta2;
+                h = Delta1*h + Delta2n;
+            }
+        }
+        else{
+            double L = (log1p(Delta1*B) - log1p(Delta2*B))/(Delta1 - Delta2);
+            double dL = 1.0/((1.0 + Delta1*B)*(1.0 + Delta2*B));
+            double d2L = -dL*(Delta1/(1.0 + Delta1*B) + Delta2/(1.0 + Delta2*B));
+            G = L/B;
+            dG = (dL - G)/B;
+            d2G = (d2L - 2*dG)/B;
+        }
+        
+        double Psir = -RT*rhotot*log1p(-B) - Atilde*G;
+        Eigen::ArrayXd grad = (RT*(-log1p(-B) + rhotot*b.array()/(1.0-B)) - 2.0*G*arho.array() - Atilde*dG*b.array()).eval();
+        Eigen::VectorXd ones = Eigen::VectorXd::Ones(N);
+        Eigen::MatrixXd H = RT*(b*ones.transpose() + ones*b.transpose())/(1.0-B) + RT*rhotot/pow2(1.0-B)*b*b.transpose()
+            - 2.0*G*aij - 2.0*dG*(arho*b.transpose() + b*arho.transpose()) - Atilde*d2G*b*b.transpose();
+        return std::make_tuple(Psir, grad, H);
+    }
 };
 
 template <typename TCType, typename PCType, typename AcentricType>
@@ -281,6 +845,7 @@ auto canonical_SRK(TCType Tc_K, PCType pc_Pa, AcentricType acentric, const std::
     const std::size_t N = m.size();
     auto cub = GenericCubic(Delta1, Delta2, OmegaA, OmegaB, CubicSuperAncillary::SRK_CODE, Tc_K, pc_Pa, std::move(alphas), kmat.value_or(Eigen::ArrayXXd::Zero(N,N)), R_JmolK.value_or(constants::R_CODATA2017));
     cub.set_meta(meta);
+    cub.set_acentric(acentric);
     return cub;
 }
 
@@ -326,6 +891,7 @@ auto canonical_PR(TCType Tc_K, PCType pc_Pa, AcentricType acentric, const std::o
     const std::size_t N = m.size();
     auto cub = GenericCubic(Delta1, Delta2, OmegaA, OmegaB, CubicSuperAncillary::PR_CODE, Tc_K, pc_Pa, std::move(alphas), kmat.value_or(Eigen::ArrayXXd::Zero(N,N)), R_JmolK.value_or(constants::R_CODATA2017));
     cub.set_meta(meta);
+    cub.set_acentric(acentric);
     return cub;
 }
 
@@ -433,6 +999,9 @@ inline auto make_generalizedcubic(const nlohmann::json& spec){
     
     auto cub = GenericCubic(Delta1, Delta2, OmegaA, OmegaB, superanc_code, Tc_K, pc_Pa, std::move(alphas), kmat.value_or(Eigen::ArrayXXd::Zero(N,N)), R_JmolK.value_or(constants::R_CODATA2017));
     cub.set_meta(meta);
+    if (!spec.contains("alpha")){
+        cub.set_acentric(acentric);
+    }
     return cub;
 }
 
@@ -687,6 +1256,18 @@ public:
         auto val = Psiminus - a/(this->Ru*T)*Psiplus;
         return forceeval(val);
     }
+    
+    /// Molar density from temperature, pressure and mole fractions from the closed-form roots of the cubic, see cubic_density_roots
+    template<typename MoleFracType>
+    Eigen::ArrayXd solve_cubic_density(const double T, const double p, const MoleFracType& molefrac, const DensityRoot root) const {
+        if (static_cast<std::size_t>(molefrac.size()) != delta_1.size()) {
+            throw std::invalid_argument("Sizes do not match");
+        }
+        double Delta1 = 0.0;
+        for (auto i = 0U; i < delta_1.size(); ++i){ Delta1 += molefrac[i]*delta_1[i]; }
+        auto [a, b] = get_ab(T, molefrac);
+        return cubic_density_roots(T, p, a, b, Delta1, (1.0-Delta1)/(1.0+Delta1), Ru, root);
+    }
 };
 using RKPRCismondi2005_t = decltype(RKPRCismondi2005({}));
 
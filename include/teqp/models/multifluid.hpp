@@ -176,6 +176,19 @@ public:
         return forceeval(corr.alphar(tau, delta, molefrac) + dep.alphar(tau, delta, molefrac));
     }
     
+    /// \f$\alpha^r\f$ of a pure fluid, from the corresponding-states term alone
+    template<typename TType, typename RhoType>
+    auto alphar_pure(const TType &T, const RhoType &rho) const
+    {
+        if (corr.size() != 1){
+            throw teqp::InvalidArgument("The pure-fluid evaluation requires one component, but "+std::to_string(corr.size()) + " are loaded");
+        }
+        const auto z = Eigen::Array<double, 1, 1>::Ones().eval();
+        auto delta = forceeval(rho / redfunc.get_rhor(z));
+        auto tau = forceeval(redfunc.get_Tr(z) / T);
+        return corr.alphari(tau, delta, 0);
+    }
+    
     template<typename TType, typename RhoType, typename MoleFracType>
     auto alphar_taudelta(const TType &tau,
         const RhoType &delta,
@@ -14,6 +14,7 @@
 #include "teqp/models/saft/pcsaftpure.hpp"
 #include "teqp/models/saft/polar_terms/GrossVrabec.hpp"
 #include <optional>
+#include <array>
 
 // Definitions for the matrices of global constants for the PCSAFT model
 namespace teqp::saft::PCSAFT::PCSAFTMatrices{
@@ -187,11 +188,11 @@ auto sumproduct(const VecType1& v1, const VecType2& v2, const VecType3& v3) {
 class PCSAFTHardChainContribution{
     
 protected:
-    const Eigen::ArrayX<double> m, ///< number of segments
+    Eigen::ArrayX<double> m, ///< number of segments
         mminus1, ///< m-1
         sigma_Angstrom, ///<
         epsilon_over_k; ///< depth of pair potential divided by Boltzman constant
-    const Eigen::ArrayXXd kmat; ///< binary interaction parameter matrix
+    Eigen::ArrayXXd kmat; ///< binary interaction parameter matrix
     Eigen::Array<double, 3, 7> a, ///< The universal constants used in Eqn. A.18 of G&S
                             b; ///< The universal constants used in Eqn. A.19 of G&S
 
@@ -201,6 +202,14 @@ public:
     
     PCSAFTHardChainContribution& operator=( const PCSAFTHardChainContribution& ) = delete; // non copyable
     
+    /// Overwrite the parameters in-place; the number of components cannot change
+    void update_parameters(const Eigen::ArrayX<double> &m_, const Eigen::ArrayX<double> &mminus1_, const Eigen::ArrayX<double> &sigma_Angstrom_, const Eigen::ArrayX<double> &epsilon_over_k_, const Eigen::ArrayXXd &kmat_){
+        if (m_.size() != m.size() || kmat_.rows() != kmat.rows()){
+            throw teqp::InvalidArgument("The number of components cannot be changed");
+        }
+        m = m_; mminus1 = mminus1_; sigma_Angstrom = sigma_Angstrom_; epsilon_over_k = epsilon_over_k_; kmat = kmat_;
+    }
+    
     template<typename TTYPE, typename RhoType, typename VecType>
     auto eval(const TTYPE& T, const RhoType& rhomolar, const VecType& mole_fractions) const {
         
@@ -211,8 +220,10 @@ public:
         }
         
         using TRHOType = std::common_type_t<std::decay_t<TTYPE>, std::decay_t<RhoType>, std::decay_t<decltype(mole_fractions[0])>, std::decay_t<decltype(m[0])>>;
+        // The per-component arrays have the compile-time size of the mole fractions, if any, so that they live on the stack
+        constexpr int Ncomp = compile_time_size_v<VecType>;
         
-        Eigen::ArrayX<TTYPE> d(N);
+        Eigen::Array<TTYPE, Ncomp, 1> d; d.resize(N);
         TRHOType m2_epsilon_sigma3_bar = 0.0;
         TRHOType m2_epsilon2_sigma3_bar = 0.0;
         for (auto i = 0L; i < N; ++i) {
@@ -237,7 +248,7 @@ public:
         
         /// Evaluate the components of zeta
         using ta = std::common_type_t<decltype(m[0]), decltype(d[0]), decltype(rho_A3)>;
-        std::vector<ta> zeta(4), D(4);
+        std::array<ta, 4> zeta, D;
         for (std::size_t n = 0; n < 4; ++n) {
             // Eqn A.8
             auto dn = pow(d, static_cast<int>(n));
@@ -258,7 +269,7 @@ public:
         
         // Hard chain contribution from G&S
         using tt = std::common_type_t<decltype(zeta[0]), decltype(d[0])>;
-        Eigen::ArrayX<tt> lngii_hs(mole_fractions.size());
+        Eigen::Array<tt, Ncomp, 1> lngii_hs; lngii_hs.resize(N);
         for (auto i = 0; i < lngii_hs.size(); ++i) {
             lngii_hs[i] = log(gij_HS(zeta, d, i, i));
         }
@@ -292,6 +303,63 @@ public:
         };
         return PCSAFTHardChainContributionTerms{eta, alphar_hc, alphar_disp};
     }
+    
+    /// The same as eval, but for a pure fluid, for which the sums over the components in the mixing rules collapse to one term
+    template<typename TTYPE, typename RhoType>
+    auto eval_pure(const TTYPE& T, const RhoType& rhomolar) const {
+        
+        if (m.size() != 1) {
+            throw teqp::InvalidArgument("The pure-fluid evaluation requires one component, but there are " + std::to_string(m.size()));
+        }
+        
+        using TRHOType = std::common_type_t<std::decay_t<TTYPE>, std::decay_t<RhoType>, std::decay_t<decltype(m[0])>>;
+        
+        auto d = forceeval(sigma_Angstrom[0]*(1.0 - 0.12 * exp(-3.0*epsilon_over_k[0]/T))); // [A]
+        auto ekT = forceeval(epsilon_over_k[0]*(1.0 - kmat(0,0))/T);
+        const double m2sigma3 = m[0]*m[0]*sigma_Angstrom[0]*sigma_Angstrom[0]*sigma_Angstrom[0];
+        TRHOType m2_epsilon_sigma3_bar = m2sigma3*ekT;
+        TRHOType m2_epsilon2_sigma3_bar = m2sigma3*(ekT*ekT);
+        const double mbar = m[0];
+        
+        /// Convert from molar density to number density in molecules/Angstrom^3
+        RhoType rho_A3 = rhomolar * N_A * 1e-30; //[molecules (not moles)/A^3]
+        
+        constexpr double MY_PI = EIGEN_PI;
+        double pi6 = (MY_PI / 6.0);
+        
+        /// Evaluate the components of zeta
+        using ta = std::common_type_t<decltype(m[0]), decltype(d), decltype(rho_A3)>;
+        std::array<ta, 4> zeta, D;
+        for (std::size_t n = 0; n < 4; ++n) {
+            // Eqn A.8
+            D[n] = forceeval(pi6*mbar*powi(d, static_cast<int>(n)));
+            zeta[n] = forceeval(D[n]*rho_A3);
+        }
+        
+        /// Packing fraction is the 4-th value in zeta, at index 3
+        auto eta = zeta[3];
+        
+        Eigen::Array<decltype(eta), 7, 1> etapowers; etapowers(0) = 1.0; for (auto i = 1U; i <= 6; ++i){ etapowers(i) = eta*etapowers(i-1); }
+        Eigen::Array<double, 7, 1> abar = (a.row(0) + ((mbar - 1.0) / mbar) * a.row(1) + ((mbar - 1.0) / mbar) * ((mbar - 2.0) / mbar) * a.row(2)).transpose();
+        Eigen::Array<double, 7, 1> bbar = (b.row(0) + ((mbar - 1.0) / mbar) * b.row(1) + ((mbar - 1.0) / mbar) * ((mbar - 2.0) / mbar) * b.row(2)).transpose();
+        auto I1 = (abar.template cast<decltype(eta)>()*etapowers).sum();
+        auto I2 = (bbar.template cast<decltype(eta)>()*etapowers).sum();
+        
+        // Hard chain contribution from G&S
+        const std::array<std::decay_t<decltype(d)>, 1> dii{d};
+        auto alphar_hc = forceeval(mbar * get_alphar_hs(zeta, D) - mminus1[0]*log(gij_HS(zeta, dii, 0, 0))); // Eq. A.4
+        
+        // Dispersive contribution
+        auto C1_ = C1(eta, mbar);
+        auto alphar_disp = forceeval(-2 * MY_PI * rho_A3 * I1 * m2_epsilon_sigma3_bar - MY_PI * rho_A3 * mbar * C1_ * I2 * m2_epsilon2_sigma3_bar);
+        
+        struct PCSAFTHardChainContributionTerms{
+            TRHOType eta;
+            TRHOType alphar_hc;
+            TRHOType alphar_disp;
+        };
+        return PCSAFTHardChainContributionTerms{eta, alphar_hc, alphar_disp};
+    }
 };
 
 /** A class used to evaluate mixtures using PC-SAFT model
@@ -406,6 +474,31 @@ public:
     auto get_kmat() const { return kmat; }
     auto get_names() const { return names;}
     auto get_BibTeXKeys() const { return bibtex;}
+    
+    /**
+     \brief Get the storage of a parameter for in-place updates, see AbstractModel::get_parameter_slot
+     
+     The supported pointers are /coeffs/i/m, /coeffs/i/sigma_Angstrom, /coeffs/i/epsilon_over_k, and /kmat/i/j. The
+     segment parameters cannot be updated in-place if a dipolar or quadrupolar contribution is present.
+     */
+    double* get_parameter_slot(const std::string& pointer){
+        auto tokens = split_JSON_pointer(pointer);
+        if (tokens.size() == 3 && tokens[0] == "coeffs" && !dipolar && !quadrupolar){
+            auto i = JSON_pointer_index(tokens[1], m.size());
+            if (tokens[2] == "m"){ return &m[i]; }
+            if (tokens[2] == "sigma_Angstrom"){ return &sigma_Angstrom[i]; }
+            if (tokens[2] == "epsilon_over_k"){ return &epsilon_over_k[i]; }
+        }
+        if (tokens.size() == 3 && tokens[0] == "kmat"){
+            return &kmat(JSON_pointer_index(tokens[1], kmat.rows()), JSON_pointer_index(tokens[2], kmat.cols()));
+        }
+        throw teqp::NotImplementedError("The PC-SAFT parameter at " + pointer + " cannot be updated in-place");
+    }
+    /// Propagate the values written to the parameter slots
+    void update_parameters(){
+        mminus1 = m - 1.0;
+        hardchain.update_parameters(m, mminus1, sigma_Angstrom, epsilon_over_k, kmat);
+    }
 
     auto print_info() {
         std::string s = std::string("i m sigma / A e/kB / K \n  ++++++++++++++") + "\n";
@@ -449,6 +542,25 @@ public:
         }
         return forceeval(alphar);
     }
+    
+    /// \f$\alpha^r\f$ of a pure fluid, without the sums over the components in the mixing rules
+    template<typename TTYPE, typename RhoType>
+    auto alphar_pure(const TTYPE& T, const RhoType& rhomolar) const {
+        auto vals = hardchain.eval_pure(T, rhomolar);
+        auto alphar = forceeval(vals.alphar_hc + vals.alphar_disp);
+        
+        if (dipolar || quadrupolar){
+            const auto mole_fractions = Eigen::Array<double, 1, 1>::Ones().eval();
+            auto rho_A3 = forceeval(rhomolar*N_A*1e-30);
+            if (dipolar){
+                alphar += dipolar.value().eval(T, rho_A3, vals.eta, mole_fractions).alpha;
+            }
+            if (quadrupolar){
+                alphar += quadrupolar.value().eval(T, rho_A3, vals.eta, mole_fractions).alpha;
+            }
+        }
+        return forceeval(alphar);
+    }
 };
 
 /// A JSON-based factory function for the PC-SAFT model
@@ -515,6 +627,10 @@ using saft::PCSAFT::PCSAFTPureGrossSadowski2001;
 
 }; // namespace teqp::saft
 
+namespace teqp{
+template<> struct supports_adjoint_t<saft::pcsaft::PCSAFTMixture> : public std::true_type {};
+}
+
 namespace teqp::PCSAFT{
 using namespace teqp::saft::pcsaft;
 }
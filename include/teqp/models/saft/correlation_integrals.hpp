@@ -2,6 +2,7 @@
 
 #include <map>
 #include <array>
+#include <tuple>
 #include <cmath>
 
 #include "teqp/types.hpp"
@@ -16,6 +17,28 @@ inline auto differentiable_abs(const X& x){
     return forceeval(sqrt(x*x));
 };
 
+/// Evaluate the polynomial \f$ \sum_k c_k x^k \f$ with the Horner scheme
+template<typename Coeffs, typename X>
+auto horner(const Coeffs& c, const X& x){
+    std::common_type_t<std::decay_t<decltype(c[0])>, X> out = c[c.size()-1];
+    for (auto k = static_cast<int>(c.size())-2; k >= 0; --k){
+        out = out*x + c[k];
+    }
+    return out;
+}
+
+/// Evaluate a function of \f$ T^* \f$ for each entry of an array of reduced temperatures, for instance those of all the pairs of components
+template<typename TType, typename Function>
+auto map_Tstar(const Eigen::ArrayXX<TType>& Tstar, const Function& f){
+    Eigen::ArrayXX<decltype(f(Tstar(0, 0)))> out(Tstar.rows(), Tstar.cols());
+    for (auto i = 0; i < Tstar.rows(); ++i){
+        for (auto j = 0; j < Tstar.cols(); ++j){
+            out(i, j) = f(Tstar(i, j));
+        }
+    }
+    return out;
+}
+
 static const std::map<int, std::array<double, 12>> Luckas_J_coeffs = {
     {4,  {-1.38410152e00,  -7.05792933e-01, 2.60947023e00,  1.96828333e01, 1.13619510e01, -2.98510490e01,  -3.15686398e01, -2.00943290e01,  5.11029320e01, 1.44194150e01, 9.40061069e00,  -2.36844608e01}},
     {5,  {-6.89702637e-01, -1.62382602e-01, 1.16302441e00,  1.42067443e01, 4.59642681e00, -1.81421003e01,  -2.45012804e01, -8.42839734e00,  3.25579587e01, 1.16339969e01, 4.00080085e00,  -1.54419815e01}},
@@ -37,8 +60,9 @@ public:
     const int n;
     const std::array<double, 12> a;
     double a00,a01,a02,a10,a11,a12,a20,a21,a22,a30,a31,a32;
+    const double Z_1, Z_2;
     
-    LuckasJIntegral(int n) : n(n), a(Luckas_J_coeffs.at(n)){
+    LuckasJIntegral(int n) : n(n), a(Luckas_J_coeffs.at(n)), Z_1(0.3 + 0.05*n), Z_2(1.0/n){
         a00 = a[0]; a01 = a[1]; a02 = a[2];
         a10 = a[3]; a11 = a[4]; a12 = a[5];
         a20 = a[6]; a21 = a[7]; a22 = a[8];
@@ -47,12 +71,29 @@ public:
     
     template<typename TType, typename RhoType>
     auto get_J(const TType& Tstar, const RhoType& rhostar) const{
-        double Z_1 = 0.3 + 0.05*n;
-        double Z_2 = 1.0/n;
-        RhoType A_0 = a00 + a10*rhostar + a20*rhostar*rhostar + a30*rhostar*rhostar*rhostar;
-        RhoType A_1 = a01 + a11*rhostar + a21*rhostar*rhostar + a31*rhostar*rhostar*rhostar;
-        RhoType A_2 = a02 + a12*rhostar + a22*rhostar*rhostar + a32*rhostar*rhostar*rhostar;
-        std::common_type_t<TType, RhoType> out = (A_0 + A_1*pow(Tstar, Z_1) + A_2*pow(Tstar, Z_2))*exp(1.0/(Tstar + 4.0/pow(differentiable_abs(log(forceeval(rhostar/sqrt(2.0)))), 3.0)));
+        return get_J_from_parts(Tstar, get_rho_parts(rhostar));
+    }
+    
+    /// Evaluate the integral for all the entries in an array of reduced temperatures, sharing the parts that only depend on \f$ \rho^* \f$
+    template<typename TType, typename RhoType>
+    auto get_J_matrix(const Eigen::ArrayXX<TType>& Tstar, const RhoType& rhostar) const{
+        const auto parts = get_rho_parts(rhostar);
+        return map_Tstar(Tstar, [&](const TType& Tstar_){ return get_J_from_parts(Tstar_, parts); });
+    }
+    
+private:
+    template<typename RhoType>
+    auto get_rho_parts(const RhoType& rhostar) const{
+        RhoType A_0 = a00 + rhostar*(a10 + rhostar*(a20 + rhostar*a30));
+        RhoType A_1 = a01 + rhostar*(a11 + rhostar*(a21 + rhostar*a31));
+        RhoType A_2 = a02 + rhostar*(a12 + rhostar*(a22 + rhostar*a32));
+        RhoType D = 4.0/pow(differentiable_abs(log(forceeval(rhostar/sqrt(2.0)))), 3.0);
+        return std::array<RhoType, 4>{A_0, A_1, A_2, D};
+    }
+    template<typename TType, typename RhoType>
+    auto get_J_from_parts(const TType& Tstar, const std::array<RhoType, 4>& parts) const{
+        const auto& [A_0, A_1, A_2, D] = parts;
+        std::common_type_t<TType, RhoType> out = (A_0 + A_1*pow(Tstar, Z_1) + A_2*pow(Tstar, Z_2))*exp(1.0/(Tstar + D));
         return out;
     }
 };
@@ -80,14 +121,32 @@ public:
     
     template<typename TType, typename RhoType>
     auto get_K(const TType& Tstar, const RhoType& rhostar) const{
-        double Z_1 = 2.0;
-        double Z_2 = 3.0;
-        double Z_3 = 4.0;
-        RhoType b_0 = a00 + a10*rhostar + a20*rhostar*rhostar + a30*rhostar*rhostar*rhostar;
-        RhoType b_1 = a01 + a11*rhostar + a21*rhostar*rhostar + a31*rhostar*rhostar*rhostar;
-        RhoType b_2 = a02 + a12*rhostar + a22*rhostar*rhostar + a32*rhostar*rhostar*rhostar;
-        RhoType b_3 = a03 + a13*rhostar + a23*rhostar*rhostar + a33*rhostar*rhostar*rhostar;
-        std::common_type_t<TType, RhoType> out = b_0 + b_1*Tstar + b_2*pow(exp(pow(1.0-rhostar/sqrt(2.0),Z_3)), Z_1) + b_3*pow(exp(pow(1.0-rhostar/sqrt(2.0),Z_3)), Z_2);
+        return get_K_from_parts(Tstar, get_rho_parts(rhostar));
+    }
+    
+    /// Evaluate the integral for all the entries in an array of reduced temperatures, sharing the parts that only depend on \f$ \rho^* \f$
+    template<typename TType, typename RhoType>
+    auto get_K_matrix(const Eigen::ArrayXX<TType>& Tstar, const RhoType& rhostar) const{
+        const auto parts = get_rho_parts(rhostar);
+        return map_Tstar(Tstar, [&](const TType& Tstar_){ return get_K_from_parts(Tstar_, parts); });
+    }
+    
+private:
+    /// All but the term linear in \f$ T^* \f$ depend only on \f$ \rho^* \f$; the exponents are Z_1=2, Z_2=3, and Z_3=4
+    template<typename RhoType>
+    auto get_rho_parts(const RhoType& rhostar) const{
+        RhoType b_0 = a00 + rhostar*(a10 + rhostar*(a20 + rhostar*a30));
+        RhoType b_1 = a01 + rhostar*(a11 + rhostar*(a21 + rhostar*a31));
+        RhoType b_2 = a02 + rhostar*(a12 + rhostar*(a22 + rhostar*a32));
+        RhoType b_3 = a03 + rhostar*(a13 + rhostar*(a23 + rhostar*a33));
+        RhoType y = 1.0-rhostar/sqrt(2.0), y2 = y*y;
+        RhoType E = exp(y2*y2), E2 = E*E;
+        RhoType c_0 = b_0 + E2*(b_2 + b_3*E);
+        return std::array<RhoType, 2>{c_0, b_1};
+    }
+    template<typename TType, typename RhoType>
+    auto get_K_from_parts(const TType& Tstar, const std::array<RhoType, 2>& parts) const{
+        std::common_type_t<TType, RhoType> out = parts[0] + parts[1]*Tstar;
         return out;
     }
 };
@@ -140,7 +199,27 @@ public:
     
     template<typename TType, typename RhoType>
     auto get_J(const TType& Tstar, const RhoType& rhostar) const{
-        std::common_type_t<TType, RhoType> out = exp(A*rhostar*rhostar*log(Tstar) + B*rhostar*rhostar + C*rhostar*log(Tstar) + D*rhostar + E*log(Tstar) + F);
+        return get_J_from_parts(Tstar, get_rho_parts(rhostar));
+    }
+    
+    /// Evaluate the integral for all the entries in an array of reduced temperatures, sharing the parts that only depend on \f$ \rho^* \f$
+    template<typename TType, typename RhoType>
+    auto get_J_matrix(const Eigen::ArrayXX<TType>& Tstar, const RhoType& rhostar) const{
+        const auto parts = get_rho_parts(rhostar);
+        return map_Tstar(Tstar, [&](const TType& Tstar_){ return get_J_from_parts(Tstar_, parts); });
+    }
+    
+private:
+    /// The coefficients of \f$ \ln T^* \f$ and of unity in the argument of the exponential
+    template<typename RhoType>
+    auto get_rho_parts(const RhoType& rhostar) const{
+        RhoType c_lnT = E + rhostar*(C + rhostar*A);
+        RhoType c_0 = F + rhostar*(D + rhostar*B);
+        return std::array<RhoType, 2>{c_lnT, c_0};
+    }
+    template<typename TType, typename RhoType>
+    auto get_J_from_parts(const TType& Tstar, const std::array<RhoType, 2>& parts) const{
+        std::common_type_t<TType, RhoType> out = exp(parts[0]*log(Tstar) + parts[1]);
         return out;
     }
 };
@@ -170,7 +249,27 @@ public:
     
     template<typename TType, typename RhoType>
     auto get_K(const TType& Tstar, const RhoType& rhostar) const{
-        std::common_type_t<TType, RhoType> out = sign_term*exp(A*rhostar*rhostar*log(Tstar) + B*rhostar*rhostar + C*rhostar*log(Tstar) + D*rhostar + E*log(Tstar) + F);
+        return get_K_from_parts(Tstar, get_rho_parts(rhostar));
+    }
+    
+    /// Evaluate the integral for all the entries in an array of reduced temperatures, sharing the parts that only depend on \f$ \rho^* \f$
+    template<typename TType, typename RhoType>
+    auto get_K_matrix(const Eigen::ArrayXX<TType>& Tstar, const RhoType& rhostar) const{
+        const auto parts = get_rho_parts(rhostar);
+        return map_Tstar(Tstar, [&](const TType& Tstar_){ return get_K_from_parts(Tstar_, parts); });
+    }
+    
+private:
+    /// The coefficients of \f$ \ln T^* \f$ and of unity in the argument of the exponential
+    template<typename RhoType>
+    auto get_rho_parts(const RhoType& rhostar) const{
+        RhoType c_lnT = E + rhostar*(C + rhostar*A);
+        RhoType c_0 = F + rhostar*(D + rhostar*B);
+        return std::array<RhoType, 2>{c_lnT, c_0};
+    }
+    template<typename TType, typename RhoType>
+    auto get_K_from_parts(const TType& Tstar, const std::array<RhoType, 2>& parts) const{
+        std::common_type_t<TType, RhoType> out = sign_term*exp(parts[0]*log(Tstar) + parts[1]);
         return out;
     }
 };
@@ -225,23 +324,48 @@ public:
     const int n;
     const std::array<double, 35> ab;
     
-    GottschalkJIntegral(int n) : n(n), ab(Gottschalk_J_coeffs.at(n)){}
-    
-    template<typename TType, typename RhoType>
-    auto get_J(const TType& Tstar, const RhoType& rhostar) const{
-        std::common_type_t<TType, RhoType> summer = 0.0;
+    GottschalkJIntegral(int n) : n(n), ab(Gottschalk_J_coeffs.at(n)){
+        // Coefficient matrices of the bivariate polynomials, stored as polynomials in rho^* for each power of T^*
         for (auto i = 0; i <= 4; ++i){
             for (auto j = 0; j <= 3; ++j){
-                auto I = 4*i + j;
-                summer += ab[I]*pow(rhostar, i)*pow(Tstar, j);
+                a[j][i] = ab[4*i + j];
             }
-        }
-        for (auto i = 0; i <= 4; ++i){
             for (auto j = 0; j <= 2; ++j){
-                auto I = 20 + 3*i + j;
-                summer += ab[I]*pow(rhostar, i)*pow(Tstar, j)*exp(1.0/Tstar);
+                b[j][i] = ab[20 + 3*i + j];
             }
         }
+    }
+    
+    /// \f$ J = \left(\sum_{i=0}^4\sum_{j=0}^3 a_{ij}\rho^{*i}T^{*j} + \exp(1/T^*)\sum_{i=0}^4\sum_{j=0}^2 b_{ij}\rho^{*i}T^{*j}\right)^{n-2} \f$, evaluated with nested Horner schemes
+    template<typename TType, typename RhoType>
+    auto get_J(const TType& Tstar, const RhoType& rhostar) const{
+        return get_J_from_parts(Tstar, get_rho_parts(rhostar));
+    }
+    
+    /// Evaluate the integral for all the entries in an array of reduced temperatures, sharing the polynomials in \f$ \rho^* \f$
+    template<typename TType, typename RhoType>
+    auto get_J_matrix(const Eigen::ArrayXX<TType>& Tstar, const RhoType& rhostar) const{
+        const auto parts = get_rho_parts(rhostar);
+        return map_Tstar(Tstar, [&](const TType& Tstar_){ return get_J_from_parts(Tstar_, parts); });
+    }
+    
+private:
+    std::array<std::array<double, 5>, 4> a;
+    std::array<std::array<double, 5>, 3> b;
+    
+    /// The coefficients of the powers of \f$ T^* \f$, each a polynomial in \f$ \rho^* \f$
+    template<typename RhoType>
+    auto get_rho_parts(const RhoType& rhostar) const{
+        std::tuple<std::array<RhoType, 4>, std::array<RhoType, 3>> parts;
+        auto& [c, d] = parts;
+        for (auto j = 0U; j < c.size(); ++j){ c[j] = horner(a[j], rhostar); }
+        for (auto j = 0U; j < d.size(); ++j){ d[j] = horner(b[j], rhostar); }
+        return parts;
+    }
+    template<typename TType, typename RhoType>
+    auto get_J_from_parts(const TType& Tstar, const std::tuple<std::array<RhoType, 4>, std::array<RhoType, 3>>& parts) const{
+        const auto& [c, d] = parts;
+        std::common_type_t<TType, RhoType> summer = horner(c, Tstar) + exp(1.0/Tstar)*horner(d, Tstar);
         return pow(summer, n-2);
     }
 };
@@ -365,29 +489,55 @@ public:
     /// Constructor taking two three digit integers, each of which are split into tuples of ints
     GottschalkKIntegral(int k1, int k2) : k1(int2key(k1)), k2(int2key(k2)), abc(Gottschalk_K_coeffs.at({this->k1, this->k2})){}
     
+    /**
+     \f$ K = \sum_{i=0}^3\sum_{j=1}^2 a_{ij}\rho^{*i}e_1^j + \sum_{i=0}^3\sum_{j=1}^2 b_{ij}\rho^{*i}e_2^j + \sum_{i=0}^5\sum_{j=0}^3 c_{ij}\rho^{*i}T^{*j} \f$
+     with \f$ e_1 = \exp((1-\rho^{*}/3)/T^*) \f$ and \f$ e_2 = \exp((1-\rho^{*}/3)^2/T^*) \f$, evaluated with nested Horner schemes
+     */
     template<typename TType, typename RhoType>
     auto get_K(const TType& Tstar, const RhoType& rhostar) const{
-        std::common_type_t<TType, RhoType> summer = 0.0;
-        int N1 = 8, N2 = 8; // N3 = 24
-        
-        for (auto i = 0; i <= 3; ++i){
-            for (auto j = 1; j <= 2; ++j){
-                auto I = 2*i + (j-1); // 2 entries in j for each i
-                summer += abc[I]*pow(rhostar, i)*pow(exp((1.0-rhostar/3.0)/Tstar), j);
-            }
-        }
-        for (auto i = 0; i <= 3; ++i){
-            for (auto j = 1; j <= 2; ++j){
-                auto I = N1 + 2*i + (j-1); // 2 entries in j for each i
-                summer += abc[I]*pow(rhostar, i)*pow(exp((1.0-rhostar/3.0)*(1.0-rhostar/3.0)/Tstar), j);
-            }
-        }
-        for (auto i = 0; i <= 5; ++i){
-            for (auto j = 0; j <= 3; ++j){
-                auto I = N1 + N2 + 4*i + j; // 4 entries in j for each i
-                summer += abc[I]*pow(rhostar, i)*pow(Tstar, j);
+        return get_K_from_parts(Tstar, get_rho_parts(rhostar));
+    }
+    
+    /// Evaluate the integral for all the entries in an array of reduced temperatures, sharing the polynomials in \f$ \rho^* \f$
+    template<typename TType, typename RhoType>
+    auto get_K_matrix(const Eigen::ArrayXX<TType>& Tstar, const RhoType& rhostar) const{
+        const auto parts = get_rho_parts(rhostar);
+        return map_Tstar(Tstar, [&](const TType& Tstar_){ return get_K_from_parts(Tstar_, parts); });
+    }
+    
+private:
+    /// Coefficient matrices of the bivariate polynomials, stored as polynomials in rho^* for each power of the other variable
+    std::array<std::array<double, 4>, 2> a = make_coeffs<2, 4>(0, 2);
+    std::array<std::array<double, 4>, 2> b = make_coeffs<2, 4>(8, 2);
+    std::array<std::array<double, 6>, 4> c = make_coeffs<4, 6>(16, 4);
+    
+    template<std::size_t Nj, std::size_t Ni>
+    std::array<std::array<double, Ni>, Nj> make_coeffs(std::size_t offset, std::size_t stride) const {
+        std::array<std::array<double, Ni>, Nj> coeffs;
+        for (auto i = 0U; i < Ni; ++i){
+            for (auto j = 0U; j < Nj; ++j){
+                coeffs[j][i] = abc[offset + stride*i + j];
             }
         }
+        return coeffs;
+    }
+    
+    /// The coefficients of the powers of \f$ e_1 \f$, \f$ e_2 \f$ and \f$ T^* \f$, each a polynomial in \f$ \rho^* \f$, and the factor \f$ 1-\rho^{*}/3 \f$
+    template<typename RhoType>
+    auto get_rho_parts(const RhoType& rhostar) const{
+        std::array<RhoType, 9> parts;
+        parts[0] = horner(a[0], rhostar); parts[1] = horner(a[1], rhostar);
+        parts[2] = horner(b[0], rhostar); parts[3] = horner(b[1], rhostar);
+        for (auto j = 0U; j < c.size(); ++j){ parts[4+j] = horner(c[j], rhostar); }
+        parts[8] = 1.0-rhostar/3.0;
+        return parts;
+    }
+    template<typename TType, typename RhoType>
+    auto get_K_from_parts(const TType& Tstar, const std::array<RhoType, 9>& parts) const{
+        using type = std::common_type_t<TType, RhoType>;
+        const RhoType& g = parts[8];
+        type e1 = exp(g/Tstar), e2 = exp(g*g/Tstar);
+        type summer = e1*(parts[0] + parts[1]*e1) + e2*(parts[2] + parts[3]*e2) + parts[4] + Tstar*(parts[5] + Tstar*(parts[6] + Tstar*parts[7]));
         return summer;
     }
 };
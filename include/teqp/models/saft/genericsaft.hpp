@@ -1,5 +1,7 @@
 #pragma once
 
+#include <concepts>
+
 #include "teqp/models/pcsaft.hpp"
 #include "teqp/models/saftvrmie.hpp"
 #include "teqp/models/association/association.hpp"
@@ -61,7 +63,32 @@ public:
     NonPolarTerms nonpolar;
 //    std::optional<PolarTerms> polar;
     std::optional<AssociationTerms> association;
-    
+
+    /// Get the storage of a parameter for in-place updates; only the parameters of the nonpolar term (under /nonpolar/model) are supported
+    double* get_parameter_slot(const std::string& pointer){
+        const std::string prefix = "/nonpolar/model";
+        if (pointer.rfind(prefix + "/", 0) == 0){
+            auto subpointer = pointer.substr(prefix.size());
+            return std::visit([&](auto& t) -> double* {
+                if constexpr (requires { { t.get_parameter_slot(subpointer) } -> std::same_as<double*>; }){
+                    return t.get_parameter_slot(subpointer);
+                }
+                else{
+                    throw teqp::NotImplementedError("The nonpolar term does not support in-place parameter updates");
+                }
+            }, nonpolar);
+        }
+        throw teqp::NotImplementedError("The generic SAFT parameter at " + pointer + " cannot be updated in-place");
+    }
+    /// Propagate the values written to the parameter slots
+    void update_parameters(){
+        std::visit([](auto& t){
+            if constexpr (requires { t.update_parameters(); }){
+                t.update_parameters();
+            }
+        }, nonpolar);
+    }
+
     template <typename TType, typename RhoType, typename MoleFractions>
     auto alphar(const TType& T, const RhoType& rho, const MoleFractions& molefrac) const {
         auto contrib = std::visit([&](auto& t) { return t.alphar(T, rho, molefrac); }, nonpolar);
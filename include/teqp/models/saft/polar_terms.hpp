@@ -12,6 +12,7 @@
 #include "teqp/exceptions.hpp"
 #include "correlation_integrals.hpp"
 #include <optional>
+#include <complex>
 #include <Eigen/Dense>  
 #include "teqp/math/pow_templates.hpp"
 #include "teqp/models/saft/polar_terms/GrossVrabec.hpp"
@@ -37,6 +38,28 @@ auto get_Kijk_334445(const KType& Kint, const RhoType& rhostar, const Txy &Tstar
     return forceeval(-pow(-forceeval(Kint.get_K(Tstarij, rhostar)*Kint.get_K(Tstarik, rhostar)*Kint.get_K(Tstarjk, rhostar)), 1.0/3.0));
 };
 
+/// The same as above, but with the K integrals of all the pairs of components evaluated beforehand
+template<typename KType>
+auto get_Kijk(const Eigen::ArrayXX<KType>& Kij, std::size_t i, std::size_t j, std::size_t k){
+    return forceeval(pow(forceeval(Kij(i, j)*Kij(i, k)*Kij(j, k)), 1.0/3.0));
+};
+template<typename KType>
+auto get_Kijk_334445(const Eigen::ArrayXX<KType>& Kij, std::size_t i, std::size_t j, std::size_t k){
+    return forceeval(-pow(-forceeval(Kij(i, j)*Kij(i, k)*Kij(j, k)), 1.0/3.0));
+};
+
+/// The reduced temperatures \f$ T^*_{ij} = T/(\epsilon_{ij}/k_B) \f$ of all the pairs of components
+template<typename TTYPE>
+auto get_Tstarij(const TTYPE& T, const Eigen::MatrixXd& EPSKIJ){
+    Eigen::ArrayXX<TTYPE> Tstarij(EPSKIJ.rows(), EPSKIJ.cols());
+    for (auto i = 0; i < EPSKIJ.rows(); ++i){
+        for (auto j = 0; j < EPSKIJ.cols(); ++j){
+            Tstarij(i, j) = forceeval(T/EPSKIJ(i, j));
+        }
+    }
+    return Tstarij;
+}
+
 /**
  \tparam JIntegral A type that can be indexed with a single integer n to give the J^{(n)} integral
  \tparam KIntegral A type that can be indexed with a two integers a and b to give the K(a,b) integral
@@ -103,24 +126,27 @@ public:
         const RhoType factor_123 = -PI_*rhoN;
         const RhoType factor_224 = -14.0*PI_*rhoN/5.0;
         
+        // The integrals of all the pairs, sharing the parts that only depend on rho^*
+        const auto Tstarij = get_Tstarij(T, EPSKIJ);
+        const auto J6ij = J6.get_J_matrix(Tstarij, rhostar), J8ij = J8.get_J_matrix(Tstarij, rhostar), J10ij = J10.get_J_matrix(Tstarij, rhostar);
+        
         for (std::size_t i = 0; i < N; ++i){
             for (std::size_t j = 0; j < N; ++j){
 
-                TTYPE Tstari = forceeval(T/EPSKIJ(i, i)), Tstarj = forceeval(T/EPSKIJ(j, j));
+                const TTYPE &Tstari = Tstarij(i, i), &Tstarj = Tstarij(j, j);
                 XTtype leading = forceeval(x[i]*x[j]/(Tstari*Tstarj)); // common for all alpha_2 terms
-                TTYPE Tstarij = forceeval(T/EPSKIJ(i, j));
                 double sigmaij = SIGMAIJ(i,j);
                 {
                     double dbl = sigma_m3[i]*sigma_m3[j]/powi(sigmaij,3)*mubar2[i]*mubar2[j];
-                    alpha2_112 += leading*dbl*J6.get_J(Tstarij, rhostar);
+                    alpha2_112 += leading*dbl*J6ij(i, j);
                 }
                 {
                     double dbl = sigma_m3[i]*sigma_m5[j]/powi(sigmaij,5)*mubar2[i]*Qbar2[j];
-                    alpha2_123 += leading*dbl*J8.get_J(Tstarij, rhostar);
+                    alpha2_123 += leading*dbl*J8ij(i, j);
                 }
                 {
                     double dbl = sigma_m5[i]*sigma_m5[j]/powi(sigmaij,7)*Qbar2[i]*Qbar2[j];
-                    alpha2_224 += leading*dbl*J10.get_J(Tstarij, rhostar);
+                    alpha2_224 += leading*dbl*J10ij(i, j);
                 }
             }
         }
@@ -137,11 +163,22 @@ public:
         type summerA_112_112_224 = 0.0, summerA_112_123_213 = 0.0, summerA_123_123_224 = 0.0, summerA_224_224_224 = 0.0;
         type summerB_112_112_112 = 0.0, summerB_112_123_123 = 0.0, summerB_123_123_224 = 0.0, summerB_224_224_224 = 0.0;
         
+        // The integrals of all the pairs, sharing the parts that only depend on rho^*; the K integrals
+        // are only needed if the corresponding combination of multipoles is present
+        const auto Tstarij = get_Tstarij(T, EPSKIJ);
+        const auto J11ij = J11.get_J_matrix(Tstarij, rhostar), J13ij = J13.get_J_matrix(Tstarij, rhostar), J15ij = J15.get_J_matrix(Tstarij, rhostar);
+        const bool has_mu = (mubar2.abs() > 0).any(), has_Q = (Qbar2.abs() > 0).any();
+        auto get_K_matrix = [&](const KIntegral& K, bool needed){
+            using Kmat = decltype(K.get_K_matrix(Tstarij, rhostar));
+            return (needed) ? K.get_K_matrix(Tstarij, rhostar) : Kmat();
+        };
+        const auto K222_333ij = get_K_matrix(K222_333, has_mu), K233_344ij = get_K_matrix(K233_344, has_mu && has_Q);
+        const auto K334_445ij = get_K_matrix(K334_445, has_mu && has_Q), K444_555ij = get_K_matrix(K444_555, has_Q);
+        
         for (std::size_t i = 0; i < N; ++i){
             for (std::size_t j = 0; j < N; ++j){
 
-                TTYPE Tstari = forceeval(T/EPSKIJ(i,i)), Tstarj = forceeval(T/EPSKIJ(j,j));
-                TTYPE Tstarij = forceeval(T/EPSKIJ(i,j));
+                const TTYPE &Tstari = Tstarij(i, i), &Tstarj = Tstarij(j, j);
 
                 XTtype leading = forceeval(x[i]*x[j]/pow(forceeval(Tstari*Tstarj), 3.0/2.0)); // common for all alpha_3A terms
                 double sigmaij = SIGMAIJ(i,j);
@@ -152,47 +189,45 @@ public:
                 
                 {
                     double dbl = pow(sigma_m[i]*sigma_m[j], 11.0/2.0)/POW8sigmaij*mubar2[i]*mubar2[j]*sqrt(Qbar2[i]*Qbar2[j]);
-                    summerA_112_112_224 += leading*dbl*J11.get_J(Tstarij, rhostar);
+                    summerA_112_112_224 += leading*dbl*J11ij(i, j);
                 }
                 {
                     double dbl = pow(sigma_m[i]*sigma_m[j], 11.0/2.0)/POW8sigmaij*mubar2[i]*mubar2[j]*sqrt(Qbar2[i]*Qbar2[j]);
-                    summerA_112_123_213 += leading*dbl*J11.get_J(Tstarij, rhostar);
+                    summerA_112_123_213 += leading*dbl*J11ij(i, j);
                 }
                 {
                     double dbl = pow(sigma_m[i], 11.0/2.0)*pow(sigma_m[j], 15.0/2.0)/POW10sigmaij*mubar2[i]*sqrt(Qbar2[i])*pow(Qbar2[j], 3.0/2.0);
-                    summerA_123_123_224 += leading*dbl*J13.get_J(Tstarij, rhostar);
+                    summerA_123_123_224 += leading*dbl*J13ij(i, j);
                 }
                 {
                     double dbl = pow(sigma_m[i]*sigma_m[j], 15.0/2.0)/POW12sigmaij*pow(Qbar2[i], 3.0/2.0)*pow(Qbar2[j], 3.0/2.0);
-                    summerA_224_224_224 += leading*dbl*J15.get_J(Tstarij, rhostar);
+                    summerA_224_224_224 += leading*dbl*J15ij(i, j);
                 }
 
                 for (std::size_t k = 0; k < N; ++k){
-                    TTYPE Tstark = forceeval(T/EPSKIJ(k,k));
-                    TTYPE Tstarik = forceeval(T/EPSKIJ(i,k));
-                    TTYPE Tstarjk = forceeval(T/EPSKIJ(j,k));
+                    const TTYPE& Tstark = Tstarij(k, k);
                     double sigmaik = SIGMAIJ(i,k), sigmajk = SIGMAIJ(j,k);
 
                     // Lorentz-Berthelot mixing rules for sigma
                     XTtype leadingijk = forceeval(x[i]*x[j]*x[k]/(Tstari*Tstarj*Tstark));
 
                     if (std::abs(mubar2[i]*mubar2[j]*mubar2[k]) > 0){
-                        auto K222333 = get_Kijk(K222_333, rhostar, Tstarij, Tstarik, Tstarjk);
+                        auto K222333 = get_Kijk(K222_333ij, i, j, k);
                         double dbl = sigma_m3[i]*sigma_m3[j]*sigma_m3[k]/(sigmaij*sigmaik*sigmajk)*mubar2[i]*mubar2[j]*mubar2[k];
                         summerB_112_112_112 += forceeval(leadingijk*dbl*K222333);
                     }
                     if (std::abs(mubar2[i]*mubar2[j]*Qbar2[k]) > 0){
-                        auto K233344 = get_Kijk(K233_344, rhostar, Tstarij, Tstarik, Tstarjk);
+                        auto K233344 = get_Kijk(K233_344ij, i, j, k);
                         double dbl = sigma_m3[i]*sigma_m3[j]*sigma_m5[k]/(sigmaij*POW2(sigmaik*sigmajk))*mubar2[i]*mubar2[j]*Qbar2[k];
                         summerB_112_123_123 += leadingijk*dbl*K233344;
                     }
                     if (std::abs(mubar2[i]*Qbar2[j]*Qbar2[k]) > 0){
-                        auto K334445 = get_Kijk_334445(K334_445, rhostar, Tstarij, Tstarik, Tstarjk);
+                        auto K334445 = get_Kijk_334445(K334_445ij, i, j, k);
                         double dbl = sigma_m3[i]*sigma_m5[j]*sigma_m5[k]/(POW2(sigmaij*sigmaik)*POW3(sigmajk))*mubar2[i]*Qbar2[j]*Qbar2[k];
                         summerB_123_123_224 += leadingijk*dbl*K334445;
                     }
                     if (std::abs(Qbar2[i]*Qbar2[j]*Qbar2[k]) > 0){
-                        auto K444555 = get_Kijk(K444_555, rhostar, Tstarij, Tstarik, Tstarjk);
+                        auto K444555 = get_Kijk(K444_555ij, i, j, k);
                         double dbl = POW5(sigma_m[i]*sigma_m[j]*sigma_m[k])/(POW3(sigmaij*sigmaik*sigmajk))*Qbar2[i]*Qbar2[j]*Qbar2[k];
                         summerB_224_224_224 += leadingijk*dbl*K444555;
                     }
@@ -269,6 +304,19 @@ struct PolarizableArrays{
     Eigen::ArrayXd alpha_symm_C2m2J, alpha_asymm_C2m2J, alpha_isotropic_C2m2J, alpha_anisotropic_C2m2J;
 };
 
+namespace detail{
+/// The highest order of the derivatives carried by a numerical type; types that are not known here get a conservative value
+template<typename T> struct derivative_order{ static constexpr int value = 6; };
+template<> struct derivative_order<double>{ static constexpr int value = 0; };
+template<typename T> struct derivative_order<std::complex<T>>{ static constexpr int value = 1 + derivative_order<T>::value; };
+template<std::size_t N, typename T> struct derivative_order<autodiff::detail::Real<N, T>>{ static constexpr int value = static_cast<int>(N) + derivative_order<T>::value; };
+template<typename T, typename G> struct derivative_order<autodiff::detail::Dual<T, G>>{ static constexpr int value = 1 + derivative_order<T>::value; };
+template<int M> struct derivative_order<VectorHyperDual<M>>{ static constexpr int value = 2; };
+template<> struct derivative_order<AdjointVar>{ static constexpr int value = 1; };
+template<> struct derivative_order<DoubleDouble>{ static constexpr int value = 1; };
+template<int N, typename T> struct derivative_order<TaylorSeries<N, T>>{ static constexpr int value = N + derivative_order<T>::value; };
+}
+
 /**
  \tparam JIntegral A type that can be indexed with a single integer n to give the J^{(n)} integral
  \tparam KIntegral A type that can be indexed with a two integers a and b to give the K(a,b) integral
@@ -388,6 +436,32 @@ public:
         return coeff*get_Kijk(K444_555, rhostar, Tstarij, Tstarik, Tstarjk);
     }
     
+    /// The same as above, but with the integrals of all the pairs of components evaluated beforehand
+    template<typename JType>
+    auto get_In(const Eigen::ArrayXX<JType>& Jij, int n, std::size_t i, std::size_t j) const{
+        return 4.0*PI_/pow(SIGMAIJ(i, j), n-3)*Jij(i, j);
+    }
+    template<typename KType>
+    auto Immm(std::size_t i, std::size_t j, std::size_t k, const Eigen::ArrayXX<KType>& K222_333ij) const {
+        const double coeff = 64.0*PI3/5.0*sqrt(14*PI_/5.0)/SIGMAIJ(i,j)/SIGMAIJ(i,k)/SIGMAIJ(j,k);
+        return coeff*get_Kijk(K222_333ij, i, j, k);
+    }
+    template<typename KType>
+    auto ImmQ(std::size_t i, std::size_t j, std::size_t k, const Eigen::ArrayXX<KType>& K233_344ij) const {
+        const double coeff = 2048.0*PI3/7.0*sqrt(3.0*PI_)/SIGMAIJ(i,j)/POW2(SIGMAIJ(i,k)*SIGMAIJ(j,k));
+        return coeff*get_Kijk(K233_344ij, i, j, k);
+    }
+    template<typename KType>
+    auto ImQQ(std::size_t i, std::size_t j, std::size_t k, const Eigen::ArrayXX<KType>& K334_445ij) const {
+        const double coeff = -4096.0*PI3/9.0*sqrt(22.0*PI_/7.0)/POW2(SIGMAIJ(i,j)*SIGMAIJ(i,k))/POW3(SIGMAIJ(j,k));
+        return coeff*get_Kijk_334445(K334_445ij, i, j, k);
+    }
+    template<typename KType>
+    auto IQQQ(std::size_t i, std::size_t j, std::size_t k, const Eigen::ArrayXX<KType>& K444_555ij) const {
+        const double coeff = 8192.0*PI3/81.0*sqrt(2002.0*PI_)/POW3(SIGMAIJ(i,j)*SIGMAIJ(i,k)*SIGMAIJ(j,k));
+        return coeff*get_Kijk(K444_555ij, i, j, k);
+    }
+    
     /// Return \f$\alpha_2=A_2/(Nk_BT)\f$, thus this is a nondimensional term. This is equivalent to \f$-w_o^{(2)}/\rhoN\f$ from Gray et al.
     template<typename TTYPE, typename RhoType, typename RhoStarType, typename VecType, typename MuPrimeType>
     auto get_alpha2(const TTYPE& T, const RhoType& rhoN, const RhoStarType& rhostar, const VecType& mole_fractions, const MuPrimeType& muprime) const{
@@ -399,6 +473,8 @@ public:
         
         const TTYPE beta = forceeval(1.0/(k_B*T));
         const auto muprime2 = POW2(muprime).eval();
+        const auto Tstarij = get_Tstarij(T, EPSKIJ);
+        const auto J6ij = J6.get_J_matrix(Tstarij, rhostar), J8ij = J8.get_J_matrix(Tstarij, rhostar), J10ij = J10.get_J_matrix(Tstarij, rhostar);
         
         using ztype = std::common_type_t<TTYPE, decltype(muprime[0])>;
         // We have to do this type promotion to the ztype to allow for multiplication with
@@ -414,12 +490,10 @@ public:
         
         for (std::size_t i = 0; i < N; ++i){
             for (std::size_t j = 0; j < N; ++j){
-                TTYPE Tstarij = forceeval(T/EPSKIJ(i, j));
-                double sigmaij = SIGMAIJ(i,j);
                 summer += x[i]*x[j]*(
-                     3.0/2.0*(z1[i]*z1[j] - z2[i]*z2[j])*get_In(J6, 6, sigmaij, Tstarij, rhostar)
-                    + 3.0/2.0*z1[i]*beta*Q2[j]*get_In(J8, 8, sigmaij, Tstarij, rhostar)
-                    +7.0/10.0*beta*beta*Q2[i]*Q2[j]*get_In(J10, 10, sigmaij, Tstarij, rhostar)
+                     3.0/2.0*(z1[i]*z1[j] - z2[i]*z2[j])*get_In(J6ij, 6, i, j)
+                    + 3.0/2.0*z1[i]*beta*Q2[j]*get_In(J8ij, 8, i, j)
+                    +7.0/10.0*beta*beta*Q2[i]*Q2[j]*get_In(J10ij, 10, i, j)
                 );
             }
         }
@@ -435,6 +509,8 @@ public:
         using type_ = std::common_type_t<TTYPE, RhoType, RhoStarType, decltype(mole_fractions[0]), decltype(muprime[0])>;
         
         const TTYPE beta = 1.0/(k_B*T);
+        const auto Tstarij = get_Tstarij(T, EPSKIJ);
+        const auto J6ij = J6.get_J_matrix(Tstarij, rhostar), J8ij = J8.get_J_matrix(Tstarij, rhostar);
         using ztype = std::common_type_t<TTYPE, decltype(muprime[0])>;
         // We have to do this type promotion to the ztype to allow for multiplication with
         // Eigen array types, as some type promotion does not happen automatically
@@ -448,10 +524,8 @@ public:
         for (std::size_t i = 0; i < N; ++i){
             type_ summer = 0;
             for (std::size_t j = 0; j < N; ++j){
-                TTYPE Tstarij = T/EPSKIJ(i, j);
-                double sigmaij = SIGMAIJ(i, j);
                 auto rhoj = rhoN*x[j];
-                summer += rhoj*(2.0*z1[i]*get_In(J6, 6, sigmaij, Tstarij, rhostar) + beta*Q2[j]*get_In(J8, 8, sigmaij, Tstarij, rhostar) );
+                summer += rhoj*(2.0*z1[i]*get_In(J6ij, 6, i, j) + beta*Q2[j]*get_In(J8ij, 8, i, j) );
             }
             Eprime2[i] = muprime[i]*summer;
         }
@@ -469,6 +543,10 @@ public:
         
         const TTYPE beta = forceeval(1.0/(k_B*T));
         const auto muprime2 = POW2(muprime).eval();
+        const auto Tstarij = get_Tstarij(T, EPSKIJ);
+        const auto J11ij = J11.get_J_matrix(Tstarij, rhostar), J13ij = J13.get_J_matrix(Tstarij, rhostar), J15ij = J15.get_J_matrix(Tstarij, rhostar);
+        const auto K222_333ij = K222_333.get_K_matrix(Tstarij, rhostar), K233_344ij = K233_344.get_K_matrix(Tstarij, rhostar);
+        const auto K334_445ij = K334_445.get_K_matrix(Tstarij, rhostar), K444_555ij = K444_555.get_K_matrix(Tstarij, rhostar);
         // We have to do this type promotion to the ztype to allow for multiplication with
         // Eigen array types, as some type promotion does not happen automatically
         using ztype = std::common_type_t<TTYPE, decltype(muprime[0])>;
@@ -484,20 +562,17 @@ public:
         for (std::size_t i = 0; i < N; ++i){
             for (std::size_t j = 0; j < N; ++j){
                 
-                TTYPE Tstarij = forceeval(T/EPSKIJ(i,j));
-                double sigmaij = SIGMAIJ(i,j);
-                
-                auto a_ij = ((2.0/5.0*beta*beta*muprime2[i]*muprime2[j] + 4.0/5.0*gamma[i]*beta*muprime2[j] + 4.0/25.0*gamma[i]*gamma[j])*beta*Q[i]*Q[j]*get_In(J11, 11, sigmaij, Tstarij, rhostar)
-                             +12.0/35.0*(beta*muprime2[i] + gamma[i])*beta*beta*Q[i]*POW3(Q[j])*get_In(J13, 13, sigmaij, Tstarij, rhostar)
-                             + 36.0/245.0*POW3(beta)*Q3[i]*Q3[j]*get_In(J15, 15, sigmaij, Tstarij, rhostar)
+                auto a_ij = ((2.0/5.0*beta*beta*muprime2[i]*muprime2[j] + 4.0/5.0*gamma[i]*beta*muprime2[j] + 4.0/25.0*gamma[i]*gamma[j])*beta*Q[i]*Q[j]*get_In(J11ij, 11, i, j)
+                             +12.0/35.0*(beta*muprime2[i] + gamma[i])*beta*beta*Q[i]*POW3(Q[j])*get_In(J13ij, 13, i, j)
+                             + 36.0/245.0*POW3(beta)*Q3[i]*Q3[j]*get_In(J15ij, 15, i, j)
                              );
                 summer_a += x[i]*x[j]*a_ij;
                 
                 for (std::size_t k = 0; k < N; ++k){
                     auto b_ijk = (
-                      1.0/2.0*(z1[i]*z1[j]*z1[k] - z2[i]*z2[j]*z2[k])*Immm(i, j, k, T, rhostar)
-                      +C3b*(3.0/160.0*z1[i]*z1[j]*beta*Q2[k]*ImmQ(i, j, k, T, rhostar) + 3.0/640.0*z1[i]*POW2(beta)*Q2[j]*Q2[k]*ImQQ(i,j,k,T, rhostar))
-                      +1.0/6400.0*POW3(beta)*Q2[i]*Q2[j]*Q2[k]*IQQQ(i, j, k, T, rhostar)
+                      1.0/2.0*(z1[i]*z1[j]*z1[k] - z2[i]*z2[j]*z2[k])*Immm(i, j, k, K222_333ij)
+                      +C3b*(3.0/160.0*z1[i]*z1[j]*beta*Q2[k]*ImmQ(i, j, k, K233_344ij) + 3.0/640.0*z1[i]*POW2(beta)*Q2[j]*Q2[k]*ImQQ(i, j, k, K334_445ij))
+                      +1.0/6400.0*POW3(beta)*Q2[i]*Q2[j]*Q2[k]*IQQQ(i, j, k, K444_555ij)
                     );
                     summer_b += x[i]*x[j]*x[k]*b_ijk;
                 }
@@ -516,6 +591,9 @@ public:
         
         const TTYPE beta = forceeval(1.0/(k_B*T));
         const auto muprime2 = POW2(muprime).eval();
+        const auto Tstarij = get_Tstarij(T, EPSKIJ);
+        const auto J11ij = J11.get_J_matrix(Tstarij, rhostar), J13ij = J13.get_J_matrix(Tstarij, rhostar);
+        const auto K222_333ij = K222_333.get_K_matrix(Tstarij, rhostar), K233_344ij = K233_344.get_K_matrix(Tstarij, rhostar), K334_445ij = K334_445.get_K_matrix(Tstarij, rhostar);
         // We have to do this type promotion to the ztype to allow for multiplication with
         // Eigen array types, as some type promotion does not happen automatically
         using ztype = std::common_type_t<TTYPE, decltype(muprime[0])>;
@@ -531,17 +609,14 @@ public:
         type_ summer_ij = 0, summer_ijk = 0;
         for (std::size_t i = 0; i < N; ++i){
             for (std::size_t j = 0; j < N; ++j){
-                
-                TTYPE Tstarij = forceeval(T/EPSKIJ(i,j));
-                double sigmaij = SIGMAIJ(i,j);
-                auto p_ij = 8.0/5.0*(beta*muprime2[j] + gamma[j])*beta*Q[i]*Q[j]*get_In(J11, 11, sigmaij, Tstarij, rhostar) + 24.0/35.0*beta*beta*Q[i]*Q3[j]*get_In(J13, 13, sigmaij, Tstarij, rhostar);
+                auto p_ij = 8.0/5.0*(beta*muprime2[j] + gamma[j])*beta*Q[i]*Q[j]*get_In(J11ij, 11, i, j) + 24.0/35.0*beta*beta*Q[i]*Q3[j]*get_In(J13ij, 13, i, j);
                 summer_ij += (rhoN*x[j]*p_ij);
                 
                 for (std::size_t k = 0; k < N; ++k){
                     auto q_ijk = (
-                      z1[j]*z1[k]*Immm(i, j, k, T, rhostar)
-                      +C3b*1.0/40.0*z1[j]*beta*Q2[k]*ImmQ(i, j, k, T, rhostar)
-                      + 1.0/320.0*POW2(beta)*Q2[j]*Q2[k]*ImQQ(i,j,k,T, rhostar)
+                      z1[j]*z1[k]*Immm(i, j, k, K222_333ij)
+                      +C3b*1.0/40.0*z1[j]*beta*Q2[k]*ImmQ(i, j, k, K233_344ij)
+                      + 1.0/320.0*POW2(beta)*Q2[j]*Q2[k]*ImQQ(i, j, k, K334_445ij)
                     );
                     summer_ijk += POW2(rhoN)*x[j]*x[k]*q_ijk;
                 }
@@ -643,6 +718,93 @@ public:
         return muprime;
     }
     
+    /**
+     \brief Solve for the effective dipole moments with Newton's method
+     
+     The residual \f$ G(\mu') = \mu'-\mu-\alpha E'(\mu') \f$ is driven to zero in double precision, with the Jacobian of \f$ E' \f$ obtained
+     from complex step derivatives. The derivatives carried by the arguments are then propagated through the converged solution
+     with the implicit function theorem: each step \f$ \mu' \leftarrow \mu' - J^{-1}G(\mu') \f$ in the type of the arguments, with the Jacobian \f$ J \f$
+     of the converged solution, makes one more order of derivatives exact, so only as many steps are needed as the order of the derivatives.
+     */
+    template<typename TTYPE, typename RhoType, typename RhoStarType, typename VecType, typename MuPrimeType>
+    auto solve_muprime(const TTYPE& T, const RhoType& rhoN, const RhoStarType& rhostar, const VecType& mole_fractions, const MuPrimeType& mu, double rel_tol = 1e-14, int max_iter = 50) const{
+        if (!polarizable){
+            throw teqp::InvalidArgument("Can only use polarizable code if polarizability is enabled");
+        }
+        using otype = std::common_type_t<TTYPE, RhoType, RhoStarType, decltype(mole_fractions[0]), decltype(mu[0])>;
+        const auto N = mu.size();
+        const Eigen::ArrayXd& alpha_symm = polarizable.value().alpha_symm_C2m2J;
+        
+        // The base values of the arguments, in which the solution is carried out
+        const double T_ = getbaseval(T), rhoN_ = getbaseval(rhoN), rhostar_ = getbaseval(rhostar);
+        Eigen::ArrayXd x_(N), mu_(N);
+        for (auto i = 0; i < N; ++i){
+            x_[i] = getbaseval(mole_fractions[i]);
+            mu_[i] = getbaseval(mu[i]);
+        }
+        Eigen::ArrayX<otype> muprime = mu.template cast<otype>();
+        // E' is proportional to mu', so without any dipoles, no dipole moment is induced
+        const double muscale = mu_.abs().maxCoeff();
+        if (muscale == 0){
+            return muprime;
+        }
+        
+        auto get_G = [&](const Eigen::ArrayXd& muprime_){
+            return (muprime_ - mu_ - alpha_symm*get_Eprime(T_, rhoN_, rhostar_, x_, muprime_)).eval();
+        };
+        auto get_J = [&](const Eigen::ArrayXd& muprime_){
+            Eigen::MatrixXd J = Eigen::MatrixXd::Identity(N, N);
+            Eigen::ArrayX<std::complex<double>> muprimec = muprime_.template cast<std::complex<double>>();
+            const double h = 1e-20*muscale;
+            for (auto k = 0; k < N; ++k){
+                muprimec[k] += std::complex<double>(0.0, h);
+                Eigen::ArrayX<std::complex<double>> Eprimec = get_Eprime(T_, rhoN_, rhostar_, x_, muprimec);
+                for (auto i = 0; i < N; ++i){
+                    J(i, k) -= alpha_symm[i]*Eprimec[i].imag()/h;
+                }
+                muprimec[k] = muprime_[k];
+            }
+            return J;
+        };
+        
+        Eigen::ArrayXd muprime_ = mu_;
+        Eigen::PartialPivLU<Eigen::MatrixXd> LU;
+        for (auto counter = 0; ; ++counter){
+            if (counter == max_iter){
+                throw teqp::IterationFailure("Could not obtain the effective dipole moments after " + std::to_string(max_iter) + " Newton iterations");
+            }
+            LU.compute(get_J(muprime_));
+            Eigen::ArrayXd dmuprime = LU.solve(-get_G(muprime_).matrix()).array();
+            muprime_ += dmuprime;
+            if (!std::isfinite(dmuprime.sum())){
+                throw teqp::IterationFailure("The Newton step for the effective dipole moments is not finite");
+            }
+            if (dmuprime.abs().maxCoeff() <= rel_tol*muprime_.abs().maxCoeff()){
+                break;
+            }
+        }
+        
+        if constexpr (std::is_same_v<otype, double>){
+            return muprime_;
+        }
+        else{
+            muprime = muprime_.template cast<otype>();
+            const Eigen::MatrixXd Jinv = LU.inverse();
+            for (auto step = 0; step < detail::derivative_order<otype>::value; ++step){
+                Eigen::ArrayX<otype> Eprime = get_Eprime(T, rhoN, rhostar, mole_fractions, muprime).template cast<otype>();
+                Eigen::ArrayX<otype> G = muprime - mu.template cast<otype>() - alpha_symm.template cast<otype>()*Eprime;
+                for (auto i = 0; i < N; ++i){
+                    otype summer = 0.0;
+                    for (auto j = 0; j < N; ++j){
+                        summer += Jinv(i, j)*G[j];
+                    }
+                    muprime[i] -= summer;
+                }
+            }
+            return muprime;
+        }
+    }
+    
     /***
      * \brief Get the contribution to \f$ \alpha = A/(NkT) \f$
      */
@@ -667,7 +829,7 @@ public:
         }
         else{
             // First solve for the effective dipole moments
-            auto muprime = iterate_muprime_SS(T, rhoN, rhostar, mole_fractions, mu, 10); // C m, array
+            auto muprime = solve_muprime(T, rhoN, rhostar, mole_fractions, mu); // C m, array
             // And the polarization energy derivative, units of J /(C m)
             auto Eprime = get_Eprime(T, rhoN, rhostar, mole_fractions, muprime); // array
             using Eprime_t = std::decay_t<decltype(Eprime[0])>;
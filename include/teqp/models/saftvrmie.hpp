@@ -248,18 +248,18 @@ struct SAFTVRMieChainContributionTerms{
     
     public:
     
-    // One entry per component
-    const Eigen::ArrayXd m, epsilon_over_k, sigma_A, lambda_a, lambda_r;
-    const Eigen::ArrayXXd kmat;
+    // One entry per component (not const so that they can be updated in-place, see update_parameters)
+    Eigen::ArrayXd m, epsilon_over_k, sigma_A, lambda_a, lambda_r;
+    Eigen::ArrayXXd kmat;
 
     const Eigen::Index N;
     const EpsilonijFlags epsilon_ij_flag = EpsilonijFlags::kLafitte;
 
     // Calculated matrices for the ij pair
-    const Eigen::ArrayXXd lambda_r_ij, lambda_a_ij, C_ij, alpha_ij, sigma_ij, epsilon_ij; // Matrices of parameters
+    Eigen::ArrayXXd lambda_r_ij, lambda_a_ij, C_ij, alpha_ij, sigma_ij, epsilon_ij; // Matrices of parameters
 
-    const std::vector<Eigen::ArrayXXd> crnij, canij, c2rnij, c2anij, carnij;
-    const std::vector<Eigen::ArrayXXd> fkij; // Matrices of parameters
+    std::vector<Eigen::ArrayXXd> crnij, canij, c2rnij, c2anij, carnij;
+    std::vector<Eigen::ArrayXXd> fkij; // Matrices of parameters
 
     SAFTVRMieChainContributionTerms(
             const Eigen::ArrayXd& m,
@@ -280,6 +280,37 @@ struct SAFTVRMieChainContributionTerms{
         fkij(get_fkij())
     {}
     
+    /**
+     \brief Get the storage of a parameter for in-place updates, see AbstractModel::get_parameter_slot
+     
+     The supported pointers are /coeffs/i/m, /coeffs/i/sigma_Angstrom, /coeffs/i/epsilon_over_k, /coeffs/i/lambda_r, /coeffs/i/lambda_a, and /kmat/i/j
+     */
+    double* get_parameter_slot(const std::string& pointer){
+        auto tokens = split_JSON_pointer(pointer);
+        if (tokens.size() == 3 && tokens[0] == "coeffs"){
+            auto i = JSON_pointer_index(tokens[1], N);
+            if (tokens[2] == "m"){ return &m[i]; }
+            if (tokens[2] == "sigma_Angstrom"){ return &sigma_A[i]; }
+            if (tokens[2] == "epsilon_over_k"){ return &epsilon_over_k[i]; }
+            if (tokens[2] == "lambda_r"){ return &lambda_r[i]; }
+            if (tokens[2] == "lambda_a"){ return &lambda_a[i]; }
+        }
+        if (tokens.size() == 3 && tokens[0] == "kmat"){
+            return &kmat(JSON_pointer_index(tokens[1], N), JSON_pointer_index(tokens[2], N));
+        }
+        throw teqp::NotImplementedError("The SAFT-VR-Mie parameter at " + pointer + " cannot be updated in-place");
+    }
+    
+    /// Recalculate the matrices for the ij pairs after the parameter slots were written, in the same order as in the constructor
+    void update_parameters(){
+        lambda_r_ij = get_lambda_k_ij(lambda_r); lambda_a_ij = get_lambda_k_ij(lambda_a);
+        C_ij = get_C_ij(); alpha_ij = C_ij*(1/(lambda_a_ij-3) - 1/(lambda_r_ij-3));
+        sigma_ij = get_sigma_ij(); epsilon_ij = get_epsilon_ij();
+        crnij = get_crnij(); canij = get_canij();
+        c2rnij = get_c2rnij(); c2anij = get_c2anij(); carnij = get_carnij();
+        fkij = get_fkij();
+    }
+    
     /// Get the matrix of \f$\varepsilon_{ij}/k_B\f$ with the entries in K
     auto get_EPSKIJ_K_matrix() const { return epsilon_ij; }
     /// Get the matrix of \f$\sigma_{ij}\f$ with the entries in m
@@ -777,7 +808,7 @@ class SAFTVRMieNonpolarMixture {
 private:
     
     std::vector<std::string> names, bibtex;
-    const SAFTVRMieChainContributionTerms terms;
+    SAFTVRMieChainContributionTerms terms;
 
     static void check_kmat(const Eigen::ArrayXXd& kmat, Eigen::Index N) {
         if (kmat.size() == 0){
@@ -844,6 +875,11 @@ public:
         return SAFTVRMieNonpolarMixture::build_chain(coeffs, kmat);
     }
     
+    /// Get the storage of a parameter for in-place updates, see SAFTVRMieChainContributionTerms::get_parameter_slot
+    double* get_parameter_slot(const std::string& pointer){ return terms.get_parameter_slot(pointer); }
+    /// Propagate the values written to the parameter slots
+    void update_parameters(){ terms.update_parameters(); }
+    
     const auto& get_terms() const { return terms; }
     auto get_core_calcs(double T, double rhomolar, const Eigen::ArrayXd& mole_fractions) const {
         auto val = terms.get_core_calcs(T, rhomolar, mole_fractions);
@@ -922,7 +958,7 @@ class SAFTVRMieMixture {
 private:
     
     std::vector<std::string> names, bibtex;
-    const SAFTVRMieChainContributionTerms terms;
+    SAFTVRMieChainContributionTerms terms;
     const std::optional<SAFTpolar::multipolar_contributions_variant> polar; // Can be present or not
 
     static void check_kmat(const Eigen::ArrayXXd& kmat, Eigen::Index N) {
@@ -1012,6 +1048,24 @@ public:
         SAFTVRMieMixture::build_chain(coeffs, kmat);
     }
     
+    /**
+     \brief Get the storage of a parameter for in-place updates, see SAFTVRMieChainContributionTerms::get_parameter_slot
+     
+     When a polar contribution is present, only the parameters that it does not depend on (kmat and the exponents) can be updated in-place
+     */
+    double* get_parameter_slot(const std::string& pointer){
+        if (polar){
+            auto tokens = split_JSON_pointer(pointer);
+            bool polar_independent = (tokens.size() == 3 && (tokens[0] == "kmat" || tokens[2] == "lambda_r" || tokens[2] == "lambda_a"));
+            if (!polar_independent){
+                throw teqp::NotImplementedError("The SAFT-VR-Mie parameter at " + pointer + " cannot be updated in-place when a polar contribution is present");
+            }
+        }
+        return terms.get_parameter_slot(pointer);
+    }
+    /// Propagate the values written to the parameter slots
+    void update_parameters(){ terms.update_parameters(); }
+    
     const auto& get_polar() const { return polar; }
     
     // Checker for whether a polar term is present
@@ -1343,4 +1397,7 @@ inline auto SAFTVRMiefactory(const nlohmann::json & spec){
 }
 
 } /* namespace SAFTVRMie */
+
+template<> struct supports_adjoint_t<SAFTVRMie::SAFTVRMieMixture> : public std::true_type {};
+
 }; // namespace teqp
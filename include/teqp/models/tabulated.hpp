@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TEQP_TABULATED_HAS_MMAP
+#endif
+
+#include "nlohmann/json.hpp"
+
+#include "teqp/types.hpp"
+#include "teqp/exceptions.hpp"
+
+namespace teqp {
+namespace tabulated {
+
+/**
+ \brief The fixed-size header at the beginning of a binary tabulation file
+
+ The header is followed immediately by a contiguous block of doubles (see TabulatedAlphar for the ordering), so that the file
+ can be memory-mapped and the values used in place without any parsing or copying
+ */
+struct TabulationFileHeader {
+    char magic[8]; ///< Always "TEQPTAB1"
+    std::uint64_t version; ///< Version of the file layout
+    std::uint64_t NT; ///< Number of temperature nodes
+    std::uint64_t Nrho; ///< Number of density nodes
+    std::uint64_t Ncomp; ///< Number of components in the (fixed) composition
+    std::uint64_t Nsat; ///< Number of points in the saturation curve (zero if not a pure fluid)
+    std::uint64_t pad[3]; ///< Reserved for future use, keeps the header 8-byte aligned
+    double R; ///< The molar gas constant of the wrapped model at the tabulated composition
+    double max_abs_err_alphar; ///< Maximum absolute error in \f$\alpha^r\f$ at the validation points
+    double max_abs_err_Ar01; ///< Maximum absolute error in \f$\Lambda^r_{01}\f$ at the validation points
+    double max_abs_err_Ar10; ///< Maximum absolute error in \f$\Lambda^r_{10}\f$ at the validation points
+};
+static_assert(sizeof(TabulationFileHeader) % sizeof(double) == 0);
+
+/// Owner of the contiguous block of doubles holding the table, either on the heap or memory-mapped from a file
+class TableMemory {
+public:
+    virtual ~TableMemory() = default;
+    virtual const double* data() const = 0;
+    virtual std::size_t size() const = 0;
+};
+
+/// The table block lives in a std::vector
+class VectorTableMemory : public TableMemory {
+private:
+    std::vector<double> buf;
+public:
+    VectorTableMemory(std::vector<double>&& buf) : buf(std::move(buf)) {};
+    const double* data() const override { return buf.data(); }
+    std::size_t size() const override { return buf.size(); }
+};
+
+#if defined(TEQP_TABULATED_HAS_MMAP)
+/// The table block is a read-only memory map of a file, unmapped when the last model referring to it is destroyed
+class MappedTableMemory : public TableMemory {
+private:
+    void* addr = nullptr;
+    std::size_t length = 0;
+    std::size_t offset_doubles = 0, Ndoubles = 0;
+public:
+    MappedTableMemory(const std::string& path, std::size_t offset_bytes) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw teqp::InvalidArgument("Unable to open tabulation file: " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw teqp::InvalidArgument("Unable to stat tabulation file: " + path);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping remains valid after closing the descriptor
+        if (addr == MAP_FAILED) {
+            addr = nullptr;
+            throw teqp::InvalidArgument("Unable to memory-map tabulation file: " + path);
+        }
+        offset_doubles = offset_bytes / sizeof(double);
+        Ndoubles = (length - offset_bytes) / sizeof(double);
+    }
+    ~MappedTableMemory() override {
+        if (addr != nullptr) { ::munmap(addr, length); }
+    }
+    MappedTableMemory(const MappedTableMemory&) = delete;
+    MappedTableMemory& operator=(const MappedTableMemory&) = delete;
+    const double* data() const override { return static_cast<const double*>(addr) + offset_doubles; }
+    std::size_t size() const override { return Ndoubles; }
+};
+#endif
+
+/**
+ \brief A residual Helmholtz energy model obtained by piecewise bicubic Hermite interpolation of \f$\alpha^r\f$ in \f$(T,\rho)\f$ for a fixed composition
+
+ At each node of a (non-uniform) rectilinear grid, the values of \f$\alpha^r\f$, \f$\partial\alpha^r/\partial T\f$, \f$\partial\alpha^r/\partial\rho\f$
+ and \f$\partial^2\alpha^r/\partial T\partial\rho\f$ are stored. Within each cell the interpolant is the bicubic Hermite patch matching
+ these values at the four corners, so the interpolant is continuously differentiable over the whole box. Because the
+ interpolant is a polynomial in \f$T\f$ and \f$\rho\f$, it can be evaluated with any numerical type, and thus all the
+ derivative machinery of teqp works without modification.
+
+ The table block is a contiguous array of doubles in the order:
+ z[Ncomp], Tnodes[NT], rhonodes[Nrho], f[NT*Nrho], fT[NT*Nrho], frho[NT*Nrho], fTrho[NT*Nrho], excluded[(NT-1)*(Nrho-1)], Tsat[Nsat], rhoLsat[Nsat], rhoVsat[Nsat]
+ with the node arrays stored with the density index varying fastest.
+
+ Cells that lie entirely within the vapor-liquid dome of a pure fluid can be marked as excluded when the table is built; the error
+ of the interpolant is not controlled there and evaluating the model in those cells raises an exception.
+ */
+class TabulatedAlphar {
+private:
+    std::shared_ptr<const TableMemory> mem;
+    TabulationFileHeader header;
+    const double *z_ = nullptr, *T_ = nullptr, *rho_ = nullptr, *f_ = nullptr, *fT_ = nullptr, *frho_ = nullptr, *fTrho_ = nullptr, *excluded_ = nullptr, *Tsat_ = nullptr, *rhoLsat_ = nullptr, *rhoVsat_ = nullptr;
+    nlohmann::json build_report;
+
+    static std::size_t get_Ndoubles(const TabulationFileHeader& h) {
+        return h.Ncomp + h.NT + h.Nrho + 4*h.NT*h.Nrho + (h.NT-1)*(h.Nrho-1) + 3*h.Nsat;
+    }
+
+    void set_pointers() {
+        if (header.NT < 2 || header.Nrho < 2) {
+            throw teqp::InvalidArgument("Tabulation must have at least two nodes in each direction");
+        }
+        if (mem->size() < get_Ndoubles(header)) {
+            throw teqp::InvalidArgument("Tabulation data block is too small for the dimensions in the header");
+        }
+        const double* p = mem->data();
+        auto NN = header.NT*header.Nrho;
+        z_ = p; p += header.Ncomp;
+        T_ = p; p += header.NT;
+        rho_ = p; p += header.Nrho;
+        f_ = p; p += NN;
+        fT_ = p; p += NN;
+        frho_ = p; p += NN;
+        fTrho_ = p; p += NN;
+        excluded_ = p; p += (header.NT-1)*(header.Nrho-1);
+        Tsat_ = p; p += header.Nsat;
+        rhoLsat_ = p; p += header.Nsat;
+        rhoVsat_ = p; p += header.Nsat;
+    }
+
+    /// Index of the interval containing x, clamped to the valid range of intervals
+    static std::size_t locate(const double* nodes, std::size_t N, double x) {
+        auto it = std::upper_bound(nodes, nodes + N, x);
+        auto i = static_cast<std::ptrdiff_t>(it - nodes) - 1;
+        return static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(i, 0, static_cast<std::ptrdiff_t>(N) - 2));
+    }
+
+public:
+    /// Construct from a header and the block of doubles that matches it
+    TabulatedAlphar(const TabulationFileHeader& h, std::shared_ptr<const TableMemory> memory, const nlohmann::json& report = nlohmann::json::object()) : mem(std::move(memory)), header(h), build_report(report) {
+        set_pointers();
+    }
+
+    /// Get the gas constant, the same as the wrapped model at the tabulated composition
+    template<class VecType>
+    auto R(const VecType& /*molefrac*/) const { return header.R; }
+
+    auto get_NT() const { return header.NT; }
+    auto get_Nrho() const { return header.Nrho; }
+    auto get_Tmin() const { return T_[0]; }
+    auto get_Tmax() const { return T_[header.NT-1]; }
+    auto get_rhomin() const { return rho_[0]; }
+    auto get_rhomax() const { return rho_[header.Nrho-1]; }
+    Eigen::ArrayXd get_molefrac() const { return Eigen::Map<const Eigen::ArrayXd>(z_, header.Ncomp); }
+    Eigen::ArrayXd get_Tnodes() const { return Eigen::Map<const Eigen::ArrayXd>(T_, header.NT); }
+    Eigen::ArrayXd get_rhonodes() const { return Eigen::Map<const Eigen::ArrayXd>(rho_, header.Nrho); }
+    /// Return the saturation curve (T, rhoL, rhoV) that was used to exclude two-phase cells (empty for mixtures)
+    auto get_saturation_curve() const {
+        return std::make_tuple(Eigen::Map<const Eigen::ArrayXd>(Tsat_, header.Nsat).eval(), Eigen::Map<const Eigen::ArrayXd>(rhoLsat_, header.Nsat).eval(), Eigen::Map<const Eigen::ArrayXd>(rhoVsat_, header.Nsat).eval());
+    }
+    /// True if the cell containing (T, rho) was excluded because it lies within the two-phase region
+    bool is_excluded(double T, double rho) const {
+        auto i = locate(T_, header.NT, T), j = locate(rho_, header.Nrho, rho);
+        return excluded_[i*(header.Nrho-1) + j] != 0.0;
+    }
+    /// The errors at the validation points, and other information about the construction of the table
+    nlohmann::json get_build_report() const {
+        nlohmann::json j = build_report;
+        j["NT"] = header.NT;
+        j["Nrho"] = header.Nrho;
+        j["max_abs_err_alphar"] = header.max_abs_err_alphar;
+        j["max_abs_err_Ar01"] = header.max_abs_err_Ar01;
+        j["max_abs_err_Ar10"] = header.max_abs_err_Ar10;
+        return j;
+    }
+
+    /**
+     \brief The residual Helmholtz energy \f$\alpha^r\f$, from the bicubic Hermite patch of the cell containing (T, rho)
+     \param T Temperature
+     \param rho Molar density
+     \param molefrac The mole fractions, which must be of the same length as those used to build the table; their values are not used
+     */
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar(const TType& T, const RhoType& rho, const MoleFracType& molefrac) const {
+        if (static_cast<std::size_t>(molefrac.size()) != header.Ncomp) {
+            throw teqp::InvalidArgument("mole fractions must be of size " + std::to_string(header.Ncomp) + " but are of size " + std::to_string(molefrac.size()));
+        }
+        const double Tval = getbaseval(T), rhoval = getbaseval(rho);
+        if (Tval < T_[0] || Tval > T_[header.NT-1] || rhoval < rho_[0] || rhoval > rho_[header.Nrho-1]) {
+            throw teqp::InvalidArgument("State point (T=" + std::to_string(Tval) + " K, rho=" + std::to_string(rhoval) + " mol/m^3) is outside the tabulated range");
+        }
+        const auto Nrho = header.Nrho;
+        const auto i = locate(T_, header.NT, Tval), j = locate(rho_, Nrho, rhoval);
+        if (excluded_[i*(Nrho-1) + j] != 0.0) {
+            throw teqp::InvalidArgument("State point (T=" + std::to_string(Tval) + " K, rho=" + std::to_string(rhoval) + " mol/m^3) is within the two-phase region excluded from the tabulation");
+        }
+        const double hT = T_[i+1] - T_[i], hrho = rho_[j+1] - rho_[j];
+        auto t = forceeval((T - T_[i])/hT);
+        auto u = forceeval((rho - rho_[j])/hrho);
+
+        // Cubic Hermite basis functions; H0 for the values and H1 for the derivatives at the left (0) and right (1) ends
+        auto t2 = forceeval(t*t), u2 = forceeval(u*u);
+        auto t3 = forceeval(t2*t), u3 = forceeval(u2*u);
+        auto H0t0 = forceeval(1.0 - 3.0*t2 + 2.0*t3), H0t1 = forceeval(3.0*t2 - 2.0*t3);
+        auto H1t0 = forceeval(hT*(t - 2.0*t2 + t3)), H1t1 = forceeval(hT*(t3 - t2));
+        auto H0u0 = forceeval(1.0 - 3.0*u2 + 2.0*u3), H0u1 = forceeval(3.0*u2 - 2.0*u3);
+        auto H1u0 = forceeval(hrho*(u - 2.0*u2 + u3)), H1u1 = forceeval(hrho*(u3 - u2));
+
+        auto corner = [&](std::size_t k, const auto& H0t, const auto& H1t, const auto& H0u, const auto& H1u) {
+            return forceeval(H0t*(H0u*f_[k] + H1u*frho_[k]) + H1t*(H0u*fT_[k] + H1u*fTrho_[k]));
+        };
+        const auto k00 = i*Nrho + j, k01 = k00 + 1, k10 = k00 + Nrho, k11 = k10 + 1;
+        return forceeval(corner(k00, H0t0, H1t0, H0u0, H1u0) + corner(k01, H0t0, H1t0, H0u1, H1u1)
+                       + corner(k10, H0t1, H1t1, H0u0, H1u0) + corner(k11, H0t1, H1t1, H0u1, H1u1));
+    }
+
+    /// Write the table to a binary file that can be later loaded (and memory-mapped) with load_tabulation
+    void save(const std::string& path) const {
+        std::ofstream ofs(path, std::ios::binary);
+        if (!ofs) {
+            throw teqp::InvalidArgument("Unable to open file for writing: " + path);
+        }
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char*>(mem->data()), static_cast<std::streamsize>(get_Ndoubles(header)*sizeof(double)));
+        if (!ofs) {
+            throw teqp::InvalidArgument("Unable to write tabulation to: " + path);
+        }
+    }
+
+    /// Store the complete table in JSON format
+    nlohmann::json to_json() const {
+        const double* p = mem->data();
+        return {
+            {"version", header.version}, {"NT", header.NT}, {"Nrho", header.Nrho}, {"Ncomp", header.Ncomp}, {"Nsat", header.Nsat},
+            {"R", header.R},
+            {"max_abs_err_alphar", header.max_abs_err_alphar}, {"max_abs_err_Ar01", header.max_abs_err_Ar01}, {"max_abs_err_Ar10", header.max_abs_err_Ar10},
+            {"data", std::vector<double>(p, p + get_Ndoubles(header))},
+            {"build_report", build_report}
+        };
+    }
+
+    /// Make the model from the JSON data generated by to_json
+    static TabulatedAlphar from_json(const nlohmann::json& j) {
+        TabulationFileHeader h{};
+        std::memcpy(h.magic, "TEQPTAB1", 8);
+        h.version = j.at("version"); h.NT = j.at("NT"); h.Nrho = j.at("Nrho"); h.Ncomp = j.at("Ncomp"); h.Nsat = j.at("Nsat");
+        h.R = j.at("R");
+        h.max_abs_err_alphar = j.at("max_abs_err_alphar"); h.max_abs_err_Ar01 = j.at("max_abs_err_Ar01"); h.max_abs_err_Ar10 = j.at("max_abs_err_Ar10");
+        auto mem = std::make_shared<VectorTableMemory>(j.at("data").get<std::vector<double>>());
+        return TabulatedAlphar(h, mem, j.value("build_report", nlohmann::json::object()));
+    }
+};
+
+/**
+ \brief Load a binary tabulation written by TabulatedAlphar::save
+ \param path The path to the file
+ \param mmap If true (and supported on this platform), memory-map the file rather than reading it into memory
+ */
+inline TabulatedAlphar load_tabulation(const std::string& path, bool mmap = true) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw teqp::InvalidArgument("Unable to open tabulation file: " + path);
+    }
+    TabulationFileHeader h;
+    ifs.read(reinterpret_cast<char*>(&h), sizeof(h));
+    if (!ifs || std::strncmp(h.magic, "TEQPTAB1", 8) != 0) {
+        throw teqp::InvalidArgument("File is not a valid teqp tabulation: " + path);
+    }
+    std::shared_ptr<const TableMemory> mem;
+#if defined(TEQP_TABULATED_HAS_MMAP)
+    if (mmap) {
+        mem = std::make_shared<MappedTableMemory>(path, sizeof(h));
+    }
+#endif
+    if (!mem) {
+        std::vector<double> buf(h.Ncomp + h.NT + h.Nrho + 4*h.NT*h.Nrho + (h.NT-1)*(h.Nrho-1) + 3*h.Nsat);
+        ifs.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()*sizeof(double)));
+        if (!ifs) {
+            throw teqp::InvalidArgument("Tabulation file is truncated: " + path);
+        }
+        mem = std::make_shared<VectorTableMemory>(std::move(buf));
+    }
+    return TabulatedAlphar(h, mem, nlohmann::json{{"path", path}});
+}
+
+} // namespace tabulated
+} // namespace teqp
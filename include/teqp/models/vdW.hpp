@@ -18,6 +18,16 @@ public:
     double get_a() const{ return a; }
     double get_b() const{ return b; }
 
+    /// \brief Get the storage of a parameter for in-place updates, see AbstractModel::get_parameter_slot
+    /// \note The supported pointers are /a and /b
+    double* get_parameter_slot(const std::string& pointer){
+        if (pointer == "/a"){ return &a; }
+        if (pointer == "/b"){ return &b; }
+        throw teqp::NotImplementedError("The vdW parameter at " + pointer + " cannot be updated in-place");
+    }
+    /// Nothing is derived from a and b, so there is nothing to update after the parameter slots were written
+    void update_parameters(){}
+
     const double Ru = 1.380649e-23 * 6.02214076e23; ///< Exact value, given by k_B*N_A
 
     /// \brief Get the universal gas constant 
@@ -127,4 +137,6 @@ public:
     }
 };
 
+template<typename NumType> struct supports_adjoint_t<vdWEOS<NumType>> : public std::true_type {};
+
 }; // namespace teqp
@@ -27,6 +27,10 @@ namespace teqp {
 #endif
 
 #include "teqp/exceptions.hpp"
+#include "teqp/math/hyperdual.hpp"
+#include "teqp/math/adjoint.hpp"
+#include "teqp/math/doubledouble.hpp"
+#include "teqp/math/taylor.hpp"
 
 // autodiff include
 #include <autodiff/forward/dual.hpp>
@@ -34,6 +38,18 @@ namespace teqp {
 #include <autodiff/forward/dual/eigen.hpp>
 using namespace autodiff;
 
+// The vector-mode hyperdual numbers carry second derivatives, the adjoint numbers first derivatives
+namespace autodiff::detail {
+    template<int M> struct NumberTraits<teqp::VectorHyperDual<M>> {
+        using NumericType = double;
+        static constexpr auto Order = 2;
+    };
+    template<> struct NumberTraits<teqp::AdjointVar> {
+        using NumericType = double;
+        static constexpr auto Order = 1;
+    };
+}
+
 namespace teqp {
 
     // Registration of types that are considered to be containers
@@ -48,6 +64,12 @@ namespace teqp {
     template <typename T, int... Is> struct is_eigen_impl<Eigen::Matrix<T, Is...>> : std::true_type {};
     template <typename T, int... Is> struct is_eigen_impl<Eigen::Array<T, Is...>> : std::true_type {};
 
+    /// The number of elements of a vector known at compile time, or Eigen::Dynamic if it is not (including for containers that are not Eigen vectors)
+    template <typename T> struct compile_time_size { static constexpr int value = Eigen::Dynamic; };
+    template <typename T, int R, int O, int MR> struct compile_time_size<Eigen::Array<T, R, 1, O, MR, 1>> { static constexpr int value = R; };
+    template <typename T, int R, int O, int MR> struct compile_time_size<Eigen::Matrix<T, R, 1, O, MR, 1>> { static constexpr int value = R; };
+    template <typename T> constexpr int compile_time_size_v = compile_time_size<std::decay_t<T>>::value;
+
     template<typename T>
     auto forceeval(T&& expr)
     {
@@ -96,6 +118,15 @@ namespace teqp {
         else if constexpr (is_complex_t<T>()) {
             return expr.real();
         }
+        else if constexpr (is_vectorhyperdual_t<T>() || is_adjointvar_t<T>()) {
+            return expr.val;
+        }
+        else if constexpr (is_doubledouble_t<T>()) {
+            return static_cast<double>(expr);
+        }
+        else if constexpr (is_taylorseries_t<T>()) {
+            return getbaseval(expr[0]);
+        }
         else if constexpr (is_mcx_t<T>()) {
 #if defined(TEQP_MULTIPRECISION_ENABLED)
             // Argument is a multicomplex of a boost multiprecision
@@ -158,6 +158,48 @@ EXPORT_CODE int CONVENTION get_ATrhoXiXjXk(const long long int uuid, const doubl
     return errcode;
 }
 
+EXPORT_CODE int CONVENTION get_ATrhoXi_all(const long long int uuid, const double T, const int NT, const double rhomolar, const int ND, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        // Make an Eigen view of the double buffer
+        Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
+        // Call the function and copy into the output buffer
+        Eigen::Map<Eigen::ArrayXd>(val, Ncomp) = library.at(uuid)->get_ATrhoXi_all(T, NT, rhomolar, ND, molefrac_);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION get_ATrhoXiXj_all(const long long int uuid, const double T, const int NT, const double rhomolar, const int ND, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        // Make an Eigen view of the double buffer
+        Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
+        // Call the function and copy into the output buffer
+        Eigen::Map<Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(val, Ncomp, Ncomp) = library.at(uuid)->get_ATrhoXiXj_all(T, NT, rhomolar, ND, molefrac_);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION get_ATrhoXiXjXk_all(const long long int uuid, const double T, const int NT, const double rhomolar, const int ND, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        // Make an Eigen view of the double buffer
+        Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
+        // Call the function and copy into the output buffer
+        Eigen::Map<Eigen::ArrayXd>(val, Ncomp*Ncomp*Ncomp) = library.at(uuid)->get_ATrhoXiXjXk_all(T, NT, rhomolar, ND, molefrac_);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
 
 EXPORT_CODE int CONVENTION get_AtaudeltaXi(const long long int uuid, const double tau, const int Ntau, const double delta, const int Ndelta, const double* molefrac, const int Ncomp, const int i, const int NXi, double *val, char* errmsg, int errmsg_length) {
     int errcode = 0;
@@ -215,10 +257,29 @@ EXPORT_CODE int CONVENTION get_dmBnvirdTm(const long long int uuid, const int Nv
     return errcode;
 }
 
+EXPORT_CODE int CONVENTION solve_density(const long long int uuid, const double T, const double p, const double* molefrac, const int Ncomp, const int root, double* rho, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        if (root < 0 || root > 2){
+            throw teqp::InvalidArgument("root must be 0 (liquid), 1 (vapor) or 2 (minimum Gibbs energy)");
+        }
+        // Make an Eigen view of the double buffer
+        Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
+        // Call the function
+        *rho = library.at(uuid)->solve_density(T, p, molefrac_, static_cast<teqp::DensityRoot>(root))[0];
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
 #if defined(TEQPC_CATCH)
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
+using Catch::Approx;
 
 #include "teqp/json_tools.hpp"
 
@@ -457,6 +518,57 @@ TEST_CASE("Use of C interface","[teqpc]") {
     };
     
 }
+
+TEST_CASE("All the composition derivatives at once through the C interface","[teqpc]") {
+    constexpr int errmsg_length = 3000;
+    char errmsg[errmsg_length] = "";
+    long long int uuid;
+    std::string j = R"({"kind": "PCSAFT", "model": {"names": ["Methane", "Ethane", "Propane"]}})";
+    REQUIRE(build_model(j.c_str(), &uuid, errmsg, errmsg_length) == 0);
+    
+    const double T = 250, rhomolar = 2000;
+    std::valarray<double> molefrac = { 0.2, 0.3, 0.5 };
+    const int N = static_cast<int>(molefrac.size());
+    std::vector<double> g(N), H(N*N), t(N*N*N);
+    for (auto [NT, ND] : std::vector<std::tuple<int, int>>{{0, 0}, {1, 0}, {0, 1}}){
+        CAPTURE(NT);
+        CAPTURE(ND);
+        REQUIRE(get_ATrhoXi_all(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, &(g[0]), errmsg, errmsg_length) == 0);
+        REQUIRE(get_ATrhoXiXj_all(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, &(H[0]), errmsg, errmsg_length) == 0);
+        REQUIRE(get_ATrhoXiXjXk_all(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, &(t[0]), errmsg, errmsg_length) == 0);
+        
+        // The buffers are in row-major order, compared against the entries one at a time
+        double val = -1;
+        for (auto i = 0; i < N; ++i){
+            REQUIRE(get_ATrhoXi(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, i, 1, &val, errmsg, errmsg_length) == 0);
+            CHECK(g[i] == Approx(val).epsilon(1e-12));
+            for (auto j = 0; j < N; ++j){
+                if (i == j){
+                    REQUIRE(get_ATrhoXi(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, i, 2, &val, errmsg, errmsg_length) == 0);
+                }
+                else{
+                    REQUIRE(get_ATrhoXiXj(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, i, 1, j, 1, &val, errmsg, errmsg_length) == 0);
+                }
+                CHECK(H[i*N + j] == Approx(val).epsilon(1e-12));
+                for (auto k = 0; k < N; ++k){
+                    if (i == j && j == k){
+                        REQUIRE(get_ATrhoXi(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, i, 3, &val, errmsg, errmsg_length) == 0);
+                    }
+                    else if (i != j && j != k && i != k){
+                        REQUIRE(get_ATrhoXiXjXk(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, i, 1, j, 1, k, 1, &val, errmsg, errmsg_length) == 0);
+                    }
+                    else{
+                        // Two of the indices are the same, a is the repeated one
+                        int a = (i == j || i == k) ? i : j, b = (i == j) ? k : ((i == k) ? j : i);
+                        REQUIRE(get_ATrhoXiXj(uuid, T, NT, rhomolar, ND, &(molefrac[0]), N, a, 2, b, 1, &val, errmsg, errmsg_length) == 0);
+                    }
+                    CHECK(t[(i*N + j)*N + k] == Approx(val).epsilon(1e-12));
+                }
+            }
+        }
+    }
+    REQUIRE(free_model(uuid, errmsg, errmsg_length) == 0);
+}
 #else 
 int main() {
 }
@@ -11,6 +11,13 @@ EXPORT_CODE int CONVENTION get_ATrhoXiXj(const long long int uuid, const double
 
 EXPORT_CODE int CONVENTION get_ATrhoXiXjXk(const long long int uuid, const double T, const int NT, const double rhomolar, const int ND, const double* molefrac, const int Ncomp, const int i, const int NXi, const int j, const int NXj, const int k, const int NXk, double *val, char* errmsg, int errmsg_length) ;
 
+/// The derivatives w.r.t. all the mole fractions at once; val must have room for Ncomp, Ncomp^2, and Ncomp^3 values respectively, in row-major order
+EXPORT_CODE int CONVENTION get_ATrhoXi_all(const long long int uuid, const double T, const int NT, const double rhomolar, const int ND, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length) ;
+
+EXPORT_CODE int CONVENTION get_ATrhoXiXj_all(const long long int uuid, const double T, const int NT, const double rhomolar, const int ND, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length) ;
+
+EXPORT_CODE int CONVENTION get_ATrhoXiXjXk_all(const long long int uuid, const double T, const int NT, const double rhomolar, const int ND, const double* molefrac, const int Ncomp, double *val, char* errmsg, int errmsg_length) ;
+
 EXPORT_CODE int CONVENTION get_AtaudeltaXi(const long long int uuid, const double tau, const int Ntau, const double delta, const int Ndelta, const double* molefrac, const int Ncomp, const int i, const int NXi, double *val, char* errmsg, int errmsg_length) ;
 
 EXPORT_CODE int CONVENTION get_AtaudeltaXiXj(const long long int uuid, const double tau, const int Ntau, const double delta, const int Ndelta, const double* molefrac, const int Ncomp, const int i, const int NXi, const int j, const int NXj, double *val, char* errmsg, int errmsg_length) ;
@@ -18,3 +25,6 @@ EXPORT_CODE int CONVENTION get_AtaudeltaXiXj(const long long int uuid, const dou
 EXPORT_CODE int CONVENTION get_AtaudeltaXiXjXk(const long long int uuid, const double tau, const int Ntau, const double delta, const int Ndelta, const double* molefrac, const int Ncomp, const int i, const int NXi, const int j, const int NXj, const int k, const int NXk, double *val, char* errmsg, int errmsg_length) ;
 
 EXPORT_CODE int CONVENTION get_dmBnvirdTm(const long long int uuid, const int Nvir, const int NT, const double T, const double* molefrac, const int Ncomp, double* val, char* errmsg, int errmsg_length) ;
+
+/// The molar density from temperature, pressure and mole fractions; root is 0 for the liquid root, 1 for the vapor root, and 2 for the root with the minimum Gibbs energy
+EXPORT_CODE int CONVENTION solve_density(const long long int uuid, const double T, const double p, const double* molefrac, const int Ncomp, const int root, double* rho, char* errmsg, int errmsg_length) ;
@@ -3,6 +3,7 @@
 #include "teqp/algorithms/VLE_pure.hpp"
 #include "teqp/algorithms/VLE.hpp"
 #include "teqp/algorithms/VLLE.hpp"
+#include "teqp/algorithms/flash.hpp"
 
 namespace teqp{
     namespace cppinterface{
@@ -44,6 +45,11 @@ namespace teqp{
         nlohmann::json AbstractModel::trace_VLLE_binary(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const{
             return VLLE::trace_VLLE_binary(*this, T, rhovecV, rhovecL1, rhovecL2, options);
         }
+        std::map<std::string, EArrayd> AbstractModel::trace_VLLE_binary_columns(const double T, const REArrayd& rhovecV, const REArrayd& rhovecL1, const REArrayd& rhovecL2, const std::optional<VLLE::VLLETracerOptions> options) const{
+            ColumnarTraceSink sink;
+            VLLE::trace_VLLE_binary(*this, T, rhovecV, rhovecL1, rhovecL2, sink, options);
+            return sink.as_map();
+        }
     
     std::tuple<VLE_return_code,EArrayd,EArrayd> AbstractModel::mix_VLE_Tx(const double T, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const REArrayd& xspec, const double atol, const double reltol, const double axtol, const double relxtol, const int maxiter) const{
         return teqp::mix_VLE_Tx(*this, T, rhovecL0, rhovecV0, xspec, atol, reltol, axtol, relxtol, maxiter);
@@ -52,6 +58,9 @@ namespace teqp{
     MixVLEReturn AbstractModel::mix_VLE_Tp(const double T, const double pgiven, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLETpFlags> &flags) const{
         return teqp::mix_VLE_Tp(*this, T, pgiven, rhovecL0, rhovecV0, flags);
     }
+    std::vector<flash::TPFlashResult> AbstractModel::flash_Tp_batch(const REArrayd& T, const REArrayd& p, const REMatrixd& Z, const std::optional<flash::TPFlashOptions>& options, const bool warm_start, const std::size_t Nthreads) const{
+        return teqp::flash::flash_Tp_batch(*this, T, p, Z, options, warm_start, Nthreads);
+    }
     std::tuple<VLE_return_code,double,EArrayd,EArrayd> AbstractModel::mixture_VLE_px(const double p_spec, const REArrayd& xmolar_spec, const double T0, const REArrayd& rhovecL0, const REArrayd& rhovecV0, const std::optional<MixVLEpxFlags>& flags) const{
         return teqp::mixture_VLE_px(*this, p_spec, xmolar_spec, T0, rhovecL0, rhovecV0, flags);
     }
@@ -71,11 +80,33 @@ namespace teqp{
     nlohmann::json AbstractModel::trace_VLE_isobar_binary(const double p, const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<PVLEOptions> &options) const{
         return teqp::trace_VLE_isobar_binary(*this, p, T0, rhovecL0, rhovecV0, options);
     }
+    std::vector<VLETraceResult> AbstractModel::trace_VLE_isotherms_binary(const std::vector<VLEIsothermSpec>& specs, const std::size_t Nthreads) const{
+        return teqp::trace_VLE_isotherms_binary(*this, specs, Nthreads);
+    }
+    std::vector<VLETraceResult> AbstractModel::trace_VLE_isobars_binary(const std::vector<VLEIsobarSpec>& specs, const std::size_t Nthreads) const{
+        return teqp::trace_VLE_isobars_binary(*this, specs, Nthreads);
+    }
+    std::map<std::string, EArrayd> AbstractModel::trace_VLE_isotherm_binary_columns(const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<TVLEOptions> &options) const{
+        ColumnarTraceSink sink;
+        teqp::trace_VLE_isotherm_binary(*this, T0, rhovecL0, rhovecV0, sink, options);
+        return sink.as_map();
+    }
+    std::map<std::string, EArrayd> AbstractModel::trace_VLE_isobar_binary_columns(const double p, const double T0, const EArrayd& rhovecL0, const EArrayd& rhovecV0, const std::optional<PVLEOptions> &options) const{
+        ColumnarTraceSink sink;
+        teqp::trace_VLE_isobar_binary(*this, p, T0, rhovecL0, rhovecV0, sink, options);
+        return sink.as_map();
+    }
     
     nlohmann::json AbstractModel::trace_critical_arclength_binary(const double T0, const EArrayd& rhovec0, const std::optional<std::string>& filename, const std::optional<TCABOptions> &options) const {
         using crit = teqp::CriticalTracing<decltype(*this), double, std::decay_t<decltype(rhovec0)>>;
         return crit::trace_critical_arclength_binary(*this, T0, rhovec0, filename , options);
     }
+    std::map<std::string, EArrayd> AbstractModel::trace_critical_arclength_binary_columns(const double T0, const EArrayd& rhovec0, const std::optional<TCABOptions> &options) const {
+        using crit = teqp::CriticalTracing<decltype(*this), double, std::decay_t<decltype(rhovec0)>>;
+        ColumnarTraceSink sink;
+        crit::trace_critical_arclength_binary(*this, T0, rhovec0, sink, options);
+        return sink.as_map();
+    }
     EArrayd AbstractModel::get_drhovec_dT_crit(const double T, const REArrayd& rhovec) const {
         using crit = teqp::CriticalTracing<decltype(*this), double, std::decay_t<decltype(rhovec)>>;
         return crit::get_drhovec_dT_crit(*this, T, rhovec);
@@ -0,0 +1,23 @@
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/cpp/deriv_adapter.hpp"
+#include "teqp/models/tabulated.hpp"
+#include "teqp/algorithms/tabulation_builder.hpp"
+
+namespace teqp{
+    namespace cppinterface{
+        using teqp::cppinterface::adapter::make_owned;
+    
+        /// Either load a tabulation from a binary file (memory-mapped if possible), or build one from the model given in the "model" field
+        std::unique_ptr<teqp::cppinterface::AbstractModel> make_tabulated(const nlohmann::json &spec){
+            if (spec.contains("path")){
+                return make_owned(tabulated::load_tabulation(spec.at("path"), spec.value("mmap", true)));
+            }
+            auto inner = make_model(spec.at("model"));
+            auto tab = tabulated::build_tabulation(*inner, spec);
+            if (spec.contains("output_path")){
+                tab.save(spec.at("output_path"));
+            }
+            return make_owned(std::move(tab));
+        }
+    }
+}
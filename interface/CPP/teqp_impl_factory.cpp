@@ -44,6 +44,8 @@ namespace teqp {
     
         std::unique_ptr<teqp::cppinterface::AbstractModel> make_IdealHelmholtz(const nlohmann::json &);
     
+        std::unique_ptr<teqp::cppinterface::AbstractModel> make_tabulated(const nlohmann::json &);
+    
         using makefunc = ModelPointerFactoryFunction;
         using namespace teqp::cppinterface::adapter;
     
@@ -99,6 +101,8 @@ namespace teqp {
             {"CPA", [](const nlohmann::json& spec){ return make_CPA(spec); }},
             
             {"IdealHelmholtz", [](const nlohmann::json& spec){ return make_IdealHelmholtz(spec); }},
+            
+            {"tabulated", [](const nlohmann::json& spec){ return make_tabulated(spec); }},
         };
 
         std::unique_ptr<teqp::cppinterface::AbstractModel> build_model_ptr(const nlohmann::json& json, const bool validate) {
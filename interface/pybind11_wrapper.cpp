@@ -21,6 +21,7 @@
 #include "teqp/algorithms/phase_equil.hpp"
 
 #include "teqp/algorithms/pure_param_optimization.hpp"
+#include "teqp/models/tabulated.hpp"
 using namespace teqp::algorithms::pure_param_optimization;
 
 namespace py = pybind11;
@@ -153,6 +154,7 @@ const std::type_index CPA_i{std::type_index(typeid(CPA_t))};
 const std::type_index genericSAFT_i{std::type_index(typeid(teqp::saft::genericsaft::GenericSAFT))};
 const std::type_index MultiFluidAssociation_i{std::type_index(typeid(MultifluidPlusAssociation))};
 const std::type_index MultiFluidActivity_i{std::type_index(typeid(teqp::multifluid::multifluid_activity::MultifluidPlusActivity))};
+const std::type_index TabulatedAlphar_i{std::type_index(typeid(teqp::tabulated::TabulatedAlphar))};
 
 /**
  At runtime we can add additional model-specific methods that only apply for a particular model.  We take in a Python-wrapped
@@ -320,6 +322,11 @@ void attach_model_specific_methods(py::object& obj){
             return get_typed<MultifluidPlusAssociation>(o).get_association().get_assoc_calcs(T, rhomolar, molefrac);
         }, "self"_a, "T"_a, "rhomolar"_a, "molefrac"_a), obj));
     }
+    else if (index == TabulatedAlphar_i){
+        setattr("get_build_report", MethodType(py::cpp_function([](py::object& o){ return get_typed<teqp::tabulated::TabulatedAlphar>(o).get_build_report(); }), obj));
+        setattr("get_saturation_curve", MethodType(py::cpp_function([](py::object& o){ return get_typed<teqp::tabulated::TabulatedAlphar>(o).get_saturation_curve(); }), obj));
+        setattr("save", MethodType(py::cpp_function([](py::object& o, const std::string& path){ get_typed<teqp::tabulated::TabulatedAlphar>(o).save(path); }, "self"_a, "path"_a), obj));
+    }
     else if (index == MultiFluidActivity_i){
         setattr("calc_gER_over_RT", MethodType(py::cpp_function([](py::object& o, double T, REArrayd& molefrac){
             return get_typed<teqp::multifluid::multifluid_activity::MultifluidPlusActivity>(o).calc_gER_over_RT(T, molefrac);
@@ -398,6 +405,30 @@ void init_teqp(py::module& m) {
         .def_readwrite("terminate_unstable", &PVLEOptions::terminate_unstable)
     ;
     
+    // The starting points for the batches of isotherms and isobars, and the result of each trace
+    py::class_<VLEIsothermSpec>(m, "VLEIsothermSpec")
+        .def(py::init<>())
+        .def_readwrite("T", &VLEIsothermSpec::T)
+        .def_readwrite("rhovecL0", &VLEIsothermSpec::rhovecL0)
+        .def_readwrite("rhovecV0", &VLEIsothermSpec::rhovecV0)
+        .def_readwrite("options", &VLEIsothermSpec::options)
+    ;
+    py::class_<VLEIsobarSpec>(m, "VLEIsobarSpec")
+        .def(py::init<>())
+        .def_readwrite("p", &VLEIsobarSpec::p)
+        .def_readwrite("T0", &VLEIsobarSpec::T0)
+        .def_readwrite("rhovecL0", &VLEIsobarSpec::rhovecL0)
+        .def_readwrite("rhovecV0", &VLEIsobarSpec::rhovecV0)
+        .def_readwrite("options", &VLEIsobarSpec::options)
+    ;
+    py::class_<VLETraceResult>(m, "VLETraceResult")
+        .def(py::init<>())
+        .def_readonly("success", &VLETraceResult::success)
+        .def_readonly("message", &VLETraceResult::message)
+        .def_readonly("trace", &VLETraceResult::trace)
+        .def_readonly("elapsed_s", &VLETraceResult::elapsed_s)
+    ;
+    
     // The options class for the finder of VLLE solutions from VLE tracing, not tied to a particular model
     py::class_<VLLE::VLLEFinderOptions>(m, "VLLEFinderOptions")
         .def(py::init<>())
@@ -440,6 +471,88 @@ void init_teqp(py::module& m) {
         .def_readwrite("maxiter", &MixVLEpxFlags::maxiter)
     ;
     
+    py::class_<flash::TPFlashOptions>(m, "TPFlashOptions")
+        .def(py::init<>())
+        .def_readwrite("stability_tol", &flash::TPFlashOptions::stability_tol)
+        .def_readwrite("tpd_tol", &flash::TPFlashOptions::tpd_tol)
+        .def_readwrite("trivial_tol", &flash::TPFlashOptions::trivial_tol)
+        .def_readwrite("SS_switch_tol", &flash::TPFlashOptions::SS_switch_tol)
+        .def_readwrite("Newton_tol", &flash::TPFlashOptions::Newton_tol)
+        .def_readwrite("rho_reltol", &flash::TPFlashOptions::rho_reltol)
+        .def_readwrite("max_stability_iter", &flash::TPFlashOptions::max_stability_iter)
+        .def_readwrite("max_SS_iter", &flash::TPFlashOptions::max_SS_iter)
+        .def_readwrite("max_Newton_iter", &flash::TPFlashOptions::max_Newton_iter)
+        .def_readwrite("acceleration_period", &flash::TPFlashOptions::acceleration_period)
+        .def_readwrite("max_rho_iter", &flash::TPFlashOptions::max_rho_iter)
+        .def_readwrite("skip_stability_with_guess", &flash::TPFlashOptions::skip_stability_with_guess)
+    ;
+    
+    py::class_<flash::TPFlashGuess>(m, "TPFlashGuess")
+        .def(py::init<>())
+        .def_readwrite("K", &flash::TPFlashGuess::K)
+        .def_readwrite("rhoL", &flash::TPFlashGuess::rhoL)
+        .def_readwrite("rhoV", &flash::TPFlashGuess::rhoV)
+    ;
+    
+    py::class_<flash::TPFlashResult>(m, "TPFlashResult")
+        .def(py::init<>())
+        .def_readonly("success", &flash::TPFlashResult::success)
+        .def_readonly("Nphases", &flash::TPFlashResult::Nphases)
+        .def_readonly("T", &flash::TPFlashResult::T)
+        .def_readonly("p", &flash::TPFlashResult::p)
+        .def_readonly("beta", &flash::TPFlashResult::beta)
+        .def_readonly("tpd", &flash::TPFlashResult::tpd)
+        .def_readonly("z", &flash::TPFlashResult::z)
+        .def_readonly("x", &flash::TPFlashResult::x)
+        .def_readonly("y", &flash::TPFlashResult::y)
+        .def_readonly("rhoL", &flash::TPFlashResult::rhoL)
+        .def_readonly("rhoV", &flash::TPFlashResult::rhoV)
+        .def_readonly("K", &flash::TPFlashResult::K)
+        .def_readonly("num_stability_iter", &flash::TPFlashResult::num_stability_iter)
+        .def_readonly("num_SS_iter", &flash::TPFlashResult::num_SS_iter)
+        .def_readonly("num_Newton_iter", &flash::TPFlashResult::num_Newton_iter)
+        .def_readonly("message", &flash::TPFlashResult::message)
+        .def("as_guess", &flash::TPFlashResult::as_guess)
+    ;
+    
+    py::class_<IsochoricDerivativeBundle>(m, "IsochoricDerivativeBundle")
+        .def(py::init<>())
+        .def_readonly("T", &IsochoricDerivativeBundle::T)
+        .def_readonly("rhovec", &IsochoricDerivativeBundle::rhovec)
+        .def_readonly("R", &IsochoricDerivativeBundle::R)
+        .def_readonly("has_T_derivatives", &IsochoricDerivativeBundle::has_T_derivatives)
+        .def_readonly("Psir", &IsochoricDerivativeBundle::Psir)
+        .def_readonly("gradient_Psir", &IsochoricDerivativeBundle::gradient_Psir)
+        .def_readonly("Hessian_Psir", &IsochoricDerivativeBundle::Hessian_Psir)
+        .def_readonly("dPsirdT", &IsochoricDerivativeBundle::dPsirdT)
+        .def_readonly("d2PsirdTdrhovec", &IsochoricDerivativeBundle::d2PsirdTdrhovec)
+        .def("rho", &IsochoricDerivativeBundle::rho)
+        .def("p", &IsochoricDerivativeBundle::p)
+        .def("dpdrhovec", &IsochoricDerivativeBundle::dpdrhovec)
+        .def("Hessian_Psi", &IsochoricDerivativeBundle::Hessian_Psi)
+        .def("dpdT", &IsochoricDerivativeBundle::dpdT)
+        .def("dchempotdT", &IsochoricDerivativeBundle::dchempotdT)
+    ;
+    
+    py::class_<PureDerivativeBundle>(m, "PureDerivativeBundle")
+        .def(py::init<>())
+        .def_readonly("T", &PureDerivativeBundle::T)
+        .def_readonly("rho", &PureDerivativeBundle::rho)
+        .def_readonly("R", &PureDerivativeBundle::R)
+        .def_readonly("Ar00", &PureDerivativeBundle::Ar00)
+        .def_readonly("Ar01", &PureDerivativeBundle::Ar01)
+        .def_readonly("Ar02", &PureDerivativeBundle::Ar02)
+        .def_readonly("Ar10", &PureDerivativeBundle::Ar10)
+        .def_readonly("Ar11", &PureDerivativeBundle::Ar11)
+        .def_readonly("Ar20", &PureDerivativeBundle::Ar20)
+        .def("p", &PureDerivativeBundle::p)
+        .def("dpdrho_T", &PureDerivativeBundle::dpdrho_T)
+        .def("dpdT_rho", &PureDerivativeBundle::dpdT_rho)
+        .def("sr", &PureDerivativeBundle::sr)
+        .def("hr", &PureDerivativeBundle::hr)
+        .def("cvr", &PureDerivativeBundle::cvr)
+    ;
+    
     using namespace teqp::cppinterface;
     // The Jacobian and value matrices for Newton-Raphson
     py::class_<IterationMatrices>(m, "IterationMatrices")
@@ -458,6 +571,13 @@ void init_teqp(py::module& m) {
         .value("notfinite_step", VLE_return_code::notfinite_step)
     ;
     
+    py::enum_<DensityRoot>(m, "DensityRoot")
+        .value("liquid", DensityRoot::liquid)
+        .value("vapor", DensityRoot::vapor)
+        .value("minimum_gibbs", DensityRoot::minimum_gibbs)
+        .value("all", DensityRoot::all)
+    ;
+    
     py::class_<MixVLEReturn>(m, "MixVLEReturn")
         .def(py::init<>())
         .def_readonly("success", &MixVLEReturn::success)
@@ -502,12 +622,16 @@ void init_teqp(py::module& m) {
     
         .def("get_B2vir", &am::get_B2vir, "T"_a, "molefrac"_a.noconvert())
         .def("get_Bnvir", &am::get_Bnvir, "Nderiv"_a, "T"_a, "molefrac"_a.noconvert())
+        .def("get_Bnvir_ep", &am::get_Bnvir_ep, "Nderiv"_a, "T"_a, "molefrac"_a.noconvert())
         .def("get_dmBnvirdTm", &am::get_dmBnvirdTm, "Nderiv"_a, "NTderiv"_a, "T"_a, "molefrac"_a.noconvert())
         .def("get_B12vir", &am::get_B12vir, "T"_a, "molefrac"_a.noconvert())
     
         .def("get_ATrhoXi", &am::get_ATrhoXi, "T"_a, "NT"_a, "rhomolar"_a, "Nrho"_a, "molefrac"_a.noconvert(), "i"_a, "NXi"_a)
         .def("get_ATrhoXiXj", &am::get_ATrhoXiXj, "T"_a, "NT"_a, "rhomolar"_a, "Nrho"_a, "molefrac"_a.noconvert(), "i"_a, "NXi"_a, "j"_a, "NXj"_a)
         .def("get_ATrhoXiXjXk", &am::get_ATrhoXiXjXk, "T"_a, "NT"_a, "rhomolar"_a, "Nrho"_a, "molefrac"_a.noconvert(), "i"_a, "NXi"_a, "j"_a, "NXj"_a, "k"_a, "NXk"_a)
+        .def("get_ATrhoXi_all", &am::get_ATrhoXi_all, "T"_a, "NT"_a, "rhomolar"_a, "Nrho"_a, "molefrac"_a.noconvert())
+        .def("get_ATrhoXiXj_all", &am::get_ATrhoXiXj_all, "T"_a, "NT"_a, "rhomolar"_a, "Nrho"_a, "molefrac"_a.noconvert())
+        .def("get_ATrhoXiXjXk_all", &am::get_ATrhoXiXjXk_all, "T"_a, "NT"_a, "rhomolar"_a, "Nrho"_a, "molefrac"_a.noconvert())
         .def("get_AtaudeltaXi", &am::get_AtaudeltaXi, "tau"_a, "Ntau"_a, "delta"_a, "Ndelta"_a, "molefrac"_a.noconvert(), "i"_a, "NXi"_a)
         .def("get_AtaudeltaXiXj", &am::get_AtaudeltaXiXj, "tau"_a, "Ntau"_a, "delta"_a, "Ndelta"_a, "molefrac"_a.noconvert(), "i"_a, "NXi"_a, "j"_a, "NXj"_a)
         .def("get_AtaudeltaXiXjXk", &am::get_AtaudeltaXiXjXk, "tau"_a, "Ntau"_a, "delta"_a, "Ndelta"_a, "molefrac"_a.noconvert(), "i"_a, "NXi"_a, "j"_a, "NXj"_a, "k"_a, "NXk"_a)
@@ -526,6 +650,8 @@ void init_teqp(py::module& m) {
     ARN0_args
 #undef X
         .def("get_neff", &am::get_neff, "T"_a, "rho"_a, "molefrac"_a.noconvert())
+        .def("get_Arxy_pure", &am::get_Arxy_pure, "NT"_a, "ND"_a, "T"_a, "rho"_a)
+        .def("pure_bundle", &am::pure_bundle, "T"_a, "rho"_a)
     
     // Methods that come from the isochoric derivatives formalism
         .def("get_pr", &am::get_pr, "T"_a, "rhovec"_a.noconvert())
@@ -538,6 +664,7 @@ void init_teqp(py::module& m) {
         .def("get_dchempotdT_autodiff", &am::get_dchempotdT_autodiff, "T"_a, "rhovec"_a.noconvert())
         .def("get_fugacity_coefficients", &am::get_fugacity_coefficients, "T"_a, "rhovec"_a.noconvert())
         .def("get_partial_molar_volumes", &am::get_partial_molar_volumes, "T"_a, "rhovec"_a.noconvert())
+        .def("build_isochoric_derivative_bundle", &am::build_isochoric_derivative_bundle, "T"_a, "rhovec"_a.noconvert(), "T_derivatives"_a = true)
     
         .def("get_deriv_mat2", &am::get_deriv_mat2, "T"_a, "rho"_a, "molefrac"_a.noconvert())
     
@@ -548,6 +675,7 @@ void init_teqp(py::module& m) {
     
     // Routines related to binary mixture critical curve tracing
         .def("trace_critical_arclength_binary", &am::trace_critical_arclength_binary, "T0"_a, "rhovec0"_a, py::arg_v("path", std::nullopt, "None"), py::arg_v("options", std::nullopt, "None"))
+        .def("trace_critical_arclength_binary_columns", &am::trace_critical_arclength_binary_columns, "T0"_a, "rhovec0"_a, py::arg_v("options", std::nullopt, "None"))
         .def("get_criticality_conditions", &am::get_criticality_conditions, "T"_a, "rhovec"_a.noconvert())
         .def("eigen_problem", &am::eigen_problem, "T"_a, "rhovec"_a, py::arg_v("alignment_v0", std::nullopt, "None"))
         .def("get_minimum_eigenvalue_Psi_Hessian", &am::get_minimum_eigenvalue_Psi_Hessian, "T"_a, "rhovec"_a.noconvert())
@@ -563,14 +691,23 @@ void init_teqp(py::module& m) {
     
         .def("trace_VLE_isotherm_binary", &am::trace_VLE_isotherm_binary, "T"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
         .def("trace_VLE_isobar_binary", &am::trace_VLE_isobar_binary, "p"_a, "T0"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("trace_VLE_isotherm_binary_columns", &am::trace_VLE_isotherm_binary_columns, "T"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("trace_VLE_isobar_binary_columns", &am::trace_VLE_isobar_binary_columns, "p"_a, "T0"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("trace_VLE_isotherms_binary", &am::trace_VLE_isotherms_binary, "specs"_a, "Nthreads"_a = 1, py::call_guard<py::gil_scoped_release>())
+        .def("trace_VLE_isobars_binary", &am::trace_VLE_isobars_binary, "specs"_a, "Nthreads"_a = 1, py::call_guard<py::gil_scoped_release>())
         .def("mix_VLE_Tx", &am::mix_VLE_Tx, "T"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), "xspec"_a.noconvert(), "atol"_a, "reltol"_a, "axtol"_a, "relxtol"_a, "maxiter"_a)
         .def("mix_VLE_Tp", &am::mix_VLE_Tp, "T"_a, "p_given"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("solve_density", &am::solve_density, "T"_a, "p"_a, "z"_a.noconvert(), "root"_a)
+        .def("solve_density_batch", &am::solve_density_batch, "T"_a, "p"_a, "Z"_a, "root"_a)
+        .def("flash_Tp", &am::flash_Tp, "T"_a, "p"_a, "z"_a.noconvert(), py::arg_v("guess", std::nullopt, "None"), py::arg_v("options", std::nullopt, "None"))
+        .def("flash_Tp_batch", &am::flash_Tp_batch, "T"_a, "p"_a, "Z"_a, py::arg_v("options", std::nullopt, "None"), "warm_start"_a = true, "Nthreads"_a = 1)
         .def("mixture_VLE_px", &am::mixture_VLE_px, "p_spec"_a, "xmolar_spec"_a.noconvert(), "T0"_a, "rhovecL0"_a.noconvert(), "rhovecV0"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
     
         .def("mix_VLLE_T", &am::mix_VLLE_T, "T"_a, "rhovecVinit"_a.noconvert(), "rhovecL1init"_a.noconvert(), "rhovecL2init"_a.noconvert(), "atol"_a, "reltol"_a, "axtol"_a, "relxtol"_a, "maxiter"_a)
         .def("find_VLLE_T_binary", &am::find_VLLE_T_binary, "traces"_a, py::arg_v("options", std::nullopt, "None"))
         .def("find_VLLE_p_binary", &am::find_VLLE_p_binary, "traces"_a, py::arg_v("options", std::nullopt, "None"))
         .def("trace_VLLE_binary", &am::trace_VLLE_binary, "T"_a, "rhovecV"_a.noconvert(), "rhovecL1"_a.noconvert(), "rhovecL2"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
+        .def("trace_VLLE_binary_columns", &am::trace_VLLE_binary_columns, "T"_a, "rhovecV"_a.noconvert(), "rhovecL1"_a.noconvert(), "rhovecL2"_a.noconvert(), py::arg_v("options", std::nullopt, "None"))
     ;
     
     m.def("_make_model", &teqp::cppinterface::make_model, "json_data"_a, py::arg_v("validate", true));
@@ -609,11 +746,30 @@ void init_teqp(py::module& m) {
             .def("pack", &UnpackedVariables::pack, "Convenience function to generate the array of independent variables")
         ;
         
+        using Counters = GeneralizedPhaseEquilibrium::Counters;
+        py::class_<Counters>(m_phaseequil, "Counters")
+            .def_readonly("Ncalls", &Counters::Ncalls)
+            .def_readonly("Nphase_derivatives", &Counters::Nphase_derivatives)
+            .def_readonly("Ncaloric_derivatives", &Counters::Ncaloric_derivatives)
+            .def_readonly("Nsteps", &Counters::Nsteps)
+        ;
+        
+        using IterationResult = GeneralizedPhaseEquilibrium::IterationResult;
+        py::class_<IterationResult>(m_phaseequil, "IterationResult")
+            .def_readonly("x", &IterationResult::x)
+            .def_readonly("Niter", &IterationResult::Niter)
+            .def_readonly("max_abs_r", &IterationResult::max_abs_r)
+            .def_readonly("converged", &IterationResult::converged)
+        ;
+        
         py::class_<GeneralizedPhaseEquilibrium>(m_phaseequil, "GeneralizedPhaseEquilibrium")
             .def(py::init<const AbstractModel&, const Eigen::ArrayXd&, const UnpackedVariables&, const std::vector<std::shared_ptr<AbstractSpecification>>&>())
             .def("call", &GeneralizedPhaseEquilibrium::call, "Call the function to build the residuals and Jacobian matrix", "x"_a)
             .def("num_Jacobian", &GeneralizedPhaseEquilibrium::num_Jacobian, "A testing function to build the Jacobian with centered differences")
+            .def("solve_step", &GeneralizedPhaseEquilibrium::solve_step, "Solve for the Newton step from the last call by block elimination")
+            .def("iterate", &GeneralizedPhaseEquilibrium::iterate, "Take Newton steps until the residuals are below the tolerance", "x0"_a, "maxiter"_a = 50, "tol"_a = 1e-10)
             .def_readonly("res", &GeneralizedPhaseEquilibrium::res, "The data structure containing r and J")
+            .def_readonly("counters", &GeneralizedPhaseEquilibrium::counters, "Counters of calls, derivative evaluations and steps")
         ;
     }
     
@@ -691,6 +847,8 @@ void init_teqp(py::module& m) {
             .def("cost_function_threaded", &PureParameterOptimizer::cost_function_threaded<Eigen::ArrayXd>)
             .def("build_JSON", &PureParameterOptimizer::build_JSON<Eigen::ArrayXd>)
             .def("add_one_contribution", &PureParameterOptimizer::add_one_contribution)
+            .def("uses_parameter_slots", &PureParameterOptimizer::uses_parameter_slots)
+            .def("cost_function_and_gradient", &PureParameterOptimizer::cost_function_and_gradient)
         ;
     };
     auto m_paramopt = m.def_submodule("paramopt", "Tools for doing parameter optimization");
@@ -6,6 +6,7 @@
 #include "teqp/models/cubics.hpp"
 
 #include "teqp/derivs.hpp"
+#include "teqp/algorithms/density.hpp"
 
 using namespace teqp;
 
@@ -162,3 +163,67 @@ TEST_CASE("Canonical cubic EOS derivatives", "[cubic]")
         return tdx::get_Ar10<ADBackends::multicomplex>(model, T, rho, z);
     };*/
 }
+
+TEST_CASE("Cubic derivatives", "[cubic]")
+{
+    std::valarray<double> Tc_K = { 190.564, 305.32, 369.83 }, pc_Pa = { 4599200, 4872200, 4248000 }, acentric = { 0.011, 0.099, 0.152 };
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    double T = 300, rho = 2000;
+    auto z = (Eigen::ArrayXd(3) << 0.2, 0.3, 0.5).finished();
+    Eigen::ArrayXd rhovec = rho*z;
+    using tdx = TDXDerivatives<decltype(model), double, decltype(z)>;
+    using iso = IsochoricDerivatives<decltype(model), double, decltype(z)>;
+
+    BENCHMARK("rho^2*d^2alphar/drho^2 w/ autodiff") {
+        return tdx::get_Agenxy<0, 2>(model, T, rho, z);
+    };
+    BENCHMARK("rho^2*d^2alphar/drho^2 closed form") {
+        return tdx::get_Ar02(model, T, rho, z);
+    };
+    BENCHMARK("(1/T)^2*d^2alphar/d(1/T)^2 w/ autodiff") {
+        return tdx::get_Agenxy<2, 0>(model, T, rho, z);
+    };
+    BENCHMARK("(1/T)^2*d^2alphar/d(1/T)^2 closed form") {
+        return tdx::get_Ar20(model, T, rho, z);
+    };
+    BENCHMARK("Hessian of Psir w/ VectorHyperDual") {
+        return iso::build_Psir_Hessian_vectorAD(model, T, rhovec);
+    };
+    BENCHMARK("Hessian of Psir closed form") {
+        return iso::build_Psir_Hessian_autodiff(model, T, rhovec);
+    };
+}
+
+TEST_CASE("Cubic mixing rule", "[cubic]")
+{
+    const int N = 50;
+    std::valarray<double> Tc_K(N), pc_Pa(N), acentric(N);
+    for (auto i = 0; i < N; ++i){
+        Tc_K[i] = 150 + 5*i; pc_Pa[i] = 3e6 + 1e4*i; acentric[i] = 0.01 + 0.005*i;
+    }
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    Eigen::ArrayXd z = Eigen::ArrayXd::Constant(N, 1.0/N);
+    double T = 300, rho = 2000;
+    
+    BENCHMARK("a(T,x) of 50 components") {
+        return model.get_a(T, z);
+    };
+    BENCHMARK("alphar of 50 components") {
+        return model.alphar(T, rho, z);
+    };
+}
+
+TEST_CASE("Cubic density", "[cubic]")
+{
+    std::valarray<double> Tc_K = { 190.564, 305.32, 369.83 }, pc_Pa = { 4599200, 4872200, 4248000 }, acentric = { 0.011, 0.099, 0.152 };
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    auto z = (Eigen::ArrayXd(3) << 0.2, 0.3, 0.5).finished();
+    double T = 300, p = 1e5;
+    
+    BENCHMARK("vapor density closed form") {
+        return solve_density(model, T, p, z, DensityRoot::vapor);
+    };
+    BENCHMARK("vapor density by marching and Newton") {
+        return scan_density_roots(model, T, p, z).front();
+    };
+}
@@ -119,6 +119,12 @@ TEST_CASE("multifluid derivatives via DerivativeAdapter", "[mf]")
         using namespace teqp::cppinterface::adapter;
         return view(model)->get_Bnvir(4, 300, z);
     };
+    BENCHMARK("B4 in double-double precision via AbstractModel") {
+        return am->get_Bnvir_ep(4, 300, z);
+    };
+    BENCHMARK("Ar03 in double-double precision via AbstractModel") {
+        return am->get_Ar03ep(300, 1e-3, z);
+    };
 }
 
 
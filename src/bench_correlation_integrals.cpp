@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+#include <catch2/catch_approx.hpp>
+using Catch::Approx;
+
+#include "nlohmann/json.hpp"
+#include "teqp/models/saft/polar_terms.hpp"
+
+using namespace teqp;
+using namespace teqp::SAFTpolar;
+
+// The direct evaluation of the double sums with powers for each term, as was done before, for comparison
+template<typename TType, typename RhoType>
+auto get_J_pow(const std::array<double, 35>& ab, int n, const TType& Tstar, const RhoType& rhostar){
+    std::common_type_t<TType, RhoType> summer = 0.0;
+    for (auto i = 0; i <= 4; ++i){
+        for (auto j = 0; j <= 3; ++j){
+            summer += ab[4*i + j]*pow(rhostar, i)*pow(Tstar, j);
+        }
+    }
+    for (auto i = 0; i <= 4; ++i){
+        for (auto j = 0; j <= 2; ++j){
+            summer += ab[20 + 3*i + j]*pow(rhostar, i)*pow(Tstar, j)*exp(1.0/Tstar);
+        }
+    }
+    return pow(summer, n-2);
+}
+template<typename TType, typename RhoType>
+auto get_K_pow(const std::array<double, 40>& abc, const TType& Tstar, const RhoType& rhostar){
+    std::common_type_t<TType, RhoType> summer = 0.0;
+    for (auto i = 0; i <= 3; ++i){
+        for (auto j = 1; j <= 2; ++j){
+            summer += abc[2*i + (j-1)]*pow(rhostar, i)*pow(exp((1.0-rhostar/3.0)/Tstar), j);
+        }
+    }
+    for (auto i = 0; i <= 3; ++i){
+        for (auto j = 1; j <= 2; ++j){
+            summer += abc[8 + 2*i + (j-1)]*pow(rhostar, i)*pow(exp((1.0-rhostar/3.0)*(1.0-rhostar/3.0)/Tstar), j);
+        }
+    }
+    for (auto i = 0; i <= 5; ++i){
+        for (auto j = 0; j <= 3; ++j){
+            summer += abc[16 + 4*i + j]*pow(rhostar, i)*pow(Tstar, j);
+        }
+    }
+    return summer;
+}
+
+TEST_CASE("Gottschalk correlation integrals", "[correlation_integrals]")
+{
+    double Tstar = 1.3, rhostar = 0.6;
+    GottschalkJIntegral J{11};
+    GottschalkKIntegral K{222, 333};
+    CHECK(J.get_J(Tstar, rhostar) == Approx(get_J_pow(J.ab, J.n, Tstar, rhostar)).epsilon(1e-12));
+    CHECK(K.get_K(Tstar, rhostar) == Approx(get_K_pow(K.abc, Tstar, rhostar)).epsilon(1e-12));
+    
+    BENCHMARK("J, powers"){
+        return get_J_pow(J.ab, J.n, Tstar, rhostar);
+    };
+    BENCHMARK("J, Horner"){
+        return J.get_J(Tstar, rhostar);
+    };
+    BENCHMARK("K, powers"){
+        return get_K_pow(K.abc, Tstar, rhostar);
+    };
+    BENCHMARK("K, Horner"){
+        return K.get_K(Tstar, rhostar);
+    };
+    
+    for (auto N : {2, 5, 10}){
+        Eigen::ArrayXXd Tstarij(N, N);
+        for (auto i = 0; i < N; ++i){
+            for (auto j = 0; j < N; ++j){
+                Tstarij(i, j) = 1.0 + 0.1*(i + j);
+            }
+        }
+        BENCHMARK("K of each pair, powers, N=" + std::to_string(N)){
+            Eigen::ArrayXXd out(N, N);
+            for (auto i = 0; i < N; ++i){
+                for (auto j = 0; j < N; ++j){
+                    out(i, j) = get_K_pow(K.abc, Tstarij(i, j), rhostar);
+                }
+            }
+            return out;
+        };
+        BENCHMARK("K of each pair, shared polynomials in rho^*, N=" + std::to_string(N)){
+            return K.get_K_matrix(Tstarij, rhostar);
+        };
+    }
+}
+
+TEST_CASE("Multipolar contributions of mixtures", "[correlation_integrals]")
+{
+    for (auto N : {1, 2, 4, 8}){
+        Eigen::ArrayXd sigma_m(N), epsilon_over_k(N), mu(N), Q(N), molefracs(N);
+        for (auto i = 0; i < N; ++i){
+            sigma_m[i] = (1.0 + 0.05*i)*1e-10;
+            epsilon_over_k[i] = 100 + 10*i;
+            mu[i] = (3.0 - 0.2*i)*1e-31;
+            Q[i] = (i % 2 == 0) ? 0.0 : 1e-40;
+            molefracs[i] = 1.0/N;
+        }
+        Eigen::MatrixXd SIGMAIJ(N, N), EPSKIJ(N, N);
+        for (auto i = 0; i < N; ++i){
+            for (auto j = 0; j < N; ++j){
+                SIGMAIJ(i, j) = (sigma_m[i] + sigma_m[j])/2;
+                EPSKIJ(i, j) = sqrt(epsilon_over_k[i]*epsilon_over_k[j]);
+            }
+        }
+        double T = 150, rhostar = 0.6, rhoN = rhostar/pow(1.1e-10, 3);
+        MultipolarContributionGrayGubbins<GottschalkJIntegral, GottschalkKIntegral> GG{sigma_m, epsilon_over_k, SIGMAIJ, EPSKIJ, mu, Q, std::nullopt};
+        MultipolarContributionGrayGubbins<LuckasJIntegral, LuckasKIntegral> GL{sigma_m, epsilon_over_k, SIGMAIJ, EPSKIJ, mu, Q, std::nullopt};
+        BENCHMARK("Gray-Gubbins+Gottschalk, N=" + std::to_string(N)){
+            return GG.eval(T, rhoN, rhostar, molefracs).alpha;
+        };
+        BENCHMARK("Gray-Gubbins+Luckas, N=" + std::to_string(N)){
+            return GL.eval(T, rhoN, rhostar, molefracs).alpha;
+        };
+    }
+}
@@ -98,6 +98,30 @@ TEST_CASE("multifluid derivatives", "[mf]")
         auto steps = NR.take_steps(4, false);
         return steps;
     };
+    
+    // A set of 1000 targets along a supercritical isochore
+    const auto Nbatch = 1000;
+    Eigen::ArrayXd Tbatch = Eigen::ArrayXd::LinSpaced(Nbatch, 400, 500), rhobatch = Eigen::ArrayXd::Constant(Nbatch, 3000.0);
+    Eigen::ArrayXXd valsbatch(Nbatch, 2);
+    for (auto i = 0; i < Nbatch; ++i){
+        valsbatch.row(i) = alpha.get_vals(vars, R, Tbatch(i), rhobatch(i), z).transpose();
+    }
+    BENCHMARK("1000 points with NRIterator"){
+        double Tsum = 0;
+        for (auto i = 0; i < Nbatch; ++i){
+            Eigen::Array2d v = valsbatch.row(i).transpose();
+            teqp::iteration::NRIterator NR(alpha, vars, v, T, rho, rz, relative_error, stopping_conditions);
+            NR.take_steps(20);
+            Tsum += NR.get_T();
+        }
+        return Tsum;
+    };
+    for (auto continuation : {false, true}){
+        teqp::iteration::BatchNROptions opt; opt.continuation = continuation;
+        BENCHMARK("1000 points with solve_NR_batch; continuation: " + std::to_string(continuation)){
+            return teqp::iteration::solve_NR_batch(alpha, vars, valsbatch, Eigen::ArrayXd::Constant(1, T), Eigen::ArrayXd::Constant(1, rho), z, opt);
+        };
+    }
 }
 
 TEST_CASE("Time very low level operations", "[mf]"){
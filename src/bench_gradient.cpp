@@ -0,0 +1,40 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/derivs.hpp"
+#include "teqp/models/cubics/simple_cubics.hpp"
+
+using namespace teqp;
+
+/// Benchmark the gradient of Psir in forward mode (one evaluation per component)
+/// against reverse mode (one evaluation and one sweep over the tape)
+void bench_gradient(int N){
+    std::valarray<double> Tc_K(N), pc_Pa(N), acentric(N);
+    for (auto i = 0; i < N; ++i){
+        Tc_K[i] = 190.0 + 5.0*i; pc_Pa[i] = 4.6e6 - 2e4*i; acentric[i] = 0.01 + 0.005*i;
+    }
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    double T = 300;
+    Eigen::ArrayXd rhovec = Eigen::ArrayXd::LinSpaced(N, 100, 300);
+    using id = IsochoricDerivatives<decltype(model)>;
+
+    BENCHMARK("PR, N=" + std::to_string(N) + ", Psir"){
+        return id::get_Psir(model, T, rhovec);
+    };
+    BENCHMARK("PR, N=" + std::to_string(N) + ", forward"){
+        return id::build_Psir_gradient_autodiff(model, T, rhovec);
+    };
+    BENCHMARK("PR, N=" + std::to_string(N) + ", reverse"){
+        return id::build_Psir_gradient_reverse(model, T, rhovec);
+    };
+    BENCHMARK("PR, N=" + std::to_string(N) + ", ln(phi), reverse"){
+        return id::get_ln_fugacity_coefficients<ADBackends::reverse>(model, T, rhovec);
+    };
+}
+
+TEST_CASE("Gradient of Psir for the Peng-Robinson EOS", "[gradient]")
+{
+    for (auto N : {2, 5, 10, 30, 60}){
+        bench_gradient(N);
+    }
+}
@@ -0,0 +1,79 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/derivs.hpp"
+#include "teqp/models/cubics/simple_cubics.hpp"
+#include "teqp/models/pcsaft.hpp"
+
+using namespace teqp;
+
+/// A PC-SAFT mixture of N made-up non-polar fluids
+auto make_PCSAFT_mixture(int N){
+    std::vector<saft::pcsaft::SAFTCoeffs> coeffs(N);
+    for (auto i = 0; i < N; ++i){
+        coeffs[i].name = "fluid" + std::to_string(i);
+        coeffs[i].m = 1.0 + 0.2*i;
+        coeffs[i].sigma_Angstrom = 3.7 - 0.02*i;
+        coeffs[i].epsilon_over_k = 150.0 + 5.0*i;
+    }
+    return saft::pcsaft::PCSAFTMixture(coeffs);
+}
+
+/// Benchmark the Hessian of Psir from the second-order dual numbers (N(N+1)/2 evaluations of the model)
+/// against the vector-mode hyperdual numbers (one evaluation in total)
+template<int N>
+void bench_Hessian(){
+    auto model = make_PCSAFT_mixture(N);
+    double T = 300;
+    Eigen::ArrayXd rhovec = Eigen::ArrayXd::LinSpaced(N, 100, 300);
+    using id = IsochoricDerivatives<decltype(model)>;
+
+    BENCHMARK("PC-SAFT, N=" + std::to_string(N) + ", dual2nd"){
+        return id::build_Psir_Hessian_autodiff(model, T, rhovec);
+    };
+    BENCHMARK("PC-SAFT, N=" + std::to_string(N) + ", VectorHyperDual<" + std::to_string(N) + ">"){
+        return id::template build_Psir_Hessian_vectorAD<N>(model, T, rhovec);
+    };
+    BENCHMARK("PC-SAFT, N=" + std::to_string(N) + ", VectorHyperDual<20>"){
+        return id::build_Psir_Hessian_vectorAD(model, T, rhovec);
+    };
+}
+
+TEST_CASE("Hessian of Psir for PC-SAFT", "[Hessian]")
+{
+    bench_Hessian<2>();
+    bench_Hessian<5>();
+    bench_Hessian<10>();
+    bench_Hessian<20>();
+}
+
+/// Benchmark the Hessian of Psir in closed form, which the cubic EOS provide, against the automatic differentiation it replaces
+template<int N>
+void bench_Hessian_closed_form(){
+    std::valarray<double> Tc_K(N), pc_Pa(N), acentric(N);
+    for (auto i = 0; i < N; ++i){
+        Tc_K[i] = 190.0 + 15.0*i; pc_Pa[i] = 4.6e6 - 5e4*i; acentric[i] = 0.01 + 0.02*i;
+    }
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    double T = 300;
+    Eigen::ArrayXd rhovec = Eigen::ArrayXd::LinSpaced(N, 100, 300);
+    using id = IsochoricDerivatives<decltype(model)>;
+
+    BENCHMARK("PR, N=" + std::to_string(N) + ", closed form"){
+        return id::build_Psir_Hessian_autodiff(model, T, rhovec);
+    };
+    BENCHMARK("PR, N=" + std::to_string(N) + ", dual2nd"){
+        return id::template build_Psir_Hessian_autodiff<false>(model, T, rhovec);
+    };
+    BENCHMARK("PR, N=" + std::to_string(N) + ", VectorHyperDual<" + std::to_string(N) + ">"){
+        return id::template build_Psir_Hessian_vectorAD<N>(model, T, rhovec);
+    };
+}
+
+TEST_CASE("Hessian of Psir for the Peng-Robinson EOS", "[Hessian]")
+{
+    bench_Hessian_closed_form<2>();
+    bench_Hessian_closed_form<5>();
+    bench_Hessian_closed_form<10>();
+    bench_Hessian_closed_form<20>();
+}
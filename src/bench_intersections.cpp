@@ -0,0 +1,34 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/algorithms/VLLE.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Intersections of long traces", "[VLLE]")
+{
+    // Lissajous curves, which cross themselves and each other, as stand-ins for finely-stepped traces
+    for (auto N : {1000, 10000, 100000}){
+        Eigen::ArrayXd s = Eigen::ArrayXd::LinSpaced(N, 0, 2*EIGEN_PI);
+        Eigen::ArrayXd x1 = sin(3*s), y1 = sin(4*s+0.3), x2 = 0.9*cos(5*s), y2 = sin(2*s);
+        
+        BENCHMARK("self intersections, N=" + std::to_string(N)){
+            return VLLE::get_self_intersections(x1, y1);
+        };
+        BENCHMARK("cross intersections, N=" + std::to_string(N)){
+            return VLLE::get_cross_intersections(x1, y1, x2, y2);
+        };
+        if (N <= 10000){
+            // The search over all pairs of segments, as was done before the sweep, for comparison
+            BENCHMARK("all pairs of segments, N=" + std::to_string(N)){
+                std::size_t count = 0;
+                for (auto j = 0; j + 1 < s.size(); ++j){
+                    for (auto k = j + 1; k + 1 < s.size(); ++k){
+                        count += VLLE::detail::intersect_segments(x1, y1, j, x1, y1, k).has_value();
+                    }
+                }
+                return count;
+            };
+        }
+    }
+}
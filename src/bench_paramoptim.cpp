@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/pure_param_optimization.hpp"
+
+using namespace teqp::algorithms::pure_param_optimization;
+
+TEST_CASE("Threaded cost function with many cheap contributions", "[paramoptim]")
+{
+    auto j = R"({
+        "kind": "PCSAFT",
+        "model": {
+            "coeffs": [{"name": "Methane", "BibTeXKey": "Gross-IECR-2001", "m": 1.0, "sigma_Angstrom": 3.7039, "epsilon_over_k": 150.03}]
+        }
+    })"_json;
+    const std::size_t Nthreads = 6;
+    std::vector<double> x = {1.05};
+    
+    for (auto N : {1000, 100000}){
+        PureParameterOptimizer ppo(j, {"/model/coeffs/0/m"});
+        for (auto i = 0; i < N; ++i){
+            PVTNoniterativePoint pt;
+            pt.T = 200 + 100.0*i/N; pt.rho_exp = 100.0 + 1000.0*i/N; pt.p_exp = 1e6;
+            ppo.add_one_contribution(pt);
+        }
+        
+        BENCHMARK("serial, N=" + std::to_string(N)){
+            return ppo.cost_function(x);
+        };
+        BENCHMARK("persistent pool and balanced chunks, N=" + std::to_string(N)){
+            return ppo.cost_function_threaded(x, Nthreads);
+        };
+        // A new pool for each call and one task per contribution, as was done before, for comparison
+        BENCHMARK("new pool and one task per contribution, N=" + std::to_string(N)){
+            boost::asio::thread_pool pool{Nthreads};
+            auto model = std::get<0>(ppo.prepare(x));
+            std::valarray<double> buffer(ppo.contributions.size());
+            std::size_t i = 0;
+            for (const auto& contrib : ppo.contributions){
+                auto& dest = buffer[i];
+                boost::asio::post(pool, [&model, &dest, contrib](){
+                    dest = std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contrib);
+                });
+                i++;
+            }
+            pool.join();
+            return buffer.sum();
+        };
+    }
+}
@@ -0,0 +1,79 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <iostream>
+
+#include "teqp/derivs.hpp"
+#include "teqp/models/vdW.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/cpp/deriv_adapter.hpp"
+
+using namespace teqp;
+
+/// Forwards to a model and counts the calls to alphar
+template<typename Model>
+struct CountingModel{
+    const Model& model;
+    mutable std::size_t Ncalls = 0;
+    template<typename MoleFracType>
+    auto R(const MoleFracType& molefrac) const { return model.R(molefrac); }
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar(const TType& T, const RhoType& rho, const MoleFracType& molefrac) const {
+        ++Ncalls;
+        return model.alphar(T, rho, molefrac);
+    }
+};
+
+TEST_CASE("Derivatives of the phases in one Newton iteration of the VLLE solver at specified pressure", "[VLLE]")
+{
+    std::valarray<double> Tc_K = { 150.687, 289.733 };
+    std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+    vdWEOS<double> vdW(Tc_K, pc_Pa);
+    CountingModel<decltype(vdW)> counter{vdW};
+    auto am = teqp::cppinterface::adapter::make_cview(counter);
+
+    double T = 200;
+    std::vector<Eigen::ArrayXd> phases = {
+        (Eigen::ArrayXd(2) << 100.0, 200.0).finished(),
+        (Eigen::ArrayXd(2) << 3000.0, 12000.0).finished(),
+        (Eigen::ArrayXd(2) << 9000.0, 6000.0).finished()
+    };
+
+    // The calls that were made for each iteration of mix_VLLE_p before the derivatives of each phase were bundled
+    auto separate = [&](){
+        double s = 0;
+        for (auto i = 0U; i < phases.size(); ++i){
+            auto [Psir, grad, H] = am->build_Psir_fgradHessian_autodiff(T, phases[i]);
+            s += Psir + am->build_Psi_Hessian_autodiff(T, phases[i]).sum();
+        }
+        s += (am->build_d2PsirdTdrhoi_autodiff(T, phases[0]) - am->build_d2PsirdTdrhoi_autodiff(T, phases[1])).sum();
+        s += (am->build_d2PsirdTdrhoi_autodiff(T, phases[1]) - am->build_d2PsirdTdrhoi_autodiff(T, phases[2])).sum();
+        s += am->get_dpdT_constrhovec(T, phases[0]) - am->get_dpdT_constrhovec(T, phases[1]);
+        s += am->get_dpdT_constrhovec(T, phases[1]) - am->get_dpdT_constrhovec(T, phases[2]);
+        s += am->get_dpdT_constrhovec(T, phases[0]);
+        return s;
+    };
+    // The calls that are made now
+    auto bundled = [&](){
+        double s = 0;
+        for (auto i = 0U; i < phases.size(); ++i){
+            auto b = am->build_isochoric_derivative_bundle(T, phases[i]);
+            s += b.Psir + b.Hessian_Psi().sum() + b.d2PsirdTdrhovec.sum() + b.dpdT();
+        }
+        return s;
+    };
+
+    counter.Ncalls = 0; separate();
+    auto Nseparate = counter.Ncalls;
+    counter.Ncalls = 0; bundled();
+    auto Nbundled = counter.Ncalls;
+    std::cout << "calls to alphar per iteration; separate: " << Nseparate << ", bundled: " << Nbundled << std::endl;
+    CHECK(Nbundled < Nseparate);
+
+    BENCHMARK("separate derivatives"){
+        return separate();
+    };
+    BENCHMARK("bundled derivatives"){
+        return bundled();
+    };
+}
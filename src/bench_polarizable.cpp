@@ -0,0 +1,66 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/models/saft/polar_terms.hpp"
+
+using namespace teqp;
+using namespace teqp::SAFTpolar;
+
+TEST_CASE("Effective dipole moments of polarizable mixtures", "[polarizability]")
+{
+    Eigen::ArrayXd sigma_m(3), epsilon_over_k(3), mu(3), Q(3), molefracs(3);
+    sigma_m << 1e-10, 1.2e-10, 1.1e-10; epsilon_over_k << 100, 150, 120; mu << 3.9e-31, 2.5e-31, 1.5e-31; Q << 0, 1e-40, 0; molefracs << 0.4, 0.3, 0.3;
+    Eigen::MatrixXd SIGMAIJ(3, 3), EPSKIJ(3, 3);
+    for (auto i = 0; i < 3; ++i){
+        for (auto j = 0; j < 3; ++j){
+            SIGMAIJ(i, j) = (sigma_m[i] + sigma_m[j])/2;
+            EPSKIJ(i, j) = sqrt(epsilon_over_k[i]*epsilon_over_k[j]);
+        }
+    }
+    auto flags = R"({"polarizable": {"alpha_symm / m^3": [0.06e-30, 0.1e-30, 0.08e-30], "alpha_asymm / m^3": [0.0, 0.0, 0.0]}})"_json;
+    MultipolarContributionGrayGubbins<GubbinsTwuJIntegral, GubbinsTwuKIntegral> GG{sigma_m, epsilon_over_k, SIGMAIJ, EPSKIJ, mu, Q, flags};
+    double T = 150, rhostar = 0.6, rhoN = rhostar/pow(1.1e-10, 3);
+    autodiff::Real<2, double> rhoNad = rhoN; rhoNad[1] = 1.0;
+    
+    BENCHMARK("double, successive substitution (10 steps)"){
+        return GG.iterate_muprime_SS(T, rhoN, rhostar, molefracs, mu, 10);
+    };
+    BENCHMARK("double, Newton"){
+        return GG.solve_muprime(T, rhoN, rhostar, molefracs, mu);
+    };
+    BENCHMARK("Real<2>, successive substitution (10 steps)"){
+        return GG.iterate_muprime_SS(T, rhoNad, rhostar, molefracs, mu, 10);
+    };
+    BENCHMARK("Real<2>, Newton and implicit derivatives"){
+        return GG.solve_muprime(T, rhoNad, rhostar, molefracs, mu);
+    };
+}
+
+TEST_CASE("Derivatives of polarizable SAFT-VR-Mie mixtures", "[polarizability]")
+{
+    auto j = R"({"kind": "SAFT-VR-Mie", "model": {"polar_model": "GrayGubbins+GubbinsTwu", "polar_flags": {"polarizable": {"alpha_symm / m^3": [0.06e-30, 0.1e-30, 0.08e-30], "alpha_asymm / m^3": [0.0, 0.0, 0.0]}}, "coeffs": [
+        {"name": "A", "BibTeXKey": "me", "m": 1.0, "epsilon_over_k": 100, "sigma_m": 1e-10, "lambda_r": 12.0, "lambda_a": 6.0, "mu_Cm": 3.9e-31, "nmu": 1.0},
+        {"name": "B", "BibTeXKey": "me", "m": 1.2, "epsilon_over_k": 150, "sigma_m": 1.2e-10, "lambda_r": 14.0, "lambda_a": 6.0, "mu_Cm": 2.5e-31, "nmu": 1.0},
+        {"name": "C", "BibTeXKey": "me", "m": 1.5, "epsilon_over_k": 120, "sigma_m": 1.1e-10, "lambda_r": 13.0, "lambda_a": 6.0, "mu_Cm": 1.5e-31, "nmu": 1.0}
+    ]}})"_json;
+    auto model = teqp::cppinterface::make_model(j);
+    double T = 150, rho = 0.3/pow(1.1e-10, 3)/teqp::constants::N_A;
+    Eigen::ArrayXd z(3); z << 0.4, 0.3, 0.3;
+    
+    BENCHMARK("Ar00"){
+        return model->get_Ar00(T, rho, z);
+    };
+    BENCHMARK("Ar01"){
+        return model->get_Ar01(T, rho, z);
+    };
+    BENCHMARK("Ar02n"){
+        return model->get_Ar02n(T, rho, z);
+    };
+    BENCHMARK("Ar11"){
+        return model->get_Ar11(T, rho, z);
+    };
+    BENCHMARK("fugacity coefficients"){
+        return model->get_fugacity_coefficients(T, (rho*z).eval());
+    };
+}
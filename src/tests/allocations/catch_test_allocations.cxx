@@ -0,0 +1,178 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include <atomic>
+#include <cstdlib>
+
+#include "teqp/cpp/teqpcpp.hpp"
+
+// The heap allocations are counted by replacing the C allocation functions, which is only possible with glibc. Eigen
+// and the global operator new both allocate through these functions. This test is built into its own executable
+// so that the replacement does not affect the other tests, and it is skipped with the sanitizers, which replace
+// the allocation functions themselves
+#if defined(__has_feature)
+#  if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#    define TEQP_ALLOCATIONS_SANITIZED
+#  endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#  define TEQP_ALLOCATIONS_SANITIZED
+#endif
+
+#if defined(__GLIBC__) && !defined(TEQP_ALLOCATIONS_SANITIZED)
+
+#include <cerrno>
+
+static std::atomic<bool> counting_allocations{false};
+static std::atomic<long> allocation_count{0};
+
+static void count_allocation(){
+    if (counting_allocations){
+        ++allocation_count;
+    }
+}
+
+extern "C" {
+void* __libc_malloc(std::size_t);
+void* __libc_calloc(std::size_t, std::size_t);
+void* __libc_realloc(void*, std::size_t);
+void* __libc_memalign(std::size_t, std::size_t);
+
+void* malloc(std::size_t size){
+    count_allocation();
+    return __libc_malloc(size);
+}
+void* calloc(std::size_t n, std::size_t size){
+    count_allocation();
+    return __libc_calloc(n, size);
+}
+void* realloc(void* ptr, std::size_t size){
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+void* memalign(std::size_t alignment, std::size_t size){
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+void* aligned_alloc(std::size_t alignment, std::size_t size){
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+int posix_memalign(void** ptr, std::size_t alignment, std::size_t size){
+    count_allocation();
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0){
+        return EINVAL;
+    }
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr){
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+}
+
+/// The number of heap allocations made in the call of the function
+template<typename Function>
+long count_allocations(const Function& f){
+    allocation_count = 0;
+    counting_allocations = true;
+    volatile double r = f();
+    counting_allocations = false;
+    (void)r;
+    return allocation_count;
+}
+
+/// Check that none of the derivatives allocate on the heap
+static void check_no_allocations(const teqp::cppinterface::AbstractModel& model, const double T, const double rho, const Eigen::ArrayXd& z){
+    model.get_Ar01(T, rho, z);
+
+    CHECK(count_allocations([&](){ return model.get_Ar00(T, rho, z); }) == 0);
+    CHECK(count_allocations([&](){ return model.get_Ar01(T, rho, z); }) == 0);
+    CHECK(count_allocations([&](){ return model.get_Ar02(T, rho, z); }) == 0);
+    CHECK(count_allocations([&](){ return model.get_Ar10(T, rho, z); }) == 0);
+    CHECK(count_allocations([&](){ return model.get_Ar11(T, rho, z); }) == 0);
+    CHECK(count_allocations([&](){ return model.get_Ar20(T, rho, z); }) == 0);
+    CHECK(count_allocations([&](){ return model.get_Arxy(1, 2, T, rho, z); }) == 0);
+}
+
+TEST_CASE("No heap allocation in the derivatives of pure fluids and small mixtures", "[allocations]"){
+    std::vector<double> Tc_K = {150.687, 289.733, 190.564, 305.32, 369.89};
+    std::vector<double> pc_Pa = {4863000.0, 5842000.0, 4599200.0, 4872200.0, 4251200.0};
+    double T = 300, rho = 100;
+
+    for (auto N = 1; N <= 4; ++N){
+        CAPTURE(N);
+        nlohmann::json spec{
+            {"kind", "vdW"},
+            {"model", {
+                {"Tcrit / K", std::vector<double>(Tc_K.begin(), Tc_K.begin() + N)},
+                {"pcrit / Pa", std::vector<double>(pc_Pa.begin(), pc_Pa.begin() + N)}
+            }}
+        };
+        auto model = teqp::cppinterface::make_model(spec);
+        Eigen::ArrayXd z = Eigen::ArrayXd::Constant(N, 1.0/N);
+        check_no_allocations(*model, T, rho, z);
+    }
+
+    SECTION("the values are the same with and without the fixed-size arrays"){
+        nlohmann::json spec{{"kind", "vdW"}, {"model", {{"Tcrit / K", Tc_K}, {"pcrit / Pa", pc_Pa}}}};
+        auto model5 = teqp::cppinterface::make_model(spec);
+        spec["model"]["Tcrit / K"] = std::vector<double>(Tc_K.begin(), Tc_K.begin() + 2);
+        spec["model"]["pcrit / Pa"] = std::vector<double>(pc_Pa.begin(), pc_Pa.begin() + 2);
+        auto model2 = teqp::cppinterface::make_model(spec);
+        // The last three components are absent, so the five-component mixture reduces to the binary one
+        Eigen::ArrayXd z5(5), z2(2);
+        z5 << 0.3, 0.7, 0.0, 0.0, 0.0;
+        z2 << 0.3, 0.7;
+        CHECK(model5->get_Ar11(T, rho, z5) == Approx(model2->get_Ar11(T, rho, z2)).epsilon(1e-14));
+        CHECK(model5->get_Ar02(T, rho, z5) == Approx(model2->get_Ar02(T, rho, z2)).epsilon(1e-14));
+    }
+}
+
+TEST_CASE("No heap allocation in the derivatives of Peng-Robinson for pure fluids and small mixtures", "[allocations]"){
+    std::vector<double> Tc_K = {190.564, 305.32, 369.89, 425.12};
+    std::vector<double> pc_Pa = {4599200.0, 4872200.0, 4251200.0, 3796000.0};
+    std::vector<double> acentric = {0.011, 0.099, 0.152, 0.2};
+    double T = 300, rho = 100;
+
+    for (auto N = 1; N <= 4; ++N){
+        CAPTURE(N);
+        nlohmann::json spec{
+            {"kind", "PR"},
+            {"model", {
+                {"Tcrit / K", std::vector<double>(Tc_K.begin(), Tc_K.begin() + N)},
+                {"pcrit / Pa", std::vector<double>(pc_Pa.begin(), pc_Pa.begin() + N)},
+                {"acentric", std::vector<double>(acentric.begin(), acentric.begin() + N)}
+            }}
+        };
+        auto model = teqp::cppinterface::make_model(spec);
+        Eigen::ArrayXd z = Eigen::ArrayXd::Constant(N, 1.0/N);
+        check_no_allocations(*model, T, rho, z);
+    }
+}
+
+TEST_CASE("No heap allocation in the derivatives of PC-SAFT for pure fluids and small mixtures", "[allocations]"){
+    auto coeffs = nlohmann::json::parse(R"([
+        {"name": "Methane", "m": 1.0000, "sigma_Angstrom": 3.7039, "epsilon_over_k": 150.03, "BibTeXKey": "Gross-IECR-2001"},
+        {"name": "Ethane", "m": 1.6069, "sigma_Angstrom": 3.5206, "epsilon_over_k": 191.42, "BibTeXKey": "Gross-IECR-2001"},
+        {"name": "Propane", "m": 2.0020, "sigma_Angstrom": 3.6184, "epsilon_over_k": 208.11, "BibTeXKey": "Gross-IECR-2001"},
+        {"name": "n-Butane", "m": 2.3316, "sigma_Angstrom": 3.7086, "epsilon_over_k": 222.88, "BibTeXKey": "Gross-IECR-2001"}
+    ])");
+    double T = 300, rho = 100;
+
+    for (auto N = 1; N <= 4; ++N){
+        CAPTURE(N);
+        nlohmann::json spec{
+            {"kind", "PCSAFT"},
+            {"model", {{"coeffs", std::vector<nlohmann::json>(coeffs.begin(), coeffs.begin() + N)}}}
+        };
+        auto model = teqp::cppinterface::make_model(spec);
+        Eigen::ArrayXd z = Eigen::ArrayXd::Constant(N, 1.0/N);
+        check_no_allocations(*model, T, rho, z);
+    }
+}
+
+#endif
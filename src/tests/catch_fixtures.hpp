@@ -28,6 +28,16 @@ public:
         CAPTURE(B_n);
         
         REQUIRE(std::isfinite(B_n));
+
+        // The same virial coefficient from the Taylor series in density in double-double precision
+        auto B_n_ep = model->get_Bnvir_ep(n, T, molefrac)[n];
+        CAPTURE(B_n_ep);
+        if (std::abs(B_n_ep) > 1e-12){
+            CHECK_THAT(B_n, WithinRel(B_n_ep, reltol));
+        }
+        else{
+            CHECK_THAT(B_n, WithinAbs(B_n_ep, reltol));
+        }
         if (n == 2){
             // B
             auto B_n_nondilute_ep = model->get_Ar01ep(T, rhotest, molefrac)/rhotest; // and divided by (n-2)! or 0! = 1
@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+using Catch::Approx;
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <variant>
+#include "teqp/types.hpp"
+#include "teqp/json_tools.hpp"
+#include "teqp/math/pow_templates.hpp"
+using namespace teqp;
+#include "teqp/models/activity/activity_models.hpp"
+using namespace teqp::activity::activity_models::COSMOSAC;
+
+namespace{
+    /// A smooth sigma profile with the given area
+    SigmaProfile gaussian_profile(double A, double sigma0, double width){
+        Eigen::ArrayXd sigma = Eigen::ArrayXd::LinSpaced(51, -0.025, 0.025);
+        Eigen::ArrayXd p = exp(-((sigma - sigma0)/width).square());
+        p = (p < 1e-8).select(0.0, p);
+        return SigmaProfile(sigma, (A*p/p.sum()).eval());
+    }
+    auto make_models(){
+        Eigen::ArrayXd sigma = Eigen::ArrayXd::LinSpaced(51, -0.025, 0.025), zero = Eigen::ArrayXd::Zero(51);
+        std::vector<FluidSigmaProfiles> profiles = {
+            {gaussian_profile(100, 0.002, 0.004), gaussian_profile(20, 0.012, 0.002), gaussian_profile(10, -0.01, 0.002)},
+            {gaussian_profile(150, -0.001, 0.005), SigmaProfile(sigma, zero), SigmaProfile(sigma, zero)},
+            {gaussian_profile(80, 0.0, 0.003), SigmaProfile(sigma, zero), gaussian_profile(15, 0.011, 0.002)}
+        };
+        std::vector<double> A = {130, 150, 95}, V = {110, 160, 90};
+        COSMO3Constants reference_constants;
+        reference_constants.fast_Gamma = false;
+        reference_constants.Gamma_rel_tol = 1e-13;
+        return std::make_tuple(COSMO3(A, V, profiles), COSMO3(A, V, profiles, reference_constants));
+    }
+}
+
+TEST_CASE("Newton solver for the segment activity coefficients", "[COSMOSAC]"){
+    auto [model, reference] = make_models();
+    Eigen::ArrayXd z(3); z << 0.2, 0.5, 0.3;
+    
+    // Also revisiting a temperature, whose quantities are then taken from the cache
+    for (double T : {280.0, 350.0, 280.0}){
+        CAPTURE(T);
+        auto lngamma = model.get_lngamma_resid(T, z), lngamma_ref = reference.get_lngamma_resid(T, z);
+        for (auto i = 0; i < z.size(); ++i){
+            CHECK(lngamma[i] == Approx(lngamma_ref[i]).margin(1e-11));
+        }
+    }
+    SECTION("Derivatives with complex step"){
+        double T = 300, h = 1e-100, dz = 1e-6;
+        Eigen::ArrayX<std::complex<double>> zc = z.cast<std::complex<double>>();
+        zc[0] += std::complex<double>(0, h);
+        Eigen::ArrayXd derivCSD = model.get_lngamma_resid(T, zc).imag()/h;
+        Eigen::ArrayXd zplus = z, zminus = z; zplus[0] += dz; zminus[0] -= dz;
+        Eigen::ArrayXd derivFD = (reference.get_lngamma_resid(T, zplus) - reference.get_lngamma_resid(T, zminus))/(2*dz);
+        for (auto i = 0; i < z.size(); ++i){
+            CHECK(derivCSD[i] == Approx(derivFD[i]).epsilon(1e-6));
+        }
+    }
+    SECTION("Changing the constants invalidates the cache"){
+        double T = 300;
+        model.get_lngamma_resid(T, z);
+        model.get_mutable_COSMO_constants().A_ES *= 1.1;
+        reference.get_mutable_COSMO_constants().A_ES *= 1.1;
+        auto lngamma = model.get_lngamma_resid(T, z), lngamma_ref = reference.get_lngamma_resid(T, z);
+        for (auto i = 0; i < z.size(); ++i){
+            CHECK(lngamma[i] == Approx(lngamma_ref[i]).margin(1e-11));
+        }
+    }
+}
+
+TEST_CASE("Copies of the model do not share the temperature cache", "[COSMOSAC]"){
+    auto [model, reference] = make_models();
+    Eigen::ArrayXd z(3); z << 0.2, 0.5, 0.3;
+    double T = 300;
+    auto lngamma = model.get_lngamma_resid(T, z);
+    
+    // The copy starts from the constants of the original, but with an empty cache
+    auto copy = model;
+    copy.get_mutable_COSMO_constants().A_ES *= 1.1;
+    reference.get_mutable_COSMO_constants().A_ES *= 1.1;
+    for (auto repeat = 0; repeat < 2; ++repeat){
+        auto lngamma_copy = copy.get_lngamma_resid(T, z), lngamma_ref = reference.get_lngamma_resid(T, z);
+        auto lngamma_again = model.get_lngamma_resid(T, z);
+        for (auto i = 0; i < z.size(); ++i){
+            CHECK(lngamma_copy[i] == Approx(lngamma_ref[i]).margin(1e-11));
+            CHECK(lngamma_again[i] == lngamma[i]);
+        }
+    }
+    // Even with the same constants, each instance holds its own cache
+    auto same = model;
+    CHECK(same.get_expDELTAW(T) != model.get_expDELTAW(T));
+    CHECK((*same.get_expDELTAW(T) == *model.get_expDELTAW(T)).all());
+}
+
+TEST_CASE("Segment activity coefficients for many compositions", "[COSMOSAC]"){
+    auto [model, reference] = make_models();
+    double T = 300;
+    Eigen::Index N = 100;
+    Eigen::ArrayXXd X(N, 3);
+    for (auto i = 0; i < N; ++i){
+        double x = (i + 0.5)/N;
+        X.row(i) << 0.5*x, 0.7*(1-x), 1 - 0.5*x - 0.7*(1-x);
+    }
+    auto lngamma = model.get_lngamma_resid_many(T, X);
+    for (auto i = 0; i < N; ++i){
+        Eigen::ArrayXd z = X.row(i).transpose();
+        CHECK((lngamma.row(i).transpose() - reference.get_lngamma_resid(T, z)).abs().maxCoeff() < 1e-11);
+    }
+    BENCHMARK("Newton, many compositions"){
+        return model.get_lngamma_resid_many(T, X);
+    };
+    BENCHMARK("successive substitution, one composition at a time"){
+        Eigen::ArrayXXd o(N, 3);
+        for (auto i = 0; i < N; ++i){
+            Eigen::ArrayXd z = X.row(i).transpose();
+            o.row(i) = reference.get_lngamma_resid(T, z).transpose();
+        }
+        return o;
+    };
+}
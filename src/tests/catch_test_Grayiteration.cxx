@@ -249,3 +249,49 @@ TEST_CASE("Test critical points against Kiyohara results", "[polarizability]"){
         }
     }
 }
+
+TEST_CASE("Newton solution for the effective dipole moments of a polarizable mixture", "[polarizability]")
+{
+    Eigen::ArrayXd sigma_m(2), epsilon_over_k(2), mu(2), Q(2), molefracs(2);
+    sigma_m << 1e-10, 1.2e-10; epsilon_over_k << 100, 150; mu << 3.9e-31, 2.5e-31; Q << 0, 1e-40; molefracs << 0.4, 0.6;
+    Eigen::MatrixXd SIGMAIJ(2, 2), EPSKIJ(2, 2);
+    for (auto i = 0; i < 2; ++i){
+        for (auto j = 0; j < 2; ++j){
+            SIGMAIJ(i, j) = (sigma_m[i] + sigma_m[j])/2;
+            EPSKIJ(i, j) = sqrt(epsilon_over_k[i]*epsilon_over_k[j]);
+        }
+    }
+    auto flags = R"({"polarizable": {"alpha_symm / m^3": [0.06e-30, 0.1e-30], "alpha_asymm / m^3": [0.0, 0.0]}})"_json;
+    MultipolarContributionGrayGubbins<GubbinsTwuJIntegral, GubbinsTwuKIntegral> GG{sigma_m, epsilon_over_k, SIGMAIJ, EPSKIJ, mu, Q, flags};
+    double T = 150, rhostar = 0.6, rhoN = rhostar/pow(1.1e-10, 3);
+    
+    SECTION("Converged successive substitution"){
+        Eigen::ArrayXd muprime = GG.solve_muprime(T, rhoN, rhostar, molefracs, mu);
+        Eigen::ArrayXd muprimeSS = GG.iterate_muprime_SS(T, rhoN, rhostar, molefracs, mu, 200);
+        for (auto i = 0; i < 2; ++i){
+            CHECK(muprime[i] == Approx(muprimeSS[i]).epsilon(1e-12));
+        }
+    }
+    SECTION("Temperature derivative from the implicit function theorem"){
+        double h = 1e-100, dT = 1e-4;
+        auto muprimecsd = GG.solve_muprime(std::complex<double>(T, h), rhoN, rhostar, molefracs, mu);
+        Eigen::ArrayXd muprimep = GG.solve_muprime(T+dT, rhoN, rhostar, molefracs, mu);
+        Eigen::ArrayXd muprimem = GG.solve_muprime(T-dT, rhoN, rhostar, molefracs, mu);
+        for (auto i = 0; i < 2; ++i){
+            CHECK(muprimecsd[i].imag()/h == Approx((muprimep[i]-muprimem[i])/(2*dT)).epsilon(1e-6));
+        }
+    }
+    SECTION("Density derivatives of polarizable SAFT-VR-Mie"){
+        auto j = R"({"kind": "SAFT-VR-Mie", "model": {"polar_model": "GrayGubbins+GubbinsTwu", "polar_flags": {"polarizable": {"alpha_symm / m^3": [0.06e-30, 0.1e-30], "alpha_asymm / m^3": [0.0, 0.0]}}, "coeffs": [
+            {"name": "A", "BibTeXKey": "me", "m": 1.0, "epsilon_over_k": 100, "sigma_m": 1e-10, "lambda_r": 12.0, "lambda_a": 6.0, "mu_Cm": 3.9e-31, "nmu": 1.0},
+            {"name": "B", "BibTeXKey": "me", "m": 1.2, "epsilon_over_k": 150, "sigma_m": 1.2e-10, "lambda_r": 14.0, "lambda_a": 6.0, "mu_Cm": 2.5e-31, "nmu": 1.0}
+        ]}})"_json;
+        auto model = teqp::cppinterface::make_model(j);
+        double rho = 0.3/pow(1.1e-10, 3)/teqp::constants::N_A, drho = 1e-5*rho;
+        Eigen::ArrayXd z = molefracs;
+        auto Ar01 = model->get_Ar01(T, rho, z);
+        auto Ar02 = model->get_Ar02(T, rho, z);
+        CHECK(Ar01 == Approx(rho*(model->get_Ar00(T, rho+drho, z)-model->get_Ar00(T, rho-drho, z))/(2*drho)).epsilon(1e-7));
+        CHECK(Ar02 == Approx(rho*(model->get_Ar01(T, rho+drho, z)/(rho+drho)-model->get_Ar01(T, rho-drho, z)/(rho-drho))/(2*drho)*rho).epsilon(1e-6));
+    }
+}
@@ -84,6 +84,30 @@ TEST_CASE("Evaluation of K^{(n,m)}", "[checkKvals]")
 }
 
 
+TEST_CASE("Integrals of all the pairs match those evaluated one at a time", "[checkKvals]")
+{
+    double rhostar = 0.88;
+    Eigen::ArrayXXd Tstarij(2, 2); Tstarij << 1.095, 1.3, 1.3, 1.6;
+    auto check = [&](const auto& integral, const auto& matrix, const auto& one){
+        for (auto i = 0; i < 2; ++i){
+            for (auto j = 0; j < 2; ++j){
+                CHECK(matrix(i, j) == Approx(one(integral, Tstarij(i, j))).epsilon(1e-14));
+            }
+        }
+    };
+    auto getJ = [&](const auto& J, double Tstar){ return J.get_J(Tstar, rhostar); };
+    auto getK = [&](const auto& K, double Tstar){ return K.get_K(Tstar, rhostar); };
+    for (auto n : {6, 11}){
+        CAPTURE(n);
+        check(LuckasJIntegral(n), LuckasJIntegral(n).get_J_matrix(Tstarij, rhostar), getJ);
+        check(GubbinsTwuJIntegral(n), GubbinsTwuJIntegral(n).get_J_matrix(Tstarij, rhostar), getJ);
+        check(GottschalkJIntegral(n), GottschalkJIntegral(n).get_J_matrix(Tstarij, rhostar), getJ);
+    }
+    check(LuckasKIntegral(233, 344), LuckasKIntegral(233, 344).get_K_matrix(Tstarij, rhostar), getK);
+    check(GubbinsTwuKIntegral(233, 344), GubbinsTwuKIntegral(233, 344).get_K_matrix(Tstarij, rhostar), getK);
+    check(GottschalkKIntegral(233, 344), GottschalkKIntegral(233, 344).get_K_matrix(Tstarij, rhostar), getK);
+}
+
 using my_float_type = boost::multiprecision::number<boost::multiprecision::cpp_bin_float<100U>>;
 
 TEST_CASE("Evaluate higher derivatives of K", "[GTK]")
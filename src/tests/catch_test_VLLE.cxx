@@ -26,6 +26,36 @@ TEST_CASE("Test intersection for trisectrix", "[VLLE]"){
     CHECK(crintersections.size() == 3);
 }
 
+TEST_CASE("Test intersections from sweep against those from all pairs of segments", "[VLLE]"){
+    Eigen::ArrayXd s = Eigen::ArrayXd::LinSpaced(1000, 0, 2*EIGEN_PI);
+    Eigen::ArrayXd x1 = sin(3*s), y1 = sin(4*s+0.3), x2 = 0.9*cos(5*s), y2 = sin(2*s);
+    
+    std::vector<teqp::VLLE::SelfIntersectionSolution> self, cross;
+    for (auto j = 0; j + 1 < s.size(); ++j){
+        for (auto k = 0; k + 1 < s.size(); ++k){
+            if (k > j){
+                auto soln = teqp::VLLE::detail::intersect_segments(x1, y1, j, x1, y1, k);
+                if (soln){ self.push_back(soln.value()); }
+            }
+            auto soln = teqp::VLLE::detail::intersect_segments(x1, y1, j, x2, y2, k);
+            if (soln){ cross.push_back(soln.value()); }
+        }
+    }
+    auto same = [](const auto& a, const auto& b){
+        if (a.size() != b.size()){ return false; }
+        for (auto i = 0U; i < a.size(); ++i){
+            if (a[i].j != b[i].j || a[i].k != b[i].k || a[i].x != b[i].x || a[i].y != b[i].y){ return false; }
+        }
+        return true;
+    };
+    auto sweepself = teqp::VLLE::get_self_intersections(x1, y1);
+    auto sweepcross = teqp::VLLE::get_cross_intersections(x1, y1, x2, y2);
+    CHECK(self.size() > 0);
+    CHECK(cross.size() > 0);
+    CHECK(same(sweepself, self));
+    CHECK(same(sweepcross, cross));
+}
+
 TEST_CASE("Test VLLE for nitrogen + ethane for isotherm", "[VLLE]")
 {
     // As in the examples in https://doi.org/10.1021/acs.iecr.1c04703
@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
 using Catch::Approx;
+#include <catch2/benchmark/catch_benchmark_all.hpp>
 
 #include "nlohmann/json.hpp"
 #include "teqp/ideal_eosterms.hpp"
@@ -67,3 +68,69 @@ TEST_CASE("Ammonia derivative", "[alphaig][NH3]") {
     
     DerivativeHolderSquare<2> dhs(ih, T, rho, molefrac);
 }
+
+TEST_CASE("Analytic temperature derivatives of the ideal-gas terms", "[alphaig]") {
+    using o = nlohmann::json::object_t;
+    nlohmann::json terms = {
+        o{ {"type", "Lead"}, {"a_1", 1.3}, {"a_2", 400.0} },
+        o{ {"type", "LogT"}, {"a", -3.0} },
+        o{ {"type", "Constant"}, {"a", 2.0} },
+        o{ {"type", "PowerT"}, {"n", {0.3, -0.2}}, {"t", {-1.5, 0.5}} },
+        o{ {"type", "PlanckEinstein"}, {"n", {2.224, 3.148}}, {"theta", {1646.0, 3965.0}} },
+        o{ {"type", "PlanckEinstein"}, {"n", {0.9579}}, {"theta", {7231.0}} },
+        o{ {"type", "PlanckEinsteinGeneralized"}, {"n", {1.1, -0.7}}, {"c", {1.0, 1.0}}, {"d", {-1.0, 1.0}}, {"theta", {-800.0, -1200.0}} },
+        o{ {"type", "GERG2004Cosh"}, {"n", {0.8}}, {"theta", {700.0}} },
+        o{ {"type", "GERG2004Sinh"}, {"n", {1.7}}, {"theta", {900.0}} },
+        o{ {"type", "Cp0Constant"}, {"c", 3.5}, {"T_0", 298.15} },
+        o{ {"type", "Cp0PowerT"}, {"c", 0.002}, {"t", 1.2}, {"T_0", 298.15} }
+    };
+    nlohmann::json j = {
+        o{ {"R", 8.31446261815324}, {"terms", terms} },
+        o{ {"R", 8.31446261815324}, {"terms", {o{ {"type", "Lead"}, {"a_1", 0.3}, {"a_2", 100.0} }, o{ {"type", "PlanckEinstein"}, {"n", {1.0}}, {"theta", {500.0}} }}} }
+    };
+    IdealHelmholtz ih(j);
+    // The two Planck-Einstein terms are merged into one
+    CHECK(ih.pures[0].contributions.size() == terms.size() - 1);
+    
+    auto molefrac = (Eigen::ArrayXd(2) << 0.7, 0.3).finished();
+    double T = 300, rho = 50;
+    using tdx = TDXDerivatives<decltype(ih), double, Eigen::ArrayXd>;
+    
+    auto analytic = tdx::get_Arn0<4>(ih, T, rho, molefrac);
+    auto AD = tdx::get_Agenn0<4, ADBackends::autodiff>(ih, T, rho, molefrac);
+    for (auto n = 0; n <= 4; ++n){
+        CAPTURE(n);
+        CHECK(analytic[n] == Approx(AD[n]).epsilon(1e-12));
+    }
+    CHECK(tdx::get_Ar20(ih, T, rho, molefrac) == Approx(AD[2]).epsilon(1e-12));
+    CHECK(tdx::get_Aigxy<1, 0>(ih, T, rho, molefrac) == Approx(AD[1]).epsilon(1e-12));
+#if defined(TEQP_MULTICOMPLEX_ENABLED)
+    {
+        // An explicitly selected backend is used as such, so this is an independent cross-check of the closed-form derivatives;
+        // the GERG terms take abs() of cosh and sinh, which is not defined for multicomplex numbers, so they are left out here
+        nlohmann::json jmcx = j;
+        nlohmann::json termsmcx = nlohmann::json::array();
+        for (const auto& term : terms){
+            if (term.at("type") != "GERG2004Cosh" && term.at("type") != "GERG2004Sinh"){ termsmcx.push_back(term); }
+        }
+        jmcx[0]["terms"] = termsmcx;
+        IdealHelmholtz ihmcx(jmcx);
+        using tdxmcx = TDXDerivatives<decltype(ihmcx), double, Eigen::ArrayXd>;
+        auto analyticmcx = tdxmcx::get_Arn0<4>(ihmcx, T, rho, molefrac);
+        auto MCX = tdxmcx::get_Arn0<4, ADBackends::multicomplex>(ihmcx, T, rho, molefrac);
+        for (auto n = 0; n <= 4; ++n){
+            CAPTURE(n);
+            CHECK(analyticmcx[n] == Approx(MCX[n]).epsilon(1e-12));
+        }
+        CHECK(tdxmcx::get_Aigxy<2, 0>(ihmcx, T, rho, molefrac) == Approx(tdxmcx::get_Aigxy<2, 0, ADBackends::multicomplex>(ihmcx, T, rho, molefrac)).epsilon(1e-12));
+        CHECK(tdxmcx::get_Arxy<3, 0>(ihmcx, T, rho, molefrac) == Approx(tdxmcx::get_Arxy<3, 0, ADBackends::multicomplex>(ihmcx, T, rho, molefrac)).epsilon(1e-12));
+    }
+#endif
+    
+    BENCHMARK("A00..A30 analytic"){
+        return tdx::get_Arn0<3>(ih, T, rho, molefrac);
+    };
+    BENCHMARK("A00..A30 autodiff"){
+        return tdx::get_Agenn0<3, ADBackends::autodiff>(ih, T, rho, molefrac);
+    };
+}
@@ -1,15 +1,19 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
 using Catch::Approx;
+using Catch::Matchers::WithinRel;
 
 #include <iostream>
 #include <concepts>
+#include <valarray>
 
 #include "teqp/models/multifluid.hpp"
 #include "teqp/models/multifluid_mutant.hpp"
 #include "teqp/derivs.hpp"
 #include "teqp/models/vdW.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
 
 using namespace teqp;
 
@@ -83,6 +87,121 @@ TEST_CASE("Test composition derivatives with get_ArTDXi", "[compderivs]"){
     std::cout << H << std::endl;
 }
 
+template<int iT, int iD, bool third, typename Model>
+void check_composition_derivatives_all(const Model& model, double T, double rhomolar, const Eigen::ArrayXd& molefrac){
+    CAPTURE(iT);
+    CAPTURE(iD);
+    using TDX = TDXDerivatives<Model>;
+    auto N = molefrac.size();
+    auto g = TDX::get_ATrhoXi_all_runtime(model, T, iT, rhomolar, iD, molefrac);
+    auto H = TDX::get_ATrhoXiXj_all_runtime(model, T, iT, rhomolar, iD, molefrac);
+    for (auto i = 0; i < N; ++i){
+        CHECK_THAT(g[i], WithinRel(TDX::template get_ATrhoXi<iT, iD, 1>(model, T, rhomolar, molefrac, i), 1e-12));
+        for (auto j = 0; j < N; ++j){
+            double val = (i == j) ? TDX::template get_ATrhoXi<iT, iD, 2>(model, T, rhomolar, molefrac, i) : TDX::template get_ATrhoXiXj<iT, iD, 1, 1>(model, T, rhomolar, molefrac, i, j);
+            CHECK_THAT(H(i, j), WithinRel(val, 1e-12));
+        }
+    }
+    if constexpr (third){
+        auto t = TDX::get_ATrhoXiXjXk_all_runtime(model, T, iT, rhomolar, iD, molefrac);
+        REQUIRE(t.size() == N*N*N);
+        for (auto i = 0; i < N; ++i){
+            for (auto j = 0; j < N; ++j){
+                for (auto k = 0; k < N; ++k){
+                    double val;
+                    if (i == j && j == k){
+                        val = TDX::template get_ATrhoXi<iT, iD, 3>(model, T, rhomolar, molefrac, i);
+                    }
+                    else if (i != j && j != k && i != k){
+                        val = TDX::template get_ATrhoXiXjXk<iT, iD, 1, 1, 1>(model, T, rhomolar, molefrac, i, j, k);
+                    }
+                    else{
+                        // Two of the indices are the same, a is the repeated one
+                        int a = (i == j || i == k) ? i : j, b = (i == j) ? k : ((i == k) ? j : i);
+                        val = TDX::template get_ATrhoXiXj<iT, iD, 2, 1>(model, T, rhomolar, molefrac, a, b);
+                    }
+                    CHECK_THAT(t[(i*N+j)*N+k], WithinRel(val, 1e-12));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("All the composition derivatives in one sweep agree with one-at-a-time", "[compderivs]"){
+    auto model = vdWEOS<double>({150.687, 126.192, 304.1282}, {4863000.0, 3395800.0, 7377300.0});
+    double T = 300, rhomolar = 3000;
+    auto molefrac = (Eigen::ArrayXd(3) << 0.2, 0.3, 0.5).finished();
+    check_composition_derivatives_all<0, 0, true>(model, T, rhomolar, molefrac);
+    check_composition_derivatives_all<1, 0, true>(model, T, rhomolar, molefrac);
+    check_composition_derivatives_all<0, 1, true>(model, T, rhomolar, molefrac);
+    check_composition_derivatives_all<2, 0, false>(model, T, rhomolar, molefrac);
+    check_composition_derivatives_all<1, 1, false>(model, T, rhomolar, molefrac);
+    check_composition_derivatives_all<0, 2, false>(model, T, rhomolar, molefrac);
+    CHECK_THROWS(TDXDerivatives<decltype(model)>::get_ATrhoXiXjXk_all_runtime(model, T, 2, rhomolar, 0, molefrac));
+}
+
+TEST_CASE("All the composition derivatives in one sweep for more components than fit on the stack", "[compderivs]"){
+    // More than the 20 components that are carried in fixed-capacity storage
+    const int N = 22;
+    std::valarray<double> Tc(N), pc(N);
+    for (auto i = 0; i < N; ++i){ Tc[i] = 150.0 + 10.0*i; pc[i] = 3e6 + 1e5*i; }
+    auto model = vdWEOS<double>(Tc, pc);
+    double T = 300, rhomolar = 3000;
+    Eigen::ArrayXd molefrac = Eigen::ArrayXd::LinSpaced(N, 1.0, 2.0); molefrac /= molefrac.sum();
+    check_composition_derivatives_all<0, 0, false>(model, T, rhomolar, molefrac);
+    check_composition_derivatives_all<0, 1, false>(model, T, rhomolar, molefrac);
+    
+    using TDX = TDXDerivatives<decltype(model)>;
+    auto t = TDX::get_ATrhoXiXjXk_all_runtime(model, T, 0, rhomolar, 0, molefrac);
+    REQUIRE(t.size() == N*N*N);
+    CHECK_THAT(t[(0*N+1)*N+2], WithinRel(TDX::get_ATrhoXiXjXk<0, 0, 1, 1, 1>(model, T, rhomolar, molefrac, 0, 1, 2), 1e-12));
+    CHECK_THAT(t[(N-1)*(N*N+N+1)], WithinRel(TDX::get_ATrhoXi<0, 0, 3>(model, T, rhomolar, molefrac, N-1), 1e-12));
+}
+
+TEST_CASE("All the composition derivatives in one sweep through the AbstractModel", "[compderivs]"){
+    auto j = R"({
+        "kind": "PCSAFT",
+        "model": {
+            "names": ["Methane", "Ethane", "Propane"]
+        }
+    })"_json;
+    auto model = teqp::cppinterface::make_model(j);
+    double T = 250, rhomolar = 2000;
+    auto molefrac = (Eigen::ArrayXd(3) << 0.2, 0.3, 0.5).finished();
+    const auto N = molefrac.size();
+    for (auto [iT, iD] : std::vector<std::tuple<int, int>>{{0, 0}, {1, 0}, {0, 1}}){
+        CAPTURE(iT);
+        CAPTURE(iD);
+        auto g = model->get_ATrhoXi_all(T, iT, rhomolar, iD, molefrac);
+        auto H = model->get_ATrhoXiXj_all(T, iT, rhomolar, iD, molefrac);
+        auto t = model->get_ATrhoXiXjXk_all(T, iT, rhomolar, iD, molefrac);
+        REQUIRE(g.size() == N);
+        REQUIRE(H.rows() == N);
+        REQUIRE(H.cols() == N);
+        REQUIRE(t.size() == N*N*N);
+        for (auto i = 0; i < N; ++i){
+            CHECK_THAT(g[i], WithinRel(model->get_ATrhoXi(T, iT, rhomolar, iD, molefrac, i, 1), 1e-12));
+            for (auto j = 0; j < N; ++j){
+                double val = (i == j) ? model->get_ATrhoXi(T, iT, rhomolar, iD, molefrac, i, 2) : model->get_ATrhoXiXj(T, iT, rhomolar, iD, molefrac, i, 1, j, 1);
+                CHECK_THAT(H(i, j), WithinRel(val, 1e-12));
+                for (auto k = 0; k < N; ++k){
+                    double val3;
+                    if (i == j && j == k){
+                        val3 = model->get_ATrhoXi(T, iT, rhomolar, iD, molefrac, i, 3);
+                    }
+                    else if (i != j && j != k && i != k){
+                        val3 = model->get_ATrhoXiXjXk(T, iT, rhomolar, iD, molefrac, i, 1, j, 1, k, 1);
+                    }
+                    else{
+                        int a = (i == j || i == k) ? i : j, b = (i == j) ? k : ((i == k) ? j : i);
+                        val3 = model->get_ATrhoXiXj(T, iT, rhomolar, iD, molefrac, a, 2, b, 1);
+                    }
+                    CHECK_THAT(t[(i*N+j)*N+k], WithinRel(val3, 1e-12));
+                }
+            }
+        }
+    }
+}
 
 TEST_CASE("get_AtaudeltaXi with multifluid mutant", "[mutant]") {
     std::string root = FLUIDDATAPATH;
@@ -1,15 +1,22 @@
 
 #include <fstream>
+#include <functional>
+#include <filesystem>
+#include <random>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
 
 using Catch::Approx;
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+using Catch::Matchers::WithinRel;
+using Catch::Matchers::WithinAbs;
 
 #include "teqp/models/cubics/simple_cubics.hpp"
 #include "teqp/models/cubics/advancedmixing_cubics.hpp"
 #include "teqp/derivs.hpp"
 #include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/density.hpp"
 #include "teqp/cpp/teqpcpp.hpp"
 
 #include <boost/numeric/odeint/stepper/euler.hpp>
@@ -448,6 +455,98 @@ TEST_CASE("Check manual integration of subcritical VLE isobar for binary mixture
     }
 }
 
+TEST_CASE("Trace a batch of isotherms concurrently", "[cubic][isochoric][isotherm]")
+{
+    // methane + propane
+    std::valarray<double> Tc_K = {190.564, 369.89}, pc_Pa = {4599200, 4251200}, acentric = {0.011, 0.1521};
+    const auto modelptr = teqp::cppinterface::adapter::make_owned(canonical_PR(Tc_K, pc_Pa, acentric));
+    const auto& model = teqp::cppinterface::adapter::get_model_cref<canonical_cubic_t>(modelptr.get());
+
+    std::vector<VLEIsothermSpec> specs;
+    for (double T : {220.0, 250.0, 280.0, 310.0}){
+        auto [rhoL, rhoV] = model.superanc_rhoLV(T, 1);
+        VLEIsothermSpec spec;
+        spec.T = T;
+        spec.rhovecL0 = (Eigen::ArrayXd(2) << 0.0, rhoL).finished();
+        spec.rhovecV0 = (Eigen::ArrayXd(2) << 0.0, rhoV).finished();
+        specs.push_back(spec);
+    }
+    auto serial = modelptr->trace_VLE_isotherms_binary(specs, 1);
+    auto parallel = modelptr->trace_VLE_isotherms_binary(specs, 3);
+    REQUIRE(parallel.size() == specs.size());
+    for (auto i = 0U; i < specs.size(); ++i){
+        CAPTURE(specs[i].T);
+        CHECK(parallel[i].success);
+        CHECK(parallel[i].elapsed_s >= 0);
+        // Same ordering and same output as the traces carried out one at a time
+        auto J = modelptr->trace_VLE_isotherm_binary(specs[i].T, specs[i].rhovecL0, specs[i].rhovecV0);
+        CHECK(parallel[i].trace.size() == J.size());
+        CHECK(serial[i].trace.back().at("pL / Pa") == J.back().at("pL / Pa"));
+        CHECK(parallel[i].trace.back().at("pL / Pa") == J.back().at("pL / Pa"));
+    }
+    
+    // A bad starting point is reported for that trace alone
+    specs[1].rhovecL0.resize(3);
+    auto withbad = modelptr->trace_VLE_isotherms_binary(specs, 2);
+    CHECK(!withbad[1].success);
+    CHECK(!withbad[1].message.empty());
+    CHECK(withbad[0].success);
+    CHECK(withbad[2].success);
+}
+
+TEST_CASE("Trace an isotherm into sinks rather than JSON", "[cubic][isochoric][isotherm]")
+{
+    // methane + propane
+    std::valarray<double> Tc_K = {190.564, 369.89}, pc_Pa = {4599200, 4251200}, acentric = {0.011, 0.1521};
+    const auto modelptr = teqp::cppinterface::adapter::make_owned(canonical_PR(Tc_K, pc_Pa, acentric));
+    const auto& model = teqp::cppinterface::adapter::get_model_cref<canonical_cubic_t>(modelptr.get());
+    double T = 250;
+    auto [rhoL, rhoV] = model.superanc_rhoLV(T, 1);
+    Eigen::ArrayXd rhovecL0 = (Eigen::ArrayXd(2) << 0.0, rhoL).finished();
+    Eigen::ArrayXd rhovecV0 = (Eigen::ArrayXd(2) << 0.0, rhoV).finished();
+    
+    auto J = trace_VLE_isotherm_binary(*modelptr, T, rhovecL0, rhovecV0);
+    
+    SECTION("columnar"){
+        ColumnarTraceSink sink;
+        trace_VLE_isotherm_binary(*modelptr, T, rhovecL0, rhovecV0, sink);
+        REQUIRE(sink.size() == J.size());
+        auto pL = sink.get("pL / Pa");
+        auto rhoL1 = sink.get("rhoL_1 / mol/m^3");
+        for (auto i = 0U; i < J.size(); ++i){
+            CHECK(pL[i] == J[i].at("pL / Pa"));
+            CHECK(rhoL1[i] == J[i].at("rhoL / mol/m^3")[1]);
+        }
+        CHECK_THROWS(sink.get("not a column"));
+        CHECK(modelptr->trace_VLE_isotherm_binary_columns(T, rhovecL0, rhovecV0).at("pV / Pa").size() == J.size());
+    }
+    SECTION("callback"){
+        std::size_t count = 0;
+        double plast = -1;
+        CallbackTraceSink sink([&](const std::vector<std::string>& columns, const Eigen::Ref<const Eigen::ArrayXd>& row){
+            CHECK(static_cast<std::size_t>(row.size()) == columns.size());
+            plast = row[3];
+            count++;
+        });
+        trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, sink);
+        CHECK(count == J.size());
+        CHECK(plast == J.back().at("pL / Pa"));
+    }
+    SECTION("binary file"){
+        // A unique file in the temporary directory, removed as soon as it has been read back
+        auto path = std::filesystem::temp_directory_path() / ("teqp_isoT_sink_" + std::to_string(std::random_device{}()) + ".bin");
+        {
+            BinaryTraceSink sink(path.string());
+            trace_VLE_isotherm_binary(*modelptr, T, rhovecL0, rhovecV0, sink);
+        }
+        auto loaded = read_binary_trace(path.string());
+        std::filesystem::remove(path);
+        CHECK(!std::filesystem::exists(path));
+        REQUIRE(loaded.size() == J.size());
+        CHECK(loaded.get("xL_0 / mole frac.")[J.size()-1] == J.back().at("xL_0 / mole frac."));
+    }
+}
+
 TEST_CASE("Bad kmat options", "[PRkmat]"){
     SECTION("null; ok"){
         auto j = nlohmann::json::parse(R"({
@@ -613,6 +712,172 @@ TEST_CASE("Check generalized and alphas", "[PRalpha]"){
     }
 }
 
+TEST_CASE("Closed-form derivatives of cubic EOS agree with automatic differentiation", "[cubic]"){
+    std::valarray<double> Tc_K = { 190.564, 305.32, 369.83 }, pc_Pa = { 4599200, 4872200, 4248000 }, acentric = { 0.011, 0.099, 0.152 };
+    Eigen::ArrayXXd kmat = Eigen::ArrayXXd::Zero(3, 3); kmat(0, 1) = kmat(1, 0) = 0.03;
+    auto jTwuMC = R"({
+        "type": "PR", "Tcrit / K": [190.564, 305.32, 369.83], "pcrit / Pa": [4599200, 4872200, 4248000], "acentric": [0.011, 0.099, 0.152],
+        "alpha": [{"type": "Twu", "c": [0.1, 0.9, 2.1]}, {"type": "Mathias-Copeman", "c": [0.5, -0.3, 0.2]}, {"type": "PR78", "acentric": 0.152}]
+    })"_json;
+    auto molefrac = (Eigen::ArrayXd(3) << 0.2, 0.3, 0.5).finished();
+    
+    // Tight enough to catch a wrong term in the higher orders; the absolute floor only matters for the values that vanish at low density
+    const double rtol = 1e-12, atol = 1e-14;
+    auto check = [&](const auto& model, double T, double rho){
+        CAPTURE(T);
+        CAPTURE(rho);
+        using tdx = TDXDerivatives<decltype(model)>;
+        auto ders = model.template alphar_TDderivs<2, 3>(T, rho, molefrac);
+        auto check_der = [&](double val, double ref){
+            CHECK_THAT(val, WithinRel(ref, rtol) || WithinAbs(ref, atol));
+        };
+        check_der(ders(0, 0), model.alphar(T, rho, molefrac));
+        check_der(ders(0, 1), tdx::template get_Agenxy<0, 1>(model, T, rho, molefrac));
+        check_der(ders(0, 3), tdx::template get_Agenxy<0, 3>(model, T, rho, molefrac));
+        check_der(ders(1, 0), tdx::template get_Agenxy<1, 0>(model, T, rho, molefrac));
+        check_der(ders(2, 0), tdx::template get_Agenxy<2, 0>(model, T, rho, molefrac));
+        check_der(ders(1, 1), tdx::template get_Agenxy<1, 1>(model, T, rho, molefrac));
+        check_der(ders(2, 3), tdx::template get_Agenxy<2, 3>(model, T, rho, molefrac));
+        // And the closed form is what is used by get_Arxy
+        CHECK(tdx::template get_Arxy<2, 3>(model, T, rho, molefrac) == ders(2, 3));
+        
+        using iso = IsochoricDerivatives<decltype(model)>;
+        Eigen::ArrayXd rhovec = rho*molefrac;
+        auto [Psir, grad, H] = model.Psir_fgradHessian(T, rhovec);
+        auto [Psirvec, gradvec, Hvec] = iso::build_Psir_fgradHessian_vectorAD(model, T, rhovec);
+        // The closed form can be bypassed to get the derivatives from autodiff
+        auto [Psirad, gradad, Had] = iso::template build_Psir_fgradHessian_autodiff<false>(model, T, rhovec);
+        // The floor for the dimensional entries is relative to the largest of them
+        auto check_entry = [&](double val, double ref, double scale){
+            CHECK_THAT(val, WithinRel(ref, rtol) || WithinAbs(ref, rtol*scale));
+        };
+        check_entry(Psir, Psirvec, std::abs(Psirvec));
+        check_entry(Psir, Psirad, std::abs(Psirad));
+        const double gradscale = gradad.array().abs().maxCoeff(), Hscale = Had.array().abs().maxCoeff();
+        for (auto i = 0; i < 3; ++i){
+            check_entry(grad[i], gradvec[i], gradscale);
+            check_entry(grad[i], gradad[i], gradscale);
+            for (auto j = 0; j < 3; ++j){
+                check_entry(H(i, j), Hvec(i, j), Hscale);
+                check_entry(H(i, j), Had(i, j), Hscale);
+            }
+        }
+    };
+    for (double rho : {1.0, 100.0, 5000.0, 12000.0}){
+        check(canonical_PR(Tc_K, pc_Pa, acentric, kmat), 250, rho);
+        check(canonical_SRK(Tc_K, pc_Pa, acentric, kmat), 250, rho);
+        check(make_generalizedcubic(jTwuMC), 250, rho);
+        check(canonical_PR(Tc_K, pc_Pa, acentric, kmat), 2000, rho);
+    }
+}
+
+TEST_CASE("Quadratic form of the cubic mixing rule agrees with the explicit double sum", "[cubic]"){
+    auto j = R"({
+        "type": "PR", "Tcrit / K": [190.564, 305.32, 369.83, 425.12], "pcrit / Pa": [4599200, 4872200, 4248000, 3796000], "acentric": [0.011, 0.099, 0.152, 0.2],
+        "alpha": [{"type": "Twu", "c": [0.1, 0.9, 2.1]}, {"type": "Mathias-Copeman", "c": [0.5, -0.3, 0.2]}, {"type": "PR78", "acentric": 0.152}, {"type": "Twu", "c": [0.2, 0.8, 1.9]}],
+        "kmat": [[0, 0.03, 0, 0.01], [0.03, 0, 0.02, 0], [0, 0.02, 0, 0], [0.01, 0, 0, 0]]
+    })"_json;
+    auto model = make_generalizedcubic(j);
+    auto kmat = j.at("kmat").get<std::vector<std::vector<double>>>();
+    auto Tc_K = j.at("Tcrit / K").get<std::vector<double>>(), pc_Pa = j.at("pcrit / Pa").get<std::vector<double>>();
+    auto molefrac = (Eigen::ArrayXd(4) << 0.1, 0.2, 0.3, 0.4).finished();
+    
+    // The reference is built without the model: a_i from the critical point, and the alpha functions evaluated one at a time,
+    // so that an error in the grouped square roots of the alpha functions or in the mixing rule does not cancel
+    const double OmegaA = 0.45723552892138218938, R = constants::R_CODATA2017;
+    const double w = 0.152, mPR78 = 0.37464 + 1.54226*w - 0.26992*w*w;
+    std::vector<std::function<double(double)>> alpha = {
+        [&](double T){ return TwuAlphaFunction<double>(Tc_K[0], (Eigen::Array3d() << 0.1, 0.9, 2.1).finished())(T); },
+        [&](double T){ return MathiasCopemanAlphaFunction<double>(Tc_K[1], (Eigen::Array3d() << 0.5, -0.3, 0.2).finished())(T); },
+        [&](double T){ return BasicAlphaFunction<double>(Tc_K[2], mPR78)(T); },
+        [&](double T){ return TwuAlphaFunction<double>(Tc_K[3], (Eigen::Array3d() << 0.2, 0.8, 1.9).finished())(T); }
+    };
+    for (double T : {150.0, 300.0, 600.0}){
+        CAPTURE(T);
+        // The pure-fluid attractive parameters a_i*alpha_i(T)
+        std::vector<double> aii;
+        for (auto i = 0; i < 4; ++i){
+            aii.push_back(OmegaA*pow(R*Tc_K[i], 2)/pc_Pa[i]*alpha[i](T));
+        }
+        double a = 0;
+        for (auto i = 0; i < 4; ++i){
+            for (auto k = 0; k < 4; ++k){
+                a += molefrac[i]*molefrac[k]*(1 - kmat[i][k])*sqrt(aii[i]*aii[k]);
+            }
+        }
+        CHECK(model.get_a(T, molefrac) == Approx(a).epsilon(1e-12));
+        // Extended-precision arguments take the per-component path
+        CHECK(static_cast<double>(model.get_a(T, molefrac.cast<long double>().eval())) == Approx(a).epsilon(1e-12));
+    }
+}
+
+TEST_CASE("Closed-form density roots of cubic EOS agree with the generic density solver", "[cubic][density]"){
+    std::valarray<double> Tc_K = { 190.564, 305.32, 369.83 }, pc_Pa = { 4599200, 4872200, 4248000 }, acentric = { 0.011, 0.099, 0.152 };
+    auto jRKPR = R"({"delta_1": [1.6, 2.0], "Tcrit / K": [190.564, 369.83], "pcrit / Pa": [4599200, 4248000], "k": [1.9, 2.2], "kmat": [[0,0],[0,0]], "lmat": [[0,0],[0,0]]})"_json;
+    
+    auto check = [](const auto& model, double T, double p, const Eigen::ArrayXd& z){
+        CAPTURE(T);
+        CAPTURE(p);
+        Eigen::ArrayXd roots = model.solve_cubic_density(T, p, z, DensityRoot::all);
+        auto generic = scan_density_roots(model, T, p, z);
+        REQUIRE(static_cast<std::size_t>(roots.size()) == generic.size());
+        for (auto i = 0; i < roots.size(); ++i){
+            CHECK(roots[i] == Approx(generic[i]).epsilon(1e-12));
+        }
+        CHECK(solve_density(model, T, p, z, DensityRoot::vapor)[0] == roots[0]);
+        CHECK(solve_density(model, T, p, z, DensityRoot::liquid)[0] == roots[roots.size()-1]);
+    };
+    auto z = (Eigen::ArrayXd(3) << 0.0, 0.0, 1.0).finished();
+    for (double p : {1e3, 1e5, 1e6, 3e6, 1e8}){
+        check(canonical_PR(Tc_K, pc_Pa, acentric), 300, p, z);
+        check(canonical_SRK(Tc_K, pc_Pa, acentric), 300, p, z);
+    }
+    z << 0.3, 0.3, 0.4;
+    for (double p : {1e5, 2e6, 5e7}){
+        check(canonical_PR(Tc_K, pc_Pa, acentric), 220, p, z);
+    }
+    auto z2 = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    for (double p : {1e5, 1e6, 1e7}){
+        check(RKPRCismondi2005(jRKPR), 250, p, z2);
+    }
+    
+    SECTION("Minimum Gibbs energy root switches at the vapor pressure"){
+        auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+        auto z1 = (Eigen::ArrayXd(3) << 0.0, 0.0, 1.0).finished();
+        auto [rhoL, rhoV] = model.superanc_rhoLV(300, 2);
+        double psat = rhoL*model.R(z1)*300*(1.0 + TDXDerivatives<decltype(model)>::get_Ar01(model, 300, rhoL, z1));
+        CHECK(model.solve_cubic_density(300, psat*0.99, z1, DensityRoot::minimum_gibbs)[0] == Approx(model.solve_cubic_density(300, psat*0.99, z1, DensityRoot::vapor)[0]));
+        CHECK(model.solve_cubic_density(300, psat*1.01, z1, DensityRoot::minimum_gibbs)[0] == Approx(model.solve_cubic_density(300, psat*1.01, z1, DensityRoot::liquid)[0]));
+        CHECK(model.solve_cubic_density(300, psat, z1, DensityRoot::vapor)[0] == Approx(rhoV).epsilon(1e-8));
+        CHECK(model.solve_cubic_density(300, psat, z1, DensityRoot::liquid)[0] == Approx(rhoL).epsilon(1e-8));
+    }
+}
+
+TEST_CASE("Density solver through the AbstractModel", "[cubic][density]"){
+    auto jPR = R"({"kind": "PR", "model": {"Tcrit / K": [190.564, 369.83], "pcrit / Pa": [4599200, 4248000], "acentric": [0.011, 0.152]}})"_json;
+    auto model = teqp::cppinterface::make_model(jPR);
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(5, 200, 400), p = Eigen::ArrayXd::Constant(5, 1e6);
+    Eigen::ArrayXXd Z = z.transpose();
+    Eigen::ArrayXd rho = model->solve_density_batch(T, p, Z, DensityRoot::minimum_gibbs);
+    for (auto i = 0; i < T.size(); ++i){
+        CHECK(rho[i] == model->solve_density(T[i], p[i], z, DensityRoot::minimum_gibbs)[0]);
+        double pcalc = rho[i]*model->get_R(z)*T[i]*(1.0 + model->get_Ar01(T[i], rho[i], z));
+        CHECK(pcalc == Approx(p[i]));
+    }
+    CHECK_THROWS(model->solve_density_batch(T, p, Z, DensityRoot::all));
+    
+    // The van der Waals model does not have the closed-form solver, so it is solved by the generic fallback
+    auto vdW = teqp::cppinterface::make_model(R"({"kind": "vdW1", "model": {"a": 0.13617, "b": 3.2203e-5}})"_json);
+    auto z1 = (Eigen::ArrayXd(1) << 1.0).finished();
+    Eigen::ArrayXd roots = vdW->solve_density(120, 1e6, z1, DensityRoot::all);
+    REQUIRE(roots.size() == 2);
+    for (auto r : roots){
+        CHECK(r*vdW->get_R(z1)*120*(1.0 + vdW->get_Ar01(120, r, z1)) == Approx(1e6));
+    }
+}
+
 TEST_CASE("QCPR", "[QCPR]"){
     
     /// Naming convention of variables follows the paper, not teqp
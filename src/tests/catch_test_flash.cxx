@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/flash.hpp"
+#include "teqp/models/cubics/simple_cubics.hpp"
+
+using namespace teqp;
+
+TEST_CASE("TP flash of methane + n-decane with Peng-Robinson", "[flash]")
+{
+    std::valarray<double> Tc_K = {190.564, 617.7}, pc_Pa = {4.5992e6, 2.11e6}, acentric = {0.011, 0.4884};
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    auto z = (Eigen::ArrayXd(2) << 0.5, 0.5).finished();
+    const double T = 400;
+    
+    SECTION("two-phase"){
+        auto r = flash::flash_Tp(model, T, 1e6, z);
+        REQUIRE(r.success);
+        CHECK(r.Nphases == 2);
+        CHECK(r.tpd < 0);
+        CHECK(r.beta > 0);
+        CHECK(r.beta < 1);
+        // Mass balance
+        CHECK(((1-r.beta)*r.x + r.beta*r.y - z).abs().maxCoeff() < 1e-12);
+        // Equality of fugacities
+        Eigen::ArrayXd lnfL = log(r.x*IsochoricDerivatives<decltype(model)>::get_fugacity_coefficients(model, T, (r.rhoL*r.x).eval()));
+        Eigen::ArrayXd lnfV = log(r.y*IsochoricDerivatives<decltype(model)>::get_fugacity_coefficients(model, T, (r.rhoV*r.y).eval()));
+        CHECK((lnfL - lnfV).abs().maxCoeff() < 1e-9);
+        
+        // Warm start from the solution skips the stability test
+        auto r2 = flash::flash_Tp(model, T, 1.01e6, z, r.as_guess());
+        CHECK(r2.success);
+        CHECK(r2.Nphases == 2);
+        CHECK(r2.num_stability_iter == 0);
+    }
+    SECTION("single-phase"){
+        auto r = flash::flash_Tp(model, T, 5e7, z);
+        REQUIRE(r.success);
+        CHECK(r.Nphases == 1);
+    }
+    SECTION("through AbstractModel, batched"){
+        auto am = cppinterface::make_model({{"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 617.7}}, {"pcrit / Pa", {4.5992e6, 2.11e6}}, {"acentric", {0.011, 0.4884}}}}});
+        auto N = 50;
+        Eigen::ArrayXd Ts = Eigen::ArrayXd::Constant(N, T), ps = Eigen::ArrayXd::LinSpaced(N, 1e5, 1e7);
+        Eigen::ArrayXXd Z(N, 2); Z.col(0).setConstant(0.5); Z.col(1).setConstant(0.5);
+        auto results1 = am->flash_Tp_batch(Ts, ps, Z, std::nullopt, true, 1);
+        auto results4 = am->flash_Tp_batch(Ts, ps, Z, std::nullopt, true, 4);
+        REQUIRE(results1.size() == static_cast<std::size_t>(N));
+        for (auto i = 0; i < N; ++i){
+            CAPTURE(i);
+            CHECK(results1[i].success);
+            CHECK(results1[i].Nphases == results4[i].Nphases);
+            CHECK(results1[i].beta == Approx(results4[i].beta).margin(1e-8));
+        }
+        auto direct = flash::flash_Tp(model, T, ps[10], z);
+        CHECK(results1[10].beta == Approx(direct.beta).margin(1e-8));
+    }
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/algorithms/iteration.hpp"
+#include "teqp/ideal_eosterms.hpp"
+#include "teqp/cpp/deriv_adapter.hpp"
+#include "teqp/models/vdW.hpp"
+
+using namespace teqp;
+
+#include "test_common.in"
+
+TEST_CASE("Batch (p,h) and (p,s) inversion", "[NRbatch]")
+{
+    using namespace teqp::cppinterface;
+    std::vector<std::string> names = {"n-Propane"};
+    std::string root = FLUIDDATAPATH;
+    std::shared_ptr<AbstractModel> resid = make_multifluid_model(names, root);
+    nlohmann::json jaig = nlohmann::json::array();
+    jaig.push_back(convert_CoolProp_idealgas(root+"/dev/fluids/"+names[0]+".json", 0 /* index of EOS */));
+    std::shared_ptr<AbstractModel> aig = make_model({{"kind", "IdealHelmholtz"}, {"model", jaig}});
+    iteration::AlphaModel alpha{aig, resid};
+    
+    // Generate the targets along a supercritical isochore, and offset the initial guesses
+    auto z = (Eigen::ArrayXd(1) << 1.0).finished();
+    const auto R = alpha.get_R(z);
+    const auto N = 40;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 400, 500), rho = Eigen::ArrayXd::Constant(N, 3000.0);
+    
+    for (auto vars : {std::vector<char>{'P','H'}, std::vector<char>{'P','S'}}){
+        Eigen::ArrayXXd vals(N, 2);
+        for (auto i = 0; i < N; ++i){
+            vals.row(i) = alpha.get_vals(vars, R, T(i), rho(i), z).transpose();
+        }
+        for (auto Nthreads : {1, 3}){
+            iteration::BatchNROptions opt; opt.Nthreads = Nthreads;
+            auto res = iteration::solve_NR_batch(alpha, vars, vals, 1.05*T, 0.9*rho, z, opt);
+            CAPTURE(Nthreads);
+            CHECK(res.success.all());
+            CHECK((res.T/T - 1).abs().maxCoeff() < 1e-9);
+            CHECK((res.rho/rho - 1).abs().maxCoeff() < 1e-9);
+            CHECK((res.maxabsr < opt.tol).all());
+            // The converged states reproduce the targets
+            for (auto i = 0; i < N; ++i){
+                auto v = alpha.get_vals(vars, R, res.T(i), res.rho(i), z);
+                CHECK(((v - vals.row(i).transpose())/vals.row(i).transpose()).abs().maxCoeff() < 1e-9);
+            }
+        }
+    }
+}
+
+/// The van der Waals model, but throwing above a temperature limit, to have one point of a batch fail in the model
+struct vdWThrowingAboveT{
+    vdWEOS1 vdw;
+    double Tmax;
+    template<class VecType>
+    auto R(const VecType& molefrac) const { return vdw.R(molefrac); }
+    template<typename TType, typename RhoType, typename VecType>
+    auto alphar(const TType& T, const RhoType& rhotot, const VecType& molefrac) const {
+        if (getbaseval(T) > Tmax){
+            throw teqp::InvalidArgument("Temperature is above the limit of the model");
+        }
+        return vdw.alphar(T, rhotot, molefrac);
+    }
+};
+
+TEST_CASE("Batch inversion with one point failing in the model", "[NRbatch]")
+{
+    using namespace teqp::cppinterface;
+    std::string root = FLUIDDATAPATH;
+    nlohmann::json jaig = nlohmann::json::array();
+    jaig.push_back(convert_CoolProp_idealgas(root+"/dev/fluids/n-Propane.json", 0 /* index of EOS */));
+    std::shared_ptr<AbstractModel> aig = make_model({{"kind", "IdealHelmholtz"}, {"model", jaig}});
+    vdWEOS1 vdw(1.0, 1e-4);
+    iteration::AlphaModel alpha{aig, adapter::make_owned(vdw)};
+    iteration::AlphaModel alphathrows{aig, adapter::make_owned(vdWThrowingAboveT{vdw, 800.0})};
+    
+    auto z = (Eigen::ArrayXd(1) << 1.0).finished();
+    const auto R = alpha.get_R(z);
+    const auto N = 20, ibad = 7;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 400, 500), rho = Eigen::ArrayXd::Constant(N, 3000.0);
+    T(ibad) = 1000; // Beyond the limit, so the model throws for this point
+    std::vector<char> vars = {'P','H'};
+    Eigen::ArrayXXd vals(N, 2);
+    for (auto i = 0; i < N; ++i){
+        vals.row(i) = alpha.get_vals(vars, R, T(i), rho(i), z).transpose();
+    }
+    for (auto Nthreads : {1, 3}){
+        CAPTURE(Nthreads);
+        iteration::BatchNROptions opt; opt.Nthreads = Nthreads;
+        auto res = iteration::solve_NR_batch(alphathrows, vars, vals, 1.05*T, 0.9*rho, z, opt);
+        CHECK(!res.success(ibad));
+        CHECK(std::isnan(res.T(ibad)));
+        CHECK(std::isnan(res.rho(ibad)));
+        CHECK(std::isnan(res.maxabsr(ibad)));
+        for (auto i = 0; i < N; ++i){
+            if (i == ibad){ continue; }
+            CAPTURE(i);
+            CHECK(res.success(i));
+            CHECK(std::abs(res.T(i)/T(i) - 1) < 1e-9);
+            CHECK(std::abs(res.rho(i)/rho(i) - 1) < 1e-9);
+        }
+    }
+}
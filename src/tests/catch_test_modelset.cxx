@@ -212,3 +212,47 @@ TEST_CASE("reducing", "[MFreducing]"){
         CHECK_THROWS(model->get_reducing_density(z));
     }
 }
+
+TEST_CASE("pure-fluid derivatives", "[pure]"){
+    auto PRmethane = R"({"kind": "PR", "model": {"Tcrit / K": [190.564], "pcrit / Pa": [4599200], "acentric": [0.011]}})"_json;
+    auto PCSAFTdipolar = R"({"kind": "PCSAFT", "model": {"coeffs": [{"name": "Acetone", "m": 2.7447, "sigma_Angstrom": 3.2742, "epsilon_over_k": 232.99, "(mu^*)^2": 2.676, "nmu": 1.0, "BibTeXKey": "Gross-IECR-2002"}]}})"_json;
+    auto multifluidmethane = multifluidmetheth_();
+    multifluidmethane["model"]["components"] = nlohmann::json::array({"Methane"});
+    
+    // Models with (PR, PC-SAFT, multifluid) and without a dedicated pure-fluid path
+    std::map<std::string, std::tuple<nlohmann::json, double, double>> models = {
+        {"PR", {PRmethane, 200.0, 1000.0}},
+        {"PCSAFT", {PCSAFT_(), 200.0, 1000.0}},
+        {"PCSAFTdipolar", {PCSAFTdipolar, 400.0, 1000.0}},
+        {"multifluid", {multifluidmethane, 200.0, 1000.0}},
+        {"PCSAFTPure", {PCSAFTPure_(), 200.0, 1000.0}},
+        {"GERG2008", {GERG2008_(), 200.0, 1000.0}},
+        {"LJ126_TholJPCRD2016", {PureFluidTestSet.at("LJ126_TholJPCRD2016").first, 1.3, 0.3}},
+    };
+    Eigen::ArrayXd z(1); z = 1.0;
+    for (const auto& [kind, specdata] : models){
+        const auto& [spec, T, rho] = specdata;
+        auto model = teqp::cppinterface::make_model(spec);
+        CAPTURE(kind);
+        for (auto [NT, NDmax] : std::vector<std::pair<int, int>>{{0, 3}, {1, 2}, {2, 1}, {3, 0}}){
+            for (auto ND = 0; ND <= NDmax; ++ND){
+                CAPTURE(NT, ND);
+                CHECK_THAT(model->get_Arxy_pure(NT, ND, T, rho), WithinRel(model->get_Arxy(NT, ND, T, rho, z), 1e-12));
+            }
+        }
+        auto bundle = model->pure_bundle(T, rho);
+        CHECK_THAT(bundle.Ar00, WithinRel(model->get_Ar00(T, rho, z), 1e-12));
+        CHECK_THAT(bundle.Ar01, WithinRel(model->get_Ar01(T, rho, z), 1e-12));
+        CHECK_THAT(bundle.Ar02, WithinRel(model->get_Ar02(T, rho, z), 1e-12));
+        CHECK_THAT(bundle.Ar10, WithinRel(model->get_Ar10(T, rho, z), 1e-12));
+        CHECK_THAT(bundle.Ar11, WithinRel(model->get_Ar11(T, rho, z), 1e-12));
+        CHECK_THAT(bundle.Ar20, WithinRel(model->get_Ar20(T, rho, z), 1e-12));
+        CHECK_THAT(bundle.p(), WithinRel(rho*model->get_R(z)*T*(1.0 + model->get_Ar01(T, rho, z)), 1e-12));
+    }
+    
+    SECTION("mixtures are rejected"){
+        auto model = teqp::cppinterface::make_model(PCSAFTmetheth_());
+        CHECK_THROWS(model->get_Arxy_pure(0, 1, 200.0, 1000.0));
+        CHECK_THROWS(model->pure_bundle(200.0, 1000.0));
+    }
+}
@@ -124,3 +124,220 @@ TEST_CASE("Benchmark param optimization", "[paramoptim]"){
         CHECK(ppo.cost_function_threaded(xx, 6) == ppo.cost_function(xx));
     }
 }
+
+TEST_CASE("In-place parameter updates give the same cost as rebuilding the model", "[paramoptim]"){
+    
+    auto PCSAFT = R"({
+        "kind": "PCSAFT",
+        "model": {
+            "coeffs": [{"name": "Methane", "BibTeXKey": "Gross-IECR-2001", "m": 1.0, "sigma_Angstrom": 3.7039, "epsilon_over_k": 150.03}]
+        }
+    })"_json;
+    auto PR = R"({
+        "kind": "PR",
+        "model": {"Tcrit / K": [190.564], "pcrit / Pa": [4599200.0], "acentric": [0.011]}
+    })"_json;
+    auto VRMie = nlohmann::json{{"kind", "genericSAFT"}, {"model", Dufal_contents}};
+    
+    using pointers_t = std::vector<std::variant<std::string, std::vector<std::string>>>;
+    std::vector<std::tuple<nlohmann::json, pointers_t, std::vector<double>>> cases = {
+        {PCSAFT, {"/model/coeffs/0/m", "/model/coeffs/0/sigma_Angstrom", "/model/coeffs/0/epsilon_over_k"}, {1.1, 3.6, 160.0}},
+        {PR, {"/model/Tcrit ~1 K/0", "/model/pcrit ~1 Pa/0", "/model/acentric/0"}, {195.0, 4.5e6, 0.02}},
+        {VRMie, {"/model/nonpolar/model/coeffs/0/m", "/model/nonpolar/model/coeffs/0/lambda_r"}, {1.3, 30.0}},
+    };
+    for (const auto& [j, pointers, x] : cases){
+        CAPTURE(j.at("kind"));
+        PureParameterOptimizer ppo(j, pointers);
+        CHECK(ppo.uses_parameter_slots());
+        for (auto T = 120.0; T < 180; T += 10){
+            PVTNoniterativePoint pt;
+            pt.T = T; pt.rho_exp = 100.0*T; pt.p_exp = 1e6;
+            ppo.add_one_contribution(pt);
+        }
+        auto rebuilt_cost = [&](const auto& x_){
+            auto model = teqp::cppinterface::make_model(ppo.build_JSON(x_));
+            double cost = 0;
+            for (const auto& contrib : ppo.contributions){
+                cost += std::visit([&model](const auto& c){ return c.calculate_contribution(model); }, contrib);
+            }
+            return cost;
+        };
+        // Move away from the base values and then back again
+        std::vector<double> x0 = x;
+        for (auto& el : x0){ el *= 0.97; }
+        for (const auto& xx : {x0, x, x0}){
+            CHECK(ppo.cost_function(xx) == Approx(rebuilt_cost(xx)).epsilon(1e-12));
+            CHECK(ppo.cost_function_threaded(xx, 2) == Approx(rebuilt_cost(xx)).epsilon(1e-12));
+        }
+        CHECK_THROWS_AS(ppo.cost_function_threaded(x, 0), teqp::InvalidArgument);
+    }
+}
+
+TEST_CASE("Parameters that cannot be updated in-place fall back to rebuilding the model", "[paramoptim]"){
+    auto j = R"({
+        "kind": "vdW1",
+        "model": {"a": 1.0, "b": 3e-5}
+    })"_json;
+    PureParameterOptimizer ppo(j, {"/model/a"});
+    CHECK(!ppo.uses_parameter_slots());
+    PVTNoniterativePoint pt;
+    pt.T = 300; pt.rho_exp = 100.0; pt.p_exp = 1e5;
+    ppo.add_one_contribution(pt);
+    CHECK(std::isfinite(ppo.cost_function(std::vector<double>{0.5})));
+
+    // But an invalid pointer is an error rather than a reason to fall back
+    auto jPCSAFT = R"({
+        "kind": "PCSAFT",
+        "model": {"coeffs": [{"name": "Methane", "m": 1.0, "sigma_Angstrom": 3.7039, "epsilon_over_k": 150.03, "BibTeXKey": "Gross-IECR-2001"}]}
+    })"_json;
+    CHECK_THROWS_AS(PureParameterOptimizer(jPCSAFT, {"/model/coeffs/3/m"}), teqp::InvalidArgument);
+}
+
+TEST_CASE("Gradient of the cost function matches extrapolated finite differences", "[paramoptim]"){
+    auto j = R"({
+        "kind": "PCSAFT",
+        "model": {
+            "coeffs": [{"name": "Methane", "BibTeXKey": "Gross-IECR-2001", "m": 1.0, "sigma_Angstrom": 3.7039, "epsilon_over_k": 150.03}]
+        }
+    })"_json;
+    PureParameterOptimizer ppo(j, {"/model/coeffs/0/m", "/model/coeffs/0/sigma_Angstrom", "/model/coeffs/0/epsilon_over_k"});
+    REQUIRE(ppo.uses_parameter_slots());
+    
+    // Pseudo-experimental data from the model with the base parameters
+    auto model = teqp::cppinterface::make_model(j);
+    Eigen::ArrayXd z = Eigen::ArrayXd::Ones(1);
+    double R = model->R(z);
+    for (auto T = 130.0; T < 180; T += 10){
+        auto rhoLrhoV = model->pure_VLE_T(T, 25000.0, 100.0, 100);
+        double rhoL = rhoLrhoV[0], rhoV = rhoLrhoV[1];
+        double p = rhoL*R*T*(1+model->get_Ar01(T, rhoL, z));
+        
+        SatRhoLPoint pt1;
+        pt1.T = T; pt1.rhoL_exp = rhoL; pt1.rhoL_guess = rhoL; pt1.rhoV_guess = rhoV;
+        ppo.add_one_contribution(pt1);
+        
+        SatRhoLPPoint pt2;
+        pt2.T = T; pt2.p_exp = p; pt2.rhoL_exp = rhoL; pt2.rhoL_guess = rhoL; pt2.rhoV_guess = rhoV;
+        ppo.add_one_contribution(pt2);
+        
+        SOSPoint pt3;
+        pt3.T = T+100; pt3.p_exp = 1e6; pt3.rho_guess = 1e6/(R*(T+100)); pt3.w_exp = 400.0; pt3.Ao20 = -3.0; pt3.M = 0.016; pt3.R = R;
+        ppo.add_one_contribution(pt3);
+        
+        PVTNoniterativePoint pt4;
+        pt4.T = T+100; pt4.rho_exp = 1000.0; pt4.p_exp = 2e6;
+        ppo.add_one_contribution(pt4);
+    }
+    
+    Eigen::ArrayXd x(3); x << 1.02, 3.68, 152.0;
+    auto [cost, gradient] = ppo.cost_function_and_gradient(x);
+    CHECK(cost == Approx(ppo.cost_function(x)).epsilon(1e-12));
+    for (auto k = 0; k < x.size(); ++k){
+        CAPTURE(k);
+        // Central differences of the cost with the states re-solved at each step, Richardson-extrapolated to
+        // remove the leading truncation error
+        auto central = [&](double h){
+            Eigen::ArrayXd xp = x, xm = x;
+            xp[k] += h; xm[k] -= h;
+            return (ppo.cost_function(xp) - ppo.cost_function(xm))/(2*h);
+        };
+        double h = 1e-4*x[k];
+        double reference = (4*central(h/2) - central(h))/3;
+        CHECK(gradient[k] == Approx(reference).epsilon(1e-8));
+    }
+    // The parameters are restored afterwards
+    CHECK(ppo.cost_function(x) == Approx(cost).epsilon(1e-12));
+}
+
+TEST_CASE("Gradient of the cost function matches the closed forms of the van der Waals EOS", "[paramoptim]"){
+    auto j = R"({"kind": "vdW1", "model": {"a": 0.14, "b": 3.2e-5}})"_json;
+    PureParameterOptimizer ppo(j, {"/model/a", "/model/b"});
+    REQUIRE(ppo.uses_parameter_slots());
+    
+    Eigen::ArrayXd x(2); x << 0.145, 3.1e-5;
+    const double a = x[0], b = x[1];
+    auto jx = j; jx["model"]["a"] = a; jx["model"]["b"] = b;
+    auto model = teqp::cppinterface::make_model(jx);
+    Eigen::ArrayXd z = Eigen::ArrayXd::Ones(1);
+    const double R = model->R(z), Tc = 8*a/(27*R*b);
+    
+    SECTION("Non-iterative p-rho-T points"){
+        // p = rho*R*T/(1-b*rho) - a*rho^2 and its density derivative, differentiated w.r.t. a and b
+        Eigen::ArrayXd reference = Eigen::ArrayXd::Zero(2);
+        for (auto T : {200.0, 300.0}){
+            for (auto rho : {1000.0, 8000.0}){
+                PVTNoniterativePoint pt;
+                pt.T = T; pt.rho_exp = rho; pt.p_exp = 1.1*rho*R*T;
+                ppo.add_one_contribution(pt);
+                double d = 1 - b*rho, p = rho*R*T/d - a*rho*rho, dpdrho = R*T/(d*d) - 2*a*rho, N = p - pt.p_exp.value();
+                double sign = (N/dpdrho > 0) ? 1 : -1;
+                auto dcost = [&](double dN, double ddpdrho){ return sign*(dN*dpdrho - N*ddpdrho)/(rho*dpdrho*dpdrho); };
+                reference[0] += dcost(-rho*rho, -2*rho);
+                reference[1] += dcost(rho*rho*R*T/(d*d), 2*rho*R*T/(d*d*d));
+            }
+        }
+        auto [cost, gradient] = ppo.cost_function_and_gradient(x);
+        CHECK((gradient/reference - 1).abs().maxCoeff() < 1e-9);
+    }
+    SECTION("Saturation pressures"){
+        // The saturation pressure is a/b^2*psi(R*T*b/a), so that dp/da = p/a - T/a*dp/dT and a*dp/da + b*dp/db = -p,
+        // and dp/dT follows from the Clapeyron equation, with the entropy difference ln((vV-b)/(vL-b)) of the van der Waals EOS
+        Eigen::ArrayXd reference = Eigen::ArrayXd::Zero(2);
+        for (auto Tr : {0.7, 0.8, 0.9}){
+            double T = Tr*Tc;
+            auto rhoLrhoV = model->pure_VLE_T(T, 0.8/b, 0.01/b, 50);
+            double rhoL = rhoLrhoV[0], rhoV = rhoLrhoV[1];
+            double p = rhoL*R*T*(1 + model->get_Ar01(T, rhoL, z));
+            SatRhoLPPoint pt;
+            pt.T = T; pt.p_exp = 0.97*p; pt.rhoL_exp = rhoL; pt.rhoL_guess = 1.01*rhoL; pt.rhoV_guess = 0.99*rhoV; pt.weight_rho = 0; pt.R = R;
+            ppo.add_one_contribution(pt);
+            double vL = 1/rhoL, vV = 1/rhoV;
+            double dpdT = R*log((vV-b)/(vL-b))/(vV-vL);
+            double dpda = p/a - T/a*dpdT, dpdb = (-p - a*dpda)/b;
+            reference[0] += dpda/pt.p_exp.value();
+            reference[1] += dpdb/pt.p_exp.value();
+        }
+        auto [cost, gradient] = ppo.cost_function_and_gradient(x);
+        CHECK((gradient/reference - 1).abs().maxCoeff() < 1e-9);
+    }
+    SECTION("Saturated liquid densities"){
+        // The saturated densities are phi(R*T*b/a)/b, homogeneous of degree -1 in (a, b), so a*drhoL/da + b*drhoL/db = -rhoL
+        double reference = 0;
+        for (auto Tr : {0.7, 0.8, 0.9}){
+            double T = Tr*Tc;
+            auto rhoLrhoV = model->pure_VLE_T(T, 0.8/b, 0.01/b, 50);
+            SatRhoLPoint pt;
+            pt.T = T; pt.rhoL_exp = 0.98*rhoLrhoV[0]; pt.rhoL_guess = 1.01*rhoLrhoV[0]; pt.rhoV_guess = 0.99*rhoLrhoV[1];
+            ppo.add_one_contribution(pt);
+            reference -= rhoLrhoV[0];
+        }
+        auto [cost, gradient] = ppo.cost_function_and_gradient(x);
+        CHECK((x*gradient).sum() == Approx(reference).epsilon(1e-9));
+    }
+}
+
+TEST_CASE("Threaded cost function with a persistent pool matches the serial one", "[paramoptim]"){
+    auto j = R"({
+        "kind": "PCSAFT",
+        "model": {
+            "coeffs": [{"name": "Methane", "BibTeXKey": "Gross-IECR-2001", "m": 1.0, "sigma_Angstrom": 3.7039, "epsilon_over_k": 150.03}]
+        }
+    })"_json;
+    PureParameterOptimizer ppo(j, {"/model/coeffs/0/m"});
+    for (auto i = 0; i < 500; ++i){
+        PVTNoniterativePoint pt;
+        pt.T = 200 + 0.1*i; pt.rho_exp = 100.0 + i; pt.p_exp = 1e6;
+        ppo.add_one_contribution(pt);
+    }
+    std::vector<double> x = {1.05};
+    // Repeated calls rebalance the chunks from the timings, changing the number of threads rebuilds the pool
+    for (auto Nthreads : {3, 3, 3, 1, 8}){
+        CAPTURE(Nthreads);
+        CHECK(ppo.cost_function_threaded(x, Nthreads) == ppo.cost_function(x));
+    }
+    // Contributions can be added between calls
+    PVTNoniterativePoint pt;
+    pt.T = 300; pt.rho_exp = 1000.0; pt.p_exp = 2e6;
+    ppo.add_one_contribution(pt);
+    CHECK(ppo.cost_function_threaded(x, 8) == ppo.cost_function(x));
+}
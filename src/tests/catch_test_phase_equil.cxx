@@ -96,3 +96,45 @@ TEST_CASE("Test new VLE routines", "[VLEgen]")
         std::cout << "x:" << x << std::endl;
     }
 }
+
+TEST_CASE("Test Jacobian and block solve of generalized phase equilibrium for three phases", "[VLEgen]")
+{
+    std::vector<std::string> names = {"Nitrogen", "Ethane", "Methane"};
+    using namespace teqp::cppinterface;
+    auto model = make_multifluid_model(names, FLUIDDATAPATH);
+    
+    // Not an equilibrium state, only used to check the derivatives and the linear algebra
+    double T = 150.0;
+    std::vector<Eigen::ArrayXd> rhovecs = {
+        (Eigen::ArrayXd(3) << 300.0, 10.0, 200.0).finished(),
+        (Eigen::ArrayXd(3) << 2000.0, 12000.0, 3000.0).finished(),
+        (Eigen::ArrayXd(3) << 8000.0, 3000.0, 9000.0).finished()
+    };
+    auto betas = (Eigen::ArrayXd(3) << 0.3, 0.3, 0.4).finished();
+    Eigen::ArrayXd zbulk = (Eigen::ArrayXd(3) << 0.4, 0.3, 0.3).finished();
+    GeneralizedPhaseEquilibrium::UnpackedVariables init{T, rhovecs, betas};
+    std::vector<std::shared_ptr<AbstractSpecification>> specs;
+    specs.push_back(std::make_shared<TSpecification>(T));
+    specs.push_back(std::make_shared<PSpecification>(1e6));
+    GeneralizedPhaseEquilibrium gpe(*model, zbulk, init, specs);
+    
+    Eigen::ArrayXd x = init.pack();
+    Eigen::MatrixXd Jnum = gpe.num_Jacobian(x, x*1e-6);
+    gpe.call(x);
+    const Eigen::MatrixXd& J = gpe.res.J;
+    for (auto i = 0; i < J.rows(); ++i){
+        CAPTURE(i);
+        CHECK((J.row(i) - Jnum.row(i)).cwiseAbs().maxCoeff() < 1e-6*J.row(i).cwiseAbs().maxCoeff());
+    }
+    
+    auto before = gpe.counters;
+    Eigen::VectorXd dense = J.colPivHouseholderQr().solve(-gpe.res.r);
+    Eigen::VectorXd block = gpe.solve_step();
+    CHECK((dense - block).norm() < 1e-10*dense.norm());
+    CHECK(gpe.counters.Nsteps == before.Nsteps + 1);
+    
+    gpe.call(x);
+    CHECK(gpe.counters.Ncalls == before.Ncalls + 1);
+    CHECK(gpe.counters.Nphase_derivatives == before.Nphase_derivatives + 3);
+    CHECK(gpe.counters.Ncaloric_derivatives == 0);
+}
@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include <filesystem>
+#include <random>
+
+#include "teqp/cpp/teqpcpp.hpp"
+#include "teqp/cpp/deriv_adapter.hpp"
+#include "teqp/models/tabulated.hpp"
+
+using namespace teqp;
+
+static auto PR_methane = nlohmann::json::parse(R"({
+    "kind": "PR",
+    "model": {
+        "Tcrit / K": [190.564],
+        "pcrit / Pa": [4599200],
+        "acentric": [0.011]
+    }
+})");
+
+TEST_CASE("Tabulated model reproduces the model it was built from", "[tabulated]")
+{
+    nlohmann::json j = {
+        {"kind", "tabulated"},
+        {"model", {
+            {"model", PR_methane},
+            {"molefrac", {1.0}},
+            {"Tmin / K", 200.0}, {"Tmax / K", 400.0},
+            {"rhomin / mol/m^3", 0.0}, {"rhomax / mol/m^3", 10000.0},
+            {"NT", 10}, {"Nrho", 10},
+            {"tolerance", 1e-7}
+        }}
+    };
+    auto tab = cppinterface::make_model(j);
+    auto model = cppinterface::make_model(PR_methane);
+    auto z = (Eigen::ArrayXd(1) << 1.0).finished();
+    
+    for (auto T : {213.7, 287.1, 399.0}){
+        for (auto rho : {1.3, 512.0, 7777.7}){
+            CAPTURE(T, rho);
+            CHECK(tab->get_Ar00(T, rho, z) == Approx(model->get_Ar00(T, rho, z)).margin(1e-6));
+            CHECK(tab->get_Ar01(T, rho, z) == Approx(model->get_Ar01(T, rho, z)).margin(1e-6));
+            CHECK(tab->get_Ar10(T, rho, z) == Approx(model->get_Ar10(T, rho, z)).margin(1e-6));
+        }
+    }
+    // Second virial coefficient comes from the limit of zero density
+    CHECK(tab->get_B2vir(300.0, z) == Approx(model->get_B2vir(300.0, z)).epsilon(1e-6));
+    
+    CHECK_THROWS(tab->get_Ar00(100.0, 1000.0, z));
+    CHECK_THROWS(tab->get_Ar00(300.0, 20000.0, z));
+    
+    SECTION("save and reload"){
+        const auto& tabmodel = cppinterface::adapter::get_model_cref<tabulated::TabulatedAlphar>(tab.get());
+        auto report = tabmodel.get_build_report();
+        CHECK(report.at("max_abs_err_alphar") < 1e-7);
+        // A unique file in the temporary directory, so that nothing is left in the build tree and parallel runs do not collide
+        auto path = std::filesystem::temp_directory_path() / ("teqp_methane_PR_" + std::to_string(std::random_device{}()) + ".teqptab");
+        tabmodel.save(path.string());
+        for (auto mmap : {true, false}){
+            auto reloaded = cppinterface::make_model({{"kind", "tabulated"}, {"model", {{"path", path.string()}, {"mmap", mmap}}}});
+            CHECK(reloaded->get_Ar01(287.1, 512.0, z) == tab->get_Ar01(287.1, 512.0, z));
+        }
+        std::filesystem::remove(path);
+        CHECK(!std::filesystem::exists(path));
+        auto fromjson = tabulated::TabulatedAlphar::from_json(tabmodel.to_json());
+        CHECK(fromjson.alphar(287.1, 512.0, z) == tab->get_Ar00(287.1, 512.0, z));
+    }
+}
+
+TEST_CASE("Tabulated model excludes the two-phase region", "[tabulated]")
+{
+    nlohmann::json j = {
+        {"kind", "tabulated"},
+        {"model", {
+            {"model", PR_methane},
+            {"molefrac", {1.0}},
+            {"Tmin / K", 120.0}, {"Tmax / K", 300.0},
+            {"rhomin / mol/m^3", 0.0}, {"rhomax / mol/m^3", 28000.0},
+            {"NT", 10}, {"Nrho", 15},
+            {"tolerance", 1e-6},
+            {"Tcguess / K", 190.0}, {"rhocguess / mol/m^3", 10000.0}
+        }}
+    };
+    auto tab = cppinterface::make_model(j);
+    const auto& tabmodel = cppinterface::adapter::get_model_cref<tabulated::TabulatedAlphar>(tab.get());
+    auto report = tabmodel.get_build_report();
+    CHECK(report.at("excluded_cells") > 0);
+    CHECK(tabmodel.is_excluded(130.0, 10000.0));
+    CHECK_THROWS(tab->get_Ar00(130.0, 10000.0, Eigen::ArrayXd::Ones(1)));
+    CHECK(!tabmodel.is_excluded(250.0, 10000.0));
+}
@@ -23,8 +23,12 @@ public:
 CATCH_REGISTER_LISTENER(testRunListener)
 
 #include "teqp/models/cubics/cubicsuperancillary.hpp"
+#include "teqp/models/cubics/simple_cubics.hpp"
 #include "teqp/models/CPA.hpp"
 #include "teqp/models/vdW.hpp"
+#include "teqp/models/pcsaft.hpp"
+#include "teqp/models/saftvrmie.hpp"
+#include "teqp/cpp/teqpcpp.hpp"
 
 #include "teqp/algorithms/VLE.hpp"
 #include "teqp/algorithms/critical_tracing.hpp"
@@ -329,6 +333,217 @@ TEST_CASE("Trace critical locus for vdW", "[vdW][crit]")
     CHECK(max_spluses.min() > -log(1 - 1.0 / 3.0));
 }
 
+TEST_CASE("Check derivative of critical curve for vdW", "[vdW][crit]")
+{
+    // Argon + Xenon
+    std::valarray<double> Tc_K = { 150.687, 289.733 };
+    std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+    const std::valarray<double> molefrac = { 1.0 };
+    vdWEOS<double> vdW(Tc_K, pc_Pa);
+    auto Zc = 3.0/8.0;
+    auto rhoc0 = pc_Pa[0] / (vdW.R(molefrac) * Tc_K[0]) / Zc;
+    Eigen::ArrayXd rhovec0(2); rhovec0 << rhoc0, 0.0;
+    
+    using ct = CriticalTracing<decltype(vdW), double, Eigen::ArrayXd>;
+    auto trace = ct::trace_critical_arclength_binary(vdW, Tc_K[0], rhovec0);
+    REQUIRE(trace.size() > 10);
+    
+    // A point in the middle of the critical curve, where both concentrations are non-zero
+    auto& pt = trace[trace.size()/2];
+    double T = pt.at("T / K");
+    Eigen::ArrayXd rhovec = (Eigen::ArrayXd(2) << pt.at("rho0 / mol/m^3"), pt.at("rho1 / mol/m^3")).finished();
+    Eigen::ArrayXd drhovecdT = ct::get_drhovec_dT_crit(vdW, T, rhovec);
+    
+    // Stepping along the derivative keeps the criticality conditions satisfied to second order in the step
+    auto conditions = [&](double T_, const Eigen::ArrayXd& rhovec_){
+        auto tot = ct::get_derivs(vdW, T_, rhovec_).tot;
+        return (Eigen::ArrayXd(2) << tot[2], tot[3]).finished();
+    };
+    double h = 1e-3;
+    auto c0 = conditions(T, rhovec);
+    auto c_along = conditions(T + h, (rhovec + h*drhovecdT).eval()) - c0;
+    auto c_Tonly = conditions(T + h, rhovec) - c0;
+    CAPTURE(c_along);
+    CAPTURE(c_Tonly);
+    CHECK(std::abs(c_along[0]) < 1e-3*std::abs(c_Tonly[0]));
+    CHECK(std::abs(c_along[1]) < 1e-3*std::abs(c_Tonly[1]));
+}
+
+TEST_CASE("Check isochoric derivative bundle against the individual derivatives", "[vdW][isochoric]")
+{
+    std::valarray<double> Tc_K = { 150.687, 289.733 };
+    std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+    vdWEOS<double> vdW(Tc_K, pc_Pa);
+    double T = 200;
+    Eigen::ArrayXd rhovec = (Eigen::ArrayXd(2) << 3000.0, 5000.0).finished();
+    
+    using id = IsochoricDerivatives<decltype(vdW)>;
+    auto b = id::build_isochoric_derivative_bundle(vdW, T, rhovec);
+    auto [Psir, grad, H] = id::build_Psir_fgradHessian_autodiff(vdW, T, rhovec);
+    auto rel = [](const auto& a, const auto& b){ return ((a-b).abs()/b.abs()).maxCoeff(); };
+    CHECK(b.Psir == Approx(Psir).epsilon(1e-13));
+    CHECK(rel(b.gradient_Psir, grad) < 1e-13);
+    CHECK(rel(b.Hessian_Psir.array(), H.array()) < 1e-13);
+    CHECK(rel(b.Hessian_Psi().array(), id::build_Psi_Hessian_autodiff(vdW, T, rhovec).array()) < 1e-13);
+    CHECK(b.dPsirdT == Approx(id::get_dPsirdT_constrhovec(vdW, T, rhovec)).epsilon(1e-13));
+    CHECK(rel(b.d2PsirdTdrhovec, id::build_d2PsirdTdrhoi_autodiff(vdW, T, rhovec)) < 1e-13);
+    CHECK(b.p() == Approx(T*b.R*rhovec.sum() + id::get_pr(vdW, T, rhovec)).epsilon(1e-13));
+    CHECK(b.dpdT() == Approx(id::get_dpdT_constrhovec(vdW, T, rhovec)).epsilon(1e-13));
+    CHECK(rel(b.dpdrhovec(), id::get_dpdrhovec_constT(vdW, T, rhovec)) < 1e-13);
+    CHECK(rel(b.dchempotdT(), id::get_dchempotdT_autodiff(vdW, T, rhovec)) < 1e-13);
+    
+    // Without the temperature derivatives, those that need them are not available
+    auto bnoT = id::build_isochoric_derivative_bundle(vdW, T, rhovec, false);
+    CHECK(rel(bnoT.Hessian_Psir.array(), H.array()) < 1e-13);
+    CHECK_THROWS(bnoT.dpdT());
+}
+
+TEST_CASE("Check vector-mode Hessian of Psir against autodiff", "[isochoric]")
+{
+    auto check = [](const auto& model, double T, const Eigen::ArrayXd& rhovec){
+        using id = IsochoricDerivatives<decltype(model)>;
+        auto [Psir, grad, H] = id::build_Psir_fgradHessian_autodiff(model, T, rhovec);
+        auto [Psirv, gradv, Hv] = id::build_Psir_fgradHessian_vectorAD(model, T, rhovec);
+        auto rel = [](const auto& a, const auto& b){ return ((a-b).abs()/b.abs()).maxCoeff(); };
+        CHECK(Psirv == Approx(Psir).epsilon(1e-13));
+        CHECK(rel(gradv, grad) < 1e-13);
+        CHECK(rel(Hv.array(), H.array()) < 1e-12);
+        CHECK(rel(id::template build_Psir_Hessian_vectorAD<5>(model, T, rhovec).array(), H.array()) < 1e-12);
+    };
+    SECTION("vdW"){
+        std::valarray<double> Tc_K = { 150.687, 289.733 };
+        std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+        check(vdWEOS<double>(Tc_K, pc_Pa), 200, (Eigen::ArrayXd(2) << 3000.0, 5000.0).finished());
+    }
+    SECTION("PR with five components"){
+        std::valarray<double> Tc_K = { 190.564, 305.32, 369.89, 425.12, 469.7 };
+        std::valarray<double> pc_Pa = { 4599200.0, 4872200.0, 4251200.0, 3796000.0, 3370000.0 };
+        std::valarray<double> acentric = { 0.011, 0.099, 0.152, 0.2, 0.252 };
+        check(canonical_PR(Tc_K, pc_Pa, acentric), 300, (Eigen::ArrayXd(5) << 1000.0, 800, 600, 400, 200).finished());
+    }
+    SECTION("PC-SAFT with three components, also against complex step and finite differences"){
+        auto model = saft::pcsaft::PCSAFTMixture(std::vector<std::string>{"Methane", "Ethane", "Propane"});
+        double T = 300;
+        Eigen::ArrayXd rhovec = (Eigen::ArrayXd(3) << 1000.0, 800, 600).finished();
+        check(model, T, rhovec);
+        
+        using id = IsochoricDerivatives<decltype(model)>;
+        auto [Psirv, gradv, Hv] = id::build_Psir_fgradHessian_vectorAD(model, T, rhovec);
+        const double R = model.R(rhovec);
+        auto Psir = [&](const Eigen::ArrayX<std::complex<double>>& rho){
+            auto rhotot = rho.sum();
+            auto molefrac = (rho/rhotot).eval();
+            return model.alphar(T, rhotot, molefrac)*R*T*rhotot;
+        };
+        double h = 1e-100;
+        for (auto i = 0; i < 3; ++i){
+            // The gradient by complex step is exact to numerical precision
+            Eigen::ArrayX<std::complex<double>> rhoi = rhovec.cast<std::complex<double>>();
+            rhoi[i] += std::complex<double>(0, h);
+            CHECK(gradv[i] == Approx(Psir(rhoi).imag()/h).epsilon(1e-13));
+            // And the Hessian from central differences of the complex-step gradient
+            for (auto j = 0; j < 3; ++j){
+                double drho = 1e-3*rhovec[j];
+                auto rhoplus = rhoi, rhominus = rhoi;
+                rhoplus[j] += drho; rhominus[j] -= drho;
+                CHECK(Hv(i, j) == Approx((Psir(rhoplus).imag() - Psir(rhominus).imag())/h/(2*drho)).epsilon(1e-7));
+            }
+        }
+    }
+    SECTION("The lower triangle of the propagated Hessian is zero rather than uninitialized"){
+        auto model = saft::pcsaft::PCSAFTMixture(std::vector<std::string>{"Methane", "Ethane", "Propane"});
+        using vhd = VectorHyperDual<5>;
+        Eigen::ArrayX<vhd> rhovec(3);
+        for (auto i = 0; i < 3; ++i){ rhovec[i] = vhd::variable(1000.0 - 200*i, i, 3); }
+        vhd rhotot = rhovec.sum();
+        auto molefrac = (rhovec/rhotot).eval();
+        vhd u = model.alphar(300.0, rhotot, molefrac)*rhotot;
+        Eigen::MatrixXd lower = u.hess.template triangularView<Eigen::StrictlyLower>();
+        CHECK(lower.isZero(0.0));
+    }
+    SECTION("too many components"){
+        std::valarray<double> Tc_K = { 150.687, 289.733 };
+        std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+        vdWEOS<double> vdW(Tc_K, pc_Pa);
+        using id = IsochoricDerivatives<decltype(vdW)>;
+        CHECK_THROWS_AS(id::build_Psir_Hessian_vectorAD<1>(vdW, 200, (Eigen::ArrayXd(2) << 3000.0, 5000.0).finished()), teqp::InvalidArgument);
+    }
+}
+
+TEST_CASE("Check reverse-mode gradient of Psir against autodiff", "[isochoric]")
+{
+    auto check = [](const auto& model, double T, const Eigen::ArrayXd& rhovec){
+        using id = IsochoricDerivatives<decltype(model)>;
+        Eigen::ArrayXd grad = id::build_Psir_gradient_autodiff(model, T, rhovec);
+        auto gradr = id::build_Psir_gradient_reverse(model, T, rhovec);
+        auto rel = [](const auto& a, const auto& b){ return ((a-b).abs()/b.abs()).maxCoeff(); };
+        CHECK(rel(gradr, grad) < 1e-13);
+        CHECK(rel(id::template get_ln_fugacity_coefficients<ADBackends::reverse>(model, T, rhovec), id::get_ln_fugacity_coefficients(model, T, rhovec)) < 1e-12);
+        // Nothing is left behind on the tape
+        CHECK(adjoint::get_tape().size() == 0);
+    };
+    SECTION("vdW"){
+        std::valarray<double> Tc_K = { 150.687, 289.733 };
+        std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+        check(vdWEOS<double>(Tc_K, pc_Pa), 200, (Eigen::ArrayXd(2) << 3000.0, 5000.0).finished());
+    }
+    SECTION("PR with 40 pseudo-components"){
+        auto N = 40;
+        std::valarray<double> Tc_K(N), pc_Pa(N), acentric(N);
+        for (auto i = 0; i < N; ++i){
+            Tc_K[i] = 190.0 + 10.0*i; pc_Pa[i] = 4.6e6 - 5e4*i; acentric[i] = 0.01 + 0.02*i;
+        }
+        check(canonical_PR(Tc_K, pc_Pa, acentric), 400, Eigen::ArrayXd::LinSpaced(N, 10, 50));
+    }
+    SECTION("PC-SAFT"){
+        check(saft::pcsaft::PCSAFTMixture(std::vector<std::string>{"Methane", "Ethane", "Propane"}), 300, (Eigen::ArrayXd(3) << 1000.0, 800.0, 600.0).finished());
+    }
+    SECTION("Polarizable SAFT-VR-Mie"){
+        // The polarizable dipoles are solved for iteratively, so this also covers the implicit steps taken with AdjointVar
+        auto j = R"({"polar_model": "GrayGubbins+GubbinsTwu", "polar_flags": {"polarizable": {"alpha_symm / m^3": [0.06e-30, 0.1e-30, 0.08e-30], "alpha_asymm / m^3": [0.0, 0.0, 0.0]}}, "coeffs": [
+            {"name": "A", "BibTeXKey": "me", "m": 1.0, "epsilon_over_k": 100, "sigma_m": 1e-10, "lambda_r": 12.0, "lambda_a": 6.0, "mu_Cm": 3.9e-31, "nmu": 1.0},
+            {"name": "B", "BibTeXKey": "me", "m": 1.2, "epsilon_over_k": 150, "sigma_m": 1.2e-10, "lambda_r": 14.0, "lambda_a": 6.0, "mu_Cm": 2.5e-31, "nmu": 1.0},
+            {"name": "C", "BibTeXKey": "me", "m": 1.5, "epsilon_over_k": 120, "sigma_m": 1.1e-10, "lambda_r": 13.0, "lambda_a": 6.0, "mu_Cm": 1.5e-31, "nmu": 1.0}
+        ]})"_json;
+        double rho = 0.3/pow(1.1e-10, 3)/teqp::constants::N_A;
+        check(SAFTVRMie::SAFTVRMiefactory(j), 150, (Eigen::ArrayXd(3) << 0.4*rho, 0.3*rho, 0.3*rho).finished());
+    }
+}
+
+TEST_CASE("Fugacity coefficients from the AbstractModel switch to reverse mode for many components", "[isochoric]")
+{
+    auto check = [](const nlohmann::json& j, const auto& model, double T, const Eigen::ArrayXd& rhovec){
+        auto am = teqp::cppinterface::make_model(j);
+        using id = IsochoricDerivatives<decltype(model)>;
+        Eigen::ArrayXd phi = am->get_fugacity_coefficients(T, rhovec);
+        Eigen::ArrayXd phifwd = id::get_fugacity_coefficients(model, T, rhovec);
+        Eigen::ArrayXd phirev = id::template get_fugacity_coefficients<ADBackends::reverse>(model, T, rhovec);
+        CHECK(((phi - phifwd).abs()/phifwd.abs()).maxCoeff() < 1e-12);
+        CHECK(((phi - phirev).abs()/phirev.abs()).maxCoeff() < 1e-12);
+        CHECK(adjoint::get_tape().size() == 0);
+    };
+    for (auto N : {2, 6}){
+        CAPTURE(N);
+        nlohmann::json coeffs = nlohmann::json::array();
+        for (auto i = 0; i < N; ++i){
+            coeffs.push_back({{"name", "C" + std::to_string(i)}, {"BibTeXKey", "me"}, {"m", 1.0 + 0.3*i}, {"sigma_Angstrom", 3.7 + 0.05*i}, {"epsilon_over_k", 150.0 + 10*i}});
+        }
+        nlohmann::json model = {{"coeffs", coeffs}};
+        check({{"kind", "PCSAFT"}, {"model", model}}, saft::pcsaft::PCSAFTfactory(model), 300, Eigen::ArrayXd::Constant(N, 3000.0/N));
+    }
+    SECTION("Polarizable SAFT-VR-Mie"){
+        const int N = 5;
+        nlohmann::json coeffs = nlohmann::json::array(), alpha = nlohmann::json::array(), zero = nlohmann::json::array();
+        for (auto i = 0; i < N; ++i){
+            coeffs.push_back({{"name", "C" + std::to_string(i)}, {"BibTeXKey", "me"}, {"m", 1.0 + 0.1*i}, {"epsilon_over_k", 100.0 + 10*i}, {"sigma_m", (1.0 + 0.05*i)*1e-10}, {"lambda_r", 12.0 + 0.5*i}, {"lambda_a", 6.0}, {"mu_Cm", 3.9e-31/(1 + i)}, {"nmu", 1.0}});
+            alpha.push_back((0.06 + 0.01*i)*1e-30); zero.push_back(0.0);
+        }
+        nlohmann::json model = {{"polar_model", "GrayGubbins+GubbinsTwu"}, {"polar_flags", {{"polarizable", {{"alpha_symm / m^3", alpha}, {"alpha_asymm / m^3", zero}}}}}, {"coeffs", coeffs}};
+        double rho = 0.3/pow(1.1e-10, 3)/teqp::constants::N_A;
+        check({{"kind", "SAFT-VR-Mie"}, {"model", model}}, SAFTVRMie::SAFTVRMiefactory(model), 150, Eigen::ArrayXd::Constant(N, rho/N));
+    }
+}
+
 TEST_CASE("Check criticality conditions for vdW", "[vdW][crit]")
 {
     // Argon